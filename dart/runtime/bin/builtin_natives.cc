@@ -40,6 +40,8 @@ namespace bin {
   V(File_Read, 2)                                                              \
   V(File_ReadInto, 4)                                                          \
   V(File_WriteFrom, 4)                                                         \
+  V(File_ReadAt, 3)                                                            \
+  V(File_WriteAt, 5)                                                           \
   V(File_Position, 1)                                                          \
   V(File_SetPosition, 2)                                                       \
   V(File_Truncate, 2)                                                          \
@@ -48,6 +50,7 @@ namespace bin {
   V(File_Stat, 1)                                                              \
   V(File_LastModified, 1)                                                      \
   V(File_Flush, 1)                                                             \
+  V(File_Map, 4)                                                               \
   V(File_Create, 1)                                                            \
   V(File_CreateLink, 2)                                                        \
   V(File_LinkTarget, 1)                                                        \
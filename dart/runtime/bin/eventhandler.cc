@@ -16,52 +16,143 @@ namespace bin {
 static const intptr_t kTimerId = -1;
 static const intptr_t kInvalidId = -2;
 
+TimeoutQueue::TimeoutQueue()
+    : ports_(&SamePort, kInitialCapacity),
+      heap_(reinterpret_cast<Timeout**>(
+          malloc(kInitialCapacity * sizeof(Timeout*)))),  // NOLINT
+      size_(0),
+      capacity_(kInitialCapacity) {}
+
+
+TimeoutQueue::~TimeoutQueue() {
+  for (intptr_t i = 0; i < size_; i++) {
+    delete heap_[i];
+  }
+  free(heap_);
+}
+
+
 void TimeoutQueue::UpdateTimeout(Dart_Port port, int64_t timeout) {
-  // Find port if present.
-  Timeout* last = NULL;
-  Timeout* current = timeouts_;
-  while (current != NULL) {
-    if (current->port() == port) {
-      // Found.
-      if (timeout < 0) {
-        // Remove from list and delete existing.
-        if (last != NULL) {
-          last->set_next(current->next());
-        } else {
-          timeouts_ = current->next();
-        }
-        delete current;
-      } else {
-        // Update timeout.
-        current->set_timeout(timeout);
-      }
-      break;
-    }
-    last = current;
-    current = current->next();
+  Timeout key(port, 0);
+  uint32_t hash = HashPort(port);
+  HashMap::Entry* entry = ports_.Lookup(&key, hash, timeout >= 0);
+  if (entry == NULL) {
+    // Removing a port without a timeout.
+    return;
   }
-  if (current == NULL && timeout >= 0) {
+  Timeout* current = reinterpret_cast<Timeout*>(entry->value);
+  if (timeout < 0) {
+    ASSERT(current != NULL);
+    Remove(current);
+    ports_.Remove(current, hash);
+    delete current;
+  } else if (current == NULL) {
     // Not found, create a new.
-    timeouts_ = new Timeout(port, timeout, timeouts_);
+    current = new Timeout(port, timeout);
+    entry->key = current;
+    entry->value = current;
+    Insert(current);
+  } else {
+    int64_t previous = current->timeout();
+    current->set_timeout(timeout);
+    if (timeout < previous) {
+      SiftUp(current);
+    } else {
+      SiftDown(current);
+    }
+  }
+}
+
+
+void TimeoutQueue::Insert(Timeout* timeout) {
+  if (size_ == capacity_) {
+    capacity_ *= 2;
+    heap_ = reinterpret_cast<Timeout**>(
+        realloc(heap_, capacity_ * sizeof(Timeout*)));  // NOLINT
+  }
+  Place(timeout, size_);
+  size_++;
+  SiftUp(timeout);
+}
+
+
+void TimeoutQueue::Remove(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  ASSERT(heap_[index] == timeout);
+  size_--;
+  if (index == size_) {
+    return;
+  }
+  // Move the last timeout into the hole and restore the heap order.
+  Timeout* last = heap_[size_];
+  Place(last, index);
+  if (last->timeout() < timeout->timeout()) {
+    SiftUp(last);
+  } else {
+    SiftDown(last);
+  }
+}
+
+
+void TimeoutQueue::SiftUp(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  while (index > 0) {
+    intptr_t parent_index = (index - 1) / 2;
+    Timeout* parent = heap_[parent_index];
+    if (parent->timeout() <= timeout->timeout()) {
+      break;
+    }
+    Place(parent, index);
+    index = parent_index;
   }
-  // Clear and find next timeout.
-  next_timeout_ = NULL;
-  current = timeouts_;
-  while (current != NULL) {
-    if (next_timeout_ == NULL ||
-        current->timeout() < next_timeout_->timeout()) {
-      next_timeout_ = current;
+  Place(timeout, index);
+}
+
+
+void TimeoutQueue::SiftDown(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  while (true) {
+    intptr_t child_index = 2 * index + 1;
+    if (child_index >= size_) {
+      break;
     }
-    current = current->next();
+    if ((child_index + 1 < size_) &&
+        (heap_[child_index + 1]->timeout() < heap_[child_index]->timeout())) {
+      child_index++;
+    }
+    Timeout* child = heap_[child_index];
+    if (timeout->timeout() <= child->timeout()) {
+      break;
+    }
+    Place(child, index);
+    index = child_index;
   }
+  Place(timeout, index);
 }
 
 
 static EventHandler* event_handler = NULL;
+bool EventHandler::use_oneshot_ = false;
+intptr_t EventHandler::poller_count_ = 1;
+
+// Counts the event handlers which have not been deleted by their thread yet.
+static dart::Monitor* shutdown_monitor = new dart::Monitor();
+static intptr_t running_handlers = 0;
+
+
+EventHandler::~EventHandler() {
+  MonitorLocker ml(shutdown_monitor);
+  running_handlers--;
+  ml.NotifyAll();
+}
 
 
 void EventHandler::Start() {
   ASSERT(event_handler == NULL);
+  {
+    MonitorLocker ml(shutdown_monitor);
+    running_handlers++;
+  }
   event_handler = new EventHandler();
   event_handler->delegate_.Start(event_handler);
 }
@@ -74,6 +165,14 @@ void EventHandler::Stop() {
 }
 
 
+void EventHandler::WaitForShutdown() {
+  MonitorLocker ml(shutdown_monitor);
+  while (running_handlers > 0) {
+    ml.Wait();
+  }
+}
+
+
 EventHandlerImplementation* EventHandler::delegate() {
   if (event_handler == NULL) return NULL;
   return &event_handler->delegate_;
@@ -8,6 +8,8 @@
 #include "bin/builtin.h"
 #include "bin/isolate_data.h"
 
+#include "platform/hashmap.h"
+
 namespace dart {
 namespace bin {
 
@@ -29,12 +31,15 @@ enum MessageFlags {
 };
 
 
+// TimeoutQueue keeps the timeouts of the Dart timer ports in a binary
+// min-heap, so adding, updating and removing a timeout are O(log n). A hash
+// map from port to timeout finds the heap entry to update.
 class TimeoutQueue {
  private:
   class Timeout {
    public:
-    Timeout(Dart_Port port, int64_t timeout, Timeout* next)
-        : port_(port), timeout_(timeout), next_(next) {}
+    Timeout(Dart_Port port, int64_t timeout)
+        : port_(port), timeout_(timeout), index_(-1) {}
 
     Dart_Port port() const { return port_; }
 
@@ -44,43 +49,64 @@ class TimeoutQueue {
       timeout_ = timeout;
     }
 
-    Timeout* next() const { return next_; }
-    void set_next(Timeout* next) {
-      next_ = next;
-    }
+    // Position in the heap.
+    intptr_t index() const { return index_; }
+    void set_index(intptr_t index) { index_ = index; }
 
    private:
     Dart_Port port_;
     int64_t timeout_;
-    Timeout* next_;
+    intptr_t index_;
   };
 
  public:
-  TimeoutQueue() : next_timeout_(NULL), timeouts_(NULL) {}
-
-  ~TimeoutQueue() {
-    while (HasTimeout()) RemoveCurrent();
-  }
+  TimeoutQueue();
+  ~TimeoutQueue();
 
-  bool HasTimeout() const { return next_timeout_ != NULL; }
+  bool HasTimeout() const { return size_ > 0; }
 
   int64_t CurrentTimeout() const {
-    return next_timeout_->timeout();
+    return heap_[0]->timeout();
   }
 
   Dart_Port CurrentPort() const {
-    return next_timeout_->port();
+    return heap_[0]->port();
   }
 
   void RemoveCurrent() {
     UpdateTimeout(CurrentPort(), -1);
   }
 
+  // Adds or changes the timeout of the port. A negative timeout removes it.
   void UpdateTimeout(Dart_Port port, int64_t timeout);
 
  private:
-  Timeout* next_timeout_;
-  Timeout* timeouts_;
+  static const intptr_t kInitialCapacity = 16;
+
+  static bool SamePort(void* key1, void* key2) {
+    return reinterpret_cast<Timeout*>(key1)->port() ==
+        reinterpret_cast<Timeout*>(key2)->port();
+  }
+
+  static uint32_t HashPort(Dart_Port port) {
+    return static_cast<uint32_t>(port ^ (port >> 32));
+  }
+
+  void Insert(Timeout* timeout);
+  void Remove(Timeout* timeout);
+  void SiftUp(Timeout* timeout);
+  void SiftDown(Timeout* timeout);
+  void Place(Timeout* timeout, intptr_t index) {
+    heap_[index] = timeout;
+    timeout->set_index(index);
+  }
+
+  HashMap ports_;
+  Timeout** heap_;
+  intptr_t size_;
+  intptr_t capacity_;
+
+  DISALLOW_COPY_AND_ASSIGN(TimeoutQueue);
 };
 
 }  // namespace bin
@@ -119,11 +145,41 @@ class EventHandler {
    */
   static void Stop();
 
+  /**
+   * Wait until the threads of all stopped event-handlers have exited, e.g.
+   * before changing the settings below for the next Start.
+   */
+  static void WaitForShutdown();
+
+  ~EventHandler();
+
   static EventHandlerImplementation* delegate();
 
+  /**
+   * Rearm file descriptors with EPOLLONESHOT after an event instead of
+   * removing them from and adding them to the epoll set again. Only the
+   * Linux event handler supports this mode. Must be set before Start.
+   */
+  static void set_use_oneshot(bool value) { use_oneshot_ = value; }
+  static bool use_oneshot() { return use_oneshot_; }
+
+  /**
+   * Number of poller threads, each with its own set of file descriptors.
+   * File descriptors are assigned to pollers by hash. Only the Linux event
+   * handler supports more than one poller. Must be set before Start.
+   */
+  static void set_poller_count(intptr_t value) {
+    ASSERT(value > 0);
+    poller_count_ = value;
+  }
+  static intptr_t poller_count() { return poller_count_; }
+
  private:
   friend class EventHandlerImplementation;
   EventHandlerImplementation delegate_;
+
+  static bool use_oneshot_;
+  static intptr_t poller_count_;
 };
 
 }  // namespace bin
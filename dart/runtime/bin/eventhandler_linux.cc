@@ -19,6 +19,7 @@
 #include "bin/dartutils.h"
 #include "bin/fdutils.h"
 #include "bin/log.h"
+#include "bin/thread.h"
 #include "bin/utils.h"
 #include "platform/hashmap.h"
 #include "platform/thread.h"
@@ -74,6 +75,11 @@ static void UpdateEpollInstance(intptr_t epoll_fd_, SocketData* sd) {
   event.events = sd->GetPollEvents();
   event.data.ptr = sd;
   if (sd->port() != 0 && event.events != 0) {
+    if (EventHandler::use_oneshot()) {
+      // The file descriptor stays in the epoll set but is disabled after
+      // reporting an event, until it is rearmed by EPOLL_CTL_MOD.
+      event.events |= EPOLLONESHOT;
+    }
     int status = 0;
     if (sd->tracked_by_epoll()) {
       status = TEMP_FAILURE_RETRY(epoll_ctl(epoll_fd_,
@@ -102,7 +108,12 @@ static void UpdateEpollInstance(intptr_t epoll_fd_, SocketData* sd) {
 
 
 EventHandlerImplementation::EventHandlerImplementation()
-    : socket_map_(&HashMap::SamePointerValue, 16) {
+    : socket_map_(&HashMap::SamePointerValue, 16),
+      handler_(NULL),
+      pollers_(NULL),
+      poller_count_(0),
+      primary_(NULL),
+      running_pollers_(0) {
   intptr_t result;
   result = TEMP_FAILURE_RETRY(pipe(interrupt_fds_));
   if (result != 0) {
@@ -138,6 +149,7 @@ EventHandlerImplementation::~EventHandlerImplementation() {
   TEMP_FAILURE_RETRY(close(epoll_fd_));
   TEMP_FAILURE_RETRY(close(interrupt_fds_[0]));
   TEMP_FAILURE_RETRY(close(interrupt_fds_[1]));
+  delete[] pollers_;
 }
 
 
@@ -194,6 +206,7 @@ void EventHandlerImplementation::HandleInterruptFd() {
     } else if (msg.id == kShutdownId) {
       shutdown_ = true;
     } else {
+      MutexLocker ml(&socket_map_lock_);
       SocketData* sd = GetSocketData(msg.id);
       if ((msg.data & (1 << kShutdownReadCommand)) != 0) {
         ASSERT(msg.data == (1 << kShutdownReadCommand));
@@ -338,6 +351,20 @@ void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
   for (int i = 0; i < size; i++) {
     if (events[i].data.ptr == NULL) {
       interrupt_seen = true;
+    } else if (EventHandler::use_oneshot()) {
+      MutexLocker ml(&socket_map_lock_);
+      SocketData* sd = reinterpret_cast<SocketData*>(events[i].data.ptr);
+      intptr_t event_mask = GetPollEvents(events[i].events, sd);
+      if (event_mask != 0) {
+        // The file descriptor has been disabled by EPOLLONESHOT. It is
+        // rearmed when the current event has been handled in Dart code.
+        Dart_Port port = sd->port();
+        ASSERT(port != 0);
+        DartUtils::PostInt32(port, event_mask);
+      } else {
+        // Nothing to report, so keep waiting for events.
+        UpdateEpollInstance(epoll_fd_, sd);
+      }
     } else {
       SocketData* sd = reinterpret_cast<SocketData*>(events[i].data.ptr);
       intptr_t event_mask = GetPollEvents(events[i].events, sd);
@@ -385,9 +412,14 @@ void EventHandlerImplementation::HandleTimeout() {
 
 void EventHandlerImplementation::Poll(uword args) {
   static const intptr_t kMaxEvents = 16;
-  struct epoll_event events[kMaxEvents];
-  EventHandler* handler = reinterpret_cast<EventHandler*>(args);
-  EventHandlerImplementation* handler_impl = &handler->delegate_;
+  // Events are cheaper to handle in oneshot mode, so take more of them per
+  // epoll_wait call.
+  static const intptr_t kMaxOneShotEvents = 256;
+  struct epoll_event events[kMaxOneShotEvents];
+  const intptr_t max_events =
+      EventHandler::use_oneshot() ? kMaxOneShotEvents : kMaxEvents;
+  EventHandlerImplementation* handler_impl =
+      reinterpret_cast<EventHandlerImplementation*>(args);
   ASSERT(handler_impl != NULL);
   while (!handler_impl->shutdown_) {
     int64_t millis = handler_impl->GetTimeout();
@@ -395,7 +427,7 @@ void EventHandlerImplementation::Poll(uword args) {
     if (millis > kMaxInt32) millis = kMaxInt32;
     intptr_t result = TEMP_FAILURE_RETRY(epoll_wait(handler_impl->epoll_fd_,
                                                     events,
-                                                    kMaxEvents,
+                                                    max_events,
                                                     millis));
     ASSERT(EAGAIN == EWOULDBLOCK);
     if (result == -1) {
@@ -407,31 +439,114 @@ void EventHandlerImplementation::Poll(uword args) {
       handler_impl->HandleEvents(events, result);
     }
   }
-  delete handler;
+  if (handler_impl->handler_ != NULL) {
+    // The other pollers read the event handler settings until they exit.
+    {
+      MonitorLocker ml(&handler_impl->pollers_monitor_);
+      while (handler_impl->running_pollers_ > 0) {
+        ml.Wait();
+      }
+    }
+    delete handler_impl->handler_;
+  } else {
+    EventHandlerImplementation* primary = handler_impl->primary_;
+    delete handler_impl;
+    MonitorLocker ml(&primary->pollers_monitor_);
+    primary->running_pollers_--;
+    ml.Notify();
+  }
 }
 
 
 void EventHandlerImplementation::Start(EventHandler* handler) {
-  int result = dart::Thread::Start(&EventHandlerImplementation::Poll,
-                                   reinterpret_cast<uword>(handler));
-  if (result != 0) {
-    FATAL1("Failed to start event handler thread %d", result);
+  handler_ = handler;
+  poller_count_ = EventHandler::poller_count();
+  pollers_ = new EventHandlerImplementation*[poller_count_];
+  pollers_[0] = this;
+  for (intptr_t i = 1; i < poller_count_; i++) {
+    pollers_[i] = new EventHandlerImplementation();
+    pollers_[i]->primary_ = this;
+  }
+  running_pollers_ = poller_count_ - 1;
+  for (intptr_t i = 0; i < poller_count_; i++) {
+    int result = dart::Thread::Start(&EventHandlerImplementation::Poll,
+                                     reinterpret_cast<uword>(pollers_[i]));
+    if (result != 0) {
+      FATAL1("Failed to start event handler thread %d", result);
+    }
   }
 }
 
 
 void EventHandlerImplementation::Shutdown() {
+  for (intptr_t i = 1; i < poller_count_; i++) {
+    pollers_[i]->WakeupHandler(kShutdownId, 0, 0);
+  }
   SendData(kShutdownId, 0, 0);
 }
 
 
+// Returns the poller handling the given file descriptor. Timers and
+// control messages are handled by the primary poller.
+EventHandlerImplementation* EventHandlerImplementation::PollerFor(
+    intptr_t id) {
+  if ((poller_count_ <= 1) || (id < 0)) {
+    return this;
+  }
+  return pollers_[GetHashmapHashFromFd(id) % poller_count_];
+}
+
+
 void EventHandlerImplementation::SendData(intptr_t id,
                                           Dart_Port dart_port,
                                           int64_t data) {
+  EventHandlerImplementation* poller = PollerFor(id);
+  if (poller != this) {
+    poller->SendData(id, dart_port, data);
+    return;
+  }
+  if (EventHandler::use_oneshot() &&
+      (id >= 0) &&
+      TryRearm(id, dart_port, data)) {
+    return;
+  }
   WakeupHandler(id, dart_port, data);
 }
 
 
+// In oneshot mode a file descriptor already in the epoll set is rearmed
+// directly from the calling thread, saving the round-trip through the
+// interrupt pipe. Returns false if the request has to be handled by the
+// event handler thread.
+bool EventHandlerImplementation::TryRearm(intptr_t fd,
+                                          Dart_Port dart_port,
+                                          int64_t data) {
+  const int64_t kCommands = (1 << kCloseCommand) |
+                            (1 << kShutdownReadCommand) |
+                            (1 << kShutdownWriteCommand);
+  if ((data & kCommands) != 0) {
+    return false;
+  }
+  MutexLocker ml(&socket_map_lock_);
+  HashMap::Entry* entry = socket_map_.Lookup(
+      GetHashmapKeyFromFd(fd), GetHashmapHashFromFd(fd), false);
+  if (entry == NULL) {
+    return false;
+  }
+  SocketData* sd = reinterpret_cast<SocketData*>(entry->value);
+  if (!sd->tracked_by_epoll() || (sd->port() != dart_port)) {
+    return false;
+  }
+  if (((data & (1 << kInEvent)) != 0) && sd->IsClosedRead()) {
+    // Let the event handler thread report the close event.
+    return false;
+  }
+  sd->SetPortAndMask(dart_port, data);
+  UpdateEpollInstance(epoll_fd_, sd);
+  return true;
+}
+
+
 void* EventHandlerImplementation::GetHashmapKeyFromFd(intptr_t fd) {
   // The hashmap does not support keys with value 0.
   return reinterpret_cast<void*>(fd + 1);
@@ -14,6 +14,7 @@
 #include <sys/socket.h>
 
 #include "platform/hashmap.h"
+#include "platform/thread.h"
 
 
 namespace dart {
@@ -109,15 +110,31 @@ class EventHandlerImplementation {
   void WakeupHandler(intptr_t id, Dart_Port dart_port, int64_t data);
   void HandleInterruptFd();
   void SetPort(intptr_t fd, Dart_Port dart_port, intptr_t mask);
+  EventHandlerImplementation* PollerFor(intptr_t id);
+  bool TryRearm(intptr_t fd, Dart_Port dart_port, int64_t data);
   intptr_t GetPollEvents(intptr_t events, SocketData* sd);
   static void* GetHashmapKeyFromFd(intptr_t fd);
   static uint32_t GetHashmapHashFromFd(intptr_t fd);
 
   HashMap socket_map_;
+  // Protects socket_map_ and the SocketData entries in oneshot mode, where
+  // file descriptors are rearmed from the Dart threads.
+  dart::Mutex socket_map_lock_;
   TimeoutQueue timeout_queue_;
   bool shutdown_;
   int interrupt_fds_[2];
   int epoll_fd_;
+  // Set in the primary poller only, which owns the event handler and
+  // dispatches requests to the other pollers.
+  EventHandler* handler_;
+  EventHandlerImplementation** pollers_;
+  intptr_t poller_count_;
+  // Set in the other pollers, which tell the primary poller when they exit.
+  EventHandlerImplementation* primary_;
+  // The number of other pollers still running, in the primary poller only.
+  // Protected by pollers_monitor_.
+  dart::Monitor pollers_monitor_;
+  intptr_t running_pollers_;
 };
 
 }  // namespace bin
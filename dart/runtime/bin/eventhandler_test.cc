@@ -0,0 +1,66 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/eventhandler.h"
+#include "platform/assert.h"
+#include "platform/globals.h"
+#include "vm/unit_test.h"
+
+
+namespace dart {
+namespace bin {
+
+UNIT_TEST_CASE(TimeoutQueue) {
+  TimeoutQueue queue;
+  EXPECT(!queue.HasTimeout());
+  queue.UpdateTimeout(1, 30);
+  queue.UpdateTimeout(2, 10);
+  queue.UpdateTimeout(3, 20);
+  EXPECT(queue.HasTimeout());
+  EXPECT_EQ(2, queue.CurrentPort());
+  EXPECT_EQ(10, queue.CurrentTimeout());
+
+  // Move the first timeout back and another one forward.
+  queue.UpdateTimeout(2, 40);
+  EXPECT_EQ(3, queue.CurrentPort());
+  queue.UpdateTimeout(1, 5);
+  EXPECT_EQ(1, queue.CurrentPort());
+
+  // Removing a timeout which is not the first one.
+  queue.UpdateTimeout(3, -1);
+  // Removing a port without a timeout is ignored.
+  queue.UpdateTimeout(4, -1);
+
+  EXPECT_EQ(1, queue.CurrentPort());
+  EXPECT_EQ(5, queue.CurrentTimeout());
+  queue.RemoveCurrent();
+  EXPECT_EQ(2, queue.CurrentPort());
+  EXPECT_EQ(40, queue.CurrentTimeout());
+  queue.RemoveCurrent();
+  EXPECT(!queue.HasTimeout());
+}
+
+
+UNIT_TEST_CASE(TimeoutQueueOrder) {
+  const intptr_t kNumTimeouts = 1000;
+  TimeoutQueue queue;
+  for (intptr_t i = 0; i < kNumTimeouts; i++) {
+    queue.UpdateTimeout(i + 1, (i * 7919) % kNumTimeouts);
+  }
+  for (intptr_t i = 0; i < kNumTimeouts; i += 3) {
+    queue.UpdateTimeout(i + 1, -1);
+  }
+  intptr_t count = 0;
+  int64_t last = 0;
+  while (queue.HasTimeout()) {
+    EXPECT(queue.CurrentTimeout() >= last);
+    last = queue.CurrentTimeout();
+    queue.RemoveCurrent();
+    count++;
+  }
+  EXPECT_EQ(kNumTimeouts - ((kNumTimeouts + 2) / 3), count);
+}
+
+}  // namespace bin
+}  // namespace dart
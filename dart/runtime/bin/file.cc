@@ -151,6 +151,31 @@ void FUNCTION_NAME(File_WriteByte)(Dart_NativeArguments args) {
 }
 
 
+// Returns a view of the first bytes_read bytes of a buffer of the given
+// length if the read was short, otherwise the buffer itself.
+static Dart_Handle TruncateReadBuffer(Dart_Handle external_array,
+                                      int64_t length,
+                                      int64_t bytes_read) {
+  if (bytes_read == length) return external_array;
+  const int kNumArgs = 3;
+  Dart_Handle dart_args[kNumArgs];
+  dart_args[0] = external_array;
+  dart_args[1] = Dart_NewInteger(0);
+  dart_args[2] = Dart_NewInteger(bytes_read);
+  // TODO(sgjesse): Cache the _makeUint8ListView function somewhere.
+  Dart_Handle io_lib =
+      Dart_LookupLibrary(DartUtils::NewString("dart:io"));
+  if (Dart_IsError(io_lib)) Dart_PropagateError(io_lib);
+  Dart_Handle array_view =
+      Dart_Invoke(io_lib,
+                  DartUtils::NewString("_makeUint8ListView"),
+                  kNumArgs,
+                  dart_args);
+  if (Dart_IsError(array_view)) Dart_PropagateError(array_view);
+  return array_view;
+}
+
+
 void FUNCTION_NAME(File_Read)(Dart_NativeArguments args) {
   File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
   ASSERT(file != NULL);
@@ -165,26 +190,10 @@ void FUNCTION_NAME(File_Read)(Dart_NativeArguments args) {
       if (Dart_IsError(err)) Dart_PropagateError(err);
       Dart_SetReturnValue(args, err);
     } else {
-      if (bytes_read < length) {
-        const int kNumArgs = 3;
-        Dart_Handle dart_args[kNumArgs];
-        dart_args[0] = external_array;
-        dart_args[1] = Dart_NewInteger(0);
-        dart_args[2] = Dart_NewInteger(bytes_read);
-        // TODO(sgjesse): Cache the _makeUint8ListView function somewhere.
-        Dart_Handle io_lib =
-            Dart_LookupLibrary(DartUtils::NewString("dart:io"));
-        if (Dart_IsError(io_lib)) Dart_PropagateError(io_lib);
-        Dart_Handle array_view =
-            Dart_Invoke(io_lib,
-                        DartUtils::NewString("_makeUint8ListView"),
-                        kNumArgs,
-                        dart_args);
-        if (Dart_IsError(array_view)) Dart_PropagateError(array_view);
-        Dart_SetReturnValue(args, array_view);
-      } else {
-        Dart_SetReturnValue(args, external_array);
-      }
+      Dart_SetReturnValue(args,
+                          TruncateReadBuffer(external_array,
+                                             length,
+                                             bytes_read));
     }
   } else {
     OSError os_error(-1, "Invalid argument", OSError::kUnknown);
@@ -275,6 +284,85 @@ void FUNCTION_NAME(File_WriteFrom)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(File_ReadAt)(Dart_NativeArguments args) {
+  File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
+  ASSERT(file != NULL);
+  int64_t position = 0;
+  int64_t length = 0;
+  if (DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &position) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 2), &length)) {
+    uint8_t* buffer = NULL;
+    Dart_Handle external_array = IOBuffer::Allocate(length, &buffer);
+    int64_t bytes_read = file->ReadAt(buffer, length, position);
+    if (bytes_read < 0) {
+      Dart_Handle err = DartUtils::NewDartOSError();
+      if (Dart_IsError(err)) Dart_PropagateError(err);
+      Dart_SetReturnValue(args, err);
+    } else {
+      Dart_SetReturnValue(args,
+                          TruncateReadBuffer(external_array,
+                                             length,
+                                             bytes_read));
+    }
+  } else {
+    OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+    Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+    if (Dart_IsError(err)) Dart_PropagateError(err);
+    Dart_SetReturnValue(args, err);
+  }
+}
+
+
+void FUNCTION_NAME(File_WriteAt)(Dart_NativeArguments args) {
+  File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
+  ASSERT(file != NULL);
+  int64_t position = 0;
+  if (!DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &position)) {
+    OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+    Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+    if (Dart_IsError(err)) Dart_PropagateError(err);
+    Dart_SetReturnValue(args, err);
+    return;
+  }
+  Dart_Handle buffer_obj = Dart_GetNativeArgument(args, 2);
+
+  // The start and end arguments are checked in Dart code, see
+  // File_WriteFrom.
+  intptr_t start =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  intptr_t end =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 4));
+
+  // The buffer object passed in has to be an Int8List or Uint8List object.
+  Dart_TypedData_Type type;
+  intptr_t buffer_len = 0;
+  void* buffer = NULL;
+  Dart_Handle result =
+      Dart_TypedDataAcquireData(buffer_obj, &type, &buffer, &buffer_len);
+  if (Dart_IsError(result)) Dart_PropagateError(result);
+
+  ASSERT(type == Dart_TypedData_kUint8 || type == Dart_TypedData_kInt8);
+  ASSERT(end <= buffer_len);
+  ASSERT(buffer != NULL);
+
+  intptr_t length = end - start;
+  int64_t bytes_written = file->WriteAt(
+      reinterpret_cast<uint8_t*>(buffer) + start, length, position);
+
+  // Extract OSError before we release data, as it may override the error.
+  if (bytes_written != length) {
+    OSError os_error;
+    Dart_TypedDataReleaseData(buffer_obj);
+    Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+    if (Dart_IsError(err)) Dart_PropagateError(err);
+    Dart_SetReturnValue(args, err);
+  } else {
+    result = Dart_TypedDataReleaseData(buffer_obj);
+    if (Dart_IsError(result)) Dart_PropagateError(result);
+  }
+}
+
+
 void FUNCTION_NAME(File_Position)(Dart_NativeArguments args) {
   File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
   ASSERT(file != NULL);
@@ -386,6 +474,50 @@ void FUNCTION_NAME(File_Flush)(Dart_NativeArguments args) {
 }
 
 
+// Returns whether the region can be mapped from the file. Mapping memory
+// beyond the end of the file would crash on access.
+static bool IsValidMapRegion(File* file, int64_t position, int64_t length) {
+  return (position >= 0) &&
+         (length > 0) &&
+         (length <= file->Length() - position);
+}
+
+
+void FUNCTION_NAME(File_Map)(Dart_NativeArguments args) {
+  File* file = GetFilePointer(Dart_GetNativeArgument(args, 0));
+  ASSERT(file != NULL);
+  int64_t position = 0;
+  int64_t length = 0;
+  int64_t hint = 0;
+  if (DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 1), &position) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 2), &length) &&
+      DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 3), &hint) &&
+      IsValidMapRegion(file, position, length)) {
+    FileMapping* mapping =
+        file->Map(position, length, static_cast<File::MapHint>(hint));
+    if (mapping == NULL) {
+      Dart_Handle err = DartUtils::NewDartOSError();
+      if (Dart_IsError(err)) Dart_PropagateError(err);
+      Dart_SetReturnValue(args, err);
+      return;
+    }
+    Dart_Handle result = Dart_NewExternalTypedData(
+        Dart_TypedData_kUint8, mapping->data(), mapping->length());
+    if (Dart_IsError(result)) {
+      delete mapping;
+      Dart_PropagateError(result);
+    }
+    Dart_NewWeakPersistentHandle(result, mapping, FileMapping::Finalizer);
+    Dart_SetReturnValue(args, result);
+  } else {
+    OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+    Dart_Handle err = DartUtils::NewDartOSError(&os_error);
+    if (Dart_IsError(err)) Dart_PropagateError(err);
+    Dart_SetReturnValue(args, err);
+  }
+}
+
+
 void FUNCTION_NAME(File_Create)(Dart_NativeArguments args) {
   const char* str =
       DartUtils::GetStringValue(Dart_GetNativeArgument(args, 0));
@@ -1161,5 +1293,169 @@ CObject* File::StatRequest(const CObjectArray& request) {
   return CObject::IllegalArgumentError();
 }
 
+
+CObject* File::ReadAtRequest(const CObjectArray& request) {
+  if (request.Length() == 3 &&
+      request[0]->IsIntptr() &&
+      request[1]->IsInt32OrInt64() &&
+      request[2]->IsInt32OrInt64()) {
+    File* file = CObjectToFilePointer(request[0]);
+    ASSERT(file != NULL);
+    if (!file->IsClosed()) {
+      int64_t position = CObjectInt32OrInt64ToInt64(request[1]);
+      int64_t length = CObjectInt32OrInt64ToInt64(request[2]);
+      Dart_CObject* io_buffer = CObject::NewIOBuffer(length);
+      ASSERT(io_buffer != NULL);
+      uint8_t* data = io_buffer->value.as_external_typed_data.data;
+      int64_t bytes_read = file->ReadAt(data, length, position);
+      if (bytes_read >= 0) {
+        CObjectExternalUint8Array* external_array =
+            new CObjectExternalUint8Array(io_buffer);
+        external_array->SetLength(bytes_read);
+        CObjectArray* result = new CObjectArray(CObject::NewArray(2));
+        result->SetAt(0, new CObjectIntptr(CObject::NewInt32(0)));
+        result->SetAt(1, external_array);
+        return result;
+      } else {
+        CObject::FreeIOBufferData(io_buffer);
+        return CObject::NewOSError();
+      }
+    } else {
+      return CObject::FileClosedError();
+    }
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+CObject* File::WriteAtRequest(const CObjectArray& request) {
+  if (request.Length() == 5 &&
+      request[0]->IsIntptr() &&
+      request[1]->IsInt32OrInt64() &&
+      request[2]->IsTypedData() &&
+      request[3]->IsInt32OrInt64() &&
+      request[4]->IsInt32OrInt64()) {
+    File* file = CObjectToFilePointer(request[0]);
+    ASSERT(file != NULL);
+    if (!file->IsClosed()) {
+      int64_t position = CObjectInt32OrInt64ToInt64(request[1]);
+      CObjectTypedData typed_data(request[2]);
+      int64_t start = CObjectInt32OrInt64ToInt64(request[3]);
+      int64_t end = CObjectInt32OrInt64ToInt64(request[4]);
+      int64_t element_size = SizeInBytes(typed_data.Type());
+      int64_t length = (end - start) * element_size;
+      int64_t bytes_written = file->WriteAt(
+          typed_data.Buffer() + start * element_size, length, position);
+      if (bytes_written >= 0) {
+        return new CObjectInt64(CObject::NewInt64(bytes_written));
+      } else {
+        return CObject::NewOSError();
+      }
+    } else {
+      return CObject::FileClosedError();
+    }
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+// Reads the regions given by a list of positions and a list of lengths into
+// one buffer, one region after the other. The response holds the buffer and
+// the number of bytes read for each region, which is less than its length if
+// the region extends beyond the end of the file.
+CObject* File::ReadBatchRequest(const CObjectArray& request) {
+  if (request.Length() == 3 &&
+      request[0]->IsIntptr() &&
+      request[1]->IsArray() &&
+      request[2]->IsArray()) {
+    File* file = CObjectToFilePointer(request[0]);
+    ASSERT(file != NULL);
+    if (!file->IsClosed()) {
+      CObjectArray positions(request[1]);
+      CObjectArray lengths(request[2]);
+      intptr_t count = positions.Length();
+      if (lengths.Length() != count) return CObject::IllegalArgumentError();
+      int64_t total_length = 0;
+      for (intptr_t i = 0; i < count; i++) {
+        if (!positions[i]->IsInt32OrInt64() ||
+            !lengths[i]->IsInt32OrInt64()) {
+          return CObject::IllegalArgumentError();
+        }
+        int64_t length = CObjectInt32OrInt64ToInt64(lengths[i]);
+        if (length < 0 || length > kIntptrMax - total_length) {
+          return CObject::IllegalArgumentError();
+        }
+        total_length += length;
+      }
+      Dart_CObject* io_buffer = CObject::NewIOBuffer(total_length);
+      ASSERT(io_buffer != NULL);
+      uint8_t* data = io_buffer->value.as_external_typed_data.data;
+      CObjectArray* bytes_read_array =
+          new CObjectArray(CObject::NewArray(count));
+      for (intptr_t i = 0; i < count; i++) {
+        int64_t position = CObjectInt32OrInt64ToInt64(positions[i]);
+        int64_t length = CObjectInt32OrInt64ToInt64(lengths[i]);
+        int64_t bytes_read = file->ReadAt(data, length, position);
+        if (bytes_read < 0) {
+          CObject::FreeIOBufferData(io_buffer);
+          return CObject::NewOSError();
+        }
+        bytes_read_array->SetAt(
+            i, new CObjectInt64(CObject::NewInt64(bytes_read)));
+        data += length;
+      }
+      CObjectArray* result = new CObjectArray(CObject::NewArray(3));
+      result->SetAt(0, new CObjectIntptr(CObject::NewInt32(0)));
+      result->SetAt(1, new CObjectExternalUint8Array(io_buffer));
+      result->SetAt(2, bytes_read_array);
+      return result;
+    } else {
+      return CObject::FileClosedError();
+    }
+  }
+  return CObject::IllegalArgumentError();
+}
+
+
+CObject* File::MapRequest(const CObjectArray& request) {
+  if (request.Length() == 4 &&
+      request[0]->IsIntptr() &&
+      request[1]->IsInt32OrInt64() &&
+      request[2]->IsInt32OrInt64() &&
+      request[3]->IsInt32()) {
+    File* file = CObjectToFilePointer(request[0]);
+    ASSERT(file != NULL);
+    if (!file->IsClosed()) {
+      int64_t position = CObjectInt32OrInt64ToInt64(request[1]);
+      int64_t length = CObjectInt32OrInt64ToInt64(request[2]);
+      CObjectInt32 hint(request[3]);
+      if (!IsValidMapRegion(file, position, length)) {
+        OSError os_error(-1, "Invalid argument", OSError::kUnknown);
+        return CObject::NewOSError(&os_error);
+      }
+      FileMapping* mapping =
+          file->Map(position, length, static_cast<File::MapHint>(hint.Value()));
+      if (mapping == NULL) {
+        return CObject::NewOSError();
+      }
+      // The finalizer unmaps the memory, also if the response is not
+      // delivered.
+      CObjectExternalUint8Array* external_array =
+          new CObjectExternalUint8Array(
+              CObject::NewExternalUint8Array(mapping->length(),
+                                             mapping->data(),
+                                             mapping,
+                                             FileMapping::Finalizer));
+      CObjectArray* result = new CObjectArray(CObject::NewArray(2));
+      result->SetAt(0, new CObjectIntptr(CObject::NewInt32(0)));
+      result->SetAt(1, external_array);
+      return result;
+    } else {
+      return CObject::FileClosedError();
+    }
+  }
+  return CObject::IllegalArgumentError();
+}
+
 }  // namespace bin
 }  // namespace dart
@@ -19,8 +19,9 @@
 namespace dart {
 namespace bin {
 
-// Forward declaration.
+// Forward declarations.
 class FileHandle;
+class FileMapping;
 
 class File {
  public:
@@ -71,6 +72,14 @@ class File {
     kStatSize = 6
   };
 
+  // These values have to be kept in sync with the hint values of
+  // FileMapHint in file.dart.
+  enum MapHint {
+    kMapNormal = 0,
+    kMapSequential = 1,
+    kMapRandom = 2
+  };
+
   ~File();
 
   // Read/Write attempt to transfer num_bytes to/from buffer. It returns
@@ -78,6 +87,12 @@ class File {
   int64_t Read(void* buffer, int64_t num_bytes);
   int64_t Write(const void* buffer, int64_t num_bytes);
 
+  // Read/Write attempt to transfer num_bytes to/from buffer at the given
+  // position in the file, without using or changing the file position.
+  // They return the number of bytes read/written, or -1 on error.
+  int64_t ReadAt(void* buffer, int64_t num_bytes, int64_t position);
+  int64_t WriteAt(const void* buffer, int64_t num_bytes, int64_t position);
+
   // ReadFully and WriteFully do attempt to transfer num_bytes to/from
   // the buffer. In the event of short accesses they will loop internally until
   // the whole buffer has been transferred or an error occurs. If an error
@@ -108,6 +123,16 @@ class File {
   // Returns whether the file has been closed.
   bool IsClosed();
 
+  // Returns the OS file descriptor of the file.
+  int GetFD();
+
+  // Maps length bytes of the file, starting at position, into memory. The
+  // mapping is private, writes to the memory do not change the file. The
+  // hint tells the OS how the memory will be accessed, where supported.
+  // Accessing memory beyond the end of the file, e.g. after it has been
+  // truncated, crashes the process. Returns NULL on error.
+  FileMapping* Map(int64_t position, int64_t length, MapHint hint);
+
   // Open the file with the given path. The file is always opened for
   // reading. If mode contains kWrite the file is opened for both
   // reading and writing. If mode contains kWrite and the file does
@@ -166,6 +191,10 @@ class File {
   static CObject* TypeRequest(const CObjectArray& request);
   static CObject* IdenticalRequest(const CObjectArray& request);
   static CObject* StatRequest(const CObjectArray& request);
+  static CObject* MapRequest(const CObjectArray& request);
+  static CObject* ReadAtRequest(const CObjectArray& request);
+  static CObject* WriteAtRequest(const CObjectArray& request);
+  static CObject* ReadBatchRequest(const CObjectArray& request);
 
  private:
   explicit File(FileHandle* handle) : handle_(handle) { }
@@ -179,6 +208,37 @@ class File {
   DISALLOW_COPY_AND_ASSIGN(File);
 };
 
+
+// A region of a file mapped into memory by File::Map. The memory stays
+// mapped until the FileMapping is deleted, also if the file is closed.
+class FileMapping {
+ public:
+  ~FileMapping();
+
+  uint8_t* data() const { return data_; }
+  intptr_t length() const { return length_; }
+
+  // Finalizer for the external typed data backed by a mapping.
+  static void Finalizer(Dart_WeakPersistentHandle handle, void* mapping) {
+    delete reinterpret_cast<FileMapping*>(mapping);
+  }
+
+ private:
+  FileMapping(void* address, intptr_t size, uint8_t* data, intptr_t length)
+      : address_(address), size_(size), data_(data), length_(length) { }
+
+  // The mapped memory, which starts at a page boundary of the file.
+  void* address_;
+  intptr_t size_;
+
+  // The requested region within the mapped memory.
+  uint8_t* data_;
+  intptr_t length_;
+
+  friend class File;
+  DISALLOW_COPY_AND_ASSIGN(FileMapping);
+};
+
 }  // namespace bin
 }  // namespace dart
 
@@ -9,6 +9,7 @@
 
 #include <errno.h>  // NOLINT
 #include <fcntl.h>  // NOLINT
+#include <sys/mman.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
 #include <sys/types.h>  // NOLINT
 #include <unistd.h>  // NOLINT
@@ -62,6 +63,48 @@ bool File::IsClosed() {
 }
 
 
+int File::GetFD() {
+  return handle_->fd();
+}
+
+
+FileMapping* File::Map(int64_t position, int64_t length, MapHint hint) {
+  ASSERT(handle_->fd() >= 0);
+  ASSERT(position >= 0 && length > 0);
+  // The offset of the mapping has to be a multiple of the page size.
+  int64_t offset = position % getpagesize();
+  int64_t size = length + offset;
+  if (size > kIntptrMax) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  void* address = mmap(NULL,
+                       size,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE,
+                       handle_->fd(),
+                       position - offset);
+  if (address == MAP_FAILED) return NULL;
+  if (hint != kMapNormal) {
+    // The hint only affects read ahead, so failing to give it is harmless.
+    madvise(address,
+            size,
+            (hint == kMapSequential) ? MADV_SEQUENTIAL : MADV_RANDOM);
+  }
+  return new FileMapping(address,
+                         size,
+                         reinterpret_cast<uint8_t*>(address) + offset,
+                         length);
+}
+
+
+FileMapping::~FileMapping() {
+  if (munmap(address_, size_) != 0) {
+    FATAL("munmap failed\n");
+  }
+}
+
+
 int64_t File::Read(void* buffer, int64_t num_bytes) {
   ASSERT(handle_->fd() >= 0);
   return TEMP_FAILURE_RETRY(read(handle_->fd(), buffer, num_bytes));
@@ -74,6 +117,22 @@ int64_t File::Write(const void* buffer, int64_t num_bytes) {
 }
 
 
+int64_t File::ReadAt(void* buffer, int64_t num_bytes, int64_t position) {
+  ASSERT(handle_->fd() >= 0);
+  return TEMP_FAILURE_RETRY(
+      pread64(handle_->fd(), buffer, num_bytes, position));
+}
+
+
+int64_t File::WriteAt(const void* buffer,
+                      int64_t num_bytes,
+                      int64_t position) {
+  ASSERT(handle_->fd() >= 0);
+  return TEMP_FAILURE_RETRY(
+      pwrite64(handle_->fd(), buffer, num_bytes, position));
+}
+
+
 off64_t File::Position() {
   ASSERT(handle_->fd() >= 0);
   return lseek64(handle_->fd(), 0, SEEK_CUR);
@@ -29,12 +29,21 @@ patch class _RandomAccessFile {
   /* patch */ static _writeByte(int id, int value) native "File_WriteByte";
   /* patch */ static _writeFrom(int id, List<int> buffer, int start, int end)
       native "File_WriteFrom";
+  /* patch */ static _readAt(int id, int position, int bytes)
+      native "File_ReadAt";
+  /* patch */ static _writeAt(int id,
+                              int position,
+                              List<int> buffer,
+                              int start,
+                              int end) native "File_WriteAt";
   /* patch */ static _position(int id) native "File_Position";
   /* patch */ static _setPosition(int id, int position)
       native "File_SetPosition";
   /* patch */ static _truncate(int id, int length) native "File_Truncate";
   /* patch */ static _length(int id) native "File_Length";
   /* patch */ static _flush(int id) native "File_Flush";
+  /* patch */ static _map(int id, int position, int length, int hint)
+      native "File_Map";
 }
 
 patch class _FileSystemWatcher {
@@ -60,6 +60,54 @@ bool File::IsClosed() {
 }
 
 
+int File::GetFD() {
+  return handle_->fd();
+}
+
+
+FileMapping* File::Map(int64_t position, int64_t length, MapHint hint) {
+  ASSERT(handle_->fd() >= 0);
+  ASSERT(position >= 0 && length > 0);
+  // The offset of the view has to be a multiple of the allocation
+  // granularity.
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  int64_t offset = position % info.dwAllocationGranularity;
+  int64_t size = length + offset;
+  if (size > kIntptrMax) {
+    SetLastError(ERROR_NOT_ENOUGH_MEMORY);
+    return NULL;
+  }
+  HANDLE file_handle = reinterpret_cast<HANDLE>(_get_osfhandle(handle_->fd()));
+  HANDLE mapping_handle =
+      CreateFileMapping(file_handle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+  if (mapping_handle == NULL) return NULL;
+  int64_t view_offset = position - offset;
+  void* address = MapViewOfFile(mapping_handle,
+                                FILE_MAP_COPY,
+                                static_cast<DWORD>(view_offset >> 32),
+                                static_cast<DWORD>(view_offset & 0xFFFFFFFF),
+                                size);
+  // The view keeps the mapping alive.
+  DWORD error = GetLastError();
+  CloseHandle(mapping_handle);
+  if (address == NULL) {
+    SetLastError(error);
+    return NULL;
+  }
+  // There are no access hints for views.
+  return new FileMapping(address,
+                         size,
+                         reinterpret_cast<uint8_t*>(address) + offset,
+                         length);
+}
+
+
+FileMapping::~FileMapping() {
+  UnmapViewOfFile(address_);
+}
+
+
 int64_t File::Read(void* buffer, int64_t num_bytes) {
   ASSERT(handle_->fd() >= 0);
   return read(handle_->fd(), buffer, num_bytes);
@@ -72,6 +120,38 @@ int64_t File::Write(const void* buffer, int64_t num_bytes) {
 }
 
 
+int64_t File::ReadAt(void* buffer, int64_t num_bytes, int64_t position) {
+  ASSERT(handle_->fd() >= 0);
+  // There is no positional read on CRT file descriptors, so restore the
+  // position after reading.
+  int64_t saved_position = _lseeki64(handle_->fd(), 0, SEEK_CUR);
+  if (saved_position < 0 ||
+      _lseeki64(handle_->fd(), position, SEEK_SET) < 0) {
+    return -1;
+  }
+  int64_t bytes_read = read(handle_->fd(), buffer, num_bytes);
+  _lseeki64(handle_->fd(), saved_position, SEEK_SET);
+  return bytes_read;
+}
+
+
+int64_t File::WriteAt(const void* buffer,
+                      int64_t num_bytes,
+                      int64_t position) {
+  ASSERT(handle_->fd() >= 0);
+  // There is no positional write on CRT file descriptors, so restore the
+  // position after writing.
+  int64_t saved_position = _lseeki64(handle_->fd(), 0, SEEK_CUR);
+  if (saved_position < 0 ||
+      _lseeki64(handle_->fd(), position, SEEK_SET) < 0) {
+    return -1;
+  }
+  int64_t bytes_written = write(handle_->fd(), buffer, num_bytes);
+  _lseeki64(handle_->fd(), saved_position, SEEK_SET);
+  return bytes_written;
+}
+
+
 off64_t File::Position() {
   ASSERT(handle_->fd() >= 0);
   return _lseeki64(handle_->fd(), 0, SEEK_CUR);
@@ -29,7 +29,7 @@ namespace bin {
   V(Filter_Processed, 3)                                                       \
   V(InternetAddress_Fixed, 1)                                                  \
   V(InternetAddress_Parse, 2)                                                  \
-  V(IOService_NewServicePort, 0)                                               \
+  V(IOService_GetServicePort, 1)                                               \
   V(Platform_NumberOfProcessors, 0)                                            \
   V(Platform_OperatingSystem, 0)                                               \
   V(Platform_PathSeparator, 0)                                                 \
@@ -61,7 +61,10 @@ namespace bin {
   V(Socket_CreateConnect, 3)                                                   \
   V(Socket_Available, 1)                                                       \
   V(Socket_Read, 2)                                                            \
+  V(Socket_ReadInto, 4)                                                        \
   V(Socket_WriteList, 4)                                                       \
+  V(Socket_WriteVector, 3)                                                     \
+  V(Socket_SendFile, 4)                                                        \
   V(Socket_GetPort, 1)                                                         \
   V(Socket_GetRemotePeer, 1)                                                   \
   V(Socket_GetError, 1)                                                        \
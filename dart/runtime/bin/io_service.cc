@@ -7,6 +7,7 @@
 #include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/io_service.h"
+#include "bin/log.h"
 #include "bin/secure_socket.h"
 #include "bin/socket.h"
 #include "bin/thread.h"
@@ -22,14 +23,24 @@
 namespace dart {
 namespace bin {
 
+intptr_t IOService::worker_count_ = IOService::kDefaultWorkerCount;
+Dart_Port* IOService::ports_ = NULL;
+intptr_t* IOService::queue_depths_ = NULL;
+int64_t IOService::latency_counts_[IOService::kNumberOfRequests]
+                                  [IOService::kLatencyBuckets];
+dart::Mutex* IOService::mutex_ = new dart::Mutex();
+
+
 #define CASE_REQUEST(type, method, id)                                         \
   case IOService::k##type##method##Request:                                    \
     response = type::method##Request(data);                                    \
     break;
 
-void IOServiceCallback(Dart_Port dest_port_id,
-                       Dart_CObject* message) {
+void IOService::HandleRequest(Dart_Port dest_port_id,
+                              Dart_CObject* message) {
   Dart_Port reply_port_id = ILLEGAL_PORT;
+  intptr_t request_id = -1;
+  int64_t start = TimerUtils::GetCurrentTimeMicros();
   CObject* response = CObject::IllegalArgumentError();
   CObjectArray request(message);
   if (message->type == Dart_CObject_kArray &&
@@ -40,16 +51,21 @@ void IOServiceCallback(Dart_Port dest_port_id,
       request[3]->IsArray()) {
     CObjectInt32 message_id(request[0]);
     CObjectSendPort reply_port(request[1]);
-    CObjectInt32 request_id(request[2]);
     CObjectArray data(request[3]);
     reply_port_id = reply_port.Value();
-    switch (request_id.Value()) {
+    request_id = CObjectInt32(request[2]).Value();
+    switch (request_id) {
   IO_SERVICE_REQUEST_LIST(CASE_REQUEST);
       default:
         UNREACHABLE();
     }
   }
 
+  // Record the request before replying, so that the stats include it once
+  // the reply has arrived. Malformed requests were counted as queued too.
+  RecordRequest(dest_port_id,
+                request_id,
+                TimerUtils::GetCurrentTimeMicros() - start);
   CObjectArray result(CObject::NewArray(2));
   result.SetAt(0, request[0]);
   result.SetAt(1, response);
@@ -57,17 +73,155 @@ void IOServiceCallback(Dart_Port dest_port_id,
 }
 
 
-Dart_Port IOService::GetServicePort() {
-  Dart_Port result = Dart_NewNativePort("IOService",
-                                        IOServiceCallback,
-                                        true);
-  return result;
+#define CASE_CATEGORY(type, method, id)                                        \
+  case IOService::k##type##method##Request:                                    \
+    return IOService::k##type##Category;
+
+IOService::Category IOService::CategoryOf(intptr_t request) {
+  switch (request) {
+IO_SERVICE_REQUEST_LIST(CASE_CATEGORY)
+    default:
+      UNREACHABLE();
+      return kFileCategory;
+  }
+}
+
+
+Dart_Port IOService::GetServicePort(intptr_t request) {
+  ASSERT((request >= 0) && (request < kNumberOfRequests));
+  MutexLocker locker(mutex_);
+  if (ports_ == NULL) {
+    intptr_t port_count = kNumberOfCategories * worker_count_;
+    ports_ = new Dart_Port[port_count];
+    queue_depths_ = new intptr_t[port_count];
+    for (intptr_t i = 0; i < port_count; i++) {
+      // Native ports run on threads of their own rather than on the bounded
+      // scheduler workers, so a blocked port never delays another one.
+      ports_[i] = Dart_NewNativePort("IOService", HandleRequest, true);
+      queue_depths_[i] = 0;
+    }
+  }
+  intptr_t first = CategoryOf(request) * worker_count_;
+  intptr_t selected = first;
+  for (intptr_t i = first + 1; i < first + worker_count_; i++) {
+    if (queue_depths_[i] < queue_depths_[selected]) selected = i;
+  }
+  if (ports_[selected] == ILLEGAL_PORT) return ILLEGAL_PORT;
+  queue_depths_[selected]++;
+  return ports_[selected];
+}
+
+
+void IOService::set_worker_count(intptr_t count) {
+  ASSERT(count > 0);
+  MutexLocker locker(mutex_);
+  if (ports_ == NULL) worker_count_ = count;
 }
 
 
-void FUNCTION_NAME(IOService_NewServicePort)(Dart_NativeArguments args) {
+intptr_t IOService::QueueDepth(Category category) {
+  MutexLocker locker(mutex_);
+  if (ports_ == NULL) return 0;
+  intptr_t depth = 0;
+  intptr_t first = category * worker_count_;
+  for (intptr_t i = first; i < first + worker_count_; i++) {
+    depth += queue_depths_[i];
+  }
+  return depth;
+}
+
+
+int64_t IOService::LatencyCount(intptr_t request, intptr_t bucket) {
+  ASSERT((request >= 0) && (request < kNumberOfRequests));
+  ASSERT((bucket >= 0) && (bucket < kLatencyBuckets));
+  MutexLocker locker(mutex_);
+  return latency_counts_[request][bucket];
+}
+
+
+intptr_t IOService::LatencyBucket(int64_t micros) {
+  if (micros <= 0) return 0;
+  intptr_t bucket = Utils::HighestBit(micros) + 1;
+  return bucket < kLatencyBuckets ? bucket : kLatencyBuckets - 1;
+}
+
+
+void IOService::RecordRequest(Dart_Port dest_port_id,
+                              intptr_t request,
+                              int64_t micros) {
+  MutexLocker locker(mutex_);
+  intptr_t port_count = kNumberOfCategories * worker_count_;
+  for (intptr_t i = 0; i < port_count; i++) {
+    if (ports_[i] == dest_port_id) {
+      ASSERT(queue_depths_[i] > 0);
+      queue_depths_[i]--;
+      break;
+    }
+  }
+  if (request != -1) {
+    latency_counts_[request][LatencyBucket(micros)]++;
+  }
+}
+
+
+static const char* category_names[IOService::kNumberOfCategories] = {
+  "File",
+  "Directory",
+  "Socket",
+  "SSLFilter",
+};
+
+
+#define REQUEST_NAME(type, method, id) #type #method,
+
+static const char* request_names[IOService::kNumberOfRequests] = {
+IO_SERVICE_REQUEST_LIST(REQUEST_NAME)
+};
+
+
+void IOService::PrintStats() {
+  Log::Print("IOService queue depths (%" Pd " ports per category):\n",
+             worker_count_);
+  for (intptr_t i = 0; i < kNumberOfCategories; i++) {
+    Log::Print("  %s: %" Pd "\n",
+               category_names[i],
+               QueueDepth(static_cast<Category>(i)));
+  }
+  Log::Print("IOService latencies (requests per bucket, in microseconds):\n");
+  for (intptr_t request = 0; request < kNumberOfRequests; request++) {
+    int64_t total = 0;
+    for (intptr_t bucket = 0; bucket < kLatencyBuckets; bucket++) {
+      total += LatencyCount(request, bucket);
+    }
+    if (total == 0) continue;
+    Log::Print("  %s: %" Pd64 " requests\n", request_names[request], total);
+    for (intptr_t bucket = 0; bucket < kLatencyBuckets; bucket++) {
+      int64_t count = LatencyCount(request, bucket);
+      if (count == 0) continue;
+      if (bucket == kLatencyBuckets - 1) {
+        Log::Print("    >= %" Pd64 ": %" Pd64 "\n",
+                   static_cast<int64_t>(1) << (bucket - 1),
+                   count);
+      } else {
+        Log::Print("    < %" Pd64 ": %" Pd64 "\n",
+                   static_cast<int64_t>(1) << bucket,
+                   count);
+      }
+    }
+  }
+}
+
+
+void FUNCTION_NAME(IOService_GetServicePort)(Dart_NativeArguments args) {
   Dart_SetReturnValue(args, Dart_Null());
-  Dart_Port service_port = IOService::GetServicePort();
+  int64_t request = -1;
+  if (!DartUtils::GetInt64Value(Dart_GetNativeArgument(args, 0), &request) ||
+      (request < 0) ||
+      (request >= IOService::kNumberOfRequests)) {
+    Dart_ThrowException(DartUtils::NewDartArgumentError(
+        "Invalid IOService request"));
+  }
+  Dart_Port service_port = IOService::GetServicePort(request);
   if (service_port != ILLEGAL_PORT) {
     // Return a send port for the service port.
     Dart_Handle send_port = Dart_NewSendPort(service_port);
@@ -6,6 +6,7 @@
 #define BIN_IO_SERVICE_H_
 
 #include "bin/builtin.h"
+#include "bin/thread.h"
 #include "bin/utils.h"
 
 
@@ -51,18 +52,84 @@ namespace bin {
   V(Directory, ListNext, 34)                                                   \
   V(Directory, ListStop, 35)                                                   \
   V(Directory, Rename, 36)                                                     \
-  V(SSLFilter, ProcessFilter, 37)
+  V(SSLFilter, ProcessFilter, 37)                                              \
+  V(File, Map, 38)                                                             \
+  V(File, ReadAt, 39)                                                          \
+  V(File, WriteAt, 40)                                                         \
+  V(File, ReadBatch, 41)
 
 #define DECLARE_REQUEST(type, method, id)                                      \
   k##type##method##Request = id,
 
+#define COUNT_REQUEST(type, method, id) + 1
+
+// Requests are served by native ports shared by all isolates. Each port
+// handles one request at a time on a thread of its own. Every category of
+// requests has its own ports, so slow requests of one category, like host
+// name lookups, do not delay requests of the other categories.
 class IOService {
  public:
   enum {
 IO_SERVICE_REQUEST_LIST(DECLARE_REQUEST)
   };
 
-  static Dart_Port GetServicePort();
+  // The categories are named after the type of the requests.
+  enum Category {
+    kFileCategory,
+    kDirectoryCategory,
+    kSocketCategory,
+    kSSLFilterCategory,
+    kNumberOfCategories
+  };
+
+  static const intptr_t kNumberOfRequests =
+      0 IO_SERVICE_REQUEST_LIST(COUNT_REQUEST);
+
+  // Bucket 0 counts requests which took less than a microsecond, bucket i
+  // requests which took at least 2^(i-1) and less than 2^i microseconds.
+  // The last bucket also counts all slower requests.
+  static const intptr_t kLatencyBuckets = 24;
+
+  static const intptr_t kDefaultWorkerCount = 8;
+
+  // Returns the least loaded port of the request's category and counts the
+  // request as queued on it until it has been handled.
+  static Dart_Port GetServicePort(intptr_t request);
+
+  static Category CategoryOf(intptr_t request);
+
+  // The number of ports per category. Only has an effect before the first
+  // request.
+  static void set_worker_count(intptr_t count);
+  static intptr_t worker_count() { return worker_count_; }
+
+  // The number of requests of the category which are queued or being
+  // handled.
+  static intptr_t QueueDepth(Category category);
+
+  // The number of handled requests of the given id whose handling time fell
+  // into the bucket.
+  static int64_t LatencyCount(intptr_t request, intptr_t bucket);
+
+  static void PrintStats();
+
+ private:
+  static intptr_t LatencyBucket(int64_t micros);
+  static void HandleRequest(Dart_Port dest_port_id, Dart_CObject* message);
+  // Counts the request as handled by the port. The request is -1 for
+  // malformed requests, which have no latency recorded.
+  static void RecordRequest(Dart_Port dest_port_id,
+                            intptr_t request,
+                            int64_t micros);
+
+  static intptr_t worker_count_;
+  static Dart_Port* ports_;
+  static intptr_t* queue_depths_;
+  static int64_t latency_counts_[kNumberOfRequests][kLatencyBuckets];
+  static dart::Mutex* mutex_;
+
+  DISALLOW_ALLOCATION();
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IOService);
 };
 
 }  // namespace bin
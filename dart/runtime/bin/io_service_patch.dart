@@ -3,9 +3,6 @@
 // BSD-style license that can be found in the LICENSE file.
 
 patch class _IOService {
-  // Lazy initialize service ports, 32 per isolate.
-  static const int _SERVICE_PORT_COUNT = 32;
-  static List<SendPort> _servicePort = new List(_SERVICE_PORT_COUNT);
   static RawReceivePort _receivePort;
   static SendPort _replyToPort;
   static Map<int, Completer> _messageMap = {};
@@ -16,18 +13,16 @@ patch class _IOService {
     do {
       id = _getNextId();
     } while (_messageMap.containsKey(id));
-    int index = id % _SERVICE_PORT_COUNT;
-    _initialize(index);
+    _initialize();
     var completer = new Completer();
     _messageMap[id] = completer;
-    _servicePort[index].send([id, _replyToPort, request, data]);
+    // The service port is chosen per request, from the ports serving the
+    // request's category.
+    _getServicePort(request).send([id, _replyToPort, request, data]);
     return completer.future;
   }
 
-  static void _initialize(int index) {
-    if (_servicePort[index] == null) {
-      _servicePort[index] = _newServicePort();
-    }
+  static void _initialize() {
     if (_receivePort == null) {
       _receivePort = new RawReceivePort();
       _replyToPort = _receivePort.sendPort;
@@ -48,5 +43,6 @@ patch class _IOService {
     return _id++;
   }
 
-  static SendPort _newServicePort() native "IOService_NewServicePort";
+  static SendPort _getServicePort(int request)
+      native "IOService_GetServicePort";
 }
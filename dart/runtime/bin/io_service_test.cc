@@ -0,0 +1,156 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "bin/dartutils.h"
+#include "bin/io_service.h"
+#include "bin/thread.h"
+#include "platform/assert.h"
+#include "platform/globals.h"
+#include "vm/unit_test.h"
+
+
+namespace dart {
+namespace bin {
+
+static dart::Monitor* reply_monitor = new dart::Monitor();
+static intptr_t reply_count = 0;
+static Dart_CObject_Type reply_type = Dart_CObject_kNull;
+
+
+static void HandleReply(Dart_Port dest_port_id, Dart_CObject* message) {
+  MonitorLocker ml(reply_monitor);
+  if ((message->type == Dart_CObject_kArray) &&
+      (message->value.as_array.length == 2)) {
+    reply_type = message->value.as_array.values[1]->type;
+  }
+  reply_count++;
+  ml.Notify();
+}
+
+
+static int64_t TotalLatencyCount(intptr_t request) {
+  int64_t total = 0;
+  for (intptr_t bucket = 0; bucket < IOService::kLatencyBuckets; bucket++) {
+    total += IOService::LatencyCount(request, bucket);
+  }
+  return total;
+}
+
+
+// Posts a request as sent by dart:io, with the given request id and data.
+static void PostRequest(Dart_Port service_port,
+                        Dart_Port reply_port,
+                        Dart_CObject* request_id,
+                        Dart_CObject* data) {
+  Dart_CObject message_id;
+  message_id.type = Dart_CObject_kInt32;
+  message_id.value.as_int32 = 1;
+  Dart_CObject reply;
+  reply.type = Dart_CObject_kSendPort;
+  reply.value.as_send_port = reply_port;
+  Dart_CObject* request_values[] = { &message_id, &reply, request_id, data };
+  Dart_CObject request;
+  request.type = Dart_CObject_kArray;
+  request.value.as_array.length = ARRAY_SIZE(request_values);
+  request.value.as_array.values = request_values;
+  EXPECT(Dart_PostCObject(service_port, &request));
+}
+
+
+// Posts a file exists request and waits for the reply.
+static void PostFileExists(Dart_Port service_port, Dart_Port reply_port) {
+  Dart_CObject request_id;
+  request_id.type = Dart_CObject_kInt32;
+  request_id.value.as_int32 = IOService::kFileExistsRequest;
+  Dart_CObject path;
+  path.type = Dart_CObject_kString;
+  path.value.as_string = const_cast<char*>("/no/such/io_service_test_file");
+  Dart_CObject* data_values[] = { &path };
+  Dart_CObject data;
+  data.type = Dart_CObject_kArray;
+  data.value.as_array.length = ARRAY_SIZE(data_values);
+  data.value.as_array.values = data_values;
+
+  MonitorLocker ml(reply_monitor);
+  intptr_t expected = reply_count + 1;
+  PostRequest(service_port, reply_port, &request_id, &data);
+  while (reply_count < expected) {
+    ml.Wait();
+  }
+}
+
+
+// Posts a request without a valid request id, which gets no reply.
+static void PostMalformed(Dart_Port service_port, Dart_Port reply_port) {
+  Dart_CObject request_id;
+  request_id.type = Dart_CObject_kNull;
+  Dart_CObject data;
+  data.type = Dart_CObject_kArray;
+  data.value.as_array.length = 0;
+  data.value.as_array.values = NULL;
+  PostRequest(service_port, reply_port, &request_id, &data);
+}
+
+
+// Waits for the queue depth of the category to drop to the given value.
+static void WaitForQueueDepth(IOService::Category category, intptr_t depth) {
+  const intptr_t kMaxWaitMillis = 10000;
+  for (intptr_t i = 0; i < kMaxWaitMillis; i++) {
+    if (IOService::QueueDepth(category) <= depth) {
+      break;
+    }
+    TimerUtils::Sleep(1);
+  }
+  EXPECT_EQ(depth, IOService::QueueDepth(category));
+}
+
+
+UNIT_TEST_CASE(IOServiceStats) {
+  Dart_Port reply_port = Dart_NewNativePort("IOServiceTest", HandleReply, true);
+  EXPECT_NE(ILLEGAL_PORT, reply_port);
+  intptr_t file_depth = IOService::QueueDepth(IOService::kFileCategory);
+  intptr_t socket_depth = IOService::QueueDepth(IOService::kSocketCategory);
+  int64_t exists_count = TotalLatencyCount(IOService::kFileExistsRequest);
+
+  // Requests are counted as queued on their own category only.
+  Dart_Port file_port =
+      IOService::GetServicePort(IOService::kFileExistsRequest);
+  EXPECT_NE(ILLEGAL_PORT, file_port);
+  EXPECT_EQ(file_depth + 1, IOService::QueueDepth(IOService::kFileCategory));
+  EXPECT_EQ(socket_depth, IOService::QueueDepth(IOService::kSocketCategory));
+
+  // Requests queued on another category do not load the file ports.
+  const intptr_t kLookups = IOService::worker_count() * 2;
+  Dart_Port* socket_ports = new Dart_Port[kLookups];
+  for (intptr_t i = 0; i < kLookups; i++) {
+    socket_ports[i] =
+        IOService::GetServicePort(IOService::kSocketLookupRequest);
+    EXPECT_NE(ILLEGAL_PORT, socket_ports[i]);
+  }
+  EXPECT_EQ(socket_depth + kLookups,
+            IOService::QueueDepth(IOService::kSocketCategory));
+  EXPECT_EQ(file_depth + 1, IOService::QueueDepth(IOService::kFileCategory));
+
+  // The handled request leaves the queue and is counted in exactly one
+  // latency bucket.
+  PostFileExists(file_port, reply_port);
+  EXPECT_EQ(Dart_CObject_kBool, reply_type);
+  EXPECT_EQ(file_depth, IOService::QueueDepth(IOService::kFileCategory));
+  EXPECT_EQ(exists_count + 1,
+            TotalLatencyCount(IOService::kFileExistsRequest));
+
+  // Malformed requests leave the queue as well.
+  for (intptr_t i = 0; i < kLookups; i++) {
+    PostMalformed(socket_ports[i], reply_port);
+  }
+  delete[] socket_ports;
+  WaitForQueueDepth(IOService::kSocketCategory, socket_depth);
+  EXPECT_EQ(exists_count + 1,
+            TotalLatencyCount(IOService::kFileExistsRequest));
+
+  EXPECT(Dart_CloseNativePort(reply_port));
+}
+
+}  // namespace bin
+}  // namespace dart
@@ -4,6 +4,7 @@
 
 #include "bin/builtin.h"
 #include "bin/dartutils.h"
+#include "bin/io_service.h"
 
 #include "include/dart_api.h"
 
@@ -11,7 +12,15 @@
 namespace dart {
 namespace bin {
 
-void FUNCTION_NAME(IOService_NewServicePort)(Dart_NativeArguments args) {
+void IOService::set_worker_count(intptr_t count) {
+}
+
+
+void IOService::PrintStats() {
+}
+
+
+void FUNCTION_NAME(IOService_GetServicePort)(Dart_NativeArguments args) {
   Dart_ThrowException(DartUtils::NewDartArgumentError(
       "IOService is unsupported on this platform"));
 }
@@ -16,10 +16,12 @@
 #include "bin/eventhandler.h"
 #include "bin/extensions.h"
 #include "bin/file.h"
+#include "bin/io_service.h"
 #include "bin/isolate_data.h"
 #include "bin/log.h"
 #include "bin/platform.h"
 #include "bin/process.h"
+#include "bin/socket.h"
 #include "bin/vmservice_impl.h"
 #include "platform/globals.h"
 #include "platform/hashmap.h"
@@ -56,6 +58,13 @@ static int debug_port = -1;
 static const char* package_root = NULL;
 
 
+// Values of the --load-type-feedback and --save-type-feedback flags.
+// (These pointers point into an argv buffer and do not need to be
+// free'd.)
+static const char* load_type_feedback_filename = NULL;
+static const char* save_type_feedback_filename = NULL;
+
+
 // Global flag that is used to indicate that we want to compile all the
 // dart functions and not run anything.
 static bool has_compile_all = false;
@@ -238,6 +247,24 @@ static bool ProcessGenScriptSnapshotOption(const char* filename) {
 }
 
 
+static bool ProcessLoadTypeFeedbackOption(const char* filename) {
+  if ((filename == NULL) || (*filename == '\0')) {
+    return false;
+  }
+  load_type_feedback_filename = filename;
+  return true;
+}
+
+
+static bool ProcessSaveTypeFeedbackOption(const char* filename) {
+  if ((filename == NULL) || (*filename == '\0')) {
+    return false;
+  }
+  save_type_feedback_filename = filename;
+  return true;
+}
+
+
 static bool ProcessEnableVmServiceOption(const char* port) {
   ASSERT(port != NULL);
   vm_service_server_port = -1;
@@ -267,6 +294,59 @@ static bool ProcessTraceDebugProtocolOption(const char* arg) {
 }
 
 
+static bool ProcessEpollOneShotOption(const char* arg) {
+  if (*arg != '\0') {
+    return false;
+  }
+  EventHandler::set_use_oneshot(true);
+  return true;
+}
+
+
+static bool ProcessEventHandlerThreadsOption(const char* arg) {
+  ASSERT(arg != NULL);
+  intptr_t threads = -1;
+  if (*arg == '=') {
+    threads = atoi(arg + 1);
+  }
+  if (threads <= 0) {
+    Log::PrintErr("unrecognized --event-handler-threads option syntax. "
+                  "Use --event-handler-threads=<number of threads>\n");
+    return false;
+  }
+  EventHandler::set_poller_count(threads);
+  // Let every poller listen on its own socket for the same port.
+  ServerSocket::set_reuse_port(threads > 1);
+  return true;
+}
+
+
+static bool ProcessIOServiceWorkersOption(const char* arg) {
+  ASSERT(arg != NULL);
+  intptr_t workers = -1;
+  if (*arg == '=') {
+    workers = atoi(arg + 1);
+  }
+  if (workers <= 0) {
+    Log::PrintErr("unrecognized --io-service-workers option syntax. "
+                  "Use --io-service-workers=<number of workers>\n");
+    return false;
+  }
+  IOService::set_worker_count(workers);
+  return true;
+}
+
+
+static bool print_io_service_stats = false;
+static bool ProcessPrintIOServiceStatsOption(const char* arg) {
+  if (*arg != '\0') {
+    return false;
+  }
+  print_io_service_stats = true;
+  return true;
+}
+
+
 static struct {
   const char* option_name;
   bool (*process)(const char* option);
@@ -285,8 +365,14 @@ static struct {
   { "--debug", ProcessDebugOption },
   { "--snapshot=", ProcessGenScriptSnapshotOption },
   { "--print-script", ProcessPrintScriptOption },
+  { "--load-type-feedback=", ProcessLoadTypeFeedbackOption },
+  { "--save-type-feedback=", ProcessSaveTypeFeedbackOption },
   { "--enable-vm-service", ProcessEnableVmServiceOption },
   { "--trace-debug-protocol", ProcessTraceDebugProtocolOption },
+  { "--epoll-oneshot", ProcessEpollOneShotOption },
+  { "--event-handler-threads", ProcessEventHandlerThreadsOption },
+  { "--io-service-workers", ProcessIOServiceWorkersOption },
+  { "--print-io-service-stats", ProcessPrintIOServiceStatsOption },
   { NULL, NULL }
 };
 
@@ -635,10 +721,34 @@ static void PrintUsage() {
 "--print-script\n"
 "  generates Dart source code back and prints it after parsing a Dart script\n"
 "\n"
+"--load-type-feedback=<file_name>\n"
+"  compiles the functions recorded in the specified file and restores their\n"
+"  type feedback before running the script, if the file exists\n"
+"\n"
+"--save-type-feedback=<file_name>\n"
+"  records the type feedback collected while running the script in the\n"
+"  specified file when the script exits\n"
+"\n"
 "--enable-vm-service[:<port number>]\n"
 "  enables the VM service and listens on specified port for connections\n"
 "  (default port number is 8181)\n"
 "\n"
+"--epoll-oneshot\n"
+"  rearms sockets with EPOLLONESHOT instead of re-registering them after\n"
+"  each event (Linux only)\n"
+"\n"
+"--event-handler-threads=<number of threads>\n"
+"  polls sockets from several threads and binds listening sockets with\n"
+"  SO_REUSEPORT (Linux only)\n"
+"\n"
+"--io-service-workers=<number of workers>\n"
+"  serves each category of asynchronous file, directory, socket and secure\n"
+"  socket requests with the given number of workers (default 8)\n"
+"\n"
+"--print-io-service-stats\n"
+"  prints the queue depths and latency histograms of the asynchronous IO\n"
+"  requests when the script exits\n"
+"\n"
 "The following options are only used for VM development and may\n"
 "be changed in any future version:\n");
     const char* print_flags = "--print_flags";
@@ -713,6 +823,52 @@ static int DartErrorExit(Dart_Handle error) {
 }
 
 
+// Loads the type feedback saved by a previous run, if there is any. A
+// missing or outdated file only makes the script warm up again.
+static void LoadTypeFeedback(const char* filename) {
+  File* file = File::Open(filename, File::kRead);
+  if (file == NULL) {
+    return;
+  }
+  int64_t length = file->Length();
+  if ((length < 0) || (length > kIntptrMax)) {
+    Log::PrintErr("Unable to read type feedback from %s\n", filename);
+    delete file;
+    return;
+  }
+  intptr_t size = static_cast<intptr_t>(length);
+  uint8_t* buffer = reinterpret_cast<uint8_t*>(malloc(size));
+  bool read = (buffer != NULL) && file->ReadFully(buffer, size);
+  delete file;
+  if (read) {
+    Dart_Handle result = Dart_LoadTypeFeedback(buffer, size);
+    if (Dart_IsError(result)) {
+      Log::PrintErr("Ignoring type feedback in %s: %s\n",
+                    filename, Dart_GetError(result));
+    }
+  } else {
+    Log::PrintErr("Unable to read type feedback from %s\n", filename);
+  }
+  free(buffer);
+}
+
+
+static void SaveTypeFeedback(const char* filename) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  Dart_Handle result = Dart_SaveTypeFeedback(&buffer, &size);
+  if (Dart_IsError(result)) {
+    Log::PrintErr("%s\n", Dart_GetError(result));
+    return;
+  }
+  File* file = File::Open(filename, File::kWriteTruncate);
+  if ((file == NULL) || !file->WriteFully(buffer, size)) {
+    Log::PrintErr("Unable to write type feedback to %s\n", filename);
+  }
+  delete file;
+}
+
+
 static void ShutdownIsolate(void* callback_data) {
   VmService::VmServiceShutdownCallback(callback_data);
   IsolateData* isolate_data = reinterpret_cast<IsolateData*>(callback_data);
@@ -919,6 +1075,10 @@ int main(int argc, char** argv) {
         return DartErrorExit(result);
       }
 
+      if (load_type_feedback_filename != NULL) {
+        LoadTypeFeedback(load_type_feedback_filename);
+      }
+
       // Set debug breakpoint if specified on the command line before calling
       // the main function.
       if (breakpoint_at != NULL) {
@@ -964,6 +1124,14 @@ int main(int argc, char** argv) {
       if (Dart_IsError(result)) {
         return DartErrorExit(result);
       }
+
+      if (save_type_feedback_filename != NULL) {
+        SaveTypeFeedback(save_type_feedback_filename);
+      }
+
+      if (print_io_service_stats) {
+        IOService::PrintStats();
+      }
     }
   }
 
@@ -2,6 +2,7 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
 
+#include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/socket.h"
 #include "bin/dartutils.h"
@@ -24,6 +25,7 @@ dart::Mutex* Socket::mutex_ = new dart::Mutex();
 int Socket::service_ports_size_ = 0;
 Dart_Port* Socket::service_ports_ = NULL;
 int Socket::service_ports_index_ = 0;
+bool ServerSocket::reuse_port_ = false;
 
 
 static Dart_Handle GetSockAddr(Dart_Handle obj, RawAddr* addr) {
@@ -193,6 +195,62 @@ void FUNCTION_NAME(Socket_Read)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_ReadInto)(Dart_NativeArguments args) {
+  static bool short_socket_reads = Dart_IsVMFlagSet("short_socket_read");
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  Dart_Handle buffer_obj = Dart_GetNativeArgument(args, 1);
+  ASSERT(Dart_IsList(buffer_obj));
+  // start and end arguments are checked in Dart code to be
+  // integers and have the property that start <= end <=
+  // list.length. Therefore, it is safe to extract their value as
+  // intptr_t.
+  intptr_t start =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 2));
+  intptr_t end =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  intptr_t length = end - start;
+  if (short_socket_reads) {
+    length = (length + 1) / 2;
+  }
+  // Read what is available with a single read, without asking for the
+  // number of available bytes first. Byte typed data is read into directly,
+  // other lists through a temporary buffer.
+  intptr_t bytes_read = 0;
+  Dart_TypedData_Type type = Dart_GetTypeOfTypedData(buffer_obj);
+  if (type == Dart_TypedData_kUint8 || type == Dart_TypedData_kInt8) {
+    uint8_t* buffer = NULL;
+    intptr_t len;
+    Dart_Handle result = Dart_TypedDataAcquireData(
+        buffer_obj, &type, reinterpret_cast<void**>(&buffer), &len);
+    if (Dart_IsError(result)) Dart_PropagateError(result);
+    ASSERT(end <= len);
+    bytes_read = Socket::Read(socket, buffer + start, length);
+    // Extract OSError before we release data, as it may override the error.
+    OSError os_error;
+    Dart_TypedDataReleaseData(buffer_obj);
+    if (bytes_read < 0) {
+      Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+      return;
+    }
+  } else {
+    uint8_t* buffer = new uint8_t[length];
+    bytes_read = Socket::Read(socket, buffer, length);
+    if (bytes_read < 0) {
+      OSError os_error;
+      delete[] buffer;
+      Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+      return;
+    }
+    Dart_Handle result =
+        Dart_ListSetAsBytes(buffer_obj, start, buffer, bytes_read);
+    delete[] buffer;
+    if (Dart_IsError(result)) Dart_PropagateError(result);
+  }
+  Dart_SetReturnValue(args, Dart_NewInteger(bytes_read));
+}
+
+
 void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
   static bool short_socket_writes = Dart_IsVMFlagSet("short_socket_write");
   intptr_t socket =
@@ -227,6 +285,97 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_WriteVector)(Dart_NativeArguments args) {
+  static bool short_socket_writes = Dart_IsVMFlagSet("short_socket_write");
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  Dart_Handle buffers_obj = Dart_GetNativeArgument(args, 1);
+  ASSERT(Dart_IsList(buffers_obj));
+  intptr_t offset =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 2));
+  intptr_t count = 0;
+  Dart_Handle result = Dart_ListLength(buffers_obj, &count);
+  if (Dart_IsError(result)) Dart_PropagateError(result);
+  if (count > Socket::kMaxWriteVectorBuffers) {
+    count = Socket::kMaxWriteVectorBuffers;
+  }
+  // All buffers are Uint8List or Int8List, see _NativeSocket.writeList.
+  Dart_Handle buffer_objs[Socket::kMaxWriteVectorBuffers];
+  const void* buffers[Socket::kMaxWriteVectorBuffers];
+  intptr_t lengths[Socket::kMaxWriteVectorBuffers];
+  for (intptr_t i = 0; i < count; i++) {
+    buffer_objs[i] = Dart_ListGetAt(buffers_obj, i);
+    if (Dart_IsError(buffer_objs[i])) Dart_PropagateError(buffer_objs[i]);
+  }
+  intptr_t acquired = 0;
+  for (; acquired < count; acquired++) {
+    Dart_TypedData_Type type;
+    uint8_t* buffer = NULL;
+    intptr_t len;
+    result = Dart_TypedDataAcquireData(
+        buffer_objs[acquired], &type, reinterpret_cast<void**>(&buffer), &len);
+    if (Dart_IsError(result)) break;
+    buffers[acquired] = buffer;
+    lengths[acquired] = len;
+  }
+  if (acquired < count) {
+    for (intptr_t i = 0; i < acquired; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    Dart_PropagateError(result);
+  }
+  if (count > 0) {
+    ASSERT(offset <= lengths[0]);
+    buffers[0] = reinterpret_cast<const uint8_t*>(buffers[0]) + offset;
+    lengths[0] -= offset;
+  }
+  intptr_t vector_count = count;
+  if (short_socket_writes && count > 0) {
+    vector_count = 1;
+    lengths[0] = (lengths[0] + 1) / 2;
+  }
+  intptr_t bytes_written =
+      Socket::WriteVector(socket, buffers, lengths, vector_count);
+  if (bytes_written >= 0) {
+    for (intptr_t i = 0; i < count; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    Dart_SetReturnValue(args, Dart_NewInteger(bytes_written));
+  } else {
+    // Extract OSError before we release data, as it may override the error.
+    OSError os_error;
+    for (intptr_t i = 0; i < count; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+  }
+}
+
+
+void FUNCTION_NAME(Socket_SendFile)(Dart_NativeArguments args) {
+  static bool short_socket_writes = Dart_IsVMFlagSet("short_socket_write");
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  // The file pointer is passed as the id of a _RandomAccessFile.
+  File* file = reinterpret_cast<File*>(
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 1)));
+  ASSERT(file != NULL);
+  int64_t position =
+      DartUtils::GetIntegerValue(Dart_GetNativeArgument(args, 2));
+  intptr_t count =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  if (short_socket_writes) {
+    count = (count + 1) / 2;
+  }
+  intptr_t bytes_sent = Socket::SendFile(socket, file, position, count);
+  if (bytes_sent >= 0) {
+    Dart_SetReturnValue(args, Dart_NewInteger(bytes_sent));
+  } else {
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError());
+  }
+}
+
+
 void FUNCTION_NAME(Socket_GetPort)(Dart_NativeArguments args) {
   intptr_t socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
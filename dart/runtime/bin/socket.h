@@ -28,6 +28,8 @@
 namespace dart {
 namespace bin {
 
+class File;
+
 union RawAddr {
   struct sockaddr_in in;
   struct sockaddr_in6 in6;
@@ -156,6 +158,9 @@ class AddressList {
 
 class Socket {
  public:
+  // Maximum number of buffers passed to WriteVector in one call.
+  static const intptr_t kMaxWriteVectorBuffers = 64;
+
   enum SocketRequest {
     kLookupRequest = 0,
     kListInterfacesRequest = 1,
@@ -166,6 +171,23 @@ class Socket {
   static intptr_t Available(intptr_t fd);
   static int Read(intptr_t fd, void* buffer, intptr_t num_bytes);
   static int Write(intptr_t fd, const void* buffer, intptr_t num_bytes);
+  // Writes count buffers in order with a single system call where the
+  // platform supports it. Returns the total number of bytes written, which
+  // can end in the middle of any of the buffers, 0 if the write would block
+  // and -1 on error.
+  static intptr_t WriteVector(intptr_t fd,
+                              const void* const* buffers,
+                              const intptr_t* lengths,
+                              intptr_t count);
+  // Sends count bytes of file, starting at position, without copying them
+  // through user space where the platform supports it. The position of the
+  // file is not changed. Returns the number of bytes sent, 0 if the write
+  // would block and -1 on error. Sending beyond the end of the file is an
+  // error.
+  static intptr_t SendFile(intptr_t fd,
+                           File* file,
+                           int64_t position,
+                           intptr_t count);
   static intptr_t Create(RawAddr addr);
   static intptr_t Connect(intptr_t fd, RawAddr addr, const intptr_t port);
   static intptr_t CreateConnect(RawAddr addr,
@@ -232,7 +254,15 @@ class ServerSocket {
                                    intptr_t backlog,
                                    bool v6_only = false);
 
+  // Lets several listening sockets bind the same address and port, so the
+  // kernel spreads incoming connections across them. Only supported on
+  // Linux.
+  static void set_reuse_port(bool value) { reuse_port_ = value; }
+  static bool reuse_port() { return reuse_port_; }
+
  private:
+  static bool reuse_port_;
+
   DISALLOW_ALLOCATION();
   DISALLOW_IMPLICIT_CONSTRUCTORS(ServerSocket);
 };
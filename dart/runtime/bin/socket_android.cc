@@ -9,7 +9,9 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/sendfile.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
+#include <sys/uio.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 #include <netinet/tcp.h>  // NOLINT
 
@@ -118,6 +120,50 @@ int Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::WriteVector(intptr_t fd,
+                             const void* const* buffers,
+                             const intptr_t* lengths,
+                             intptr_t count) {
+  ASSERT(fd >= 0);
+  ASSERT(count <= kMaxWriteVectorBuffers);
+  struct iovec iov[kMaxWriteVectorBuffers];
+  for (intptr_t i = 0; i < count; i++) {
+    iov[i].iov_base = const_cast<void*>(buffers[i]);
+    iov[i].iov_len = lengths[i];
+  }
+  ssize_t written_bytes = TEMP_FAILURE_RETRY(writev(fd, iov, count));
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (written_bytes == -1 && errno == EWOULDBLOCK) {
+    // If the would block we need to retry and therefore return 0 as
+    // the number of bytes written.
+    written_bytes = 0;
+  }
+  return written_bytes;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          File* file,
+                          int64_t position,
+                          intptr_t count) {
+  ASSERT(fd >= 0);
+  off_t offset = position;
+  ssize_t sent_bytes =
+      TEMP_FAILURE_RETRY(sendfile(fd, file->GetFD(), &offset, count));
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (sent_bytes == -1 && errno == EWOULDBLOCK) {
+    // If the would block we need to retry and therefore return 0 as
+    // the number of bytes sent.
+    sent_bytes = 0;
+  } else if (sent_bytes == 0 && count > 0) {
+    // Reached the end of the file.
+    errno = EINVAL;
+    sent_bytes = -1;
+  }
+  return sent_bytes;
+}
+
+
 intptr_t Socket::GetPort(intptr_t fd) {
   ASSERT(fd >= 0);
   RawAddr raw;
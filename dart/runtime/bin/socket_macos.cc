@@ -9,7 +9,10 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/socket.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
+#include <sys/types.h>  // NOLINT
+#include <sys/uio.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 #include <netinet/tcp.h>  // NOLINT
 #include <ifaddrs.h>  // NOLINT
@@ -119,6 +122,51 @@ int Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::WriteVector(intptr_t fd,
+                             const void* const* buffers,
+                             const intptr_t* lengths,
+                             intptr_t count) {
+  ASSERT(fd >= 0);
+  ASSERT(count <= kMaxWriteVectorBuffers);
+  struct iovec iov[kMaxWriteVectorBuffers];
+  for (intptr_t i = 0; i < count; i++) {
+    iov[i].iov_base = const_cast<void*>(buffers[i]);
+    iov[i].iov_len = lengths[i];
+  }
+  ssize_t written_bytes = TEMP_FAILURE_RETRY(writev(fd, iov, count));
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (written_bytes == -1 && errno == EWOULDBLOCK) {
+    // If the would block we need to retry and therefore return 0 as
+    // the number of bytes written.
+    written_bytes = 0;
+  }
+  return written_bytes;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          File* file,
+                          int64_t position,
+                          intptr_t count) {
+  ASSERT(fd >= 0);
+  // On return len holds the number of bytes sent, also if the write would
+  // block.
+  off_t len = count;
+  int result = sendfile(file->GetFD(), fd, position, &len, NULL, 0);
+  ASSERT(EAGAIN == EWOULDBLOCK);
+  if (result == -1 && (errno == EWOULDBLOCK || errno == EINTR)) {
+    return len;
+  }
+  if (result == -1) return -1;
+  if (len == 0 && count > 0) {
+    // Reached the end of the file.
+    errno = EINVAL;
+    return -1;
+  }
+  return len;
+}
+
+
 intptr_t Socket::GetPort(intptr_t fd) {
   ASSERT(fd >= 0);
   RawAddr raw;
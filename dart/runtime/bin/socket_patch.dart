@@ -441,6 +441,17 @@ class _NativeSocket extends NativeFieldWrapperClass1 {
     return result;
   }
 
+  int readInto(List<int> buffer, int start, int end) {
+    if (isClosing || isClosed) return 0;
+    if (start == end) return 0;
+    var result = nativeReadInto(buffer, start, end);
+    if (result is OSError) {
+      reportError(result, "Read failed");
+      return 0;
+    }
+    return result;
+  }
+
   int write(List<int> buffer, int offset, int bytes) {
     if (buffer is! List) throw new ArgumentError();
     if (offset == null) offset = 0;
@@ -471,6 +482,52 @@ class _NativeSocket extends NativeFieldWrapperClass1 {
     return result;
   }
 
+  int writeList(List<List<int>> buffers, int offset) {
+    if (buffers is! List) throw new ArgumentError();
+    if (offset == null) offset = 0;
+    if (offset is! int) {
+      throw new ArgumentError("Invalid arguments to writeList on Socket");
+    }
+    if (offset < 0) throw new RangeError.value(offset);
+    if (buffers.isEmpty) {
+      if (offset != 0) throw new RangeError.value(offset);
+      return 0;
+    }
+    if (offset > buffers[0].length) throw new RangeError.value(offset);
+    if (isClosing || isClosed) return 0;
+    // Pass the buffers to the native call as Uint8List or Int8List, copying
+    // only the lists which are neither.
+    var fastBuffers = new List(buffers.length);
+    for (int i = 0; i < buffers.length; i++) {
+      var buffer = buffers[i];
+      if (buffer is! List) {
+        throw new ArgumentError("Invalid arguments to writeList on Socket");
+      }
+      int start = (i == 0) ? offset : 0;
+      _BufferAndStart bufferAndStart =
+          _ensureFastAndSerializableByteData(buffer, start, buffer.length);
+      fastBuffers[i] = bufferAndStart.buffer;
+      if (i == 0) offset = bufferAndStart.start;
+    }
+    var result = nativeWriteVector(fastBuffers, offset);
+    if (result is OSError) {
+      reportError(result, "Write failed");
+      result = 0;
+    }
+    return result;
+  }
+
+  int sendFile(_RandomAccessFile file, int position, int count) {
+    if (isClosing || isClosed) return 0;
+    if (count == 0) return 0;
+    var result = nativeSendFile(file._id, position, count);
+    if (result is OSError) {
+      reportError(result, "Send file failed");
+      result = 0;
+    }
+    return result;
+  }
+
   _NativeSocket accept() {
     // Don't issue accept if we're closing.
     if (isClosing || isClosed) return null;
@@ -702,8 +759,14 @@ class _NativeSocket extends NativeFieldWrapperClass1 {
   void nativeSetSocketId(int id) native "Socket_SetSocketId";
   nativeAvailable() native "Socket_Available";
   nativeRead(int len) native "Socket_Read";
+  nativeReadInto(List<int> buffer, int start, int end)
+      native "Socket_ReadInto";
   nativeWrite(List<int> buffer, int offset, int bytes)
       native "Socket_WriteList";
+  nativeWriteVector(List<List<int>> buffers, int offset)
+      native "Socket_WriteVector";
+  nativeSendFile(int fileId, int position, int count)
+      native "Socket_SendFile";
   nativeCreateConnect(List<int> addr,
                       int port) native "Socket_CreateConnect";
   nativeCreateBindListen(List<int> addr, int port, int backlog, bool v6Only)
@@ -880,9 +943,42 @@ class _RawSocket extends Stream<RawSocketEvent>
     }
   }
 
+  int readInto(List<int> buffer, [int start, int end]) {
+    if (buffer is! List ||
+        (start != null && start is! int) ||
+        (end != null && end is! int)) {
+      throw new ArgumentError("Invalid arguments to readInto on Socket");
+    }
+    if (start == null) start = 0;
+    if (end == null) end = buffer.length;
+    if (start < 0) throw new RangeError.value(start);
+    if (end < start || end > buffer.length) throw new RangeError.value(end);
+    if (_isMacOSTerminalInput) {
+      // Go through read, which detects Ctrl-D.
+      if (start == end) return 0;
+      var data = read(end - start);
+      if (data == null) return 0;
+      buffer.setRange(start, start + data.length, data);
+      return data.length;
+    }
+    return _socket.readInto(buffer, start, end);
+  }
+
   int write(List<int> buffer, [int offset, int count]) =>
       _socket.write(buffer, offset, count);
 
+  int writeList(List<List<int>> buffers, [int offset]) =>
+      _socket.writeList(buffers, offset);
+
+  int sendFile(RandomAccessFile file, int position, int count) {
+    if (file is! _RandomAccessFile || file.closed ||
+        position is! int || position < 0 ||
+        count is! int || count < 0) {
+      throw new ArgumentError("Invalid arguments to sendFile on Socket");
+    }
+    return _socket.sendFile(file, position, count);
+  }
+
   Future close() => _socket.close().then((_) => this);
 
   void shutdown(SocketDirection direction) => _socket.shutdown(direction);
@@ -997,6 +1093,12 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
   List<int> buffer;
   bool paused = false;
   Completer streamCompleter;
+  // The range of a file being sent in place of the data of a stream, see
+  // _Socket.sendFile.
+  RandomAccessFile file;
+  int filePosition;
+  int fileEnd;
+  StreamController fileController;
 
   _SocketStreamConsumer(this.socket);
 
@@ -1029,9 +1131,29 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     return new Future.value(socket);
   }
 
+  void sendFile(RandomAccessFile file,
+                int start,
+                int end,
+                StreamController controller) {
+    if (subscription == null) {
+      controller.close();
+      return;
+    }
+    assert(buffer == null);
+    this.file = file;
+    filePosition = start;
+    fileEnd = end;
+    fileController = controller;
+    write();
+  }
+
   void write() {
     try {
       if (subscription == null) return;
+      if (file != null) {
+        writeFile();
+        return;
+      }
       assert(buffer != null);
       // Write as much as possible.
       offset += socket._write(buffer, offset, buffer.length - offset);
@@ -1055,6 +1177,21 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     }
   }
 
+  void writeFile() {
+    // Send as much as possible.
+    filePosition +=
+        socket._sendFile(file, filePosition, fileEnd - filePosition);
+    if (filePosition < fileEnd) {
+      socket._enableWriteEvent();
+    } else {
+      var controller = fileController;
+      file = null;
+      fileController = null;
+      // Completes the stream the sink is bound to.
+      controller.close();
+    }
+  }
+
   void done([error, stackTrace]) {
     if (streamCompleter != null) {
       if (error != null) {
@@ -1071,6 +1208,8 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     subscription.cancel();
     subscription = null;
     paused = false;
+    file = null;
+    fileController = null;
     socket._disableWriteEvent();
   }
 }
@@ -1149,6 +1288,29 @@ class _Socket extends Stream<List<int>> implements Socket {
 
   Future<Socket> get done => _sink.done;
 
+  Future<Socket> sendFile(RandomAccessFile file, [int start, int end]) {
+    if (file is! RandomAccessFile ||
+        (start != null && start is! int) ||
+        (end != null && end is! int)) {
+      throw new ArgumentError("Invalid arguments to sendFile on Socket");
+    }
+    if (start == null) start = 0;
+    if (end == null) end = file.lengthSync();
+    if (start < 0) throw new RangeError.value(start);
+    if (end < start) throw new RangeError.value(end);
+    // Bind the sink to a stream without data, so adding data fails until
+    // the file has been sent. The consumer listens to the stream once all
+    // data added before has been written, and closes it when the file has
+    // been sent.
+    var controller;
+    controller = new StreamController<List<int>>(onListen: () {
+      scheduleMicrotask(() {
+        _consumer.sendFile(file, start, end, controller);
+      });
+    });
+    return _sink.addStream(controller.stream);
+  }
+
   void destroy() {
     // Destroy can always be called to get rid of a socket.
     if (_raw == null) return;
@@ -1254,6 +1416,9 @@ class _Socket extends Stream<List<int>> implements Socket {
   int _write(List<int> data, int offset, int length) =>
       _raw.write(data, offset, length);
 
+  int _sendFile(RandomAccessFile file, int position, int count) =>
+      _raw.sendFile(file, position, count);
+
   void _enableWriteEvent() {
     _raw.writeEventsEnabled = true;
   }
@@ -70,6 +70,54 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::WriteVector(intptr_t fd,
+                             const void* const* buffers,
+                             const intptr_t* lengths,
+                             intptr_t count) {
+  // Handles have a single pending overlapped write, so the buffers are
+  // written one at a time until one is not written completely.
+  Handle* handle = reinterpret_cast<Handle*>(fd);
+  intptr_t total_written = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    if (lengths[i] == 0) continue;
+    intptr_t written = handle->Write(buffers[i], lengths[i]);
+    if (written < 0) return (total_written > 0) ? total_written : -1;
+    total_written += written;
+    if (written < lengths[i]) break;
+  }
+  return total_written;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          File* file,
+                          int64_t position,
+                          intptr_t count) {
+  // Handles copy the data into an overlapped buffer when writing, so read
+  // the range of the file into a buffer of at most that size and write it.
+  const intptr_t kMaxSendSize = 64 * KB;
+  Handle* handle = reinterpret_cast<Handle*>(fd);
+  if (count == 0) return 0;
+  if (count > kMaxSendSize) count = kMaxSendSize;
+  uint8_t* buffer = new uint8_t[count];
+  off64_t saved_position = file->Position();
+  intptr_t bytes_read = -1;
+  if (saved_position >= 0 && file->SetPosition(position)) {
+    bytes_read = file->Read(buffer, count);
+    file->SetPosition(saved_position);
+  }
+  intptr_t sent_bytes = -1;
+  if (bytes_read > 0) {
+    sent_bytes = handle->Write(buffer, bytes_read);
+  } else if (bytes_read == 0) {
+    // Reached the end of the file.
+    SetLastError(ERROR_HANDLE_EOF);
+  }
+  delete[] buffer;
+  return sent_bytes;
+}
+
+
 intptr_t Socket::GetPort(intptr_t fd) {
   ASSERT(reinterpret_cast<Handle*>(fd)->is_socket());
   SocketHandle* socket_handle = reinterpret_cast<SocketHandle*>(fd);
@@ -899,6 +899,50 @@ DART_EXPORT Dart_Handle Dart_CreateSnapshot(uint8_t** buffer,
 DART_EXPORT Dart_Handle Dart_CreateScriptSnapshot(uint8_t** buffer,
                                                   intptr_t* size);
 
+/**
+ * Saves the type feedback collected by the isolate.
+ *
+ * The type feedback records, by library url and name, the functions which
+ * have been compiled, how often they have been invoked and the receiver
+ * classes seen at their calls. Loading it into a new isolate running the
+ * same application with Dart_LoadTypeFeedback lets the new isolate skip
+ * warming up.
+ *
+ * Requires there to be a current isolate.
+ *
+ * \param buffer Returns a pointer to a buffer containing the type
+ *   feedback. This buffer is scope allocated and is only valid until the
+ *   next call to Dart_ExitScope.
+ * \param size Returns the size of the buffer.
+ *
+ * \return A valid handle if no error occurs during the operation.
+ */
+DART_EXPORT Dart_Handle Dart_SaveTypeFeedback(uint8_t** buffer,
+                                              intptr_t* size);
+
+/**
+ * Loads type feedback saved by Dart_SaveTypeFeedback.
+ *
+ * The recorded functions are compiled, the receiver classes seen at their
+ * calls are entered into their inline caches and their invocation counts
+ * are restored, so that hot functions are optimized when they are first
+ * invoked. Feedback for functions whose source changed, or for calls which
+ * dispatch to a different target in the current class hierarchy, is
+ * dropped.
+ *
+ * Requires there to be a current isolate which already has loaded script.
+ * Should be called before the application starts running.
+ *
+ * \param buffer A buffer containing the type feedback.
+ * \param size The size of the buffer.
+ *
+ * \return A valid handle if no error occurs during the operation. An error
+ *   handle is returned, and nothing is loaded, if the type feedback was
+ *   saved by a different version of the VM or with different flags.
+ */
+DART_EXPORT Dart_Handle Dart_LoadTypeFeedback(const uint8_t* buffer,
+                                              intptr_t size);
+
 /**
  * Schedules an interrupt for the specified isolate.
  *
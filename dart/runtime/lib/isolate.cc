@@ -100,15 +100,44 @@ DEFINE_NATIVE_ENTRY(SendPortImpl_sendInternal_, 2) {
   // TODO(iposva): Allow for arbitrary messages to be sent.
   GET_NON_NULL_NATIVE_ARGUMENT(Instance, obj, arguments->NativeArgAt(1));
 
+  // The bytes of transferable typed data can only be moved to a Dart
+  // isolate, native ports receive a copy.
+  bool can_transfer = (PortMap::GetIsolate(send_id.Value()) != NULL);
   uint8_t* data = NULL;
-  MessageWriter writer(&data, &allocator);
+  MessageWriter writer(&data, &allocator, can_transfer);
   writer.WriteMessage(obj);
 
   // TODO(turnidge): Throw an exception when the return value is false?
-  PortMap::PostMessage(new Message(send_id.Value(), Message::kIllegalPort,
-                                   data, writer.BytesWritten(),
-                                   Message::kNormalPriority));
-  return Object::null();
+  bool posted =
+      PortMap::PostMessage(new Message(send_id.Value(), Message::kIllegalPort,
+                                       data, writer.BytesWritten(),
+                                       Message::kNormalPriority));
+  // Returns the transferable typed data whose bytes were moved, the caller
+  // empties them.
+  return writer.CompleteTransfers(posted);
+}
+
+
+DEFINE_NATIVE_ENTRY(TransferableTypedData_allocate, 1) {
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, length, arguments->NativeArgAt(0));
+  const intptr_t cid = kExternalTypedDataUint8ArrayCid;
+  intptr_t len = length.Value();
+  intptr_t max = ExternalTypedData::MaxElements(cid);
+  if ((len < 0) || (len > max)) {
+    const String& error = String::Handle(String::NewFormatted(
+        "Length (%" Pd ") of object must be in range [0..%" Pd "]",
+        len, max));
+    Exceptions::ThrowArgumentError(error);
+  }
+  uint8_t* data = reinterpret_cast<uint8_t*>(malloc(len));
+  if ((data == NULL) && (len > 0)) {
+    Exceptions::ThrowOOM();
+  }
+  const ExternalTypedData& bytes =
+      ExternalTypedData::Handle(ExternalTypedData::New(cid, data, len));
+  bytes.AddFinalizer(new TransferableTypedDataPeer(data),
+                     &TransferableTypedDataPeer::Finalize);
+  return bytes.raw();
 }
 
 
@@ -3,6 +3,7 @@
 // BSD-style license that can be found in the LICENSE file.
 
 import "dart:collection" show HashMap;
+import "dart:typed_data";
 
 patch class ReceivePort {
   /* patch */ factory ReceivePort() = _ReceivePortImpl;
@@ -26,6 +27,46 @@ patch class RawReceivePort {
   }
 }
 
+patch class TransferableTypedData {
+  /* patch */ factory TransferableTypedData.fromList(List<TypedData> list) =
+      _TransferableTypedDataImpl;
+}
+
+class _TransferableTypedDataImpl implements TransferableTypedData {
+  _TransferableTypedDataImpl(List<TypedData> list) {
+    int length = 0;
+    for (TypedData data in list) {
+      length += data.lengthInBytes;
+    }
+    _bytes = _allocate(length);
+    int offset = 0;
+    for (TypedData data in list) {
+      int end = offset + data.lengthInBytes;
+      _bytes.setRange(offset, end, new Uint8List.view(
+          data.buffer, data.offsetInBytes, data.lengthInBytes));
+      offset = end;
+    }
+  }
+
+  ByteBuffer materialize() {
+    if (_bytes == null) {
+      throw new StateError(
+          "TransferableTypedData was already materialized or sent");
+    }
+    ByteBuffer buffer = _bytes.buffer;
+    _bytes = null;
+    return buffer;
+  }
+
+  // Allocates external bytes which the VM can hand over to another isolate.
+  static Uint8List _allocate(int length)
+      native "TransferableTypedData_allocate";
+
+  // The VM moves these bytes when the object is sent to another isolate,
+  // see _SendPortImpl.send.
+  Uint8List _bytes;
+}
+
 class _ReceivePortImpl extends Stream implements ReceivePort {
   _ReceivePortImpl() : this.fromRawReceivePort(new RawReceivePort());
 
@@ -113,7 +154,13 @@ class _RawReceivePortImpl implements RawReceivePort {
 class _SendPortImpl implements SendPort {
   /*--- public interface ---*/
   void send(var message) {
-    _sendInternal(_id, message);
+    List moved = _sendInternal(_id, message);
+    if (moved != null) {
+      // The receiver took over the bytes of these objects.
+      for (_TransferableTypedDataImpl transferable in moved) {
+        transferable._bytes = null;
+      }
+    }
   }
 
   bool operator==(var other) {
@@ -141,7 +188,8 @@ class _SendPortImpl implements SendPort {
   }
 
   // Forward the implementation of sending messages to the VM. Only port ids
-  // are being handed to the VM.
+  // are being handed to the VM. Returns the transferable typed data whose
+  // bytes were moved, or null.
   static _sendInternal(int sendId, var message)
       native "SendPortImpl_sendInternal_";
 
@@ -10,7 +10,9 @@
 #include "vm/allocation.h"
 #include "vm/exceptions.h"
 #include "vm/globals.h"
+#include "vm/heap.h"
 #include "vm/isolate.h"
+#include "vm/regexp_compiler.h"
 #include "third_party/jscre/pcre.h"
 
 namespace dart {
@@ -104,13 +106,36 @@ RawJSRegExp* Jscre::Compile(const String& pattern,
 }
 
 
+// Returns the native matcher of the regexp for subjects with char_size bytes
+// per character, compiling it on first use, or Code::null() if native
+// matching is disabled or the pattern is not supported.
+static RawCode* NativeCode(const JSRegExp& regex, intptr_t char_size) {
+  if (!FLAG_regexp_native_code || regex.has_no_native_code()) {
+    return Code::null();
+  }
+  Code& code = Code::Handle(regex.native_code(char_size));
+  if (code.IsNull()) {
+    const String& pattern = String::Handle(regex.pattern());
+    const Smi& num_bracket_exprs =
+        Smi::Handle(regex.num_bracket_expressions());
+    code = RegExpCompiler::Compile(pattern,
+                                   regex.is_multi_line(),
+                                   regex.is_ignore_case(),
+                                   num_bracket_exprs.Value(),
+                                   char_size);
+    if (code.IsNull()) {
+      regex.set_has_no_native_code();
+    } else {
+      regex.set_native_code(char_size, code);
+    }
+  }
+  return code.raw();
+}
+
+
 RawArray* Jscre::Execute(const JSRegExp& regex,
                          const String& str,
                          intptr_t start_index) {
-  // First convert the input str to UTF16 format as the jscre library expects
-  // strings to be in UTF16 encoding.
-  uint16_t* two_byte_str = GetTwoByteData(str);
-
   // Execute a regex match by calling into the jscre library.
   jscre::JSRegExp* jscregexp =
       reinterpret_cast<jscre::JSRegExp*>(regex.GetDataStartAddress());
@@ -126,12 +151,68 @@ RawArray* Jscre::Execute(const JSRegExp& regex,
   int offsets_length = (num_bracket_expressions + 1) * kJscreMultiple;
   int* offsets = NULL;
   offsets = zone->Alloc<int>(offsets_length);
-  int retval = jscre::jsRegExpExecute(jscregexp,
-                                      two_byte_str,
-                                      str.Length(),
-                                      start_index,
-                                      offsets,
-                                      offsets_length);
+  // Match directly on the character data of the subject string, so that
+  // repeated matches against a long string, e.g. from allMatches, do not
+  // copy it on every call. The matchers do not allocate, so the character
+  // data cannot move. They expect a non-NULL subject even when it is empty.
+  static const uint16_t kEmpty = 0;
+  intptr_t length = str.Length();
+  intptr_t char_size =
+      (str.IsOneByteString() || str.IsExternalOneByteString()) ? 1 : 2;
+  const Code& code = Code::Handle(NativeCode(regex, char_size));
+  int retval;
+  {
+    NoGCScope no_gc;
+    const void* data = &kEmpty;
+    if (length > 0) {
+      if (str.IsOneByteString()) {
+        data = OneByteString::CharAddr(str, 0);
+      } else if (str.IsExternalOneByteString()) {
+        data = ExternalOneByteString::CharAddr(str, 0);
+      } else if (str.IsTwoByteString()) {
+        data = TwoByteString::CharAddr(str, 0);
+      } else {
+        ASSERT(str.IsExternalTwoByteString());
+        data = ExternalTwoByteString::CharAddr(str, 0);
+      }
+    }
+    RegExpCompiler::Result result = RegExpCompiler::kStackOverflow;
+    if (!code.IsNull()) {
+      intptr_t* captures =
+          zone->Alloc<intptr_t>(2 * (num_bracket_expressions + 1));
+      result =
+          RegExpCompiler::Execute(code, data, length, start_index, captures);
+      if (result == RegExpCompiler::kMatch) {
+        for (intptr_t i = 0; i < 2 * (num_bracket_expressions + 1); i++) {
+          offsets[i] = captures[i];
+        }
+        retval = 1;
+      } else if (result == RegExpCompiler::kNoMatch) {
+        retval = jscre::JSRegExpErrorNoMatch;
+      }
+    }
+    // The interpreter handles everything else, including matches which
+    // need more backtracking than the native matcher supports.
+    if (result == RegExpCompiler::kStackOverflow) {
+      if (char_size == 1) {
+        retval = jscre::jsRegExpExecuteLatin1(
+            jscregexp,
+            reinterpret_cast<const uint8_t*>(data),
+            length,
+            start_index,
+            offsets,
+            offsets_length);
+      } else {
+        retval = jscre::jsRegExpExecute(
+            jscregexp,
+            reinterpret_cast<const uint16_t*>(data),
+            length,
+            start_index,
+            offsets,
+            offsets_length);
+      }
+    }
+  }
 
   // The KJS JavaScript engine returns null (ie, a failed match) when
   // JSRE's internal match limit is exceeded.  We duplicate that behavior here.
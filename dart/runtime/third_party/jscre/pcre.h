@@ -61,6 +61,7 @@ typedef unsigned __int16 uint16_t;
 namespace dart { namespace jscre {
 
 typedef uint16_t UChar;
+typedef uint8_t LChar;
 
 struct JSRegExp;
 typedef struct JSRegExp JscreRegExp;
@@ -86,6 +87,12 @@ int jsRegExpExecute(const JSRegExp*,
     const UChar* subject, int subjectLength, int startOffset,
     int* offsetsVector, int offsetsVectorLength);
 
+/* Same as jsRegExpExecute for a subject with one Latin-1 byte per
+character. */
+int jsRegExpExecuteLatin1(const JSRegExp*,
+    const LChar* subject, int subjectLength, int startOffset,
+    int* offsetsVector, int offsetsVectorLength);
+
 void jsRegExpFree(JSRegExp* regexp);
 
 } }  // namespace dart::jscre
@@ -63,6 +63,16 @@ the JavaScript specification. There are also some supporting functions. */
 
 namespace dart { namespace jscre {
 
+/* The matcher is compiled once for UTF-16 subjects and, by
+pcre_exec_latin1.cpp, once more for subjects with one byte per character,
+so that such strings can be matched without converting them first. */
+#ifdef JSCRE_LATIN1_SUBJECT
+typedef LChar SubjectChar;
+#define jsRegExpExecute jsRegExpExecuteLatin1
+#else
+typedef UChar SubjectChar;
+#endif
+
 #ifndef USE_COMPUTED_GOTO_FOR_MATCH_RECURSION
 typedef int ReturnLocation;
 #else
@@ -74,7 +84,7 @@ the subject pointer at the start of each bracket, used to detect when
 an empty string has been matched by a bracket to break infinite loops. */ 
 struct BracketChainNode {
     BracketChainNode* previousBracket;
-    const UChar* bracketStart;
+    const SubjectChar* bracketStart;
 };
 
 struct MatchFrame {
@@ -83,7 +93,7 @@ struct MatchFrame {
     
     /* Function arguments that may change */
     struct {
-        const UChar* subjectPtr;
+        const SubjectChar* subjectPtr;
         const unsigned char* instructionPtr;
         int offsetTop;
         BracketChainNode* bracketChain;
@@ -96,7 +106,7 @@ struct MatchFrame {
     struct {
         const unsigned char* data;
         const unsigned char* startOfRepeatingBracket;
-        const UChar* subjectPtrAtStartOfInstruction; // Several instrutions stash away a subjectPtr here for later compare
+        const SubjectChar* subjectPtrAtStartOfInstruction; // Several instrutions stash away a subjectPtr here for later compare
         const unsigned char* instructionPtrAtStartOfOnce;
         
         int repeatOthercase;
@@ -124,9 +134,9 @@ struct MatchData {
   int    offsetEnd;            /* One past the end */
   int    offsetMax;            /* The maximum usable for return data */
   bool   offsetOverflow;       /* Set if too many extractions */
-  const UChar*  startSubject;         /* Start of the subject string */
-  const UChar*  endSubject;           /* End of the subject string */
-  const UChar*  endMatchPtr;         /* Subject position at end match */
+  const SubjectChar*  startSubject;         /* Start of the subject string */
+  const SubjectChar*  endSubject;           /* End of the subject string */
+  const SubjectChar*  endMatchPtr;         /* Subject position at end match */
   int    endOffsetTop;        /* Highwater mark at end of match */
   bool   multiline;
   bool   ignoreCase;
@@ -157,7 +167,7 @@ Arguments:
   md          pointer to matching data block, if isSubject is true
 */
 
-static void pchars(const UChar* p, int length, bool isSubject, const MatchData& md)
+static void pchars(const SubjectChar* p, int length, bool isSubject, const MatchData& md)
 {
     if (isSubject && length > md.endSubject - p)
         length = md.endSubject - p;
@@ -189,9 +199,9 @@ Arguments:
 Returns:      true if matched
 */
 
-static bool matchRef(int offset, const UChar* subjectPtr, int length, const MatchData& md)
+static bool matchRef(int offset, const SubjectChar* subjectPtr, int length, const MatchData& md)
 {
-    const UChar* p = md.startSubject + md.offsetVector[offset];
+    const SubjectChar* p = md.startSubject + md.offsetVector[offset];
     
 #ifdef DEBUG
     if (subjectPtr >= md.endSubject)
@@ -214,9 +224,9 @@ static bool matchRef(int offset, const UChar* subjectPtr, int length, const Matc
     
     if (md.ignoreCase) {
         while (length-- > 0) {
-            UChar c = *p++;
+            SubjectChar c = *p++;
             int othercase = kjs_pcre_ucp_othercase(c);
-            UChar d = *subjectPtr++;
+            SubjectChar d = *subjectPtr++;
             if (c != d && othercase != d)
                 return false;
         }
@@ -406,7 +416,7 @@ static inline void repeatInformationFromInstructionOffset(short instructionOffse
     maximumRepeats = maximumRepeatsFromInstructionOffset[instructionOffset];
 }
 
-static int match(const UChar* subjectPtr, const unsigned char* instructionPtr, int offsetTop, MatchData& md)
+static int match(const SubjectChar* subjectPtr, const unsigned char* instructionPtr, int offsetTop, MatchData& md)
 {
     bool isMatch = false;
     int min;
@@ -1831,12 +1841,12 @@ Returns:          > 0 => success; value is the number of elements filled in
                  < -1 => some kind of unexpected problem
 */
 
-static void tryFirstByteOptimization(const UChar*& subjectPtr, const UChar* endSubject, int first_byte, bool first_byte_caseless, bool useMultiLineFirstCharOptimization, const UChar* originalSubjectStart)
+static void tryFirstByteOptimization(const SubjectChar*& subjectPtr, const SubjectChar* endSubject, int first_byte, bool first_byte_caseless, bool useMultiLineFirstCharOptimization, const SubjectChar* originalSubjectStart)
 {
     // If first_byte is set, try scanning to the first instance of that byte
     // no need to try and match against any earlier part of the subject string.
     if (first_byte >= 0) {
-        UChar first_char = first_byte;
+        SubjectChar first_char = first_byte;
         if (first_byte_caseless)
             while (subjectPtr < endSubject) {
                 int c = *subjectPtr;
@@ -1860,7 +1870,7 @@ static void tryFirstByteOptimization(const UChar*& subjectPtr, const UChar* endS
     }
 }
 
-static bool tryRequiredByteOptimization(const UChar*& subjectPtr, const UChar* endSubject, int req_byte, int req_byte2, bool req_byte_caseless, bool hasFirstByte, const UChar*& reqBytePtr)
+static bool tryRequiredByteOptimization(const SubjectChar*& subjectPtr, const SubjectChar* endSubject, int req_byte, int req_byte2, bool req_byte_caseless, bool hasFirstByte, const SubjectChar*& reqBytePtr)
 {
     /* If req_byte is set, we know that that character must appear in the subject
      for the match to succeed. If the first character is set, req_byte must be
@@ -1877,7 +1887,7 @@ static bool tryRequiredByteOptimization(const UChar*& subjectPtr, const UChar* e
     */
 
     if (req_byte >= 0 && endSubject - subjectPtr < REQ_BYTE_MAX) {
-        const UChar* p = subjectPtr + (hasFirstByte ? 1 : 0);
+        const SubjectChar* p = subjectPtr + (hasFirstByte ? 1 : 0);
 
         /* We don't need to repeat the search if we haven't yet reached the
          place we found it at last time. */
@@ -1916,7 +1926,7 @@ static bool tryRequiredByteOptimization(const UChar*& subjectPtr, const UChar* e
 }
 
 int jsRegExpExecute(const JSRegExp* re,
-                    const UChar* subject, int length, int start_offset, int* offsets,
+                    const SubjectChar* subject, int length, int start_offset, int* offsets,
                     int offsetcount)
 {
     ASSERT(re);
@@ -1927,7 +1937,7 @@ int jsRegExpExecute(const JSRegExp* re,
     MatchData matchBlock;
     matchBlock.startSubject = subject;
     matchBlock.endSubject = matchBlock.startSubject + length;
-    const UChar* endSubject = matchBlock.endSubject;
+    const SubjectChar* endSubject = matchBlock.endSubject;
     
     matchBlock.multiline = (re->options & MatchAcrossMultipleLinesOption);
     matchBlock.ignoreCase = (re->options & IgnoreCaseOption);
@@ -2004,8 +2014,8 @@ int jsRegExpExecute(const JSRegExp* re,
     /* Loop for handling unanchored repeated matching attempts; for anchored regexs
      the loop runs just once. */
     
-    const UChar* startMatch = subject + start_offset;
-    const UChar* reqBytePtr = startMatch - 1;
+    const SubjectChar* startMatch = subject + start_offset;
+    const SubjectChar* reqBytePtr = startMatch - 1;
     bool useMultiLineFirstCharOptimization = re->options & UseMultiLineFirstByteOptimizationOption;
     
     do {
@@ -0,0 +1,9 @@
+// Copyright (c) 2014, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Compiles the matcher in pcre_exec.cpp a second time, for subject strings
+// with one Latin-1 byte per character. This defines jsRegExpExecuteLatin1.
+
+#define JSCRE_LATIN1_SUBJECT
+#include "pcre_exec.cpp"
@@ -2045,13 +2045,33 @@ void Assembler::StoreIntoObject(Register object,
                                 bool can_value_be_smi) {
   ASSERT(object != value);
   movl(dest, value);
-  Label done;
+  Label done, update_store_buffer;
+  if (FLAG_incremental_marking) {
+    // While the old generation is being marked incrementally, a marked old
+    // object that is written to is added to the store buffer so that the
+    // marker visits it again. The value register is used as scratch.
+    Label generational_barrier;
+    pushl(value);
+    movl(value, FieldAddress(CTX, Context::isolate_offset()));
+    cmpl(Address(value, Isolate::marking_in_progress_offset()), Immediate(0));
+    j(EQUAL, &generational_barrier, Assembler::kNearJump);
+    testl(object, Immediate(kNewObjectAlignmentOffset));
+    j(NOT_ZERO, &generational_barrier, Assembler::kNearJump);
+    movl(value, FieldAddress(object, Object::tags_offset()));
+    testl(value, Immediate(1 << RawObject::kMarkBit));
+    j(ZERO, &generational_barrier, Assembler::kNearJump);
+    popl(value);
+    jmp(&update_store_buffer);
+    Bind(&generational_barrier);
+    popl(value);
+  }
   if (can_value_be_smi) {
     StoreIntoObjectFilter(object, value, &done);
   } else {
     StoreIntoObjectFilterNoSmi(object, value, &done);
   }
   // A store buffer update is required.
+  Bind(&update_store_buffer);
   if (value != EAX) pushl(EAX);  // Preserve EAX.
   if (object != EAX) {
     movl(EAX, object);
@@ -2301,6 +2321,50 @@ void Assembler::TryAllocate(const Class& cls,
 }
 
 
+void Assembler::TryAllocateOld(intptr_t instance_size,
+                               intptr_t cid,
+                               Label* failure,
+                               bool near_jump,
+                               Register instance_reg,
+                               Register temp_reg) {
+  ASSERT(failure != NULL);
+  ASSERT(instance_size <= PageSpace::kMaxPretenureObjectSize);
+  ASSERT(instance_reg != temp_reg);
+  if (FLAG_inline_alloc) {
+    Heap* heap = Isolate::Current()->heap();
+    movl(instance_reg, Address::Absolute(heap->PretenureTopAddress()));
+    // The remainder of the area must stay large enough to hold a free list
+    // element with an explicit size. An empty area (top == end == 0) always
+    // fails here.
+    leal(temp_reg,
+         Address(instance_reg,
+                 instance_size + PageSpace::kPretenureAreaReserve));
+    cmpl(temp_reg, Address::Absolute(heap->PretenureEndAddress()));
+    j(ABOVE, failure, near_jump);
+    // Successfully allocated the object, now update top to point to
+    // next object start.
+    addl(instance_reg, Immediate(instance_size));
+    movl(Address::Absolute(heap->PretenureTopAddress()), instance_reg);
+    // Keep the remainder of the area walkable: format it as a free list
+    // element with a size tag of 0, i.e. with its size in the third word.
+    movl(temp_reg, Address::Absolute(heap->PretenureEndAddress()));
+    subl(temp_reg, instance_reg);
+    movl(Address(instance_reg, 2 * kWordSize), temp_reg);
+    uword free_tags = 0;
+    free_tags = RawObject::ClassIdTag::update(kFreeListElement, free_tags);
+    movl(Address(instance_reg, Object::tags_offset()), Immediate(free_tags));
+    subl(instance_reg, Immediate(instance_size - kHeapObjectTag));
+    uword tags = 0;
+    tags = RawObject::SizeTag::update(instance_size, tags);
+    ASSERT(cid != kIllegalCid);
+    tags = RawObject::ClassIdTag::update(cid, tags);
+    movl(FieldAddress(instance_reg, Object::tags_offset()), Immediate(tags));
+  } else {
+    jmp(failure);
+  }
+}
+
+
 void Assembler::EnterDartFrame(intptr_t frame_size) {
   EnterFrame(0);
   Label dart_entry;
@@ -2552,13 +2552,29 @@ void Assembler::StoreIntoObject(Register object,
                                 bool can_value_be_smi) {
   ASSERT(object != value);
   movq(dest, value);
-  Label done;
+  Label done, update_store_buffer;
+  if (FLAG_incremental_marking) {
+    // While the old generation is being marked incrementally, a marked old
+    // object that is written to is added to the store buffer so that the
+    // marker visits it again.
+    Label generational_barrier;
+    movq(TMP, FieldAddress(CTX, Context::isolate_offset()));
+    cmpq(Address(TMP, Isolate::marking_in_progress_offset()), Immediate(0));
+    j(EQUAL, &generational_barrier, Assembler::kNearJump);
+    testl(object, Immediate(kNewObjectAlignmentOffset));
+    j(NOT_ZERO, &done);
+    movq(TMP, FieldAddress(object, Object::tags_offset()));
+    testq(TMP, Immediate(1 << RawObject::kMarkBit));
+    j(NOT_ZERO, &update_store_buffer);
+    Bind(&generational_barrier);
+  }
   if (can_value_be_smi) {
     StoreIntoObjectFilter(object, value, &done);
   } else {
     StoreIntoObjectFilterNoSmi(object, value, &done);
   }
   // A store buffer update is required.
+  Bind(&update_store_buffer);
   if (value != RAX) pushq(RAX);
   if (object != RAX) {
     movq(RAX, object);
@@ -2914,6 +2930,56 @@ void Assembler::TryAllocate(const Class& cls,
 }
 
 
+void Assembler::TryAllocateOld(intptr_t instance_size,
+                               intptr_t cid,
+                               Label* failure,
+                               bool near_jump,
+                               Register instance_reg,
+                               Register temp_reg,
+                               Register pp) {
+  ASSERT(failure != NULL);
+  ASSERT(instance_size <= PageSpace::kMaxPretenureObjectSize);
+  ASSERT(instance_reg != temp_reg);
+  if (FLAG_inline_alloc) {
+    Heap* heap = Isolate::Current()->heap();
+    LoadImmediate(TMP, Immediate(heap->PretenureTopAddress()), pp);
+    movq(instance_reg, Address(TMP, 0));
+    // The remainder of the area must stay large enough to hold a free list
+    // element with an explicit size. An empty area (top == end == 0) always
+    // fails here.
+    leaq(temp_reg,
+         Address(instance_reg,
+                 instance_size + PageSpace::kPretenureAreaReserve));
+    LoadImmediate(TMP, Immediate(heap->PretenureEndAddress()), pp);
+    cmpq(temp_reg, Address(TMP, 0));
+    j(ABOVE, failure, near_jump);
+    movq(temp_reg, Address(TMP, 0));
+    // Successfully allocated the object, now update top to point to
+    // next object start.
+    AddImmediate(instance_reg, Immediate(instance_size), pp);
+    LoadImmediate(TMP, Immediate(heap->PretenureTopAddress()), pp);
+    movq(Address(TMP, 0), instance_reg);
+    // Keep the remainder of the area walkable: format it as a free list
+    // element with a size tag of 0, i.e. with its size in the third word.
+    subq(temp_reg, instance_reg);
+    movq(Address(instance_reg, 2 * kWordSize), temp_reg);
+    uword free_tags = 0;
+    free_tags = RawObject::ClassIdTag::update(kFreeListElement, free_tags);
+    LoadImmediate(Address(instance_reg, Object::tags_offset()),
+                  Immediate(free_tags), pp);
+    AddImmediate(instance_reg, Immediate(kHeapObjectTag - instance_size), pp);
+    uword tags = 0;
+    tags = RawObject::SizeTag::update(instance_size, tags);
+    ASSERT(cid != kIllegalCid);
+    tags = RawObject::ClassIdTag::update(cid, tags);
+    LoadImmediate(FieldAddress(instance_reg, Object::tags_offset()),
+                  Immediate(tags), pp);
+  } else {
+    jmp(failure);
+  }
+}
+
+
 void Assembler::Align(int alignment, intptr_t offset) {
   ASSERT(Utils::IsPowerOfTwo(alignment));
   intptr_t pos = offset + buffer_.GetPosition();
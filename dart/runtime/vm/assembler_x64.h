@@ -837,6 +837,19 @@ class Assembler : public ValueObject {
                    Register instance_reg,
                    Register pp);
 
+  // Allocates an object of 'instance_size' bytes and class 'cid' in the
+  // pretenuring area of old space (see PageSpace::RefillPretenureArea).
+  // Jump to 'failure' if the area is exhausted.
+  // Allocated instance is returned in 'instance_reg'; 'temp_reg' is clobbered.
+  // Only the tags field of the object is initialized.
+  void TryAllocateOld(intptr_t instance_size,
+                      intptr_t cid,
+                      Label* failure,
+                      bool near_jump,
+                      Register instance_reg,
+                      Register temp_reg,
+                      Register pp);
+
   // Debugging and bringup support.
   void Stop(const char* message);
   void Unimplemented(const char* message);
@@ -0,0 +1,169 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/background_compiler.h"
+
+#include "vm/compiler.h"
+#include "vm/debugger.h"
+#include "vm/isolate.h"
+#include "vm/json_stream.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, background_compilation, false,
+    "Optimize hot functions between messages instead of while handling the "
+    "message which made them hot.");
+DEFINE_FLAG(bool, trace_background_compilation, false,
+    "Trace queueing and compilation of functions by the background "
+    "compiler.");
+
+
+BackgroundCompiler::BackgroundCompiler(Isolate* isolate)
+    : isolate_(isolate),
+      queue_(NULL),
+      length_(0),
+      capacity_(0),
+      enqueued_count_(0),
+      compiled_count_(0),
+      skipped_count_(0),
+      failed_count_(0),
+      max_queue_length_(0),
+      total_latency_(0),
+      max_latency_(0),
+      total_compile_time_(0),
+      max_compile_time_(0) {
+}
+
+
+BackgroundCompiler::~BackgroundCompiler() {
+  free(queue_);
+}
+
+
+void BackgroundCompiler::Grow() {
+  intptr_t new_capacity = (capacity_ == 0) ? 16 : (2 * capacity_);
+  queue_ = reinterpret_cast<Entry*>(
+      realloc(queue_, new_capacity * sizeof(Entry)));  // NOLINT
+  capacity_ = new_capacity;
+}
+
+
+bool BackgroundCompiler::IsQueued(const Function& function) const {
+  // The queue only holds functions which became hot since the isolate was
+  // last idle, so it is short.
+  for (intptr_t i = 0; i < length_; i++) {
+    if (queue_[i].function == function.raw()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool BackgroundCompiler::Enqueue(const Function& function) {
+  if (IsQueued(function)) {
+    return false;
+  }
+  if (length_ == capacity_) {
+    Grow();
+  }
+  queue_[length_].function = function.raw();
+  queue_[length_].enqueue_time = OS::GetCurrentTimeMicros();
+  length_++;
+  enqueued_count_++;
+  if (length_ > max_queue_length_) {
+    max_queue_length_ = length_;
+  }
+  if (FLAG_trace_background_compilation) {
+    OS::Print("Queued for optimization (%" Pd " queued): %s\n",
+              length_, function.ToFullyQualifiedCString());
+  }
+  return true;
+}
+
+
+void BackgroundCompiler::CompileNext() {
+  ASSERT(isolate_ == Isolate::Current());
+  ASSERT(length_ > 0);
+  const Function& function = Function::Handle(queue_[0].function);
+  int64_t enqueue_time = queue_[0].enqueue_time;
+  length_--;
+  memmove(&queue_[0], &queue_[1], length_ * sizeof(Entry));
+
+  // The function may have been optimized synchronously since it was queued,
+  // or a breakpoint may have been set in it.
+  if (function.HasOptimizedCode() ||
+      !function.is_optimizable() ||
+      isolate_->debugger()->IsStepping() ||
+      isolate_->debugger()->HasBreakpoint(function)) {
+    skipped_count_++;
+    return;
+  }
+
+  int64_t start = OS::GetCurrentTimeMicros();
+  const Error& error =
+      Error::Handle(Compiler::CompileOptimizedFunction(function));
+  int64_t end = OS::GetCurrentTimeMicros();
+  if (!error.IsNull()) {
+    // The function keeps running unoptimized. Errors which matter are
+    // reported when the function is compiled for running it.
+    failed_count_++;
+    if (FLAG_trace_background_compilation) {
+      OS::Print("Optimizing %s failed: %s\n",
+                function.ToFullyQualifiedCString(),
+                error.ToErrorCString());
+    }
+    return;
+  }
+  // Reset usage counter for reoptimization.
+  function.set_usage_counter(0);
+  compiled_count_++;
+  int64_t compile_time = end - start;
+  int64_t latency = end - enqueue_time;
+  total_compile_time_ += compile_time;
+  total_latency_ += latency;
+  if (compile_time > max_compile_time_) {
+    max_compile_time_ = compile_time;
+  }
+  if (latency > max_latency_) {
+    max_latency_ = latency;
+  }
+  if (FLAG_trace_background_compilation) {
+    OS::Print("Optimized in %" Pd64 " us, %" Pd64 " us after queueing: %s\n",
+              compile_time, latency, function.ToFullyQualifiedCString());
+  }
+}
+
+
+void BackgroundCompiler::VisitObjectPointers(ObjectPointerVisitor* visitor) {
+  for (intptr_t i = 0; i < length_; i++) {
+    visitor->VisitPointer(reinterpret_cast<RawObject**>(&queue_[i].function));
+  }
+}
+
+
+void BackgroundCompiler::PrintToJSONStream(JSONStream* stream) {
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "BackgroundCompiler");
+  jsobj.AddProperty("enabled", FLAG_background_compilation);
+  jsobj.AddProperty("queueLength", length_);
+  jsobj.AddProperty("maxQueueLength", max_queue_length_);
+  jsobj.AddProperty("enqueued", enqueued_count_);
+  jsobj.AddProperty("compiled", compiled_count_);
+  jsobj.AddProperty("skipped", skipped_count_);
+  jsobj.AddProperty("failed", failed_count_);
+  intptr_t compiled = (compiled_count_ > 0) ? compiled_count_ : 1;
+  jsobj.AddProperty("averageCompileTimeMicros",
+                    static_cast<intptr_t>(total_compile_time_ / compiled));
+  jsobj.AddProperty("maxCompileTimeMicros",
+                    static_cast<intptr_t>(max_compile_time_));
+  jsobj.AddProperty("averageLatencyMicros",
+                    static_cast<intptr_t>(total_latency_ / compiled));
+  jsobj.AddProperty("maxLatencyMicros", static_cast<intptr_t>(max_latency_));
+}
+
+}  // namespace dart
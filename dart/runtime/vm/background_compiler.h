@@ -0,0 +1,82 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_BACKGROUND_COMPILER_H_
+#define VM_BACKGROUND_COMPILER_H_
+
+#include "platform/assert.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class Function;
+class Isolate;
+class JSONStream;
+class ObjectPointerVisitor;
+class RawFunction;
+
+DECLARE_FLAG(bool, background_compilation);
+
+// BackgroundCompiler moves optimizing compilation out of the message being
+// handled. When the usage counter of a function trips, the function is
+// queued and its unoptimized code keeps running. The isolate's message
+// handler compiles queued functions on its thread pool worker while no
+// messages are pending, where no Dart frames are active and the optimized
+// code can be installed safely.
+//
+// A function whose usage counter trips again while it is still queued is
+// compiled right away, so isolates that are never idle are not stuck with
+// unoptimized code.
+class BackgroundCompiler {
+ public:
+  explicit BackgroundCompiler(Isolate* isolate);
+  ~BackgroundCompiler();
+
+  // Queues the function for optimization. Returns false if it is already
+  // queued, in which case the caller should compile it itself.
+  bool Enqueue(const Function& function);
+
+  bool HasQueuedFunctions() const { return length_ > 0; }
+  intptr_t queue_length() const { return length_; }
+
+  // Compiles the oldest queued function. Must not be called while Dart
+  // code of the isolate is active.
+  void CompileNext();
+
+  void VisitObjectPointers(ObjectPointerVisitor* visitor);
+
+  void PrintToJSONStream(JSONStream* stream);
+
+ private:
+  struct Entry {
+    RawFunction* function;
+    int64_t enqueue_time;  // In microseconds.
+  };
+
+  bool IsQueued(const Function& function) const;
+  void Grow();
+
+  Isolate* isolate_;
+  Entry* queue_;
+  intptr_t length_;
+  intptr_t capacity_;
+
+  // Statistics over the lifetime of the isolate, times in microseconds.
+  intptr_t enqueued_count_;
+  intptr_t compiled_count_;
+  intptr_t skipped_count_;  // Optimized meanwhile or no longer optimizable.
+  intptr_t failed_count_;
+  intptr_t max_queue_length_;
+  int64_t total_latency_;  // From enqueueing until installing the code.
+  int64_t max_latency_;
+  int64_t total_compile_time_;
+  int64_t max_compile_time_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundCompiler);
+};
+
+}  // namespace dart
+
+#endif  // VM_BACKGROUND_COMPILER_H_
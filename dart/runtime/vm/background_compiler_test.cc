@@ -0,0 +1,90 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/background_compiler.h"
+#include "vm/dart_api_impl.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(int, optimization_counter_threshold);
+
+static const int kThreshold = 5;
+
+static const char* kScriptChars =
+    "int foo(int i) => i + 1;\n";
+
+
+// Calls foo the given number of times and returns the function.
+static RawFunction* CallFoo(Dart_Handle lib, intptr_t count) {
+  Dart_Handle args[1];
+  args[0] = Dart_NewInteger(41);
+  for (intptr_t i = 0; i < count; i++) {
+    Dart_Handle result = Dart_Invoke(lib, NewString("foo"), 1, args);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(42, value);
+  }
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  return library.LookupLocalFunction(
+      String::Handle(Symbols::New("foo")));
+}
+
+
+TEST_CASE(BackgroundCompiler_CompileWhenIdle) {
+  bool saved_background_compilation = FLAG_background_compilation;
+  int saved_threshold = FLAG_optimization_counter_threshold;
+  FLAG_background_compilation = true;
+  FLAG_optimization_counter_threshold = kThreshold;
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  BackgroundCompiler* compiler = Isolate::Current()->background_compiler();
+  EXPECT(!compiler->HasQueuedFunctions());
+
+  // The hot function is queued and keeps running unoptimized.
+  const Function& foo =
+      Function::Handle(CallFoo(lib, kThreshold + 3));
+  EXPECT(!foo.HasOptimizedCode());
+  EXPECT_EQ(1, compiler->queue_length());
+
+  // No Dart code is active here, like between messages.
+  compiler->CompileNext();
+  EXPECT(!compiler->HasQueuedFunctions());
+  EXPECT(foo.HasOptimizedCode());
+  CallFoo(lib, 1);
+
+  FLAG_background_compilation = saved_background_compilation;
+  FLAG_optimization_counter_threshold = saved_threshold;
+}
+
+
+TEST_CASE(BackgroundCompiler_CompileWhenStillHot) {
+  bool saved_background_compilation = FLAG_background_compilation;
+  int saved_threshold = FLAG_optimization_counter_threshold;
+  FLAG_background_compilation = true;
+  FLAG_optimization_counter_threshold = kThreshold;
+
+  // A queued function which stays hot is optimized right away.
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  const Function& foo =
+      Function::Handle(CallFoo(lib, 4 * kThreshold));
+  EXPECT(foo.HasOptimizedCode());
+
+  // The queued request is dropped.
+  BackgroundCompiler* compiler = Isolate::Current()->background_compiler();
+  EXPECT_EQ(1, compiler->queue_length());
+  compiler->CompileNext();
+  EXPECT(!compiler->HasQueuedFunctions());
+  EXPECT(foo.HasOptimizedCode());
+
+  FLAG_background_compilation = saved_background_compilation;
+  FLAG_optimization_counter_threshold = saved_threshold;
+}
+
+}  // namespace dart
@@ -4,19 +4,39 @@
 
 #include "vm/benchmark_test.h"
 
+#if defined(TARGET_OS_LINUX)
+#include <sys/socket.h>  // NOLINT
+#include <unistd.h>  // NOLINT
+#endif
+
 #include "bin/builtin.h"
+#include "bin/eventhandler.h"
 #include "bin/file.h"
+#include "bin/io_buffer.h"
+#include "bin/socket.h"
+
+#include "include/dart_native_api.h"
 
 #include "platform/assert.h"
 
 #include "vm/dart_api_impl.h"
+#include "vm/message_handler.h"
+#include "vm/port.h"
+#include "vm/regexp_compiler.h"
+#include "vm/snapshot.h"
 #include "vm/stack_frame.h"
+#include "vm/thread.h"
 #include "vm/unit_test.h"
 
 using dart::bin::File;
 
 namespace dart {
 
+DECLARE_FLAG(int, marker_tasks);
+DECLARE_FLAG(int, scavenger_tasks);
+DECLARE_FLAG(bool, flat_messages);
+DECLARE_FLAG(bool, snapshot_heap_image);
+
 Benchmark* Benchmark::first_ = NULL;
 Benchmark* Benchmark::tail_ = NULL;
 const char* Benchmark::executable_ = NULL;
@@ -55,7 +75,7 @@ BENCHMARK(CorelibCompileAll) {
 //
 // Measure creation of core isolate from a snapshot.
 //
-BENCHMARK(CorelibIsolateStartup) {
+static void RunCorelibIsolateStartup(Benchmark* benchmark, bool heap_image) {
   const int kNumIterations = 100;
   char* err = NULL;
   Dart_Isolate base_isolate = Dart_CurrentIsolate();
@@ -68,6 +88,21 @@ BENCHMARK(CorelibIsolateStartup) {
   intptr_t size = 0;
   Dart_Handle result = Dart_CreateSnapshot(&buffer, &size);
   EXPECT_VALID(result);
+  if (heap_image) {
+    // Heap images refer to the snapshot as long as the VM runs.
+    uint8_t* copy = reinterpret_cast<uint8_t*>(malloc(size));
+    memmove(copy, buffer, size);
+    buffer = copy;
+  }
+  bool saved_heap_image = FLAG_snapshot_heap_image;
+  FLAG_snapshot_heap_image = heap_image;
+  if (heap_image) {
+    // The first isolate captures the image, it is not measured.
+    Dart_Isolate new_isolate =
+        Dart_CreateIsolate(NULL, NULL, buffer, NULL, &err);
+    EXPECT(new_isolate != NULL);
+    Dart_ShutdownIsolate();
+  }
   Timer timer(true, "Core Isolate startup benchmark");
   timer.Start();
   for (int i = 0; i < kNumIterations; i++) {
@@ -77,6 +112,7 @@ BENCHMARK(CorelibIsolateStartup) {
     Dart_ShutdownIsolate();
   }
   timer.Stop();
+  FLAG_snapshot_heap_image = saved_heap_image;
   int64_t elapsed_time = timer.TotalElapsedTime();
   benchmark->set_score(elapsed_time / kNumIterations);
   Dart_EnterIsolate(test_isolate);
@@ -86,6 +122,16 @@ BENCHMARK(CorelibIsolateStartup) {
 }
 
 
+BENCHMARK(CorelibIsolateStartup) {
+  RunCorelibIsolateStartup(benchmark, false);
+}
+
+
+BENCHMARK(CorelibIsolateStartupFromHeapImage) {
+  RunCorelibIsolateStartup(benchmark, true);
+}
+
+
 //
 // Measure invocation of Dart API functions.
 //
@@ -399,6 +445,57 @@ static uint8_t* malloc_allocator(
 }
 
 
+//
+// Measure writing and reading a small message of numbers and strings, in the
+// flat or in the regular message format.
+//
+static void RunSmallMessage(Benchmark* benchmark, bool flat_messages) {
+  const int kNumIterations = 100000;
+  Isolate* isolate = benchmark->isolate();
+  StackZone zone(isolate);
+  HandleScope scope(isolate);
+  const Array& args = Array::Handle(Array::New(3));
+  for (intptr_t i = 0; i < args.Length(); i++) {
+    args.SetAt(i, Smi::Handle(Smi::New(i)));
+  }
+  const GrowableObjectArray& message =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  message.Add(Smi::Handle(Smi::New(17)));
+  message.Add(String::Handle(String::New("request")));
+  message.Add(Double::Handle(Double::New(0.5)));
+  message.Add(args);
+  bool saved_flat_messages = FLAG_flat_messages;
+  FLAG_flat_messages = flat_messages;
+  Timer timer(true, "Small message benchmark");
+  timer.Start();
+  for (int i = 0; i < kNumIterations; i++) {
+    StackZone iteration_zone(isolate);
+    HandleScope iteration_scope(isolate);
+    uint8_t* buffer = NULL;
+    MessageWriter writer(&buffer, &malloc_allocator);
+    writer.WriteMessage(message);
+    SnapshotReader reader(buffer, writer.BytesWritten(),
+                          Snapshot::kMessage, isolate);
+    const Object& result = Object::Handle(reader.ReadObject());
+    EXPECT(result.IsGrowableObjectArray());
+    free(buffer);
+  }
+  timer.Stop();
+  FLAG_flat_messages = saved_flat_messages;
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+BENCHMARK(SmallMessageRegular) {
+  RunSmallMessage(benchmark, false);
+}
+
+
+BENCHMARK(SmallMessageFlat) {
+  RunSmallMessage(benchmark, true);
+}
+
+
 BENCHMARK(CoreSnapshotSize) {
   const char* kScriptChars =
       "import 'dart:async';\n"
@@ -472,4 +569,695 @@ BENCHMARK(CreateMirrorSystem) {
   benchmark->set_score(elapsed_time);
 }
 
+
+//
+// Measure the old generation marking pause with a varying number of
+// parallel marker tasks.
+//
+static void MarkOldGeneration(Benchmark* benchmark, intptr_t marker_tasks) {
+  const char* kScriptChars =
+      "class Node {\n"
+      "  Node(this.next, this.value);\n"
+      "  var next;\n"
+      "  var value;\n"
+      "}\n"
+      "var lists;\n"
+      "void build() {\n"
+      "  lists = new List(2000);\n"
+      "  for (int i = 0; i < lists.length; i++) {\n"
+      "    var node = null;\n"
+      "    for (int j = 0; j < 500; j++) {\n"
+      "      node = new Node(node, j);\n"
+      "    }\n"
+      "    lists[i] = node;\n"
+      "  }\n"
+      "}\n";
+  const int kNumIterations = 10;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+  EXPECT_VALID(result);
+  Heap* heap = benchmark->isolate()->heap();
+  // Promote the object graph.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  const intptr_t saved_marker_tasks = FLAG_marker_tasks;
+  FLAG_marker_tasks = marker_tasks;
+  Timer timer(true, "Old generation marking benchmark");
+  timer.Start();
+  for (int i = 0; i < kNumIterations; i++) {
+    heap->CollectGarbage(Heap::kOld);
+  }
+  timer.Stop();
+  FLAG_marker_tasks = saved_marker_tasks;
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time / kNumIterations);
+}
+
+
+BENCHMARK(OldGenMarkSerial) {
+  MarkOldGeneration(benchmark, 0);
+}
+
+
+BENCHMARK(OldGenMarkParallel1) {
+  MarkOldGeneration(benchmark, 1);
+}
+
+
+BENCHMARK(OldGenMarkParallel3) {
+  MarkOldGeneration(benchmark, 3);
+}
+
+
+BENCHMARK(OldGenMarkParallel7) {
+  MarkOldGeneration(benchmark, 7);
+}
+
+
+//
+// Measure the scavenge pause with a varying number of parallel scavenger
+// tasks.
+//
+static void ScavengeNewGeneration(Benchmark* benchmark,
+                                  intptr_t scavenger_tasks) {
+  const char* kScriptChars =
+      "class Node {\n"
+      "  Node(this.next, this.value);\n"
+      "  var next;\n"
+      "  var value;\n"
+      "}\n"
+      "var lists;\n"
+      "void build() {\n"
+      "  lists = new List(200);\n"
+      "  for (int i = 0; i < lists.length; i++) {\n"
+      "    var node = null;\n"
+      "    for (int j = 0; j < 500; j++) {\n"
+      "      node = new Node(node, j);\n"
+      "    }\n"
+      "    lists[i] = node;\n"
+      "  }\n"
+      "}\n";
+  const int kNumIterations = 10;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  const intptr_t saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = scavenger_tasks;
+  Heap* heap = benchmark->isolate()->heap();
+  int64_t elapsed_time = 0;
+  for (int i = 0; i < kNumIterations; i++) {
+    // Rebuild the graph so that each scavenge copies it within new space
+    // instead of promoting it.
+    Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+    EXPECT_VALID(result);
+    Timer timer(true, "Scavenge benchmark");
+    timer.Start();
+    heap->CollectGarbage(Heap::kNew);
+    timer.Stop();
+    elapsed_time += timer.TotalElapsedTime();
+  }
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  benchmark->set_score(elapsed_time / kNumIterations);
+}
+
+
+BENCHMARK(ScavengeSerial) {
+  ScavengeNewGeneration(benchmark, 0);
+}
+
+
+BENCHMARK(ScavengeParallel1) {
+  ScavengeNewGeneration(benchmark, 1);
+}
+
+
+BENCHMARK(ScavengeParallel3) {
+  ScavengeNewGeneration(benchmark, 3);
+}
+
+
+BENCHMARK(ScavengeParallel7) {
+  ScavengeNewGeneration(benchmark, 7);
+}
+
+
+//
+// Measure adding, rescheduling and expiring 100k timeouts in the event
+// handler's timeout queue.
+//
+BENCHMARK(TimeoutQueue) {
+  const intptr_t kNumTimeouts = 100000;
+  bin::TimeoutQueue queue;
+  Timer timer(true, "Timeout queue benchmark");
+  timer.Start();
+  for (intptr_t i = 0; i < kNumTimeouts; i++) {
+    queue.UpdateTimeout(i + 1, (i * 7919) % kNumTimeouts);
+  }
+  // Push back every other timeout, as done when a timer is rescheduled.
+  for (intptr_t i = 0; i < kNumTimeouts; i += 2) {
+    queue.UpdateTimeout(i + 1, kNumTimeouts + ((i * 104729) % kNumTimeouts));
+  }
+  int64_t last = 0;
+  while (queue.HasTimeout()) {
+    EXPECT(queue.CurrentTimeout() >= last);
+    last = queue.CurrentTimeout();
+    queue.RemoveCurrent();
+  }
+  timer.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+#if defined(TARGET_OS_LINUX)
+//
+// Measure the event handler throughput for a set of busy sockets, each
+// notified, drained and rearmed once per round.
+//
+static const intptr_t kEventSockets = 64;
+static const intptr_t kEventRounds = 2000;
+static int event_fds[kEventSockets][2];
+static Dart_Port event_ports[kEventSockets];
+static Monitor* event_monitor = NULL;
+static intptr_t events_handled = 0;
+
+
+static void HandleSocketEvent(Dart_Port dest_port_id, Dart_CObject* message) {
+  for (intptr_t i = 0; i < kEventSockets; i++) {
+    if (event_ports[i] == dest_port_id) {
+      char byte;
+      EXPECT_EQ(1, read(event_fds[i][0], &byte, 1));
+      // Rearm before reporting, so the socket is not closed under us.
+      bin::EventHandler::delegate()->SendData(
+          event_fds[i][0], dest_port_id, 1 << bin::kInEvent);
+      MonitorLocker ml(event_monitor);
+      events_handled++;
+      ml.Notify();
+      return;
+    }
+  }
+  UNREACHABLE();
+}
+
+
+static void EventHandlerThroughput(Benchmark* benchmark,
+                                   bool oneshot,
+                                   intptr_t pollers) {
+  bin::EventHandler::set_use_oneshot(oneshot);
+  bin::EventHandler::set_poller_count(pollers);
+  bin::EventHandler::Start();
+  event_monitor = new Monitor();
+  events_handled = 0;
+  for (intptr_t i = 0; i < kEventSockets; i++) {
+    EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, event_fds[i]));
+    event_ports[i] = Dart_NewNativePort("EventHandlerBenchmark",
+                                        HandleSocketEvent,
+                                        false);
+    bin::EventHandler::delegate()->SendData(
+        event_fds[i][0], event_ports[i], 1 << bin::kInEvent);
+  }
+  Timer timer(true, "Event handler benchmark");
+  timer.Start();
+  const char byte = 0;
+  for (intptr_t round = 1; round <= kEventRounds; round++) {
+    for (intptr_t i = 0; i < kEventSockets; i++) {
+      EXPECT_EQ(1, write(event_fds[i][1], &byte, 1));
+    }
+    MonitorLocker ml(event_monitor);
+    while (events_handled < round * kEventSockets) {
+      ml.Wait();
+    }
+  }
+  timer.Stop();
+  for (intptr_t i = 0; i < kEventSockets; i++) {
+    Dart_CloseNativePort(event_ports[i]);
+    bin::EventHandler::delegate()->SendData(
+        event_fds[i][0], event_ports[i], 1 << bin::kCloseCommand);
+    close(event_fds[i][1]);
+  }
+  bin::EventHandler::Stop();
+  // The pollers read the settings until they exit.
+  bin::EventHandler::WaitForShutdown();
+  bin::EventHandler::set_use_oneshot(false);
+  bin::EventHandler::set_poller_count(1);
+  delete event_monitor;
+  event_monitor = NULL;
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+BENCHMARK(EventHandlerLevelTriggered) {
+  EventHandlerThroughput(benchmark, false, 1);
+}
+
+
+BENCHMARK(EventHandlerOneShot) {
+  EventHandlerThroughput(benchmark, true, 1);
+}
+
+
+BENCHMARK(EventHandlerOneShotPollers4) {
+  EventHandlerThroughput(benchmark, true, 4);
+}
+
+
+//
+// Measure reading a local stream the way Socket_Read does, asking for the
+// available bytes and allocating an IO buffer of that size per read, against
+// reading into a reused Uint8List with a single read as Socket_ReadInto does.
+//
+static void RunSocketRead(Benchmark* benchmark, bool read_into) {
+  const intptr_t kChunkSize = 16 * KB;
+  const intptr_t kTotalSize = 256 * MB;
+  int fds[2];
+  EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  uint8_t* chunk = new uint8_t[kChunkSize];
+  memset(chunk, 0x5a, kChunkSize);
+  Dart_EnterScope();
+  Dart_Handle reused = Dart_NewTypedData(Dart_TypedData_kUint8, kChunkSize);
+  EXPECT_VALID(reused);
+  Timer timer(true, "Socket read benchmark");
+  timer.Start();
+  intptr_t total_read = 0;
+  while (total_read < kTotalSize) {
+    intptr_t pending = bin::Socket::Write(fds[1], chunk, kChunkSize);
+    EXPECT(pending > 0);
+    Dart_EnterScope();
+    while (pending > 0) {
+      intptr_t bytes_read = 0;
+      if (read_into) {
+        Dart_TypedData_Type type;
+        void* data = NULL;
+        intptr_t len = 0;
+        EXPECT_VALID(Dart_TypedDataAcquireData(reused, &type, &data, &len));
+        bytes_read = bin::Socket::Read(fds[0], data, len);
+        EXPECT_VALID(Dart_TypedDataReleaseData(reused));
+      } else {
+        intptr_t available = bin::Socket::Available(fds[0]);
+        uint8_t* data = NULL;
+        EXPECT_VALID(bin::IOBuffer::Allocate(available, &data));
+        bytes_read = bin::Socket::Read(fds[0], data, available);
+      }
+      EXPECT(bytes_read > 0);
+      pending -= bytes_read;
+      total_read += bytes_read;
+    }
+    Dart_ExitScope();
+  }
+  timer.Stop();
+  Dart_ExitScope();
+  close(fds[0]);
+  close(fds[1]);
+  delete[] chunk;
+  // Megabytes per second.
+  benchmark->set_score((total_read / MB) * kMicrosecondsPerSecond /
+                       timer.TotalElapsedTime());
+}
+
+
+BENCHMARK(SocketReadAvailable) {
+  RunSocketRead(benchmark, false);
+}
+
+
+BENCHMARK(SocketReadInto) {
+  RunSocketRead(benchmark, true);
+}
+
+
+//
+// Measure writing a response made of a small header and a few body chunks to
+// a local stream with one write per buffer against a single vectored write.
+//
+static void RunSocketWrite(Benchmark* benchmark, bool write_vector) {
+  const intptr_t kHeaderSize = 256;
+  const intptr_t kChunkSize = 4 * KB;
+  const intptr_t kNumBuffers = 5;
+  const intptr_t kResponseSize = kHeaderSize + (kNumBuffers - 1) * kChunkSize;
+  const intptr_t kTotalSize = 256 * MB;
+  int fds[2];
+  EXPECT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+  uint8_t* data = new uint8_t[kResponseSize];
+  memset(data, 0x5a, kResponseSize);
+  const void* buffers[kNumBuffers];
+  intptr_t lengths[kNumBuffers];
+  buffers[0] = data;
+  lengths[0] = kHeaderSize;
+  for (intptr_t i = 1; i < kNumBuffers; i++) {
+    buffers[i] = data + kHeaderSize + (i - 1) * kChunkSize;
+    lengths[i] = kChunkSize;
+  }
+  uint8_t* read_buffer = new uint8_t[kResponseSize];
+  Timer timer(true, "Socket write benchmark");
+  timer.Start();
+  intptr_t total_written = 0;
+  while (total_written < kTotalSize) {
+    intptr_t written = 0;
+    if (write_vector) {
+      written = bin::Socket::WriteVector(fds[1], buffers, lengths, kNumBuffers);
+    } else {
+      for (intptr_t i = 0; i < kNumBuffers; i++) {
+        written += bin::Socket::Write(fds[1], buffers[i], lengths[i]);
+      }
+    }
+    EXPECT_EQ(kResponseSize, written);
+    intptr_t pending = written;
+    while (pending > 0) {
+      intptr_t bytes_read = bin::Socket::Read(fds[0], read_buffer, pending);
+      EXPECT(bytes_read > 0);
+      pending -= bytes_read;
+    }
+    total_written += written;
+  }
+  timer.Stop();
+  close(fds[0]);
+  close(fds[1]);
+  delete[] data;
+  delete[] read_buffer;
+  // Megabytes per second.
+  benchmark->set_score((total_written / MB) * kMicrosecondsPerSecond /
+                       timer.TotalElapsedTime());
+}
+
+
+BENCHMARK(SocketWriteSeparate) {
+  RunSocketWrite(benchmark, false);
+}
+
+
+BENCHMARK(SocketWriteVector) {
+  RunSocketWrite(benchmark, true);
+}
+#endif  // defined(TARGET_OS_LINUX)
+
+
+
+//
+// Measure regular expression matching. The script defines a function
+// 'benchmark' which is run once to warm up and once timed, either with the
+// jscre interpreter or with the regular expressions compiled to native code.
+//
+static void RunRegExpBenchmark(Benchmark* benchmark,
+                               const char* name,
+                               const char* script,
+                               bool native_code) {
+  bool saved_native_code = FLAG_regexp_native_code;
+  FLAG_regexp_native_code = native_code;
+  Dart_Handle lib = TestCase::LoadTestScript(script, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle result = Dart_Invoke(lib, NewString("benchmark"), 0, NULL);
+  EXPECT_VALID(result);
+  Timer timer(true, name);
+  timer.Start();
+  result = Dart_Invoke(lib, NewString("benchmark"), 0, NULL);
+  timer.Stop();
+  EXPECT_VALID(result);
+  benchmark->set_score(timer.TotalElapsedTime());
+  FLAG_regexp_native_code = saved_native_code;
+}
+
+
+// Iterates allMatches over a single 1 MB line.
+static const char* kRegExpLogParsingScript =
+    "int benchmark() {\n"
+    "  var entry = '127.0.0.1 - - [10/Oct/2013:13:55:36] '\n"
+    "      '\"GET /index.html HTTP/1.0\" 200 2326 ';\n"
+    "  var buffer = new StringBuffer();\n"
+    "  while (buffer.length < 1024 * 1024) buffer.write(entry);\n"
+    "  var line = buffer.toString();\n"
+    "  var re = new RegExp(r'\"(GET|POST) ([^ ]*) HTTP/1\\.[01]\" (\\d+)');\n"
+    "  int count = 0;\n"
+    "  for (var match in re.allMatches(line)) {\n"
+    "    if (match.group(3) == '200') count++;\n"
+    "  }\n"
+    "  return count;\n"
+    "}\n";
+
+
+BENCHMARK(RegExpLogParsing) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpLogParsing benchmark",
+                     kRegExpLogParsingScript,
+                     false);
+}
+
+
+BENCHMARK(RegExpLogParsingNativeCode) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpLogParsingNativeCode benchmark",
+                     kRegExpLogParsingScript,
+                     true);
+}
+
+
+static const char* kRegExpTokenizingScript =
+    "int benchmark() {\n"
+    "  var source = 'var x = foo(a, 42) + bar[\"key\"] * 3.14; // done\\n';\n"
+    "  var buffer = new StringBuffer();\n"
+    "  for (int i = 0; i < 5000; i++) buffer.write(source);\n"
+    "  var text = buffer.toString();\n"
+    "  var re = new RegExp(\n"
+    "      r'([A-Za-z_]\\w*)|(\\d+(?:\\.\\d+)?)|(\"[^\"]*\")|(//[^\\n]*)|'\n"
+    "      r'([-+*/=;,()\\[\\]])');\n"
+    "  int count = 0;\n"
+    "  for (var match in re.allMatches(text)) count++;\n"
+    "  return count;\n"
+    "}\n";
+
+
+BENCHMARK(RegExpTokenizing) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpTokenizing benchmark",
+                     kRegExpTokenizingScript,
+                     false);
+}
+
+
+BENCHMARK(RegExpTokenizingNativeCode) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpTokenizingNativeCode benchmark",
+                     kRegExpTokenizingScript,
+                     true);
+}
+
+
+static const char* kRegExpEmailValidationScript =
+    "int benchmark() {\n"
+    "  var addresses = ['john.doe@example.com', 'invalid@', 'a@b.co',\n"
+    "                   'first.last+tag@sub.domain.org', 'no-at-sign.com',\n"
+    "                   'x@y', 'J\\u00f6rg@example.de'];\n"
+    "  var re = new RegExp(\n"
+    "      r'^[A-Za-z0-9._%+-]+@[A-Za-z0-9.-]+\\.[A-Za-z]{2,}$');\n"
+    "  int count = 0;\n"
+    "  for (int i = 0; i < 100000; i++) {\n"
+    "    if (re.hasMatch(addresses[i % addresses.length])) count++;\n"
+    "  }\n"
+    "  return count;\n"
+    "}\n";
+
+
+BENCHMARK(RegExpEmailValidation) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpEmailValidation benchmark",
+                     kRegExpEmailValidationScript,
+                     false);
+}
+
+
+BENCHMARK(RegExpEmailValidationNativeCode) {
+  RunRegExpBenchmark(benchmark,
+                     "RegExpEmailValidationNativeCode benchmark",
+                     kRegExpEmailValidationScript,
+                     true);
+}
+
+
+//
+// Measure sending typed data to a port of the same isolate, either copied
+// into each message or moved as TransferableTypedData. The transferables are
+// created before the timer is started, the score is the time per message.
+//
+static const intptr_t kNumMessages = 64;
+
+static const char* kMessagePassingScript =
+    "import 'dart:isolate';\n"
+    "import 'dart:typed_data';\n"
+    "var port;\n"
+    "var payloads;\n"
+    "var received = 0;\n"
+    "prepare(int size, int count, bool transfer) {\n"
+    "  port = new RawReceivePort((message) {\n"
+    "    if (message is TransferableTypedData) message.materialize();\n"
+    "    if (++received == payloads.length) port.close();\n"
+    "  });\n"
+    "  var data = new Uint8List(size);\n"
+    "  payloads = new List.generate(count, (_) =>\n"
+    "      transfer ? new TransferableTypedData.fromList([data]) : data);\n"
+    "}\n"
+    "send() {\n"
+    "  var sendPort = port.sendPort;\n"
+    "  for (var payload in payloads) sendPort.send(payload);\n"
+    "}\n"
+    "receivedCount() => received;\n";
+
+
+static void RunMessagePassing(Benchmark* benchmark,
+                              const char* name,
+                              intptr_t size,
+                              bool transfer) {
+  Dart_Handle lib = TestCase::LoadTestScript(kMessagePassingScript, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle args[3];
+  args[0] = Dart_NewInteger(size);
+  args[1] = Dart_NewInteger(kNumMessages);
+  args[2] = Dart_NewBoolean(transfer);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("prepare"), 3, args));
+  Timer timer(true, name);
+  timer.Start();
+  EXPECT_VALID(Dart_Invoke(lib, NewString("send"), 0, NULL));
+  EXPECT_VALID(Dart_RunLoop());
+  timer.Stop();
+  Dart_Handle result = Dart_Invoke(lib, NewString("receivedCount"), 0, NULL);
+  EXPECT_VALID(result);
+  int64_t received = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &received));
+  EXPECT_EQ(kNumMessages, received);
+  benchmark->set_score(timer.TotalElapsedTime() / kNumMessages);
+}
+
+
+BENCHMARK(MessageTypedData1KB) {
+  RunMessagePassing(benchmark, "MessageTypedData1KB benchmark", KB, false);
+}
+
+
+BENCHMARK(MessageTransferableTypedData1KB) {
+  RunMessagePassing(benchmark,
+                    "MessageTransferableTypedData1KB benchmark",
+                    KB,
+                    true);
+}
+
+
+BENCHMARK(MessageTypedData64KB) {
+  RunMessagePassing(benchmark,
+                    "MessageTypedData64KB benchmark",
+                    64 * KB,
+                    false);
+}
+
+
+BENCHMARK(MessageTransferableTypedData64KB) {
+  RunMessagePassing(benchmark,
+                    "MessageTransferableTypedData64KB benchmark",
+                    64 * KB,
+                    true);
+}
+
+
+BENCHMARK(MessageTypedData4MB) {
+  RunMessagePassing(benchmark, "MessageTypedData4MB benchmark", 4 * MB, false);
+}
+
+
+BENCHMARK(MessageTransferableTypedData4MB) {
+  RunMessagePassing(benchmark,
+                    "MessageTransferableTypedData4MB benchmark",
+                    4 * MB,
+                    true);
+}
+
+
+//
+// Measure posting messages through the port map from several threads at once.
+//
+class BenchmarkMessageHandler : public MessageHandler {
+ public:
+  BenchmarkMessageHandler() { }
+
+  bool HandleMessage(Message* message) {
+    delete message;
+    return true;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(BenchmarkMessageHandler);
+};
+
+
+struct PostMessagesInfo {
+  Dart_Port* ports;
+  intptr_t num_ports;
+  intptr_t first_port;
+  intptr_t num_messages;
+  Monitor* monitor;
+  intptr_t* running;
+};
+
+
+static void PostMessages(uword param) {
+  PostMessagesInfo* info = reinterpret_cast<PostMessagesInfo*>(param);
+  for (intptr_t i = 0; i < info->num_messages; i++) {
+    Dart_Port port = info->ports[(info->first_port + i) % info->num_ports];
+    PortMap::PostMessage(new Message(port, 0, NULL, 0,
+                                     Message::kNormalPriority));
+  }
+  MonitorLocker ml(info->monitor);
+  (*info->running)--;
+  ml.Notify();
+}
+
+
+static void RunPortMapContention(Benchmark* benchmark,
+                                 const char* name,
+                                 intptr_t num_threads) {
+  const intptr_t kNumMessages = 100000;
+  BenchmarkMessageHandler* handlers = new BenchmarkMessageHandler[num_threads];
+  Dart_Port* ports = new Dart_Port[num_threads];
+  for (intptr_t i = 0; i < num_threads; i++) {
+    ports[i] = PortMap::CreatePort(&handlers[i]);
+  }
+  PostMessagesInfo* infos = new PostMessagesInfo[num_threads];
+  Monitor monitor;
+  intptr_t running = num_threads;
+  Timer timer(true, name);
+  timer.Start();
+  for (intptr_t i = 0; i < num_threads; i++) {
+    // Each thread posts to all ports, starting at a different one.
+    infos[i].ports = ports;
+    infos[i].num_ports = num_threads;
+    infos[i].first_port = i;
+    infos[i].num_messages = kNumMessages / num_threads;
+    infos[i].monitor = &monitor;
+    infos[i].running = &running;
+    Thread::Start(PostMessages, reinterpret_cast<uword>(&infos[i]));
+  }
+  {
+    MonitorLocker ml(&monitor);
+    while (running > 0) {
+      ml.Wait();
+    }
+  }
+  timer.Stop();
+  for (intptr_t i = 0; i < num_threads; i++) {
+    PortMap::ClosePorts(&handlers[i]);
+  }
+  delete[] infos;
+  delete[] ports;
+  delete[] handlers;
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+
+BENCHMARK(PortMapContention1Thread) {
+  RunPortMapContention(benchmark, "PortMapContention1Thread benchmark", 1);
+}
+
+
+BENCHMARK(PortMapContention4Threads) {
+  RunPortMapContention(benchmark, "PortMapContention4Threads benchmark", 4);
+}
+
+
+BENCHMARK(PortMapContention16Threads) {
+  RunPortMapContention(benchmark, "PortMapContention16Threads benchmark", 16);
+}
+
 }  // namespace dart
@@ -76,6 +76,28 @@ void ClassTable::Register(const Class& cls) {
 }
 
 
+void ClassTable::SetAt(intptr_t index, RawClass* raw_cls) {
+  ASSERT(index > 0);
+  if (index >= capacity_) {
+    intptr_t new_capacity = capacity_;
+    while (index >= new_capacity) {
+      new_capacity += capacity_increment_;
+    }
+    RawClass** new_table = reinterpret_cast<RawClass**>(
+        realloc(table_, new_capacity * sizeof(RawClass*)));  // NOLINT
+    for (intptr_t i = capacity_; i < new_capacity; i++) {
+      new_table[i] = NULL;
+    }
+    capacity_ = new_capacity;
+    table_ = new_table;
+  }
+  table_[index] = raw_cls;
+  if (index >= top_) {
+    top_ = index + 1;
+  }
+}
+
+
 void ClassTable::VisitObjectPointers(ObjectPointerVisitor* visitor) {
   ASSERT(visitor != NULL);
   visitor->VisitPointers(reinterpret_cast<RawObject**>(&table_[0]), top_);
@@ -38,6 +38,10 @@ class ClassTable {
 
   void Register(const Class& cls);
 
+  // Sets the class at the index, growing the table as needed. Used when the
+  // table of an isolate is restored from a heap image.
+  void SetAt(intptr_t index, RawClass* raw_cls);
+
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
   void Print();
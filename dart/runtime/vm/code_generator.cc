@@ -6,6 +6,7 @@
 
 #include "vm/assembler.h"
 #include "vm/ast.h"
+#include "vm/background_compiler.h"
 #include "vm/bigint_operations.h"
 #include "vm/code_patcher.h"
 #include "vm/compiler.h"
@@ -87,9 +88,10 @@ DEFINE_RUNTIME_ENTRY(TraceFunctionExit, 1) {
 // Arg0: array length.
 // Arg1: array type arguments, i.e. vector of 1 type, the element type.
 // Return value: newly allocated array of length arg0.
-DEFINE_RUNTIME_ENTRY(AllocateArray, 2) {
+static void AllocateArrayInSpace(NativeArguments arguments,
+                                 Heap::Space space) {
   const Smi& length = Smi::CheckedHandle(arguments.ArgAt(0));
-  const Array& array = Array::Handle(Array::New(length.Value()));
+  const Array& array = Array::Handle(Array::New(length.Value(), space));
   arguments.SetReturn(array);
   AbstractTypeArguments& element_type =
       AbstractTypeArguments::CheckedHandle(arguments.ArgAt(1));
@@ -102,14 +104,33 @@ DEFINE_RUNTIME_ENTRY(AllocateArray, 2) {
 }
 
 
+DEFINE_RUNTIME_ENTRY(AllocateArray, 2) {
+  AllocateArrayInSpace(arguments, Heap::kNew);
+}
+
+
+// Same as AllocateArray, but allocates the array in old space. Called from
+// optimized code for pretenured allocation sites, which allocate small
+// arrays inline until the pretenuring area is exhausted.
+DEFINE_RUNTIME_ENTRY(AllocatePretenuredArray, 2) {
+  AllocateArrayInSpace(arguments, Heap::kOld);
+  const Smi& length = Smi::CheckedHandle(arguments.ArgAt(0));
+  if (Array::InstanceSize(length.Value()) <=
+      PageSpace::kMaxPretenureObjectSize) {
+    isolate->heap()->old_space()->RefillPretenureArea();
+  }
+}
+
+
 // Allocate a new object.
 // Arg0: class of the object that needs to be allocated.
 // Arg1: type arguments of the object that needs to be allocated.
 // Arg2: type arguments of the instantiator or kNoInstantiator.
 // Return value: newly allocated object.
-DEFINE_RUNTIME_ENTRY(AllocateObject, 3) {
+static void AllocateObjectInSpace(NativeArguments arguments,
+                                  Heap::Space space) {
   const Class& cls = Class::CheckedHandle(arguments.ArgAt(0));
-  const Instance& instance = Instance::Handle(Instance::New(cls));
+  const Instance& instance = Instance::Handle(Instance::New(cls, space));
   arguments.SetReturn(instance);
   if (cls.NumTypeArguments() == 0) {
     // No type arguments required for a non-parameterized type.
@@ -145,6 +166,25 @@ DEFINE_RUNTIME_ENTRY(AllocateObject, 3) {
 }
 
 
+DEFINE_RUNTIME_ENTRY(AllocateObject, 3) {
+  AllocateObjectInSpace(arguments, Heap::kNew);
+}
+
+
+// Same as AllocateObject, but allocates the object in old space. Called from
+// optimized code for pretenured allocation sites, which allocate small
+// objects of non-parameterized classes inline until the pretenuring area is
+// exhausted.
+DEFINE_RUNTIME_ENTRY(AllocatePretenuredObject, 3) {
+  AllocateObjectInSpace(arguments, Heap::kOld);
+  const Class& cls = Class::CheckedHandle(arguments.ArgAt(0));
+  if ((cls.NumTypeArguments() == 0) &&
+      (cls.instance_size() <= PageSpace::kMaxPretenureObjectSize)) {
+    isolate->heap()->old_space()->RefillPretenureArea();
+  }
+}
+
+
 // Helper returning the token position of the Dart caller.
 static intptr_t GetCallerLocation() {
   DartFrameIterator iterator;
@@ -1336,6 +1376,9 @@ DEFINE_RUNTIME_ENTRY(StackOverflow, 0) {
       (*callback)();
     }
   }
+  if (interrupt_bits & Isolate::kPretenuringInterrupt) {
+    isolate->heap()->pretenuring_policy()->DeoptimizeChangedCode();
+  }
 
   if (FLAG_use_osr && (interrupt_bits == 0)) {
     DartFrameIterator iterator;
@@ -1399,15 +1442,21 @@ DEFINE_RUNTIME_ENTRY(OptimizeInvokedFunction, 1) {
   ASSERT(function.HasCode());
 
   if (CanOptimizeFunction(function, isolate)) {
-    const Error& error =
-        Error::Handle(Compiler::CompileOptimizedFunction(function));
-    if (!error.IsNull()) {
-      Exceptions::PropagateError(error);
+    if (FLAG_background_compilation &&
+        isolate->background_compiler()->Enqueue(function)) {
+      // Keep running the unoptimized code until the isolate is idle.
+      function.set_usage_counter(0);
+    } else {
+      const Error& error =
+          Error::Handle(Compiler::CompileOptimizedFunction(function));
+      if (!error.IsNull()) {
+        Exceptions::PropagateError(error);
+      }
+      const Code& optimized_code = Code::Handle(function.CurrentCode());
+      ASSERT(!optimized_code.IsNull());
+      // Reset usage counter for reoptimization.
+      function.set_usage_counter(0);
     }
-    const Code& optimized_code = Code::Handle(function.CurrentCode());
-    ASSERT(!optimized_code.IsNull());
-    // Reset usage counter for reoptimization.
-    function.set_usage_counter(0);
   }
   arguments.SetReturn(Code::Handle(function.CurrentCode()));
 }
@@ -28,6 +28,7 @@
 #include "vm/object_store.h"
 #include "vm/os.h"
 #include "vm/parser.h"
+#include "vm/pretenuring.h"
 #include "vm/scanner.h"
 #include "vm/symbols.h"
 #include "vm/timer.h"
@@ -541,6 +542,13 @@ static bool CompileParsedFunctionHelper(ParsedFunction* parsed_function,
             const Field* field = (*flow_graph->guarded_fields())[i];
             field->RegisterDependentCode(code);
           }
+
+          for (intptr_t i = 0;
+               i < graph_compiler.pretenuring_class_ids().length();
+               i++) {
+            PretenuringPolicy::RegisterDependentCode(
+                code, graph_compiler.pretenuring_class_ids()[i]);
+          }
         } else {
           function.set_unoptimized_code(code);
           function.SetCode(code);
@@ -11,6 +11,7 @@
 #include "vm/freelist.h"
 #include "vm/handles.h"
 #include "vm/heap.h"
+#include "vm/heap_image.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -95,6 +96,8 @@ const char* Dart::InitOnce(Dart_IsolateCreateCallback create,
   VirtualMemory::InitOnce();
   Isolate::InitOnce();
   PortMap::InitOnce();
+  ThreadPool::InitOnce();
+  HeapImage::InitOnce();
   FreeListElement::InitOnce();
   Api::InitOnce();
   CodeObservers::InitOnce();
@@ -206,19 +209,24 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer, void* data) {
       return error.raw();
     }
   } else {
-    // Initialize from snapshot (this should replicate the functionality
-    // of Object::Init(..) in a regular isolate creation path.
-    Object::InitFromSnapshot(isolate);
-
     // TODO(turnidge): Remove once length is not part of the snapshot.
     const Snapshot* snapshot = Snapshot::SetupFromBuffer(snapshot_buffer);
     ASSERT(snapshot->kind() == Snapshot::kFull);
     if (FLAG_trace_isolates) {
       OS::Print("Size of isolate snapshot = %d\n", snapshot->length());
     }
-    SnapshotReader reader(snapshot->content(), snapshot->length(),
-                          Snapshot::kFull, isolate);
-    reader.ReadFullSnapshot();
+    if (!FLAG_snapshot_heap_image ||
+        !HeapImage::Instantiate(snapshot_buffer, isolate)) {
+      // Initialize from snapshot (this should replicate the functionality
+      // of Object::Init(..) in a regular isolate creation path.
+      Object::InitFromSnapshot(isolate);
+      SnapshotReader reader(snapshot->content(), snapshot->length(),
+                            Snapshot::kFull, isolate);
+      reader.ReadFullSnapshot();
+      if (FLAG_snapshot_heap_image) {
+        HeapImage::Capture(snapshot_buffer, isolate);
+      }
+    }
     if (FLAG_trace_isolates) {
       isolate->heap()->PrintSizes();
       isolate->megamorphic_cache_table()->PrintSizes();
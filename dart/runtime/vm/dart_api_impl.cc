@@ -30,6 +30,7 @@
 #include "vm/stack_frame.h"
 #include "vm/symbols.h"
 #include "vm/timer.h"
+#include "vm/type_feedback_cache.h"
 #include "vm/unicode.h"
 #include "vm/verifier.h"
 #include "vm/version.h"
@@ -942,6 +943,42 @@ DART_EXPORT Dart_Handle Dart_CreateScriptSnapshot(uint8_t** buffer,
 }
 
 
+DART_EXPORT Dart_Handle Dart_SaveTypeFeedback(uint8_t** buffer,
+                                              intptr_t* size) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  if (buffer == NULL) {
+    RETURN_NULL_ERROR(buffer);
+  }
+  if (size == NULL) {
+    RETURN_NULL_ERROR(size);
+  }
+  TypeFeedbackCache::Write(buffer, ApiReallocate, size);
+  return Api::Success();
+}
+
+
+DART_EXPORT Dart_Handle Dart_LoadTypeFeedback(const uint8_t* buffer,
+                                              intptr_t size) {
+  Isolate* isolate = Isolate::Current();
+  DARTSCOPE(isolate);
+  if (buffer == NULL) {
+    RETURN_NULL_ERROR(buffer);
+  }
+  Dart_Handle state = Api::CheckIsolateState(isolate);
+  if (::Dart_IsError(state)) {
+    return state;
+  }
+  TypeFeedbackCache cache;
+  if (!cache.Apply(buffer, size)) {
+    return Api::NewError("%s: the type feedback was saved by a different "
+                         "version of the VM or with different flags.",
+                         CURRENT_FUNC);
+  }
+  return Api::Success();
+}
+
+
 DART_EXPORT void Dart_InterruptIsolate(Dart_Isolate isolate) {
   TRACE_API_CALL(CURRENT_FUNC);
   if (isolate == NULL) {
@@ -4,6 +4,7 @@
 
 #include "vm/bigint_operations.h"
 #include "vm/dart_api_message.h"
+#include "vm/flags.h"
 #include "vm/object.h"
 #include "vm/snapshot_ids.h"
 #include "vm/symbols.h"
@@ -11,8 +12,14 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, flat_messages);
+
 static const int kNumInitialReferences = 4;
 
+// Private class names carry the private key of their library after the '@'.
+static const char kTransferableTypedDataImplPrefix[] =
+    "_TransferableTypedDataImpl@";
+
 ApiMessageReader::ApiMessageReader(const uint8_t* buffer,
                                    intptr_t length,
                                    ReAlloc alloc)
@@ -255,6 +262,114 @@ static Dart_TypedData_Type GetTypedDataTypeFromView(
 }
 
 
+Dart_CObject* ApiMessageReader::ReadOneByteString(intptr_t len) {
+  uint8_t *latin1 =
+      reinterpret_cast<uint8_t*>(::malloc(len * sizeof(uint8_t)));
+  intptr_t utf8_len = 0;
+  for (intptr_t i = 0; i < len; i++) {
+    latin1[i] = Read<uint8_t>();
+    utf8_len += Utf8::Length(latin1[i]);
+  }
+  Dart_CObject* object = AllocateDartCObjectString(utf8_len);
+  char* p = object->value.as_string;
+  for (intptr_t i = 0; i < len; i++) {
+    p += Utf8::Encode(latin1[i], p);
+  }
+  *p = '\0';
+  ASSERT(p == (object->value.as_string + utf8_len));
+  ::free(latin1);
+  return object;
+}
+
+
+Dart_CObject* ApiMessageReader::ReadTwoByteString(intptr_t len) {
+  uint16_t *utf16 =
+      reinterpret_cast<uint16_t*>(::malloc(len * sizeof(uint16_t)));
+  intptr_t utf8_len = 0;
+  // Read all the UTF-16 code units.
+  for (intptr_t i = 0; i < len; i++) {
+    utf16[i] = Read<uint16_t>();
+  }
+  // Calculate the UTF-8 length and check if the string can be
+  // UTF-8 encoded.
+  bool valid = true;
+  intptr_t i = 0;
+  while (i < len && valid) {
+    int32_t ch = Utf16::Next(utf16, &i, len);
+    utf8_len += Utf8::Length(ch);
+    valid = !Utf16::IsSurrogate(ch);
+  }
+  if (!valid) {
+    ::free(utf16);
+    return AllocateDartCObjectUnsupported();
+  }
+  Dart_CObject* object = AllocateDartCObjectString(utf8_len);
+  char* p = object->value.as_string;
+  i = 0;
+  while (i < len) {
+    p += Utf8::Encode(Utf16::Next(utf16, &i, len), p);
+  }
+  *p = '\0';
+  ASSERT(p == (object->value.as_string + utf8_len));
+  ::free(utf16);
+  return object;
+}
+
+
+Dart_CObject* ApiMessageReader::ReadFlatObject() {
+  intptr_t tag = Read<int8_t>();
+  switch (tag) {
+    case kFlatNull:
+      return AllocateDartCObjectNull();
+    case kFlatTrue:
+      return AllocateDartCObjectBool(true);
+    case kFlatFalse:
+      return AllocateDartCObjectBool(false);
+    case kFlatInteger: {
+      int64_t value = Read<int64_t>();
+      if (kMinInt32 <= value && value <= kMaxInt32) {
+        return AllocateDartCObjectInt32(value);
+      }
+      return AllocateDartCObjectInt64(value);
+    }
+    case kFlatDouble:
+      return AllocateDartCObjectDouble(Read<double>());
+    case kFlatOneByteString:
+      return ReadOneByteString(ReadIntptrValue());
+    case kFlatTwoByteString:
+      return ReadTwoByteString(ReadIntptrValue());
+    case kFlatUtf8String: {
+      intptr_t len = ReadIntptrValue();
+      Dart_CObject* object = AllocateDartCObjectString(len);
+      ReadBytes(reinterpret_cast<uint8_t*>(object->value.as_string), len);
+      object->value.as_string[len] = '\0';
+      return object;
+    }
+    case kFlatArray:
+    case kFlatGrowableArray: {
+      intptr_t len = ReadIntptrValue();
+      Dart_CObject* object = AllocateDartCObjectArray(len);
+      for (intptr_t i = 0; i < len; i++) {
+        object->value.as_array.values[i] = ReadFlatObject();
+      }
+      return object;
+    }
+    case kFlatUint8Array: {
+      intptr_t len = ReadIntptrValue();
+      Dart_CObject* object =
+          AllocateDartCObjectTypedData(Dart_TypedData_kUint8, len);
+      ReadBytes(object->value.as_typed_data.values, len);
+      return object;
+    }
+    case kFlatCanonical:
+      return ReadFlatObject();
+    default:
+      UNREACHABLE();
+      return NULL;
+  }
+}
+
+
 Dart_CObject* ApiMessageReader::ReadInlinedObject(intptr_t object_id) {
   // Read the class header information and lookup the class.
   intptr_t class_header = ReadIntptrValue();
@@ -330,6 +445,18 @@ Dart_CObject* ApiMessageReader::ReadInlinedObject(intptr_t object_id) {
         object->type = Dart_CObject_kSendPort;
         object->value.as_send_port = port->value.as_int64;
       }
+    } else if (strcmp("dart:isolate", library_uri) == 0 &&
+               strncmp(kTransferableTypedDataImplPrefix,
+                       class_name,
+                       strlen(kTransferableTypedDataImplPrefix)) == 0) {
+      Dart_CObject_Internal* cls =
+          reinterpret_cast<Dart_CObject_Internal*>(ReadObjectImpl());
+      ASSERT(cls == object->cls);
+      // The bytes are copied for native ports, turn the transferable into
+      // the typed data holding them.
+      Dart_CObject* bytes = ReadObjectImpl();
+      object->type = bytes->type;
+      object->value = bytes->value;
     } else {
       // TODO(sgjesse): Handle other instances. Currently this will
       // skew the reading as the fields of the instance is not read.
@@ -544,57 +671,19 @@ Dart_CObject* ApiMessageReader::ReadInternalVMObject(intptr_t class_id,
       intptr_t len = ReadSmiValue();
       intptr_t hash = ReadSmiValue();
       USE(hash);
-      uint8_t *latin1 =
-          reinterpret_cast<uint8_t*>(::malloc(len * sizeof(uint8_t)));
-      intptr_t utf8_len = 0;
-      for (intptr_t i = 0; i < len; i++) {
-        latin1[i] = Read<uint8_t>();
-        utf8_len += Utf8::Length(latin1[i]);
-      }
-      Dart_CObject* object = AllocateDartCObjectString(utf8_len);
+      Dart_CObject* object = ReadOneByteString(len);
       AddBackRef(object_id, object, kIsDeserialized);
-      char* p = object->value.as_string;
-      for (intptr_t i = 0; i < len; i++) {
-        p += Utf8::Encode(latin1[i], p);
-      }
-      *p = '\0';
-      ASSERT(p == (object->value.as_string + utf8_len));
-      ::free(latin1);
       return object;
     }
     case kTwoByteStringCid: {
       intptr_t len = ReadSmiValue();
       intptr_t hash = ReadSmiValue();
       USE(hash);
-      uint16_t *utf16 =
-          reinterpret_cast<uint16_t*>(::malloc(len * sizeof(uint16_t)));
-      intptr_t utf8_len = 0;
-      // Read all the UTF-16 code units.
-      for (intptr_t i = 0; i < len; i++) {
-        utf16[i] = Read<uint16_t>();
-      }
-      // Calculate the UTF-8 length and check if the string can be
-      // UTF-8 encoded.
-      bool valid = true;
-      intptr_t i = 0;
-      while (i < len && valid) {
-        int32_t ch = Utf16::Next(utf16, &i, len);
-        utf8_len += Utf8::Length(ch);
-        valid = !Utf16::IsSurrogate(ch);
+      Dart_CObject* object = ReadTwoByteString(len);
+      if (object->type == Dart_CObject_kUnsupported) {
+        return object;
       }
-      if (!valid) {
-        return AllocateDartCObjectUnsupported();
-      }
-      Dart_CObject* object = AllocateDartCObjectString(utf8_len);
       AddBackRef(object_id, object, kIsDeserialized);
-      char* p = object->value.as_string;
-      i = 0;
-      while (i < len) {
-        p += Utf8::Encode(Utf16::Next(utf16, &i, len), p);
-      }
-      *p = '\0';
-      ASSERT(p == (object->value.as_string + utf8_len));
-      ::free(utf16);
       return object;
     }
 
@@ -706,7 +795,11 @@ Dart_CObject* ApiMessageReader::ReadIndexedObject(intptr_t object_id) {
 
 
 Dart_CObject* ApiMessageReader::ReadObject() {
-  Dart_CObject* value = ReadObjectImpl();
+  int64_t header_value = Read<int64_t>();
+  if (header_value == kFlatMessageHeader) {
+    return ReadFlatObject();
+  }
+  Dart_CObject* value = ReadObjectImpl(header_value);
   for (intptr_t i = 0; i < backward_references_.length(); i++) {
     if (!backward_references_[i]->is_deserialized()) {
       ReadObjectImpl();
@@ -718,7 +811,11 @@ Dart_CObject* ApiMessageReader::ReadObject() {
 
 
 Dart_CObject* ApiMessageReader::ReadObjectImpl() {
-  int64_t value = Read<int64_t>();
+  return ReadObjectImpl(Read<int64_t>());
+}
+
+
+Dart_CObject* ApiMessageReader::ReadObjectImpl(int64_t value) {
   if ((value & kSmiTagMask) == 0) {
     int64_t untagged_value = value >> kSmiTagShift;
     if (kMinInt32 <= untagged_value && untagged_value <= kMaxInt32) {
@@ -1156,7 +1253,87 @@ bool ApiMessageWriter::WriteCObjectInlined(Dart_CObject* object,
 }
 
 
+bool ApiMessageWriter::WriteFlatCObject(Dart_CObject* object,
+                                        FlatMessageObjects* objects) {
+  switch (object->type) {
+    case Dart_CObject_kNull:
+      Write<int8_t>(kFlatNull);
+      return true;
+    case Dart_CObject_kBool:
+      Write<int8_t>(object->value.as_bool ? kFlatTrue : kFlatFalse);
+      return true;
+    case Dart_CObject_kInt32:
+      Write<int8_t>(kFlatInteger);
+      Write<int64_t>(object->value.as_int32);
+      return true;
+    case Dart_CObject_kInt64:
+      Write<int8_t>(kFlatInteger);
+      Write<int64_t>(object->value.as_int64);
+      return true;
+    case Dart_CObject_kDouble:
+      Write<int8_t>(kFlatDouble);
+      Write<double>(object->value.as_double);
+      return true;
+    case Dart_CObject_kString: {
+      const uint8_t* utf8_str =
+          reinterpret_cast<const uint8_t*>(object->value.as_string);
+      intptr_t utf8_len = strlen(object->value.as_string);
+      // A string has at most as many code units as UTF-8 bytes.
+      if ((utf8_len > String::kMaxElements) ||
+          !Utf8::IsValid(utf8_str, utf8_len) ||
+          !objects->Add(object)) {
+        return false;
+      }
+      Write<int8_t>(kFlatUtf8String);
+      WriteIntptrValue(utf8_len);
+      WriteBytes(utf8_str, utf8_len);
+      return true;
+    }
+    case Dart_CObject_kArray: {
+      intptr_t len = object->value.as_array.length;
+      if ((len < 0) || (len > Array::kMaxElements) || !objects->Add(object)) {
+        return false;
+      }
+      Write<int8_t>(kFlatArray);
+      WriteIntptrValue(len);
+      for (intptr_t i = 0; i < len; i++) {
+        if (!WriteFlatCObject(object->value.as_array.values[i], objects)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case Dart_CObject_kTypedData: {
+      intptr_t len = object->value.as_typed_data.length;
+      if ((object->value.as_typed_data.type != Dart_TypedData_kUint8) ||
+          (len < 0) ||
+          (len > TypedData::MaxElements(kTypedDataUint8ArrayCid)) ||
+          !objects->Add(object)) {
+        return false;
+      }
+      Write<int8_t>(kFlatUint8Array);
+      WriteIntptrValue(len);
+      WriteBytes(object->value.as_typed_data.values, len);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+
 bool ApiMessageWriter::WriteCMessage(Dart_CObject* object) {
+  // Most messages are small lists of numbers and strings, try writing them
+  // without marking the objects first.
+  if (FLAG_flat_messages) {
+    FlatMessageObjects objects;
+    WriteIntptrValue(kFlatMessageHeader);
+    if (WriteFlatCObject(object, &objects)) {
+      return true;
+    }
+    Rewind(0);
+  }
+
   bool success = WriteCObject(object);
   if (!success) {
     UnmarkAllCObjects(object);
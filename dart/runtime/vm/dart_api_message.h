@@ -108,7 +108,11 @@ class ApiMessageReader : public BaseReader {
   Dart_CObject* ReadVMIsolateObject(intptr_t value);
   Dart_CObject* ReadInternalVMObject(intptr_t class_id, intptr_t object_id);
   Dart_CObject* ReadInlinedObject(intptr_t object_id);
+  Dart_CObject* ReadOneByteString(intptr_t len);
+  Dart_CObject* ReadTwoByteString(intptr_t len);
+  Dart_CObject* ReadFlatObject();
   Dart_CObject* ReadObjectImpl();
+  Dart_CObject* ReadObjectImpl(int64_t value);
   Dart_CObject* ReadIndexedObject(intptr_t object_id);
   Dart_CObject* ReadVMSymbol(intptr_t object_id);
   Dart_CObject* ReadObjectRef();
@@ -179,6 +183,7 @@ class ApiMessageWriter : public BaseWriter {
   bool WriteCObjectRef(Dart_CObject* object);
   bool WriteForwardedCObject(Dart_CObject* object);
   bool WriteCObjectInlined(Dart_CObject* object, Dart_CObject_Type type);
+  bool WriteFlatCObject(Dart_CObject* object, FlatMessageObjects* objects);
 
   intptr_t object_id_;
   Dart_CObject** forward_list_;
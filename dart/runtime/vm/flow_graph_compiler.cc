@@ -76,6 +76,7 @@ FlowGraphCompiler::FlowGraphCompiler(Assembler* assembler,
           is_optimizing ? new StackmapTableBuilder() : NULL),
       block_info_(block_order_.length()),
       deopt_infos_(),
+      pretenuring_class_ids_(),
       static_calls_target_table_(GrowableObjectArray::ZoneHandle(
           GrowableObjectArray::New())),
       is_optimizing_(is_optimizing),
@@ -166,6 +167,24 @@ bool FlowGraphCompiler::CanOSRFunction() const {
 }
 
 
+bool FlowGraphCompiler::ShouldPretenure(intptr_t class_id) {
+  if (!is_optimizing() || !FLAG_pretenure) {
+    return false;
+  }
+  bool found = false;
+  for (intptr_t i = 0; i < pretenuring_class_ids_.length(); i++) {
+    if (pretenuring_class_ids_[i] == class_id) {
+      found = true;
+      break;
+    }
+  }
+  if (!found) {
+    pretenuring_class_ids_.Add(class_id);
+  }
+  return Isolate::Current()->heap()->ShouldPretenure(class_id);
+}
+
+
 static bool IsEmptyBlock(BlockEntryInstr* block) {
   return !block->HasParallelMove() &&
          block->next()->IsGoto() &&
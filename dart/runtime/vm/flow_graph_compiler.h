@@ -274,6 +274,16 @@ class FlowGraphCompiler : public ValueObject {
   bool CanOSRFunction() const;
   bool is_optimizing() const { return is_optimizing_; }
 
+  // Returns true if optimized code should allocate objects of the given class
+  // directly in old space, as most of them survive their first scavenge.
+  // The class is recorded so that the code can be registered as dependent on
+  // the decision.
+  bool ShouldPretenure(intptr_t class_id);
+
+  const GrowableArray<intptr_t>& pretenuring_class_ids() const {
+    return pretenuring_class_ids_;
+  }
+
   const GrowableArray<BlockInfo*>& block_info() const { return block_info_; }
   ParallelMoveResolver* parallel_move_resolver() {
     return &parallel_move_resolver_;
@@ -594,6 +604,8 @@ class FlowGraphCompiler : public ValueObject {
   GrowableArray<BlockInfo*> block_info_;
   GrowableArray<CompilerDeoptInfo*> deopt_infos_;
   GrowableArray<SlowPathCode*> slow_path_code_;
+  // Classes whose pretenuring decision the optimized code depends on.
+  GrowableArray<intptr_t> pretenuring_class_ids_;
   // Stores: [code offset, function, null(code)].
   const GrowableObjectArray& static_calls_target_table_;
   const bool is_optimizing_;
@@ -40,7 +40,7 @@ void FreeListElement::InitOnce() {
 }
 
 
-FreeList::FreeList() {
+FreeList::FreeList() : bump_allocations_(0), bump_slow_allocations_(0) {
   Reset();
 }
 
@@ -88,6 +88,49 @@ uword FreeList::TryAllocate(intptr_t size) {
 }
 
 
+uword FreeList::TryAllocateBumpSlow(intptr_t size) {
+  bump_slow_allocations_++;
+  FreeListElement* element = free_lists_[kNumLists];
+  if ((size <= kMaxBumpObjectSize) &&
+      (element != NULL) &&
+      (element->Size() >= size)) {
+    // Carve a new area out of a large free chunk.
+    free_lists_[kNumLists] = element->next();
+    ReleaseBumpArea();
+    intptr_t area_size = element->Size();
+    if (area_size > kBumpAreaSize) {
+      SplitElementAfterAndEnqueue(element, kBumpAreaSize);
+      area_size = kBumpAreaSize;
+    }
+    uword result = reinterpret_cast<uword>(element);
+    bump_top_ = result + size;
+    bump_end_ = result + area_size;
+    if (bump_top_ < bump_end_) {
+      FreeListElement::AsElement(bump_top_, bump_end_ - bump_top_);
+    }
+    return result;
+  }
+  // Large requests, and small ones when the free memory is too fragmented for
+  // bump allocation to pay off.
+  uword result = TryAllocate(size);
+  if ((result == 0) && (bump_top_ < bump_end_)) {
+    // The free memory might be held by the bump allocation area.
+    ReleaseBumpArea();
+    result = TryAllocate(size);
+  }
+  return result;
+}
+
+
+void FreeList::ReleaseBumpArea() {
+  if (bump_top_ < bump_end_) {
+    Free(bump_top_, bump_end_ - bump_top_);
+  }
+  bump_top_ = 0;
+  bump_end_ = 0;
+}
+
+
 void FreeList::Free(uword addr, intptr_t size) {
   intptr_t index = IndexForSize(size);
   FreeListElement* element = FreeListElement::AsElement(addr, size);
@@ -96,6 +139,9 @@ void FreeList::Free(uword addr, intptr_t size) {
 
 
 void FreeList::Reset() {
+  // The unused part of the bump allocation area is reclaimed by the sweeper.
+  bump_top_ = 0;
+  bump_end_ = 0;
   free_map_.Reset();
   for (int i = 0; i < (kNumLists + 1); i++) {
     free_lists_[i] = NULL;
@@ -209,6 +255,9 @@ void FreeList::PrintLarge() const {
 void FreeList::Print() const {
   PrintSmall();
   PrintLarge();
+  OS::Print("bump allocations: %8" Pd "; slow path: %8" Pd "\n",
+            bump_allocations_,
+            bump_slow_allocations_);
 }
 
 
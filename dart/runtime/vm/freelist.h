@@ -78,15 +78,47 @@ class FreeList {
   uword TryAllocate(intptr_t size);
   void Free(uword addr, intptr_t size);
 
+  // Allocates out of a bump allocation area carved from a free chunk. Used
+  // for promotion and pretenuring, where most requests are small. The free
+  // lists are only consulted when the area is exhausted. The unused part of
+  // the area is kept formatted as a free list element so that the page stays
+  // iterable.
+  uword TryAllocateBump(intptr_t size) {
+    ASSERT(Utils::IsAligned(size, kObjectAlignment));
+    if ((bump_end_ - bump_top_) >= static_cast<uword>(size)) {
+      uword result = bump_top_;
+      bump_top_ += size;
+      if (bump_top_ < bump_end_) {
+        FreeListElement::AsElement(bump_top_, bump_end_ - bump_top_);
+      }
+      bump_allocations_++;
+      return result;
+    }
+    return TryAllocateBumpSlow(size);
+  }
+
   void Reset();
 
   intptr_t Length(int index) const;
 
+  // Number of bump allocations served from the current area, and number of
+  // those which had to go to the free lists instead.
+  intptr_t bump_allocations() const { return bump_allocations_; }
+  intptr_t bump_slow_allocations() const { return bump_slow_allocations_; }
+
   void Print() const;
 
  private:
   static const int kNumLists = 128;
 
+  // Size of the bump allocation areas. Larger requests are served from the
+  // free lists directly.
+  static const intptr_t kBumpAreaSize = 16 * KB;
+  static const intptr_t kMaxBumpObjectSize = kBumpAreaSize / 8;
+
+  uword TryAllocateBumpSlow(intptr_t size);
+  void ReleaseBumpArea();
+
   static intptr_t IndexForSize(intptr_t size);
 
   void EnqueueElement(FreeListElement* element, intptr_t index);
@@ -101,6 +133,13 @@ class FreeList {
 
   FreeListElement* free_lists_[kNumLists + 1];
 
+  // The current bump allocation area, empty if both are 0.
+  uword bump_top_;
+  uword bump_end_;
+
+  intptr_t bump_allocations_;
+  intptr_t bump_slow_allocations_;
+
   DISALLOW_COPY_AND_ASSIGN(FreeList);
 };
 
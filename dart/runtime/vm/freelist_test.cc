@@ -50,4 +50,46 @@ TEST_CASE(FreeList) {
   delete free_list;
 }
 
+
+TEST_CASE(FreeListBumpAllocation) {
+  FreeList* free_list = new FreeList();
+  intptr_t kBlobSize = 1 * MB;
+  intptr_t kSmallObjectSize = 4 * kWordSize;
+  intptr_t kLargeObjectSize = 8 * KB;
+  uword blob = reinterpret_cast<uword>(malloc(kBlobSize));
+  free_list->Free(blob, kBlobSize);
+  // The first allocation carves a bump allocation area out of the blob.
+  uword small_object = free_list->TryAllocateBump(kSmallObjectSize);
+  EXPECT_EQ(blob, small_object);
+  EXPECT_EQ(0, free_list->bump_allocations());
+  EXPECT_EQ(1, free_list->bump_slow_allocations());
+  // Subsequent allocations bump the pointer.
+  uword small_object2 = free_list->TryAllocateBump(kSmallObjectSize);
+  EXPECT_EQ(small_object + kSmallObjectSize, small_object2);
+  EXPECT_EQ(1, free_list->bump_allocations());
+  EXPECT_EQ(1, free_list->bump_slow_allocations());
+  // The rest of the area is formatted as a free list element.
+  FreeListElement* rest =
+      reinterpret_cast<FreeListElement*>(small_object2 + kSmallObjectSize);
+  intptr_t rest_size = rest->Size();
+  EXPECT(rest_size > kSmallObjectSize);
+  // Large objects are allocated from the free lists, outside of the area.
+  uword large_object = free_list->TryAllocateBump(kLargeObjectSize);
+  EXPECT(large_object >= (small_object2 + kSmallObjectSize + rest_size));
+  EXPECT_EQ(2, free_list->bump_slow_allocations());
+  // The area is still used for small objects.
+  uword small_object3 = free_list->TryAllocateBump(kSmallObjectSize);
+  EXPECT_EQ(small_object2 + kSmallObjectSize, small_object3);
+  EXPECT_EQ(2, free_list->bump_allocations());
+  // After a reset the area is abandoned and a new one is carved.
+  free_list->Reset();
+  free_list->Free(blob, kBlobSize);
+  small_object = free_list->TryAllocateBump(kSmallObjectSize);
+  EXPECT_EQ(blob, small_object);
+  EXPECT_EQ(3, free_list->bump_slow_allocations());
+  // Delete the memory associated with the test.
+  free(reinterpret_cast<void*>(blob));
+  delete free_list;
+}
+
 }  // namespace dart
@@ -8,18 +8,47 @@
 #include <utility>
 
 #include "vm/allocation.h"
+#include "vm/dart.h"
 #include "vm/dart_api_state.h"
 #include "vm/isolate.h"
 #include "vm/pages.h"
 #include "vm/raw_object.h"
 #include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/thread_pool.h"
 #include "vm/visitor.h"
 #include "vm/object_id_ring.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, marker_tasks, 0,
+            "The number of tasks to spawn during old gen GC marking "
+            "(0 means perform all marking on main thread).");
+
+class MarkingStackChunk {
+ public:
+  MarkingStackChunk() : next_(NULL) {}
+  ~MarkingStackChunk() {}
+
+  RawObject** MarkingStackChunkMemory() {
+    return &memory_[0];
+  }
+
+  MarkingStackChunk* next() const { return next_; }
+  void set_next(MarkingStackChunk* value) { next_ = value; }
+
+  static const uint32_t kMarkingStackChunkSize = 1024;
+
+ private:
+  RawObject* memory_[kMarkingStackChunkSize];
+  MarkingStackChunk* next_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
+};
+
+
 // A simple chunked marking stack.
-class MarkingStack : public ValueObject {
+class MarkingStack {
  public:
   MarkingStack()
       : head_(new MarkingStackChunk()),
@@ -79,28 +108,27 @@ class MarkingStack : public ValueObject {
     return marking_stack_[top_];
   }
 
- private:
-  class MarkingStackChunk {
-   public:
-    MarkingStackChunk() : next_(NULL) {}
-    ~MarkingStackChunk() {}
-
-    RawObject** MarkingStackChunkMemory() {
-      return &memory_[0];
-    }
-
-    MarkingStackChunk* next() const { return next_; }
-    void set_next(MarkingStackChunk* value) { next_ = value; }
-
-    static const uint32_t kMarkingStackChunkSize = 1024;
+  // All chunks but the head chunk are full. They can be handed over to other
+  // marking stacks for load balancing between parallel marker tasks.
+  bool HasFullChunk() const {
+    return head_->next() != NULL;
+  }
 
-   private:
-    RawObject* memory_[kMarkingStackChunkSize];
-    MarkingStackChunk* next_;
+  MarkingStackChunk* RemoveFullChunk() {
+    ASSERT(HasFullChunk());
+    MarkingStackChunk* chunk = head_->next();
+    head_->set_next(chunk->next());
+    chunk->set_next(NULL);
+    return chunk;
+  }
 
-    DISALLOW_COPY_AND_ASSIGN(MarkingStackChunk);
-  };
+  void AddFullChunk(MarkingStackChunk* chunk) {
+    ASSERT(chunk->next() == NULL);
+    chunk->set_next(head_->next());
+    head_->set_next(chunk);
+  }
 
+ private:
   bool IsMarkingStackChunkFull() const {
     return top_ == MarkingStackChunk::kMarkingStackChunkSize;
   }
@@ -118,23 +146,120 @@ class MarkingStack : public ValueObject {
 };
 
 
+// Full marking stack chunks shared between parallel marker tasks. A task
+// donates surplus chunks while other tasks are waiting for work and steals a
+// chunk once its own marking stack is drained. Marking is complete when all
+// tasks are waiting and no chunks are left.
+class MarkingWorkList : public ValueObject {
+ public:
+  explicit MarkingWorkList(intptr_t num_tasks)
+      : chunks_(NULL),
+        num_tasks_(num_tasks),
+        num_waiting_(0),
+        num_helpers_done_(0) {
+    ASSERT(num_tasks > 1);
+  }
+
+  ~MarkingWorkList() {
+    ASSERT(chunks_ == NULL);
+  }
+
+  // Unsynchronized hint, only used to decide whether to donate work.
+  bool HasWaitingTasks() const { return num_waiting_ > 0; }
+
+  void Donate(MarkingStackChunk* chunk) {
+    MonitorLocker ml(&monitor_);
+    chunk->set_next(chunks_);
+    chunks_ = chunk;
+    ml.Notify();
+  }
+
+  // Returns NULL once all tasks have run out of work.
+  MarkingStackChunk* Steal() {
+    MonitorLocker ml(&monitor_);
+    num_waiting_++;
+    while ((chunks_ == NULL) && (num_waiting_ < num_tasks_)) {
+      ml.Wait();
+    }
+    if (chunks_ == NULL) {
+      // Nobody is left to produce work: wake up the other waiting tasks.
+      ml.NotifyAll();
+      return NULL;
+    }
+    num_waiting_--;
+    MarkingStackChunk* chunk = chunks_;
+    chunks_ = chunk->next();
+    chunk->set_next(NULL);
+    return chunk;
+  }
+
+  void HelperDone() {
+    MonitorLocker ml(&monitor_);
+    num_helpers_done_++;
+    ml.NotifyAll();
+  }
+
+  // The main marking task is not a helper.
+  void WaitForHelpers() {
+    MonitorLocker ml(&monitor_);
+    while (num_helpers_done_ < (num_tasks_ - 1)) {
+      ml.Wait();
+    }
+  }
+
+  // Called by the main marking task once the helpers are done. It continues
+  // marking on its own, so nobody is waiting for donated work anymore.
+  // Returns the chunks which are left.
+  MarkingStackChunk* Finish() {
+    MonitorLocker ml(&monitor_);
+    ASSERT(num_helpers_done_ == (num_tasks_ - 1));
+    num_waiting_ = 0;
+    MarkingStackChunk* chunks = chunks_;
+    chunks_ = NULL;
+    return chunks;
+  }
+
+ private:
+  Monitor monitor_;
+  MarkingStackChunk* chunks_;
+  const intptr_t num_tasks_;
+  intptr_t num_waiting_;
+  intptr_t num_helpers_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkingWorkList);
+};
+
+
 class MarkingVisitor : public ObjectPointerVisitor {
  public:
+  // A non-NULL work_list selects parallel marking: the mark bit is acquired
+  // atomically, and work that must happen on the isolate's thread (store
+  // buffer updates) or after all tasks are done (weak properties) is deferred.
+  // An incremental visitor leaves the store buffer intact, as the mutator
+  // keeps adding to it while marking is in progress.
   MarkingVisitor(Isolate* isolate,
                  Heap* heap,
                  PageSpace* page_space,
-                 MarkingStack* marking_stack)
+                 MarkingStack* marking_stack,
+                 MarkingWorkList* work_list,
+                 bool incremental)
       : ObjectPointerVisitor(isolate),
         heap_(heap),
         vm_heap_(Dart::vm_isolate()->heap()),
         page_space_(page_space),
         marking_stack_(marking_stack),
-        visiting_old_object_(NULL) {
+        work_list_(work_list),
+        incremental_(incremental),
+        visiting_old_object_(NULL),
+        marked_bytes_(0) {
     ASSERT(heap_ != vm_heap_);
   }
 
   MarkingStack* marking_stack() const { return marking_stack_; }
 
+  intptr_t marked_bytes() const { return marked_bytes_; }
+  void AddMarkedBytes(intptr_t size) { marked_bytes_ += size; }
+
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
       MarkObject(*current, current);
@@ -142,6 +267,12 @@ class MarkingVisitor : public ObjectPointerVisitor {
   }
 
   void DelayWeakProperty(RawWeakProperty* raw_weak) {
+    if (work_list_ != NULL) {
+      // Watched bits cannot be maintained by concurrent tasks. Keep the weak
+      // property until marking has reached a fixed point.
+      delayed_weak_properties_.Push(raw_weak);
+      return;
+    }
     RawObject* raw_key = raw_weak->ptr()->key_;
     DelaySet::iterator it = delay_set_.find(raw_key);
     if (it != delay_set_.end()) {
@@ -153,10 +284,61 @@ class MarkingVisitor : public ObjectPointerVisitor {
     delay_set_.insert(std::make_pair(raw_key, raw_weak));
   }
 
+  // Visits the delayed weak properties whose keys have been marked since they
+  // were delayed. Returns true if any weak property was visited.
+  bool ProcessDelayedWeakProperties() {
+    if (delayed_weak_properties_.IsEmpty()) {
+      return false;
+    }
+    bool visited = false;
+    MarkingStack still_delayed;
+    while (!delayed_weak_properties_.IsEmpty()) {
+      RawWeakProperty* raw_weak =
+          reinterpret_cast<RawWeakProperty*>(delayed_weak_properties_.Pop());
+      if (raw_weak->ptr()->key_->IsMarked()) {
+        VisitingOldObject(raw_weak);
+        raw_weak->VisitPointers(this);
+        VisitingOldObject(NULL);
+        visited = true;
+      } else {
+        still_delayed.Push(raw_weak);
+      }
+    }
+    while (!still_delayed.IsEmpty()) {
+      delayed_weak_properties_.Push(still_delayed.Pop());
+    }
+    return visited;
+  }
+
+  // Takes over the deferred work of a finished parallel marker task.
+  void AbsorbDeferredWork(MarkingVisitor* other) {
+    ASSERT(other->marking_stack()->IsEmpty());
+    marked_bytes_ += other->marked_bytes_;
+    while (!other->delayed_weak_properties_.IsEmpty()) {
+      delayed_weak_properties_.Push(other->delayed_weak_properties_.Pop());
+    }
+    while (!other->deferred_remembered_objects_.IsEmpty()) {
+      deferred_remembered_objects_.Push(
+          other->deferred_remembered_objects_.Pop());
+    }
+  }
+
   void Finalize() {
     DelaySet::iterator it = delay_set_.begin();
     for (; it != delay_set_.end(); ++it) {
-      WeakProperty::Clear(it->second);
+      // A weak property whose key was replaced during incremental marking has
+      // been visited again with its new key.
+      if (it->second->ptr()->key_ == it->first) {
+        WeakProperty::Clear(it->second);
+      }
+    }
+    while (!delayed_weak_properties_.IsEmpty()) {
+      WeakProperty::Clear(
+          reinterpret_cast<RawWeakProperty*>(delayed_weak_properties_.Pop()));
+    }
+    while (!deferred_remembered_objects_.IsEmpty()) {
+      isolate()->store_buffer()->AddObjectGC(
+          deferred_remembered_objects_.Pop());
     }
   }
 
@@ -173,21 +355,36 @@ class MarkingVisitor : public ObjectPointerVisitor {
            true);
 
     // Mark the object and push it on the marking stack.
-    ASSERT(!raw_obj->IsMarked());
     RawClass* raw_class = isolate()->class_table()->At(raw_obj->GetClassId());
-    raw_obj->SetMarkBit();
-    raw_obj->ClearRememberedBit();
-    if (raw_obj->IsWatched()) {
-      std::pair<DelaySet::iterator, DelaySet::iterator> ret;
-      // Visit all elements with a key equal to raw_obj.
-      ret = delay_set_.equal_range(raw_obj);
-      for (DelaySet::iterator it = ret.first; it != ret.second; ++it) {
-        it->second->VisitPointers(this);
+    if (work_list_ != NULL) {
+      if (!raw_obj->TryAcquireMarkBit()) {
+        // Another marker task got here first.
+        return;
+      }
+      raw_obj->ClearRememberedBit();
+    } else {
+      ASSERT(!raw_obj->IsMarked());
+      raw_obj->SetMarkBit();
+      if (!incremental_) {
+        raw_obj->ClearRememberedBit();
+      }
+      if (raw_obj->IsWatched()) {
+        std::pair<DelaySet::iterator, DelaySet::iterator> ret;
+        // Visit all elements with a key equal to raw_obj.
+        ret = delay_set_.equal_range(raw_obj);
+        for (DelaySet::iterator it = ret.first; it != ret.second; ++it) {
+          it->second->VisitPointers(this);
+        }
+        delay_set_.erase(ret.first, ret.second);
+        raw_obj->ClearWatchedBit();
       }
-      delay_set_.erase(ret.first, ret.second);
-      raw_obj->ClearWatchedBit();
     }
     marking_stack_->Push(raw_obj);
+    if ((work_list_ != NULL) &&
+        marking_stack_->HasFullChunk() &&
+        work_list_->HasWaitingTasks()) {
+      work_list_->Donate(marking_stack_->RemoveFullChunk());
+    }
 
     // TODO(iposva): Should we mark the classes early?
     MarkObject(raw_class, NULL);
@@ -207,7 +404,11 @@ class MarkingVisitor : public ObjectPointerVisitor {
           !visiting_old_object_->IsRemembered()) {
         ASSERT(p != NULL);
         visiting_old_object_->SetRememberedBit();
-        isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        if (work_list_ != NULL) {
+          deferred_remembered_objects_.Push(visiting_old_object_);
+        } else {
+          isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
+        }
       }
       return;
     }
@@ -219,9 +420,15 @@ class MarkingVisitor : public ObjectPointerVisitor {
   Heap* vm_heap_;
   PageSpace* page_space_;
   MarkingStack* marking_stack_;
+  MarkingWorkList* work_list_;
+  bool incremental_;
   RawObject* visiting_old_object_;
+  intptr_t marked_bytes_;
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
   DelaySet delay_set_;
+  // Only used when marking in parallel.
+  MarkingStack delayed_weak_properties_;
+  MarkingStack deferred_remembered_objects_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitor);
 };
@@ -350,14 +557,26 @@ void GCMarker::IterateWeakReferences(Isolate* isolate,
 
 void GCMarker::DrainMarkingStack(Isolate* isolate,
                                  MarkingVisitor* visitor) {
-  while (!visitor->marking_stack()->IsEmpty()) {
+  do {
+    ProcessMarkingStack(visitor, kIntptrMax);
+  } while (visitor->ProcessDelayedWeakProperties());
+}
+
+
+void GCMarker::ProcessMarkingStack(MarkingVisitor* visitor,
+                                   intptr_t budget_in_bytes) {
+  const intptr_t start = visitor->marked_bytes();
+  while (!visitor->marking_stack()->IsEmpty() &&
+         ((visitor->marked_bytes() - start) < budget_in_bytes)) {
     RawObject* raw_obj = visitor->marking_stack()->Pop();
     visitor->VisitingOldObject(raw_obj);
     if (raw_obj->GetClassId() != kWeakPropertyCid) {
-      raw_obj->VisitPointers(visitor);
+      visitor->AddMarkedBytes(raw_obj->VisitPointers(visitor));
     } else {
-      RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+      RawWeakProperty* raw_weak =
+          reinterpret_cast<RawWeakProperty*>(raw_obj);
       ProcessWeakProperty(raw_weak, visitor);
+      visitor->AddMarkedBytes(WeakProperty::InstanceSize());
     }
   }
   visitor->VisitingOldObject(NULL);
@@ -427,23 +646,236 @@ void GCMarker::ProcessObjectIdTable(Isolate* isolate) {
 }
 
 
+class MarkTask : public ThreadPool::Task {
+ public:
+  MarkTask(GCMarker* marker,
+           Isolate* isolate,
+           Heap* heap,
+           MarkingVisitor* visitor,
+           MarkingWorkList* work_list,
+           bool visit_new_space)
+      : marker_(marker),
+        isolate_(isolate),
+        heap_(heap),
+        visitor_(visitor),
+        work_list_(work_list),
+        visit_new_space_(visit_new_space) {
+  }
+
+  virtual void Run() {
+    if (visit_new_space_) {
+      heap_->IterateNewPointers(visitor_);
+    }
+    marker_->DrainMarkingStackParallel(isolate_, visitor_, work_list_);
+    work_list_->HelperDone();
+  }
+
+ private:
+  GCMarker* marker_;
+  Isolate* isolate_;
+  Heap* heap_;
+  MarkingVisitor* visitor_;
+  MarkingWorkList* work_list_;
+  bool visit_new_space_;
+
+  DISALLOW_COPY_AND_ASSIGN(MarkTask);
+};
+
+
+void GCMarker::DrainMarkingStackParallel(Isolate* isolate,
+                                         MarkingVisitor* visitor,
+                                         MarkingWorkList* work_list) {
+  while (true) {
+    DrainMarkingStack(isolate, visitor);
+    MarkingStackChunk* chunk = work_list->Steal();
+    if (chunk == NULL) {
+      return;
+    }
+    visitor->marking_stack()->AddFullChunk(chunk);
+  }
+}
+
+
+void GCMarker::MarkObjectsParallel(Isolate* isolate,
+                                   PageSpace* page_space,
+                                   bool invoke_api_callbacks,
+                                   MarkingVisitor* visitor,
+                                   MarkingWorkList* work_list,
+                                   intptr_t num_helpers) {
+  MarkingStack** helper_stacks = new MarkingStack*[num_helpers];
+  MarkingVisitor** helpers = new MarkingVisitor*[num_helpers];
+  for (intptr_t i = 0; i < num_helpers; i++) {
+    helper_stacks[i] = new MarkingStack();
+    helpers[i] = new MarkingVisitor(isolate, heap_, page_space,
+                                    helper_stacks[i], work_list, false);
+    // The first helper takes the pointers from new space as its roots, the
+    // other helpers start out stealing work.
+    Dart::thread_pool()->Run(new MarkTask(this, isolate, heap_, helpers[i],
+                                          work_list, (i == 0)));
+  }
+  // The isolate roots have to be visited on the isolate's thread.
+  isolate->VisitObjectPointers(visitor,
+                               !invoke_api_callbacks,
+                               StackFrameIterator::kDontValidateFrames);
+  DrainMarkingStackParallel(isolate, visitor, work_list);
+  work_list->WaitForHelpers();
+  MarkingStackChunk* chunk = work_list->Finish();
+  while (chunk != NULL) {
+    MarkingStackChunk* next = chunk->next();
+    chunk->set_next(NULL);
+    visitor->marking_stack()->AddFullChunk(chunk);
+    chunk = next;
+  }
+  for (intptr_t i = 0; i < num_helpers; i++) {
+    visitor->AbsorbDeferredWork(helpers[i]);
+    delete helpers[i];
+    delete helper_stacks[i];
+  }
+  delete[] helpers;
+  delete[] helper_stacks;
+}
+
+
 void GCMarker::MarkObjects(Isolate* isolate,
                            PageSpace* page_space,
                            bool invoke_api_callbacks) {
   MarkingStack marking_stack;
   Prologue(isolate, invoke_api_callbacks);
-  MarkingVisitor mark(isolate, heap_, page_space, &marking_stack);
-  IterateRoots(isolate, &mark, !invoke_api_callbacks);
-  DrainMarkingStack(isolate, &mark);
-  IterateWeakReferences(isolate, &mark);
+  const intptr_t num_helpers = FLAG_marker_tasks;
+  if (num_helpers > 0) {
+    MarkingWorkList work_list(num_helpers + 1);
+    MarkingVisitor mark(isolate, heap_, page_space, &marking_stack,
+                        &work_list, false);
+    MarkObjectsParallel(isolate, page_space, invoke_api_callbacks,
+                        &mark, &work_list, num_helpers);
+    // Weak properties whose keys were marked by another task are revisited.
+    DrainMarkingStack(isolate, &mark);
+    FinishMarking(isolate, page_space, invoke_api_callbacks, &mark);
+  } else {
+    MarkingVisitor mark(isolate, heap_, page_space, &marking_stack, NULL,
+                        false);
+    IterateRoots(isolate, &mark, !invoke_api_callbacks);
+    DrainMarkingStack(isolate, &mark);
+    FinishMarking(isolate, page_space, invoke_api_callbacks, &mark);
+  }
+  Epilogue(isolate, invoke_api_callbacks);
+}
+
+
+void GCMarker::FinishMarking(Isolate* isolate,
+                             PageSpace* page_space,
+                             bool invoke_api_callbacks,
+                             MarkingVisitor* visitor) {
+  IterateWeakReferences(isolate, visitor);
   MarkingWeakVisitor mark_weak;
   IterateWeakRoots(isolate, &mark_weak, invoke_api_callbacks);
-  mark.Finalize();
+  visitor->Finalize();
+  marked_bytes_ = visitor->marked_bytes();
   ProcessWeakTables(page_space);
   ProcessObjectIdTable(isolate);
+}
 
 
-  Epilogue(isolate, invoke_api_callbacks);
+
+IncrementalMarker::IncrementalMarker(Isolate* isolate,
+                                     Heap* heap,
+                                     PageSpace* page_space)
+    : isolate_(isolate),
+      page_space_(page_space),
+      marker_(heap),
+      marking_stack_(new MarkingStack()),
+      rescan_stack_(new MarkingStack()),
+      visitor_(NULL) {
+  visitor_ = new MarkingVisitor(isolate, heap, page_space, marking_stack_,
+                                NULL, true);
+}
+
+
+IncrementalMarker::~IncrementalMarker() {
+  // Marking is abandoned if the isolate shuts down while it is in progress.
+  while (!marking_stack_->IsEmpty()) {
+    marking_stack_->Pop();
+  }
+  while (!rescan_stack_->IsEmpty()) {
+    rescan_stack_->Pop();
+  }
+  delete visitor_;
+  delete rescan_stack_;
+  delete marking_stack_;
+}
+
+
+void IncrementalMarker::Start() {
+  ASSERT(!isolate_->marking_in_progress());
+  marker_.IterateRoots(isolate_, visitor_, false);
+  isolate_->set_marking_in_progress(true);
+}
+
+
+bool IncrementalMarker::Step(intptr_t budget_in_bytes) {
+  ASSERT(isolate_->marking_in_progress());
+  ProcessRescanStack();
+  marker_.ProcessMarkingStack(visitor_, budget_in_bytes);
+  return marking_stack_->IsEmpty();
+}
+
+
+void IncrementalMarker::Finish(bool invoke_api_callbacks) {
+  ASSERT(isolate_->marking_in_progress());
+  if (invoke_api_callbacks) {
+    isolate_->gc_prologue_callbacks().Invoke();
+  }
+  // Objects marked in earlier steps are not visited again, so the store
+  // buffer cannot be rebuilt as part of marking. Instead the marked objects
+  // in it are rescanned, and its entries are kept unless they are garbage.
+  StoreBufferBlock* pending = isolate_->store_buffer()->Blocks();
+  for (StoreBufferBlock* block = pending;
+       block != NULL;
+       block = block->next()) {
+    intptr_t count = block->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = block->At(i);
+      if (raw_obj->IsMarked()) {
+        Rescan(raw_obj);
+      }
+    }
+  }
+  ProcessRescanStack();
+  marker_.IterateRoots(isolate_, visitor_, !invoke_api_callbacks);
+  marker_.DrainMarkingStack(isolate_, visitor_);
+  marker_.FinishMarking(isolate_, page_space_, invoke_api_callbacks, visitor_);
+  isolate_->set_marking_in_progress(false);
+  StoreBuffer* store_buffer = isolate_->store_buffer();
+  while (pending != NULL) {
+    StoreBufferBlock* next = pending->next();
+    intptr_t count = pending->Count();
+    for (intptr_t i = 0; i < count; i++) {
+      RawObject* raw_obj = pending->At(i);
+      ASSERT(raw_obj->IsRemembered());
+      if (raw_obj->IsMarked()) {
+        store_buffer->AddObjectGC(raw_obj);
+      }
+    }
+    delete pending;
+    pending = next;
+  }
+  marker_.Epilogue(isolate_, invoke_api_callbacks);
+}
+
+
+void IncrementalMarker::Rescan(RawObject* raw_obj) {
+  ASSERT(raw_obj->IsOldObject() && raw_obj->IsMarked());
+  rescan_stack_->Push(raw_obj);
+}
+
+
+void IncrementalMarker::ProcessRescanStack() {
+  while (!rescan_stack_->IsEmpty()) {
+    RawObject* raw_obj = rescan_stack_->Pop();
+    visitor_->VisitingOldObject(raw_obj);
+    raw_obj->VisitPointers(visitor_);
+  }
+  visitor_->VisitingOldObject(NULL);
 }
 
 }  // namespace dart
@@ -13,23 +13,32 @@ namespace dart {
 class HandleVisitor;
 class Heap;
 class Isolate;
+class MarkingStack;
 class MarkingVisitor;
+class MarkingWorkList;
 class ObjectPointerVisitor;
 class PageSpace;
+class RawObject;
 class RawWeakProperty;
 
 // The class GCMarker is used to mark reachable old generation objects as part
 // of the mark-sweep collection. The marking bit used is defined in RawObject.
 class GCMarker : public ValueObject {
  public:
-  explicit GCMarker(Heap* heap) : heap_(heap) { }
+  explicit GCMarker(Heap* heap) : heap_(heap), marked_bytes_(0) { }
   ~GCMarker() { }
 
   void MarkObjects(Isolate* isolate,
                    PageSpace* page_space,
                    bool invoke_api_callbacks);
 
+  // Size of all objects marked by the last call to MarkObjects.
+  intptr_t marked_words() const { return marked_bytes_ >> kWordSizeLog2; }
+
  private:
+  friend class IncrementalMarker;
+  friend class MarkTask;
+
   void Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void Epilogue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateRoots(Isolate* isolate,
@@ -40,16 +49,72 @@ class GCMarker : public ValueObject {
                         bool visit_prologue_weak_persistent_handles);
   void IterateWeakReferences(Isolate* isolate, MarkingVisitor* visitor);
   void DrainMarkingStack(Isolate* isolate, MarkingVisitor* visitor);
+  void ProcessMarkingStack(MarkingVisitor* visitor, intptr_t budget_in_bytes);
+  void DrainMarkingStackParallel(Isolate* isolate,
+                                 MarkingVisitor* visitor,
+                                 MarkingWorkList* work_list);
+  void MarkObjectsParallel(Isolate* isolate,
+                           PageSpace* page_space,
+                           bool invoke_api_callbacks,
+                           MarkingVisitor* visitor,
+                           MarkingWorkList* work_list,
+                           intptr_t num_helpers);
+  void FinishMarking(Isolate* isolate,
+                     PageSpace* page_space,
+                     bool invoke_api_callbacks,
+                     MarkingVisitor* visitor);
   void ProcessWeakProperty(RawWeakProperty* raw_weak, MarkingVisitor* visitor);
   void ProcessWeakTables(PageSpace* page_space);
   void ProcessObjectIdTable(Isolate* isolate);
 
-
   Heap* heap_;
+  intptr_t marked_bytes_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
 
+
+// The class IncrementalMarker marks the old generation in steps taken between
+// scavenges (see --incremental_marking). While marking is in progress, the
+// write barrier adds marked objects that are written to to the store buffer
+// and the marker visits them again. Marking is completed in the pause of the
+// next mark-sweep, which also visits the roots again.
+class IncrementalMarker {
+ public:
+  IncrementalMarker(Isolate* isolate, Heap* heap, PageSpace* page_space);
+  ~IncrementalMarker();
+
+  // Marks the objects referenced from the roots and turns on the marking
+  // write barrier.
+  void Start();
+
+  // Visits about budget_in_bytes worth of marked objects. Returns true if
+  // there is no marking work left.
+  bool Step(intptr_t budget_in_bytes);
+
+  // Completes marking and turns off the marking write barrier.
+  void Finish(bool invoke_api_callbacks);
+
+  // Queues a marked object whose pointers may have changed to be visited
+  // again.
+  void Rescan(RawObject* raw_obj);
+
+  // Size of all objects marked, valid after Finish.
+  intptr_t marked_words() const { return marker_.marked_words(); }
+
+ private:
+  void ProcessRescanStack();
+
+  Isolate* isolate_;
+  PageSpace* page_space_;
+  GCMarker marker_;
+  MarkingStack* marking_stack_;
+  MarkingStack* rescan_stack_;
+  MarkingVisitor* visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(IncrementalMarker);
+};
+
 }  // namespace dart
 
 #endif  // VM_GC_MARKER_H_
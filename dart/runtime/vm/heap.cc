@@ -30,6 +30,8 @@ DEFINE_FLAG(bool, verify_before_gc, false,
 DEFINE_FLAG(bool, verify_after_gc, false,
             "Enables heap verification after GC.");
 DEFINE_FLAG(bool, gc_at_alloc, false, "GC at every allocation.");
+DEFINE_FLAG(bool, incremental_marking, false,
+            "Mark the old gen in steps between scavenges (ia32 and x64 only).");
 DEFINE_FLAG(int, new_gen_heap_size, 32, "new gen heap size in MB,"
             "e.g: --new_gen_heap_size=64 allocates a 64MB new gen heap");
 DEFINE_FLAG(int, old_gen_heap_size, Heap::kHeapSizeInMB,
@@ -166,6 +168,9 @@ void Heap::CollectGarbage(Space space, ApiCallbacks api_callbacks) {
       if (new_space_->HadPromotionFailure()) {
         // Old collections should call the API callbacks.
         CollectGarbage(kOld, kInvokeApiCallbacks);
+      } else if (old_space_->AdvanceIncrementalMarking()) {
+        // Incremental marking has run out of work, finish the collection.
+        CollectGarbage(kOld, kInvokeApiCallbacks);
       }
       break;
     }
@@ -216,6 +221,21 @@ void Heap::CollectAllGarbage() {
 }
 
 
+IncrementalMarker* Heap::incremental_marker() const {
+  return old_space_->incremental_marker();
+}
+
+
+PretenuringPolicy* Heap::pretenuring_policy() const {
+  return new_space_->pretenuring_policy();
+}
+
+
+bool Heap::ShouldPretenure(intptr_t class_id) const {
+  return new_space_->pretenuring_policy()->ShouldPretenure(class_id);
+}
+
+
 void Heap::SetGrowthControlState(bool state) {
   old_space_->SetGrowthControlState(state);
 }
@@ -243,6 +263,16 @@ uword Heap::EndAddress() {
 }
 
 
+uword Heap::PretenureTopAddress() {
+  return old_space_->PretenureTopAddress();
+}
+
+
+uword Heap::PretenureEndAddress() {
+  return old_space_->PretenureEndAddress();
+}
+
+
 void Heap::Init(Isolate* isolate) {
   ASSERT(isolate->heap() == NULL);
   Heap* heap = new Heap();
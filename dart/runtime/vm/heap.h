@@ -16,6 +16,7 @@
 namespace dart {
 
 // Forward declarations.
+class IncrementalMarker;
 class Isolate;
 class ObjectPointerVisitor;
 class ObjectSet;
@@ -25,6 +26,7 @@ DECLARE_FLAG(bool, verbose_gc);
 DECLARE_FLAG(bool, verify_before_gc);
 DECLARE_FLAG(bool, verify_after_gc);
 DECLARE_FLAG(bool, gc_at_alloc);
+DECLARE_FLAG(bool, incremental_marking);
 
 class Heap {
  public:
@@ -150,6 +152,9 @@ class Heap {
   // Accessors for inlined allocation in generated code.
   uword TopAddress();
   uword EndAddress();
+  // The pretenuring area in old space (see PageSpace::RefillPretenureArea).
+  uword PretenureTopAddress();
+  uword PretenureEndAddress();
   static intptr_t new_space_offset() { return OFFSET_OF(Heap, new_space_); }
 
   // Initialize the heap and register it with the isolate.
@@ -228,6 +233,17 @@ class Heap {
 
   bool gc_in_progress() const { return gc_in_progress_; }
 
+  // The marker of the old generation while it is being marked incrementally,
+  // NULL otherwise.
+  IncrementalMarker* incremental_marker() const;
+
+  PageSpace* old_space() const { return old_space_; }
+
+  // Scavenge survival statistics, used to decide whether optimized code
+  // allocates objects of a class directly in old space.
+  PretenuringPolicy* pretenuring_policy() const;
+  bool ShouldPretenure(intptr_t class_id) const;
+
   static bool IsAllocatableInNewSpace(intptr_t size) {
     return size <= kNewAllocatableSize;
   }
@@ -0,0 +1,489 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap_image.h"
+
+#include "platform/utils.h"
+#include "vm/class_table.h"
+#include "vm/dart.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/pages.h"
+#include "vm/snapshot.h"
+#include "vm/thread.h"
+#include "vm/virtual_memory.h"
+#include "vm/visitor.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, snapshot_heap_image, false,
+    "Create isolates from a relocatable image of the heap of the first "
+    "isolate created from the same full snapshot. Snapshot buffers must not "
+    "be freed or changed as long as the VM runs.");
+DECLARE_FLAG(bool, trace_isolates);
+
+Mutex* HeapImage::mutex_ = NULL;
+HeapImage* HeapImage::images_ = NULL;
+
+
+// A page of the captured heap and where its objects are in the image.
+struct CapturedPage {
+  uword start;
+  uword end;
+  intptr_t offset;
+};
+
+
+static int CompareCapturedPages(const void* a, const void* b) {
+  uword a_start = reinterpret_cast<const CapturedPage*>(a)->start;
+  uword b_start = reinterpret_cast<const CapturedPage*>(b)->start;
+  if (a_start < b_start) {
+    return -1;
+  }
+  return (a_start > b_start) ? 1 : 0;
+}
+
+
+// Encodes the pointers of objects copied into the image as tagged offsets of
+// their targets in the image and records the offsets of the pointers.
+class ImageRelocationVisitor : public ObjectPointerVisitor {
+ public:
+  ImageRelocationVisitor(Isolate* isolate,
+                         const CapturedPage* pages,
+                         intptr_t num_pages,
+                         uword image_start)
+      : ObjectPointerVisitor(isolate),
+        pages_(pages),
+        num_pages_(num_pages),
+        image_start_(image_start),
+        page_(NULL),
+        relocations_(NULL),
+        num_relocations_(0),
+        capacity_(0),
+        failed_(false) { }
+
+  ~ImageRelocationVisitor() {
+    free(relocations_);
+  }
+
+  void set_page(const CapturedPage* page) { page_ = page; }
+
+  bool failed() const { return failed_; }
+
+  // Encodes a pointer to an object. Pointers to objects outside of the image
+  // are only kept if the objects are in the VM isolate, which is shared by
+  // all isolates. Returns false for any other pointer.
+  bool Encode(RawObject* raw, uword* value, bool* relocate) const {
+    *value = reinterpret_cast<uword>(raw);
+    *relocate = false;
+    if (!raw->IsHeapObject()) {
+      return true;
+    }
+    uword addr = RawObject::ToAddr(raw);
+    const CapturedPage* page = FindPage(addr);
+    if (page != NULL) {
+      *value = page->offset + (addr - page->start) + kHeapObjectTag;
+      *relocate = true;
+      return true;
+    }
+    return Dart::vm_isolate()->heap()->Contains(addr);
+  }
+
+  virtual void VisitPointers(RawObject** first, RawObject** last) {
+    for (RawObject** current = first; current <= last; current++) {
+      uword value = 0;
+      bool relocate = false;
+      if (!Encode(*current, &value, &relocate)) {
+        failed_ = true;
+        return;
+      }
+      if (relocate) {
+        uword offset =
+            page_->offset + (reinterpret_cast<uword>(current) - page_->start);
+        *reinterpret_cast<uword*>(image_start_ + offset) = value;
+        AddRelocation(offset);
+      }
+    }
+  }
+
+  // Transfers the ownership of the recorded relocations to the caller.
+  uint32_t* TakeRelocations(intptr_t* num_relocations) {
+    uint32_t* result = relocations_;
+    *num_relocations = num_relocations_;
+    relocations_ = NULL;
+    num_relocations_ = 0;
+    capacity_ = 0;
+    return result;
+  }
+
+ private:
+  const CapturedPage* FindPage(uword addr) const {
+    intptr_t low = 0;
+    intptr_t high = num_pages_ - 1;
+    while (low <= high) {
+      intptr_t mid = low + (high - low) / 2;
+      if (addr < pages_[mid].start) {
+        high = mid - 1;
+      } else if (addr >= pages_[mid].end) {
+        low = mid + 1;
+      } else {
+        return &pages_[mid];
+      }
+    }
+    return NULL;
+  }
+
+  void AddRelocation(uword offset) {
+    if (num_relocations_ == capacity_) {
+      capacity_ = (capacity_ == 0) ? 1024 : (2 * capacity_);
+      relocations_ = reinterpret_cast<uint32_t*>(
+          realloc(relocations_, capacity_ * sizeof(uint32_t)));  // NOLINT
+    }
+    relocations_[num_relocations_++] = static_cast<uint32_t>(offset);
+  }
+
+  const CapturedPage* pages_;
+  intptr_t num_pages_;
+  uword image_start_;
+  const CapturedPage* page_;
+  uint32_t* relocations_;
+  intptr_t num_relocations_;
+  intptr_t capacity_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(ImageRelocationVisitor);
+};
+
+
+HeapImage::HeapImage(const uint8_t* snapshot_buffer, intptr_t snapshot_length)
+    : snapshot_buffer_(snapshot_buffer),
+      snapshot_length_(snapshot_length),
+      memory_(NULL),
+      pages_(NULL),
+      num_pages_(0),
+      relocations_(NULL),
+      num_relocations_(0),
+      free_chunks_(NULL),
+      num_free_chunks_(0),
+      object_store_(NULL),
+      relocate_object_store_(NULL),
+      num_object_store_fields_(0),
+      class_table_(NULL),
+      relocate_class_table_(NULL),
+      num_cids_(0),
+      next_(NULL) {
+}
+
+
+HeapImage::~HeapImage() {
+  delete memory_;
+  delete[] pages_;
+  free(relocations_);
+  free(free_chunks_);
+  delete[] object_store_;
+  delete[] relocate_object_store_;
+  delete[] class_table_;
+  delete[] relocate_class_table_;
+}
+
+
+void HeapImage::InitOnce() {
+  mutex_ = new Mutex();
+}
+
+
+HeapImage* HeapImage::Lookup(const uint8_t* snapshot_buffer,
+                             intptr_t snapshot_length) {
+  for (HeapImage* image = images_; image != NULL; image = image->next_) {
+    if ((image->snapshot_buffer_ == snapshot_buffer) &&
+        (image->snapshot_length_ == snapshot_length)) {
+      return image;
+    }
+  }
+  return NULL;
+}
+
+
+bool HeapImage::HasImage(const uint8_t* snapshot_buffer) {
+  const Snapshot* snapshot = Snapshot::SetupFromBuffer(snapshot_buffer);
+  MutexLocker ml(mutex_);
+  HeapImage* image = Lookup(snapshot_buffer, snapshot->length());
+  return (image != NULL) && (image->memory_ != NULL);
+}
+
+
+void HeapImage::Capture(const uint8_t* snapshot_buffer, Isolate* isolate) {
+  const Snapshot* snapshot = Snapshot::SetupFromBuffer(snapshot_buffer);
+  {
+    MutexLocker ml(mutex_);
+    if (Lookup(snapshot_buffer, snapshot->length()) != NULL) {
+      return;
+    }
+  }
+  HeapImage* image = new HeapImage(snapshot_buffer, snapshot->length());
+  if (!image->CaptureFrom(isolate)) {
+    // Remember the failure, so that the next isolate created from the
+    // snapshot does not try again.
+    delete image;
+    image = new HeapImage(snapshot_buffer, snapshot->length());
+  }
+  if (FLAG_trace_isolates) {
+    if (image->memory_ != NULL) {
+      OS::Print("Captured heap image of snapshot: %" Pd " pages, "
+                "%" Pd " relocations\n", image->num_pages_,
+                image->num_relocations_);
+    } else {
+      OS::Print("Heap of snapshot cannot be captured as heap image\n");
+    }
+  }
+  MutexLocker ml(mutex_);
+  if (Lookup(snapshot_buffer, snapshot->length()) != NULL) {
+    // Another isolate captured the snapshot at the same time.
+    delete image;
+    return;
+  }
+  image->next_ = images_;
+  images_ = image;
+}
+
+
+bool HeapImage::Instantiate(const uint8_t* snapshot_buffer,
+                            Isolate* isolate) {
+  const Snapshot* snapshot = Snapshot::SetupFromBuffer(snapshot_buffer);
+  HeapImage* image = NULL;
+  {
+    MutexLocker ml(mutex_);
+    image = Lookup(snapshot_buffer, snapshot->length());
+  }
+  // Images are never removed, they can be used outside of the lock.
+  if ((image == NULL) || (image->memory_ == NULL)) {
+    return false;
+  }
+  image->CopyTo(isolate);
+  return true;
+}
+
+
+bool HeapImage::CaptureFrom(Isolate* isolate) {
+  NoGCScope no_gc;
+  Heap* heap = isolate->heap();
+  // Reading a full snapshot only allocates in old space. Peers and identity
+  // hash codes are kept by address outside of the heap.
+  if ((heap->UsedInWords(Heap::kNew) != 0) ||
+      (heap->PeerCount() != 0) ||
+      (heap->HashCount() != 0)) {
+    return false;
+  }
+  PageSpace* old_space = heap->old_space();
+  for (HeapPage* page = old_space->pages_; page != NULL; page = page->next()) {
+    num_pages_++;
+  }
+  for (HeapPage* page = old_space->large_pages_;
+       page != NULL;
+       page = page->next()) {
+    num_pages_++;
+  }
+  pages_ = new Page[num_pages_];
+  CapturedPage* captured =
+      isolate->current_zone()->Alloc<CapturedPage>(num_pages_);
+  intptr_t image_size = 0;
+  intptr_t index = 0;
+  for (intptr_t large = 0; large < 2; large++) {
+    HeapPage* page = (large == 0) ? old_space->pages_ : old_space->large_pages_;
+    for (; page != NULL; page = page->next()) {
+      if ((page->type() != HeapPage::kData) || page->needs_sweep()) {
+        return false;
+      }
+      intptr_t size = page->object_end() - page->object_start();
+      pages_[index].offset = image_size;
+      pages_[index].size = size;
+      pages_[index].is_large = (large != 0);
+      captured[index].start = page->object_start();
+      captured[index].end = page->object_end();
+      captured[index].offset = image_size;
+      image_size += Utils::RoundUp(size, PageSpace::kPageSize);
+      index++;
+    }
+  }
+  // Relocations are 32-bit offsets into the image.
+  if ((image_size == 0) || (image_size > kMaxUint32)) {
+    return false;
+  }
+  memory_ = VirtualMemory::Reserve(image_size);
+  if (memory_ == NULL) {
+    return false;
+  }
+  if (!memory_->Commit(false)) {
+    delete memory_;
+    memory_ = NULL;
+    return false;
+  }
+  for (intptr_t i = 0; i < num_pages_; i++) {
+    memmove(reinterpret_cast<void*>(memory_->start() + captured[i].offset),
+            reinterpret_cast<void*>(captured[i].start),
+            captured[i].end - captured[i].start);
+  }
+  qsort(captured, num_pages_, sizeof(CapturedPage), CompareCapturedPages);
+
+  ImageRelocationVisitor visitor(isolate, captured, num_pages_,
+                                 memory_->start());
+  ExternalTypedData& external = ExternalTypedData::Handle(isolate);
+  uword snapshot_start = reinterpret_cast<uword>(snapshot_buffer_);
+  uword snapshot_end = snapshot_start + snapshot_length_;
+  intptr_t free_capacity = 0;
+  bool failed = false;
+  for (intptr_t i = 0; (i < num_pages_) && !failed; i++) {
+    visitor.set_page(&captured[i]);
+    uword addr = captured[i].start;
+    while (addr < captured[i].end) {
+      RawObject* raw = RawObject::FromAddr(addr);
+      intptr_t size = raw->Size();
+      uword image_addr = memory_->start() + captured[i].offset +
+          (addr - captured[i].start);
+      intptr_t cid = raw->GetClassId();
+      if (cid == kFreeListElement) {
+        if (num_free_chunks_ == free_capacity) {
+          free_capacity = (free_capacity == 0) ? 64 : (2 * free_capacity);
+          free_chunks_ = reinterpret_cast<FreeChunk*>(
+              realloc(free_chunks_, free_capacity * sizeof(FreeChunk)));  // NOLINT
+        }
+        free_chunks_[num_free_chunks_].offset = image_addr - memory_->start();
+        free_chunks_[num_free_chunks_].size = size;
+        num_free_chunks_++;
+      } else {
+        // External data other than the token streams in the snapshot buffer
+        // belongs to the isolate which captures the image.
+        if (RawObject::IsExternalStringClassId(cid)) {
+          failed = true;
+          break;
+        }
+        if (RawObject::IsExternalTypedDataClassId(cid)) {
+          external ^= raw;
+          uword data = reinterpret_cast<uword>(external.DataAddr(0));
+          if ((data < snapshot_start) ||
+              ((data + external.LengthInBytes()) > snapshot_end)) {
+            failed = true;
+            break;
+          }
+        }
+        RawObject* image_raw = RawObject::FromAddr(image_addr);
+        if (image_raw->IsMarked()) {
+          image_raw->ClearMarkBit();
+        }
+        if (image_raw->IsWatched()) {
+          image_raw->ClearWatchedBit();
+        }
+        image_raw->ClearRememberedBit();
+        raw->VisitPointers(&visitor);
+        if (visitor.failed()) {
+          failed = true;
+          break;
+        }
+      }
+      addr += size;
+    }
+  }
+  if (failed) {
+    return false;
+  }
+  relocations_ = visitor.TakeRelocations(&num_relocations_);
+
+  // The roots of the heap.
+  ObjectStore* object_store = isolate->object_store();
+  num_object_store_fields_ = (object_store->to() - object_store->from()) + 1;
+  object_store_ = new uword[num_object_store_fields_];
+  relocate_object_store_ = new bool[num_object_store_fields_];
+  for (intptr_t i = 0; i < num_object_store_fields_; i++) {
+    if (!visitor.Encode(*(object_store->from() + i),
+                        &object_store_[i],
+                        &relocate_object_store_[i])) {
+      return false;
+    }
+  }
+  ClassTable* class_table = isolate->class_table();
+  num_cids_ = class_table->NumCids();
+  class_table_ = new uword[num_cids_];
+  relocate_class_table_ = new bool[num_cids_];
+  class_table_[0] = 0;
+  relocate_class_table_[0] = false;
+  for (intptr_t i = 1; i < num_cids_; i++) {
+    if (!visitor.Encode(class_table->At(i),
+                        &class_table_[i],
+                        &relocate_class_table_[i])) {
+      return false;
+    }
+  }
+  return memory_->Protect(VirtualMemory::kReadOnly);
+}
+
+
+void HeapImage::CopyTo(Isolate* isolate) const {
+  NoGCScope no_gc;
+  PageSpace* old_space = isolate->heap()->old_space();
+  const intptr_t kPageSize = PageSpace::kPageSize;
+
+  // The distance between the image and the heap, for each page sized chunk
+  // of the image.
+  intptr_t num_chunks = memory_->size() / kPageSize;
+  intptr_t* deltas = isolate->current_zone()->Alloc<intptr_t>(num_chunks);
+  for (intptr_t i = 0; i < num_pages_; i++) {
+    const Page& page = pages_[i];
+    HeapPage* heap_page = page.is_large ?
+        old_space->AllocateLargePage(page.size, HeapPage::kData) :
+        old_space->AllocatePage(HeapPage::kData);
+    ASSERT(static_cast<intptr_t>(
+        heap_page->object_end() - heap_page->object_start()) == page.size);
+    memmove(reinterpret_cast<void*>(heap_page->object_start()),
+            reinterpret_cast<void*>(memory_->start() + page.offset),
+            page.size);
+    old_space->used_in_words_ += (page.size >> kWordSizeLog2);
+    intptr_t delta = heap_page->object_start() - page.offset;
+    for (intptr_t chunk = page.offset / kPageSize;
+         (chunk * kPageSize) < (page.offset + page.size);
+         chunk++) {
+      deltas[chunk] = delta;
+    }
+  }
+
+  for (intptr_t i = 0; i < num_relocations_; i++) {
+    uword offset = relocations_[i];
+    uword* slot = reinterpret_cast<uword*>(offset + deltas[offset / kPageSize]);
+    uword target = *slot - kHeapObjectTag;
+    *slot = target + deltas[target / kPageSize] + kHeapObjectTag;
+  }
+
+  for (intptr_t i = 0; i < num_free_chunks_; i++) {
+    uword offset = free_chunks_[i].offset;
+    old_space->ReleaseUnused(offset + deltas[offset / kPageSize],
+                             free_chunks_[i].size);
+  }
+
+  ObjectStore* object_store = isolate->object_store();
+  ASSERT(num_object_store_fields_ ==
+         ((object_store->to() - object_store->from()) + 1));
+  for (intptr_t i = 0; i < num_object_store_fields_; i++) {
+    uword value = object_store_[i];
+    if (relocate_object_store_[i]) {
+      value += deltas[(value - kHeapObjectTag) / kPageSize];
+    }
+    *(object_store->from() + i) = reinterpret_cast<RawObject*>(value);
+  }
+  ClassTable* class_table = isolate->class_table();
+  for (intptr_t i = 1; i < num_cids_; i++) {
+    uword value = class_table_[i];
+    if (relocate_class_table_[i]) {
+      value += deltas[(value - kHeapObjectTag) / kPageSize];
+    }
+    class_table->SetAt(i, reinterpret_cast<RawClass*>(value));
+  }
+  if (FLAG_trace_isolates) {
+    OS::Print("Heap of isolate created from heap image: %" Pd " pages, "
+              "%" Pd " relocations\n", num_pages_, num_relocations_);
+  }
+}
+
+}  // namespace dart
@@ -0,0 +1,110 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_HEAP_IMAGE_H_
+#define VM_HEAP_IMAGE_H_
+
+#include "vm/allocation.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class Isolate;
+class Mutex;
+class VirtualMemory;
+
+DECLARE_FLAG(bool, snapshot_heap_image);
+
+// A HeapImage is the old space of an isolate as it looks right after reading
+// a full snapshot, laid out page by page together with the relocations needed
+// to move it to other addresses. The first isolate created from a snapshot
+// captures an image of its heap, further isolates created from the same
+// snapshot copy the pages of the image into their own heap and relocate the
+// pointers between them instead of deserializing the snapshot object by
+// object.
+//
+// Images are kept for the lifetime of the process and are shared by all its
+// isolates. The pages of an image are protected read-only. Pointers to
+// objects of the VM isolate are not relocated, and the token streams of the
+// image still point into the snapshot, so the snapshot buffer has to stay
+// alive and unchanged as long as the VM runs.
+class HeapImage {
+ public:
+  static void InitOnce();
+
+  // Initializes the heap, object store and class table of the current
+  // isolate from the image captured for the snapshot. Returns false if there
+  // is no such image, in which case the isolate is left untouched.
+  static bool Instantiate(const uint8_t* snapshot_buffer, Isolate* isolate);
+
+  // Captures an image of the heap of an isolate which has just read the
+  // snapshot. Heaps which cannot be relocated, e.g. because they contain
+  // code or external data other than the token streams of the snapshot, are
+  // not captured and are read from the snapshot again the next time.
+  static void Capture(const uint8_t* snapshot_buffer, Isolate* isolate);
+
+  // Returns true if an image was captured for the snapshot.
+  static bool HasImage(const uint8_t* snapshot_buffer);
+
+ private:
+  struct Page {
+    intptr_t offset;  // Offset of the objects of the page in the image.
+    intptr_t size;  // Size of the objects of the page.
+    bool is_large;
+  };
+
+  struct FreeChunk {
+    intptr_t offset;
+    intptr_t size;
+  };
+
+  HeapImage(const uint8_t* snapshot_buffer, intptr_t snapshot_length);
+  ~HeapImage();
+
+  // Returns the image captured for the snapshot, or NULL.
+  static HeapImage* Lookup(const uint8_t* snapshot_buffer,
+                           intptr_t snapshot_length);
+
+  bool CaptureFrom(Isolate* isolate);
+  void CopyTo(Isolate* isolate) const;
+
+  const uint8_t* snapshot_buffer_;
+  intptr_t snapshot_length_;
+
+  // The objects of all pages, each page starting at a multiple of the page
+  // size. NULL if the heap could not be captured.
+  VirtualMemory* memory_;
+
+  Page* pages_;
+  intptr_t num_pages_;
+
+  // Offsets of the pointers between objects of the image. The pointers
+  // themselves hold the tagged offsets of their targets.
+  uint32_t* relocations_;
+  intptr_t num_relocations_;
+
+  FreeChunk* free_chunks_;
+  intptr_t num_free_chunks_;
+
+  // Object store fields and class table entries, encoded like pointers in
+  // the image if the corresponding relocate flag is set.
+  uword* object_store_;
+  bool* relocate_object_store_;
+  intptr_t num_object_store_fields_;
+  uword* class_table_;
+  bool* relocate_class_table_;
+  intptr_t num_cids_;
+
+  HeapImage* next_;
+
+  static Mutex* mutex_;
+  static HeapImage* images_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapImage);
+};
+
+}  // namespace dart
+
+#endif  // VM_HEAP_IMAGE_H_
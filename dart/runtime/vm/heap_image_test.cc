@@ -0,0 +1,70 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/class_table.h"
+#include "vm/dart_api_impl.h"
+#include "vm/heap.h"
+#include "vm/heap_image.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static const char* kScriptChars =
+    "class Point {\n"
+    "  final x;\n"
+    "  final y;\n"
+    "  Point(this.x, this.y);\n"
+    "  toString() => '($x, $y)';\n"
+    "}\n"
+    "main() {\n"
+    "  var points = new List.generate(10, (i) => new Point(i, i * i));\n"
+    "  var map = new Map();\n"
+    "  for (var p in points) map[p.x] = p;\n"
+    "  return map.values.where((p) => p.y > 50).join(' ');\n"
+    "}\n";
+
+
+// Runs the script in an isolate created from the core snapshot and returns
+// the number of classes the isolate started out with.
+static intptr_t RunScript(Isolate* isolate) {
+  Heap* heap = isolate->heap();
+  intptr_t num_cids = isolate->class_table()->NumCids();
+  EXPECT(heap->Verify());
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  const char* result_chars = NULL;
+  EXPECT_VALID(Dart_StringToCString(result, &result_chars));
+  EXPECT_STREQ("(8, 64) (9, 81)", result_chars);
+  heap->CollectAllGarbage();
+  EXPECT(heap->Verify());
+  return num_cids;
+}
+
+
+UNIT_TEST_CASE(HeapImage_CreateIsolate) {
+  bool saved_heap_image = FLAG_snapshot_heap_image;
+  FLAG_snapshot_heap_image = true;
+  intptr_t num_cids = 0;
+  {
+    // The first isolate reads the snapshot and captures the image.
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    EXPECT(HeapImage::HasImage(bin::snapshot_buffer));
+    num_cids = RunScript(__test_isolate__.isolate());
+  }
+  for (intptr_t i = 0; i < 2; i++) {
+    // Further isolates are created from the image.
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    EXPECT_EQ(num_cids, RunScript(__test_isolate__.isolate()));
+  }
+  FLAG_snapshot_heap_image = saved_heap_image;
+}
+
+}  // namespace dart
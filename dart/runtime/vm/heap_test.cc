@@ -3,12 +3,21 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "vm/gc_marker.h"
 #include "vm/globals.h"
 #include "vm/heap.h"
+#include "vm/object.h"
 #include "vm/unit_test.h"
 
 namespace dart {
 
+DECLARE_FLAG(int, marker_tasks);
+DECLARE_FLAG(bool, lazy_sweep);
+DECLARE_FLAG(int, eager_sweep_pages);
+DECLARE_FLAG(int, incremental_marking_growth);
+DECLARE_FLAG(int, scavenger_tasks);
+DECLARE_FLAG(int, pretenure_min_allocations);
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
   "main() {\n"
@@ -46,4 +55,367 @@ TEST_CASE(LargeSweep) {
   Dart_ExitScope();
   heap->CollectGarbage(Heap::kOld);
 }
+
+
+TEST_CASE(ParallelMarking) {
+  const char* kScriptChars =
+  "class Node {\n"
+  "  Node(this.next, this.value);\n"
+  "  var next;\n"
+  "  var value;\n"
+  "}\n"
+  "var lists;\n"
+  "var expando;\n"
+  "build() {\n"
+  "  lists = new List(1000);\n"
+  "  expando = new Expando();\n"
+  "  for (int i = 0; i < lists.length; i++) {\n"
+  "    var node = null;\n"
+  "    for (int j = 0; j < 100; j++) {\n"
+  "      node = new Node(node, j);\n"
+  "    }\n"
+  "    lists[i] = node;\n"
+  "    expando[node] = new Node(null, i);\n"
+  "    // Only reachable through the expando.\n"
+  "    expando[new Node(null, i)] = new Node(null, i);\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < lists.length; i++) {\n"
+  "    var node = lists[i];\n"
+  "    if (expando[node].value != i) return false;\n"
+  "    int count = 0;\n"
+  "    while (node != null) {\n"
+  "      if (node.value != 99 - count) return false;\n"
+  "      node = node.next;\n"
+  "      count++;\n"
+  "    }\n"
+  "    if (count != 100) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  const intptr_t saved_marker_tasks = FLAG_marker_tasks;
+  FLAG_marker_tasks = 3;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+  EXPECT_VALID(result);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Promote the object graph so that it is traced by the old gen marker.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kOld);
+  heap->CollectGarbage(Heap::kOld);
+  result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+  FLAG_marker_tasks = saved_marker_tasks;
+}
+
+
+// The keys of the expando entries are only reachable through the values of
+// the previous entries. Their weak properties are delayed by one marker task
+// and only processed after all tasks are done, when the main task marks the
+// large values on its own.
+TEST_CASE(ParallelMarkingWeakPropertyValues) {
+  const char* kScriptChars =
+  "class Node {\n"
+  "  Node(this.value);\n"
+  "  var value;\n"
+  "}\n"
+  "var first;\n"
+  "var expando;\n"
+  "build() {\n"
+  "  expando = new Expando();\n"
+  "  first = new Node(0);\n"
+  "  var key = first;\n"
+  "  for (int i = 0; i < 10; i++) {\n"
+  "    var values = new List(4000);\n"
+  "    for (int j = 0; j < values.length; j++) {\n"
+  "      values[j] = new Node(new Node(j));\n"
+  "    }\n"
+  "    var next = new Node(i + 1);\n"
+  "    expando[key] = [values, next];\n"
+  "    key = next;\n"
+  "  }\n"
+  "}\n"
+  "garbage() {\n"
+  "  var list = new List(40000);\n"
+  "  for (int i = 0; i < list.length; i++) list[i] = new Node(-1);\n"
+  "}\n"
+  "check() {\n"
+  "  var key = first;\n"
+  "  for (int i = 0; i < 10; i++) {\n"
+  "    var entry = expando[key];\n"
+  "    var values = entry[0];\n"
+  "    for (int j = 0; j < values.length; j++) {\n"
+  "      if (values[j].value.value != j) return false;\n"
+  "    }\n"
+  "    key = entry[1];\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  const intptr_t saved_marker_tasks = FLAG_marker_tasks;
+  FLAG_marker_tasks = 3;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+  EXPECT_VALID(result);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Promote the object graph so that it is traced by the old gen marker.
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kOld);
+  // Reuse the memory of anything that was freed while still reachable.
+  for (intptr_t i = 0; i < 3; i++) {
+    EXPECT_VALID(Dart_Invoke(lib, NewString("garbage"), 0, NULL));
+    heap->CollectGarbage(Heap::kNew);
+    heap->CollectGarbage(Heap::kNew);
+  }
+  heap->CollectGarbage(Heap::kOld);
+  result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+  FLAG_marker_tasks = saved_marker_tasks;
+}
+
+
+TEST_CASE(ParallelScavenge) {
+  const char* kScriptChars =
+  "class Node {\n"
+  "  Node(this.next, this.value);\n"
+  "  var next;\n"
+  "  var value;\n"
+  "}\n"
+  "var lists;\n"
+  "var expando;\n"
+  "build() {\n"
+  "  lists = new List(1000);\n"
+  "  expando = new Expando();\n"
+  "  for (int i = 0; i < lists.length; i++) {\n"
+  "    var node = null;\n"
+  "    for (int j = 0; j < 100; j++) {\n"
+  "      node = new Node(node, j);\n"
+  "    }\n"
+  "    lists[i] = node;\n"
+  "    expando[node] = new Node(null, i);\n"
+  "    // Only reachable through the expando.\n"
+  "    expando[new Node(null, i)] = new Node(null, i);\n"
+  "    // A large object copied outside of the allocation buffers.\n"
+  "    if (i % 100 == 0) node.value = new List(4096);\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < lists.length; i++) {\n"
+  "    var node = lists[i];\n"
+  "    if (expando[node].value != i) return false;\n"
+  "    if (i % 100 == 0) {\n"
+  "      if (node.value.length != 4096) return false;\n"
+  "      node = node.next;\n"
+  "    }\n"
+  "    int count = i % 100 == 0 ? 1 : 0;\n"
+  "    while (node != null) {\n"
+  "      if (node.value != 99 - count) return false;\n"
+  "      node = node.next;\n"
+  "      count++;\n"
+  "    }\n"
+  "    if (count != 100) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n";
+  const intptr_t saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = 3;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+  EXPECT_VALID(result);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  // Objects surviving a second scavenge are promoted.
+  heap->CollectGarbage(Heap::kNew);
+  result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
 }
+
+
+TEST_CASE(LazySweep) {
+  const char* kScriptChars =
+  "var kept;\n"
+  "build() {\n"
+  "  kept = new List(10000);\n"
+  "  for (int i = 0; i < 20000; i++) {\n"
+  "    var list = new List(64);\n"
+  "    list[0] = i;\n"
+  "    if (i.isEven) kept[i ~/ 2] = list;\n"
+  "  }\n"
+  "}\n"
+  "check() {\n"
+  "  for (int i = 0; i < kept.length; i++) {\n"
+  "    if (kept[i][0] != 2 * i) return false;\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n"
+  "allocate() {\n"
+  "  var result = new List(1000);\n"
+  "  for (int i = 0; i < result.length; i++) result[i] = new List(64);\n"
+  "  return result;\n"
+  "}\n";
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  const intptr_t saved_eager_sweep_pages = FLAG_eager_sweep_pages;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_Handle result = Dart_Invoke(lib, NewString("build"), 0, NULL);
+  EXPECT_VALID(result);
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+
+  FLAG_lazy_sweep = true;
+  FLAG_eager_sweep_pages = 0;
+  heap->CollectGarbage(Heap::kOld);
+  intptr_t lazy_used = heap->UsedInWords(Heap::kOld);
+  FLAG_lazy_sweep = false;
+  heap->CollectGarbage(Heap::kOld);
+  // The marked size must match the size found by sweeping every page.
+  EXPECT_EQ(lazy_used, heap->UsedInWords(Heap::kOld));
+
+  // Promotion sweeps pages on demand.
+  FLAG_lazy_sweep = true;
+  heap->CollectGarbage(Heap::kOld);
+  Dart_EnterScope();
+  result = Dart_Invoke(lib, NewString("allocate"), 0, NULL);
+  EXPECT_VALID(result);
+  heap->CollectGarbage(Heap::kNew);
+  heap->CollectGarbage(Heap::kNew);
+  result = Dart_Invoke(lib, NewString("check"), 0, NULL);
+  EXPECT_VALID(result);
+  bool value = false;
+  EXPECT_VALID(Dart_BooleanValue(result, &value));
+  EXPECT(value);
+  Dart_ExitScope();
+  heap->CollectGarbage(Heap::kOld);
+  FLAG_lazy_sweep = saved_lazy_sweep;
+  FLAG_eager_sweep_pages = saved_eager_sweep_pages;
+}
+
+
+TEST_CASE(Pretenuring) {
+  const bool saved_pretenure = FLAG_pretenure;
+  const intptr_t saved_pretenure_min_allocations =
+      FLAG_pretenure_min_allocations;
+  FLAG_pretenure = true;
+  FLAG_pretenure_min_allocations = 100;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kNew);
+  const intptr_t kNumArrays = 1000;
+  const Array& kept = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  {
+    HANDLESCOPE(isolate);
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < kNumArrays; i++) {
+      array = Array::New(4);
+      kept.SetAt(i, array);
+    }
+  }
+  isolate->GetAndClearInterrupts();
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(heap->ShouldPretenure(kArrayCid));
+  // Code depending on the old decision is deoptimized on an interrupt.
+  EXPECT((isolate->GetAndClearInterrupts() &
+          Isolate::kPretenuringInterrupt) != 0);
+  {
+    HANDLESCOPE(isolate);
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < kNumArrays; i++) {
+      array = Array::New(4);
+    }
+  }
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(!heap->ShouldPretenure(kArrayCid));
+  EXPECT((isolate->GetAndClearInterrupts() &
+          Isolate::kPretenuringInterrupt) != 0);
+  heap->pretenuring_policy()->DeoptimizeChangedCode();
+  FLAG_pretenure = saved_pretenure;
+  FLAG_pretenure_min_allocations = saved_pretenure_min_allocations;
+}
+
+
+TEST_CASE(PretenureArea) {
+  Heap* heap = Isolate::Current()->heap();
+  PageSpace* old_space = heap->old_space();
+  uword* top = reinterpret_cast<uword*>(heap->PretenureTopAddress());
+  uword* end = reinterpret_cast<uword*>(heap->PretenureEndAddress());
+  old_space->RefillPretenureArea();
+  EXPECT(*top != 0);
+  EXPECT_EQ(PageSpace::kPretenureAreaSize,
+            static_cast<intptr_t>(*end - *top));
+  EXPECT(old_space->Contains(*top));
+  // The unused area must stay walkable.
+  EXPECT(heap->Verify());
+  old_space->RefillPretenureArea();
+  EXPECT(*top != 0);
+  EXPECT(heap->Verify());
+  // A full collection hands the area back to the sweeper.
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT_EQ(0, static_cast<intptr_t>(*top));
+  EXPECT_EQ(0, static_cast<intptr_t>(*end));
+}
+
+
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+TEST_CASE(IncrementalMarking) {
+  const bool saved_incremental_marking = FLAG_incremental_marking;
+  const intptr_t saved_incremental_marking_growth =
+      FLAG_incremental_marking_growth;
+  FLAG_incremental_marking = true;
+  FLAG_incremental_marking_growth = 0;
+  Isolate* isolate = Isolate::Current();
+  Heap* heap = isolate->heap();
+  heap->CollectGarbage(Heap::kOld);
+  const Array& array = Array::Handle(Array::New(1, Heap::kOld));
+  {
+    HANDLESCOPE(isolate);
+    // Grow the old generation enough for the next scavenge to start marking.
+    Array::Handle(Array::New(5 * MB / kWordSize, Heap::kOld));
+  }
+  heap->CollectGarbage(Heap::kNew);
+  IncrementalMarker* marker = heap->incremental_marker();
+  EXPECT(marker != NULL);
+  EXPECT(isolate->marking_in_progress());
+  // Visit everything reachable so far, the array included.
+  EXPECT(marker->Step(kIntptrMax));
+  {
+    HANDLESCOPE(isolate);
+    // Once the scope is left only the already visited array refers to the
+    // string.
+    const String& str = String::Handle(String::New("incremental",
+                                                   Heap::kOld));
+    array.SetAt(0, str);
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(heap->incremental_marker() == NULL);
+  EXPECT(!isolate->marking_in_progress());
+  const Object& element = Object::Handle(array.At(0));
+  EXPECT(element.IsString());
+  EXPECT(String::Cast(element).Equals("incremental"));
+  FLAG_incremental_marking = saved_incremental_marking;
+  FLAG_incremental_marking_growth = saved_incremental_marking_growth;
+}
+#endif  // defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+}  // namespace dart
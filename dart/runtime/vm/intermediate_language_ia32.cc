@@ -1707,7 +1707,72 @@ LocationSummary* CreateArrayInstr::MakeLocationSummary() const {
 }
 
 
+// Initializes the fields of the object in 'instance_reg' from 'start_offset'
+// up to 'end_offset' with null. Clobbers 'temp_reg' and 'null_reg'.
+static void InitializeFieldsWithNull(FlowGraphCompiler* compiler,
+                                     Register instance_reg,
+                                     intptr_t start_offset,
+                                     intptr_t end_offset,
+                                     Register temp_reg,
+                                     Register null_reg) {
+  // Objects larger than this are initialized with a loop.
+  const intptr_t kInlineInitSize = 12 * kWordSize;
+  const Immediate& raw_null =
+      Immediate(reinterpret_cast<intptr_t>(Object::null()));
+  __ movl(null_reg, raw_null);
+  if ((end_offset - start_offset) < kInlineInitSize) {
+    for (intptr_t offset = start_offset;
+         offset < end_offset;
+         offset += kWordSize) {
+      __ movl(FieldAddress(instance_reg, offset), null_reg);
+    }
+  } else if (end_offset > start_offset) {
+    // temp_reg: number of bytes still to be initialized.
+    __ movl(temp_reg, Immediate(end_offset - start_offset));
+    Label init_loop;
+    __ Bind(&init_loop);
+    __ movl(Address(instance_reg, temp_reg, TIMES_1,
+                    start_offset - kHeapObjectTag - kWordSize), null_reg);
+    __ subl(temp_reg, Immediate(kWordSize));
+    __ j(NOT_ZERO, &init_loop, Assembler::kNearJump);
+  }
+}
+
+
 void CreateArrayInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  if (compiler->ShouldPretenure(kArrayCid)) {
+    Label slow_path, done;
+    const intptr_t instance_size = Array::InstanceSize(num_elements());
+    if (instance_size <= PageSpace::kMaxPretenureObjectSize) {
+      // Allocate the array in the pretenuring area of old space.
+      ASSERT(locs()->in(0).reg() == ECX);
+      __ TryAllocateOld(instance_size, kArrayCid, &slow_path,
+                        Assembler::kFarJump, EAX, EDX);
+      __ movl(FieldAddress(EAX, Array::length_offset()),
+              Immediate(Smi::RawValue(num_elements())));
+      InitializeFieldsWithNull(compiler, EAX, Array::data_offset(),
+                               instance_size, EDX, EBX);
+      // The element type may be in new space.
+      __ StoreIntoObject(EAX,
+                         FieldAddress(EAX, Array::type_arguments_offset()),
+                         ECX);
+      __ jmp(&done);
+      __ Bind(&slow_path);
+    }
+    // Allocate the array in old space through the runtime.
+    __ PushObject(Object::ZoneHandle());  // Make room for the result.
+    __ PushObject(Smi::ZoneHandle(Smi::New(num_elements())));
+    __ pushl(ECX);
+    compiler->GenerateRuntimeCall(token_pos(),
+                                  Isolate::kNoDeoptId,
+                                  kAllocatePretenuredArrayRuntimeEntry,
+                                  2,
+                                  locs());
+    __ Drop(2);
+    __ popl(EAX);
+    __ Bind(&done);
+    return;
+  }
   // Allocate the array.  EDX = length, ECX = element type.
   ASSERT(locs()->in(0).reg() == ECX);
   __ movl(EDX, Immediate(Smi::RawValue(num_elements())));
@@ -4850,6 +4915,43 @@ LocationSummary* AllocateObjectInstr::MakeLocationSummary() const {
 
 
 void AllocateObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  if (compiler->ShouldPretenure(cls().id())) {
+    Label slow_path, done;
+    const intptr_t instance_size = cls().instance_size();
+    // Objects of parameterized classes may need to instantiate their type
+    // arguments and are always allocated through the runtime.
+    if ((ArgumentCount() == 0) &&
+        (instance_size <= PageSpace::kMaxPretenureObjectSize)) {
+      // Allocate the object in the pretenuring area of old space.
+      __ TryAllocateOld(instance_size, cls().id(), &slow_path,
+                        Assembler::kFarJump, EAX, EDX);
+      InitializeFieldsWithNull(compiler, EAX, sizeof(RawInstance),
+                               instance_size, EDX, EBX);
+      __ jmp(&done);
+      __ Bind(&slow_path);
+    }
+    // Allocate the object in old space through the runtime.
+    __ PushObject(Object::ZoneHandle());  // Make room for the result.
+    __ PushObject(cls());
+    if (ArgumentCount() == 0) {
+      __ PushObject(Object::ZoneHandle());  // No type arguments.
+      __ PushObject(Smi::ZoneHandle(Smi::New(StubCode::kNoInstantiator)));
+    } else {
+      // Copy the type arguments and the instantiator pushed as arguments.
+      __ pushl(Address(ESP, 3 * kWordSize));
+      __ pushl(Address(ESP, 3 * kWordSize));
+    }
+    compiler->GenerateRuntimeCall(token_pos(),
+                                  Isolate::kNoDeoptId,
+                                  kAllocatePretenuredObjectRuntimeEntry,
+                                  3,
+                                  locs());
+    __ Drop(3);
+    __ popl(EAX);
+    __ Bind(&done);
+    __ Drop(ArgumentCount());  // Discard arguments.
+    return;
+  }
   const Code& stub = Code::Handle(StubCode::GetAllocationStubForClass(cls()));
   const ExternalLabel label(cls().ToCString(), stub.EntryPoint());
   compiler->GenerateCall(token_pos(),
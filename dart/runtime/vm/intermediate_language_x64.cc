@@ -1618,7 +1618,69 @@ LocationSummary* CreateArrayInstr::MakeLocationSummary() const {
 }
 
 
+// Initializes the fields of the object in 'instance_reg' from 'start_offset'
+// up to 'end_offset' with null. Clobbers 'temp_reg'.
+static void InitializeFieldsWithNull(FlowGraphCompiler* compiler,
+                                     Register instance_reg,
+                                     intptr_t start_offset,
+                                     intptr_t end_offset,
+                                     Register temp_reg) {
+  // Objects larger than this are initialized with a loop.
+  const intptr_t kInlineInitSize = 12 * kWordSize;
+  __ LoadObject(R12, Object::null_object(), PP);
+  if ((end_offset - start_offset) < kInlineInitSize) {
+    for (intptr_t offset = start_offset;
+         offset < end_offset;
+         offset += kWordSize) {
+      __ movq(FieldAddress(instance_reg, offset), R12);
+    }
+  } else if (end_offset > start_offset) {
+    // temp_reg: number of bytes still to be initialized.
+    __ movq(temp_reg, Immediate(end_offset - start_offset));
+    Label init_loop;
+    __ Bind(&init_loop);
+    __ movq(Address(instance_reg, temp_reg, TIMES_1,
+                    start_offset - kHeapObjectTag - kWordSize), R12);
+    __ subq(temp_reg, Immediate(kWordSize));
+    __ j(NOT_ZERO, &init_loop, Assembler::kNearJump);
+  }
+}
+
+
 void CreateArrayInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  if (compiler->ShouldPretenure(kArrayCid)) {
+    Label slow_path, done;
+    const intptr_t instance_size = Array::InstanceSize(num_elements());
+    if (instance_size <= PageSpace::kMaxPretenureObjectSize) {
+      // Allocate the array in the pretenuring area of old space.
+      ASSERT(locs()->in(0).reg() == RBX);
+      __ TryAllocateOld(instance_size, kArrayCid, &slow_path,
+                        Assembler::kFarJump, RAX, RCX, PP);
+      __ LoadImmediate(FieldAddress(RAX, Array::length_offset()),
+                       Immediate(Smi::RawValue(num_elements())), PP);
+      InitializeFieldsWithNull(compiler, RAX, Array::data_offset(),
+                               instance_size, RCX);
+      // The element type may be in new space.
+      __ StoreIntoObject(RAX,
+                         FieldAddress(RAX, Array::type_arguments_offset()),
+                         RBX);
+      __ jmp(&done);
+      __ Bind(&slow_path);
+    }
+    // Allocate the array in old space through the runtime.
+    __ PushObject(Object::ZoneHandle(), PP);  // Make room for the result.
+    __ PushObject(Smi::ZoneHandle(Smi::New(num_elements())), PP);
+    __ pushq(RBX);
+    compiler->GenerateRuntimeCall(token_pos(),
+                                  Isolate::kNoDeoptId,
+                                  kAllocatePretenuredArrayRuntimeEntry,
+                                  2,
+                                  locs());
+    __ Drop(2);
+    __ popq(RAX);
+    __ Bind(&done);
+    return;
+  }
   // Allocate the array.  R10 = length, RBX = element type.
   ASSERT(locs()->in(0).reg() == RBX);
   __ LoadImmediate(R10, Immediate(Smi::RawValue(num_elements())), PP);
@@ -4546,6 +4608,43 @@ LocationSummary* AllocateObjectInstr::MakeLocationSummary() const {
 
 
 void AllocateObjectInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
+  if (compiler->ShouldPretenure(cls().id())) {
+    Label slow_path, done;
+    const intptr_t instance_size = cls().instance_size();
+    // Objects of parameterized classes may need to instantiate their type
+    // arguments and are always allocated through the runtime.
+    if ((ArgumentCount() == 0) &&
+        (instance_size <= PageSpace::kMaxPretenureObjectSize)) {
+      // Allocate the object in the pretenuring area of old space.
+      __ TryAllocateOld(instance_size, cls().id(), &slow_path,
+                        Assembler::kFarJump, RAX, RCX, PP);
+      InitializeFieldsWithNull(compiler, RAX, sizeof(RawInstance),
+                               instance_size, RCX);
+      __ jmp(&done);
+      __ Bind(&slow_path);
+    }
+    // Allocate the object in old space through the runtime.
+    __ PushObject(Object::ZoneHandle(), PP);  // Make room for the result.
+    __ PushObject(cls(), PP);
+    if (ArgumentCount() == 0) {
+      __ PushObject(Object::ZoneHandle(), PP);  // No type arguments.
+      __ PushObject(Smi::ZoneHandle(Smi::New(StubCode::kNoInstantiator)), PP);
+    } else {
+      // Copy the type arguments and the instantiator pushed as arguments.
+      __ pushq(Address(RSP, 3 * kWordSize));
+      __ pushq(Address(RSP, 3 * kWordSize));
+    }
+    compiler->GenerateRuntimeCall(token_pos(),
+                                  Isolate::kNoDeoptId,
+                                  kAllocatePretenuredObjectRuntimeEntry,
+                                  3,
+                                  locs());
+    __ Drop(3);
+    __ popq(RAX);
+    __ Bind(&done);
+    __ Drop(ArgumentCount());  // Discard arguments.
+    return;
+  }
   const Code& stub = Code::Handle(StubCode::GetAllocationStubForClass(cls()));
   const ExternalLabel label(cls().ToCString(), stub.EntryPoint());
   compiler->GenerateCall(token_pos(),
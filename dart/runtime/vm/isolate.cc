@@ -8,6 +8,7 @@
 #include "platform/assert.h"
 #include "platform/json.h"
 #include "lib/mirrors.h"
+#include "vm/background_compiler.h"
 #include "vm/code_observers.h"
 #include "vm/compiler_stats.h"
 #include "vm/coverage.h"
@@ -57,6 +58,9 @@ class IsolateMessageHandler : public MessageHandler {
   const char* name() const;
   void MessageNotify(Message::Priority priority);
   bool HandleMessage(Message* message);
+  bool HasIdleWork();
+  void HandleIdleWork();
+  bool UseScheduler() const { return true; }
 
 #if defined(DEBUG)
   // Check that it is safe to access this handler.
@@ -159,6 +163,20 @@ bool IsolateMessageHandler::HandleMessage(Message* message) {
 }
 
 
+bool IsolateMessageHandler::HasIdleWork() {
+  BackgroundCompiler* compiler = isolate_->background_compiler();
+  return (compiler != NULL) && compiler->HasQueuedFunctions();
+}
+
+
+void IsolateMessageHandler::HandleIdleWork() {
+  StartIsolateScope start_scope(isolate_);
+  StackZone zone(isolate_);
+  HandleScope handle_scope(isolate_);
+  isolate_->background_compiler()->CompileNext();
+}
+
+
 RawFunction* IsolateMessageHandler::ResolveCallbackFunction() {
   ASSERT(isolate_->object_store()->unhandled_exception_handler() != NULL);
   String& callback_name = String::Handle(isolate_);
@@ -277,6 +295,7 @@ void BaseIsolate::AssertCurrent(BaseIsolate* isolate) {
 
 Isolate::Isolate()
     : store_buffer_(),
+      marking_in_progress_(0),
       message_notify_callback_(NULL),
       name_(NULL),
       start_time_(OS::GetCurrentTimeMicros()),
@@ -291,6 +310,7 @@ Isolate::Isolate()
       api_state_(NULL),
       stub_code_(NULL),
       debugger_(NULL),
+      background_compiler_(NULL),
       single_step_(false),
       random_(),
       simulator_(NULL),
@@ -328,6 +348,7 @@ Isolate::~Isolate() {
   delete api_state_;
   delete stub_code_;
   delete debugger_;
+  delete background_compiler_;
 #if defined(USING_SIMULATOR)
   delete simulator_;
 #endif
@@ -402,6 +423,7 @@ Isolate* Isolate::Init(const char* name_prefix) {
 
   result->debugger_ = new Debugger();
   result->debugger_->Initialize(result);
+  result->background_compiler_ = new BackgroundCompiler(result);
   if (FLAG_trace_isolates) {
     if (name_prefix == NULL || strcmp(name_prefix, "vm-isolate") != 0) {
       OS::Print("[+] Starting isolate:\n"
@@ -809,6 +831,11 @@ void Isolate::VisitObjectPointers(ObjectPointerVisitor* visitor,
   // Visit objects in the debugger.
   debugger()->VisitObjectPointers(visitor);
 
+  // Visit the functions queued for optimization.
+  if (background_compiler() != NULL) {
+    background_compiler()->VisitObjectPointers(visitor);
+  }
+
   // Visit objects that are being used for deoptimization.
   if (deopt_context() != NULL) {
     deopt_context()->VisitObjectPointers(visitor);
@@ -22,6 +22,7 @@ namespace dart {
 // Forward declarations.
 class AbstractType;
 class ApiState;
+class BackgroundCompiler;
 class Array;
 class Class;
 class CodeIndexTable;
@@ -105,6 +106,16 @@ class Isolate : public BaseIsolate {
     return OFFSET_OF(Isolate, store_buffer_);
   }
 
+  // While the old generation is being marked incrementally, the write barrier
+  // also records marked old objects that are written to in the store buffer.
+  bool marking_in_progress() const { return marking_in_progress_ != 0; }
+  void set_marking_in_progress(bool value) {
+    marking_in_progress_ = value ? 1 : 0;
+  }
+  static intptr_t marking_in_progress_offset() {
+    return OFFSET_OF(Isolate, marking_in_progress_);
+  }
+
   ClassTable* class_table() { return &class_table_; }
   static intptr_t class_table_offset() {
     return OFFSET_OF(Isolate, class_table_);
@@ -217,12 +228,14 @@ class Isolate : public BaseIsolate {
     kMessageInterrupt = 0x2,  // An interrupt to process an out of band message.
     kStoreBufferInterrupt = 0x4,  // An interrupt to process the store buffer.
     kVmStatusInterrupt = 0x8,     // An interrupt to process a status request.
+    kPretenuringInterrupt = 0x10,  // A pretenuring decision has changed.
 
     kInterruptsMask =
         kApiInterrupt |
         kMessageInterrupt |
         kStoreBufferInterrupt |
-        kVmStatusInterrupt,
+        kVmStatusInterrupt |
+        kPretenuringInterrupt,
   };
 
   void ScheduleInterrupts(uword interrupt_bits);
@@ -273,6 +286,10 @@ class Isolate : public BaseIsolate {
 
   Debugger* debugger() const { return debugger_; }
 
+  BackgroundCompiler* background_compiler() const {
+    return background_compiler_;
+  }
+
   void set_single_step(bool value) { single_step_ = value; }
   bool single_step() const { return single_step_; }
   static intptr_t single_step_offset() {
@@ -417,6 +434,7 @@ class Isolate : public BaseIsolate {
   static ThreadLocalKey isolate_key;
 
   StoreBuffer store_buffer_;
+  uword marking_in_progress_;
   ClassTable class_table_;
   MegamorphicCacheTable megamorphic_cache_table_;
   Dart_MessageNotifyCallback message_notify_callback_;
@@ -433,6 +451,7 @@ class Isolate : public BaseIsolate {
   ApiState* api_state_;
   StubCode* stub_code_;
   Debugger* debugger_;
+  BackgroundCompiler* background_compiler_;
   bool single_step_;
   Random random_;
   Simulator* simulator_;
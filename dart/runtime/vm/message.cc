@@ -4,63 +4,101 @@
 
 #include "vm/message.h"
 
+#include "vm/atomic.h"
+
 namespace dart {
 
-MessageQueue::MessageQueue() {
-  head_ = NULL;
-  tail_ = NULL;
+MessageQueue::MessageQueue()
+    : stub_(Message::kIllegalPort, Message::kIllegalPort, NULL, 0,
+            Message::kNormalPriority) {
+  head_ = &stub_;
+  tail_ = &stub_;
 }
 
 
 MessageQueue::~MessageQueue() {
   // Ensure that all pending messages have been released.
   Clear();
-  ASSERT(head_ == NULL);
+  ASSERT(IsEmpty());
+}
+
+
+void MessageQueue::Push(Message* msg) {
+  msg->next_ = NULL;
+  Message* previous = tail_;
+  uword old_value;
+  do {
+    old_value = reinterpret_cast<uword>(previous);
+    previous = reinterpret_cast<Message*>(AtomicOperations::CompareAndSwapWord(
+        reinterpret_cast<uword*>(&tail_),
+        old_value,
+        reinterpret_cast<uword>(msg)));
+  } while (reinterpret_cast<uword>(previous) != old_value);
+  // Until the previous tail is linked to msg, the consumer sees the queue
+  // ending at the previous tail. Linking with a compare-and-swap makes the
+  // contents of msg visible before the link.
+  AtomicOperations::CompareAndSwapWord(
+      reinterpret_cast<uword*>(&previous->next_),
+      0,
+      reinterpret_cast<uword>(msg));
 }
 
 
 void MessageQueue::Enqueue(Message* msg) {
   // Make sure messages are not reused.
   ASSERT(msg->next_ == NULL);
-  if (head_ == NULL) {
-    // Only element in the queue.
-    ASSERT(tail_ == NULL);
-    head_ = msg;
-    tail_ = msg;
-  } else {
-    ASSERT(tail_ != NULL);
-    // Append at the tail.
-    tail_->next_ = msg;
-    tail_ = msg;
-  }
+  ASSERT(msg != &stub_);
+  Push(msg);
 }
 
 
 Message* MessageQueue::Dequeue() {
   Message* result = head_;
-  if (result != NULL) {
-    head_ = result->next_;
-    // The following update to tail_ is not strictly needed.
-    if (head_ == NULL) {
-      tail_ = NULL;
+  Message* next = result->next_;
+  if (result == &stub_) {
+    if (next == NULL) {
+      return NULL;
+    }
+    // Skip the stub.
+    head_ = next;
+    result = next;
+    next = next->next_;
+  }
+  if (next == NULL) {
+    // The result is the last message of the queue, or a message is being
+    // enqueued after it. Put the stub back behind it, so that the result can
+    // be unlinked without touching tail_.
+    if (result != tail_) {
+      // An Enqueue has swapped tail_ but not yet linked the result to its
+      // message. Report the queue as empty until it has.
+      return NULL;
     }
+    Push(&stub_);
+    next = result->next_;
+    if (next == NULL) {
+      // A concurrent Enqueue got in between the check of tail_ and the push
+      // of the stub and has not linked its message yet.
+      return NULL;
+    }
+  }
+  head_ = next;
 #if defined(DEBUG)
-    result->next_ = result;  // Make sure to trigger ASSERT in Enqueue.
+  result->next_ = result;  // Make sure to trigger ASSERT in Enqueue.
 #endif  // DEBUG
-    return result;
-  }
-  return NULL;
+  return result;
+}
+
+
+bool MessageQueue::IsEmpty() const {
+  return (head_ == &stub_) && (stub_.next_ == NULL);
 }
 
 
 void MessageQueue::Clear() {
-  Message* cur = head_;
-  head_ = NULL;
-  tail_ = NULL;
+  Message* cur = Dequeue();
   while (cur != NULL) {
-    Message* next = cur->next_;
     delete cur;
-    cur = next;
+    cur = Dequeue();
   }
 }
 
@@ -65,6 +65,11 @@ class Message {
 };
 
 // There is a message queue per isolate.
+//
+// Messages can be enqueued by any number of threads concurrently without
+// taking a lock. Dequeue, IsEmpty and Clear must only be called by a single
+// thread at a time, e.g. while holding the lock of the message handler
+// owning the queue.
 class MessageQueue {
  public:
   MessageQueue();
@@ -76,14 +81,26 @@ class MessageQueue {
   // message is available.  This function will not block.
   Message* Dequeue();
 
+  // Returns true if there is no message to dequeue. A message which is being
+  // enqueued concurrently may not be seen until its Enqueue returned.
+  bool IsEmpty() const;
+
   // Clear all messages from the message queue.
   void Clear();
 
  private:
   friend class MessageQueueTestPeer;
 
+  // Links msg after the last message of the queue.
+  void Push(Message* msg);
+
+  // The queue is a singly linked list from head_ to tail_ which always
+  // contains at least one message, the stub_ when it is otherwise empty.
+  // Enqueue swaps tail_ atomically and then links the previous tail to the
+  // new message, Dequeue only follows and updates head_.
   Message* head_;
   Message* tail_;
+  Message stub_;
 
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
@@ -3,11 +3,15 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/message_handler.h"
+#include "vm/atomic.h"
 #include "vm/port.h"
 #include "vm/dart.h"
 
 namespace dart {
 
+DEFINE_FLAG(int, message_time_slice_millis, 10,
+            "Let other message handlers run after handling messages for this "
+            "amount of time, if any are waiting for the same worker.");
 DECLARE_FLAG(bool, trace_isolates);
 
 
@@ -82,13 +86,22 @@ void MessageHandler::Run(ThreadPool* pool,
   start_callback_ = start_callback;
   end_callback_ = end_callback;
   callback_data_ = data;
+  StartTask();
+}
+
+
+void MessageHandler::StartTask() {
+  ASSERT(task_ == NULL);
   task_ = new MessageHandlerTask(this);
-  pool_->Run(task_);
+  if (UseScheduler()) {
+    pool_->Schedule(task_);
+  } else {
+    pool_->Run(task_);
+  }
 }
 
 
 void MessageHandler::PostMessage(Message* message) {
-  MonitorLocker ml(&monitor_);
   if (FLAG_trace_isolates) {
     const char* source_name = "<native code>";
     Isolate* source_isolate = Isolate::Current();
@@ -103,6 +116,10 @@ void MessageHandler::PostMessage(Message* message) {
               source_name, message->reply_port(), name(), message->dest_port());
   }
 
+  // The queues accept messages without holding the monitor_. The monitor_ is
+  // only needed if no task is scheduled to handle the message. The enqueue
+  // is a full memory barrier, so either task_ is read as NULL here, or the
+  // running task sees the message before it clears task_, see TaskCallback.
   Message::Priority saved_priority = message->priority();
   if (message->IsOOB()) {
     oob_queue_->Enqueue(message);
@@ -112,8 +129,10 @@ void MessageHandler::PostMessage(Message* message) {
   message = NULL;  // Do not access message.  May have been deleted.
 
   if (pool_ != NULL && task_ == NULL) {
-    task_ = new MessageHandlerTask(this);
-    pool_->Run(task_);
+    MonitorLocker ml(&monitor_);
+    if (pool_ != NULL && task_ == NULL) {
+      StartTask();
+    }
   }
 
   // Invoke any custom message notification.
@@ -121,6 +140,11 @@ void MessageHandler::PostMessage(Message* message) {
 }
 
 
+bool MessageHandler::HasPendingMessages() const {
+  return !oob_queue_->IsEmpty() || !queue_->IsEmpty();
+}
+
+
 Message* MessageHandler::DequeueMessage(Message::Priority min_priority) {
   // TODO(turnidge): Add assert that monitor_ is held here.
   Message* message = oob_queue_->Dequeue();
@@ -132,7 +156,8 @@ Message* MessageHandler::DequeueMessage(Message::Priority min_priority) {
 
 
 bool MessageHandler::HandleMessages(bool allow_normal_messages,
-                                    bool allow_multiple_normal_messages) {
+                                    bool allow_multiple_normal_messages,
+                                    int64_t deadline) {
   // TODO(turnidge): Add assert that monitor_ is held here.
   bool result = true;
   Message::Priority min_priority = (allow_normal_messages
@@ -162,6 +187,13 @@ bool MessageHandler::HandleMessages(bool allow_normal_messages,
       // Some callers want to process only one normal message and then quit.
       break;
     }
+    if ((deadline > 0) &&
+        (OS::GetCurrentTimeMillis() >= deadline) &&
+        pool_->HasWaitingTasks()) {
+      // Our time slice is used up and others are waiting for our worker. The
+      // remaining messages are handled by a new task, see TaskCallback.
+      break;
+    }
     message = DequeueMessage(min_priority);
   }
   return result;
@@ -176,7 +208,7 @@ bool MessageHandler::HandleNextMessage() {
 #if defined(DEBUG)
   CheckAccess();
 #endif
-  return HandleMessages(true, false);
+  return HandleMessages(true, false, 0);
 }
 
 
@@ -185,7 +217,7 @@ bool MessageHandler::HandleOOBMessages() {
 #if defined(DEBUG)
   CheckAccess();
 #endif
-  return HandleMessages(false, false);
+  return HandleMessages(false, false, 0);
 }
 
 
@@ -206,13 +238,32 @@ void MessageHandler::TaskCallback() {
       monitor_.Enter();
     }
 
-    // Handle any pending messages for this message handler.
+    // Handle any pending messages for this message handler. Once there are
+    // none, do idle work, checking for new messages after each step. Stop
+    // early if other scheduled tasks are waiting once the time slice is used
+    // up.
     if (ok) {
-      ok = HandleMessages(true, true);
+      int64_t deadline = 0;
+      if (UseScheduler() && (FLAG_message_time_slice_millis > 0)) {
+        deadline = OS::GetCurrentTimeMillis() + FLAG_message_time_slice_millis;
+      }
+      ok = HandleMessages(true, true, deadline);
+      while (ok && HasLivePorts() && !HasPendingMessages() && HasIdleWork()) {
+        monitor_.Exit();
+        HandleIdleWork();
+        monitor_.Enter();
+        ok = HandleMessages(true, true, deadline);
+      }
     }
-    task_ = NULL;  // No task in queue.
-
-    if (!ok || !HasLivePorts()) {
+    // No task in queue. Clear task_ with a full memory barrier before
+    // looking at the queues a last time, so that a message posted meanwhile
+    // is either seen here or schedules a new task itself.
+    AtomicOperations::CompareAndSwapWord(reinterpret_cast<uword*>(&task_),
+                                         reinterpret_cast<uword>(task_),
+                                         0);
+    if (ok && HasLivePorts() && HasPendingMessages()) {
+      StartTask();
+    } else if (!ok || !HasLivePorts()) {
       if (FLAG_trace_isolates) {
         OS::Print("[-] Stopping message handler (%s):\n"
                   "\thandler:    %s\n",
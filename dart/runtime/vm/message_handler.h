@@ -101,6 +101,9 @@ class MessageHandler {
   // ------------ END PortMap API ------------
 
   // Custom message notification.  Optionally provided by subclass.
+  //
+  // Called on the posting thread after the message has been enqueued,
+  // without holding the lock of this handler.
   virtual void MessageNotify(Message::Priority priority);
 
   // Handles a single message.  Provided by subclass.
@@ -108,6 +111,19 @@ class MessageHandler {
   // Returns true on success.
   virtual bool HandleMessage(Message* message) = 0;
 
+  // Work done on the thread pool while no messages are pending, such as
+  // compiling functions queued for optimization. Optionally provided by
+  // subclass. HandleIdleWork should do a small step at a time, as messages
+  // which arrive meanwhile wait until it returns.
+  virtual bool HasIdleWork() { return false; }
+  virtual void HandleIdleWork() { }
+
+  // Returns true if the tasks of this handler run on the bounded scheduler
+  // workers of the thread pool (see ThreadPool::Schedule) rather than on
+  // threads of their own (see ThreadPool::Run). Only handlers which give up
+  // their worker in a timely manner should use the scheduler.
+  virtual bool UseScheduler() const { return false; }
+
  private:
   friend class PortMap;
   friend class MessageHandlerTestPeer;
@@ -116,15 +132,25 @@ class MessageHandler {
   // Called by MessageHandlerTask to process our task queue.
   void TaskCallback();
 
+  // Creates task_ and hands it to the thread pool.
+  void StartTask();
+
+  // Returns true if any message is waiting in either queue.
+  bool HasPendingMessages() const;
+
   // Dequeue the next message.  Prefer messages from the oob_queue_ to
   // messages from the queue_.
   Message* DequeueMessage(Message::Priority min_priority);
 
-  // Handles any pending messages.
+  // Handles any pending messages. If deadline is not 0, stops once the time
+  // in milliseconds passes it while other tasks wait for the thread pool.
   bool HandleMessages(bool allow_normal_messages,
-                      bool allow_multiple_normal_messages);
+                      bool allow_multiple_normal_messages,
+                      int64_t deadline);
 
-  Monitor monitor_;  // Protects all fields in MessageHandler.
+  // Protects all fields in MessageHandler. Messages are enqueued without
+  // it, but only dequeued while holding it.
+  Monitor monitor_;
   MessageQueue* queue_;
   MessageQueue* oob_queue_;
   intptr_t control_ports_;  // The number of open control ports usually 0 or 1.
@@ -4,6 +4,8 @@
 
 #include "platform/assert.h"
 #include "vm/message.h"
+#include "vm/os.h"
+#include "vm/thread.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -17,7 +19,7 @@ class MessageQueueTestPeer {
   bool HasMessage() const {
     // We don't really need to grab the monitor during the unit test,
     // but it doesn't hurt.
-    bool result = (queue_->head_ != NULL);
+    bool result = !queue_->IsEmpty();
     return result;
   }
 
@@ -99,4 +101,59 @@ TEST_CASE(MessageQueue_Clear) {
   // msg1 and msg2 already delete by FlushAll.
 }
 
+
+struct EnqueueInfo {
+  MessageQueue* queue;
+  Dart_Port port;
+  intptr_t count;
+};
+
+
+static void EnqueueMessages(uword param) {
+  EnqueueInfo* info = reinterpret_cast<EnqueueInfo*>(param);
+  MessageQueue* queue = info->queue;
+  Dart_Port port = info->port;
+  intptr_t count = info->count;
+  for (intptr_t i = 0; i < count; i++) {
+    // The reply port numbers the messages of each sender.
+    queue->Enqueue(new Message(port, i, NULL, 0, Message::kNormalPriority));
+  }
+}
+
+
+UNIT_TEST_CASE(MessageQueue_ConcurrentEnqueue) {
+  const intptr_t kNumSenders = 4;
+  const intptr_t kCount = 10000;
+  const int kMaxSleep = 20 * 1000;  // 20 seconds.
+  MessageQueue queue;
+  EnqueueInfo info[kNumSenders];
+  Dart_Port next[kNumSenders];
+  for (intptr_t i = 0; i < kNumSenders; i++) {
+    info[i].queue = &queue;
+    info[i].port = i;
+    info[i].count = kCount;
+    next[i] = 0;
+    Thread::Start(EnqueueMessages, reinterpret_cast<uword>(&info[i]));
+  }
+
+  // Each sender's messages are dequeued in the order they were enqueued.
+  intptr_t received = 0;
+  int sleep = 0;
+  while (received < (kNumSenders * kCount) && sleep < kMaxSleep) {
+    Message* msg = queue.Dequeue();
+    if (msg == NULL) {
+      OS::Sleep(1);
+      sleep++;
+      continue;
+    }
+    intptr_t sender = msg->dest_port();
+    EXPECT_EQ(next[sender], msg->reply_port());
+    next[sender] = msg->reply_port() + 1;
+    delete msg;
+    received++;
+  }
+  EXPECT_EQ(kNumSenders * kCount, received);
+  EXPECT(queue.Dequeue() == NULL);
+}
+
 }  // namespace dart
@@ -15750,6 +15750,16 @@ void JSRegExp::set_num_bracket_expressions(intptr_t value) const {
 }
 
 
+void JSRegExp::set_native_code(intptr_t char_size, const Code& code) const {
+  if (char_size == 1) {
+    StorePointer(&raw_ptr()->one_byte_code_, code.raw());
+  } else {
+    ASSERT(char_size == 2);
+    StorePointer(&raw_ptr()->two_byte_code_, code.raw());
+  }
+}
+
+
 RawJSRegExp* JSRegExp::New(intptr_t len, Heap::Space space) {
   ASSERT(Isolate::Current()->object_store()->jsregexp_class() !=
          Class::null());
@@ -15787,7 +15797,7 @@ RawJSRegExp* JSRegExp::FromDataStartAddress(void* data) {
 
 
 const char* JSRegExp::Flags() const {
-  switch (raw_ptr()->flags_) {
+  switch (raw_ptr()->flags_ & (kGlobal | kIgnoreCase | kMultiLine)) {
     case kGlobal | kIgnoreCase | kMultiLine :
     case kIgnoreCase | kMultiLine :
       return "im";
@@ -525,6 +525,14 @@ class Object {
         !raw()->IsRemembered()) {
       raw()->SetRememberedBit();
       Isolate::Current()->store_buffer()->AddObject(raw());
+    } else if (FLAG_incremental_marking && raw()->IsMarked() &&
+               raw()->IsOldObject() && !raw()->IsRemembered()) {
+      // The incremental marker rescans marked objects that are written to.
+      Isolate* isolate = Isolate::Current();
+      if (isolate->marking_in_progress()) {
+        raw()->SetRememberedBit();
+        isolate->store_buffer()->AddObject(raw());
+      }
     }
   }
 
@@ -5131,6 +5139,7 @@ class OneByteString : public AllStatic {
   friend class String;
   friend class ExternalOneByteString;
   friend class SnapshotReader;
+  friend class Jscre;  // Matches directly on the character data.
 };
 
 
@@ -5222,6 +5231,7 @@ class TwoByteString : public AllStatic {
   friend class Class;
   friend class String;
   friend class SnapshotReader;
+  friend class Jscre;  // Matches directly on the character data.
 };
 
 
@@ -5295,6 +5305,7 @@ class ExternalOneByteString : public AllStatic {
   friend class Class;
   friend class String;
   friend class SnapshotReader;
+  friend class Jscre;  // Matches directly on the character data.
 };
 
 
@@ -5366,6 +5377,7 @@ class ExternalTwoByteString : public AllStatic {
   friend class Class;
   friend class String;
   friend class SnapshotReader;
+  friend class Jscre;  // Matches directly on the character data.
 };
 
 
@@ -6179,6 +6191,7 @@ class JSRegExp : public Instance {
     kGlobal = 1,
     kIgnoreCase = 2,
     kMultiLine = 4,
+    kNoNativeCode = 8,  // The pattern cannot be compiled to native code.
   };
 
   bool is_initialized() const { return (raw_ptr()->type_ != kUnitialized); }
@@ -6188,14 +6201,26 @@ class JSRegExp : public Instance {
   bool is_global() const { return (raw_ptr()->flags_ & kGlobal); }
   bool is_ignore_case() const { return (raw_ptr()->flags_ & kIgnoreCase); }
   bool is_multi_line() const { return (raw_ptr()->flags_ & kMultiLine); }
+  bool has_no_native_code() const {
+    return (raw_ptr()->flags_ & kNoNativeCode);
+  }
 
   RawString* pattern() const { return raw_ptr()->pattern_; }
+  // The native matcher for subjects with char_size bytes per character.
+  RawCode* native_code(intptr_t char_size) const {
+    return (char_size == 1) ? raw_ptr()->one_byte_code_
+                            : raw_ptr()->two_byte_code_;
+  }
   RawSmi* num_bracket_expressions() const {
     return raw_ptr()->num_bracket_expressions_;
   }
 
   void set_pattern(const String& pattern) const;
   void set_num_bracket_expressions(intptr_t value) const;
+  void set_native_code(intptr_t char_size, const Code& code) const;
+  void set_has_no_native_code() const {
+    raw_ptr()->flags_ |= kNoNativeCode;
+  }
   void set_is_global() const { raw_ptr()->flags_ |= kGlobal; }
   void set_is_ignore_case() const { raw_ptr()->flags_ |= kIgnoreCase; }
   void set_is_multi_line() const { raw_ptr()->flags_ |= kMultiLine; }
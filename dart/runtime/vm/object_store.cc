@@ -70,7 +70,9 @@ ObjectStore::ObjectStore()
     preallocated_stack_trace_(Stacktrace::null()),
     receive_port_create_function_(Function::null()),
     lookup_receive_port_function_(Function::null()),
-    handle_message_function_(Function::null()) {
+    handle_message_function_(Function::null()),
+    transferable_typed_data_class_(Class::null()),
+    pretenured_code_(GrowableObjectArray::null()) {
 }
 
 
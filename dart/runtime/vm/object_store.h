@@ -400,6 +400,20 @@ class ObjectStore {
     handle_message_function_ = function.raw();
   }
 
+  RawClass* transferable_typed_data_class() const {
+    return transferable_typed_data_class_;
+  }
+  void set_transferable_typed_data_class(const Class& value) {
+    transferable_typed_data_class_ = value.raw();
+  }
+
+  RawGrowableObjectArray* pretenured_code() const {
+    return pretenured_code_;
+  }
+  void set_pretenured_code(const GrowableObjectArray& value) {
+    pretenured_code_ = value.raw();
+  }
+
   // Visit all object pointers.
   void VisitObjectPointers(ObjectPointerVisitor* visitor);
 
@@ -481,10 +495,13 @@ class ObjectStore {
   RawFunction* receive_port_create_function_;
   RawFunction* lookup_receive_port_function_;
   RawFunction* handle_message_function_;
+  RawClass* transferable_typed_data_class_;
+  RawGrowableObjectArray* pretenured_code_;
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&handle_message_function_);
+    return reinterpret_cast<RawObject**>(&pretenured_code_);
   }
 
+  friend class HeapImage;
   friend class SnapshotReader;
 
   DISALLOW_COPY_AND_ASSIGN(ObjectStore);
@@ -29,6 +29,32 @@ DEFINE_FLAG(int, code_collection_interval_in_us, 30000000,
             "Time between attempts to collect unused code.");
 DEFINE_FLAG(bool, log_code_drop, false,
             "Emit a log message when pointers to unused code are dropped.");
+DEFINE_FLAG(bool, lazy_sweep, false,
+            "Sweep most old gen pages on allocation instead of during GC.");
+DEFINE_FLAG(int, eager_sweep_pages, 4,
+            "Number of old gen pages swept during GC when lazy sweeping.");
+DEFINE_FLAG(int, incremental_marking_growth, 50,
+            "Start incremental marking once the old gen has grown by this "
+            "percentage since the last GC.");
+DEFINE_FLAG(int, incremental_marking_step_kb, 256,
+            "The amount of old gen objects visited by each incremental "
+            "marking step.");
+DECLARE_FLAG(bool, incremental_marking);
+
+// Incremental marking is not started before the old gen has grown by at
+// least this much since the last GC.
+static const intptr_t kMinIncrementalMarkingGrowthInWords = 4 * MBInWords;
+
+
+static bool IsIncrementalMarkingEnabled() {
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+  return FLAG_incremental_marking;
+#else
+  // Only the ia32 and x64 write barriers know about incremental marking.
+  return false;
+#endif
+}
+
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   ASSERT(memory->size() > VirtualMemory::PageSize());
@@ -39,6 +65,7 @@ HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   result->memory_ = memory;
   result->next_ = NULL;
   result->executable_ = is_executable;
+  result->needs_sweep_ = false;
   return result;
 }
 
@@ -60,7 +87,9 @@ void HeapPage::VisitObjects(ObjectVisitor* visitor) const {
   uword end_addr = object_end();
   while (obj_addr < end_addr) {
     RawObject* raw_obj = RawObject::FromAddr(obj_addr);
-    visitor->VisitObject(raw_obj);
+    if (!needs_sweep_ || raw_obj->IsMarked()) {
+      visitor->VisitObject(raw_obj);
+    }
     obj_addr += raw_obj->Size();
   }
   ASSERT(obj_addr == end_addr);
@@ -72,7 +101,11 @@ void HeapPage::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
   uword end_addr = object_end();
   while (obj_addr < end_addr) {
     RawObject* raw_obj = RawObject::FromAddr(obj_addr);
-    obj_addr += raw_obj->VisitPointers(visitor);
+    if (!needs_sweep_ || raw_obj->IsMarked()) {
+      obj_addr += raw_obj->VisitPointers(visitor);
+    } else {
+      obj_addr += raw_obj->Size();
+    }
   }
   ASSERT(obj_addr == end_addr);
 }
@@ -83,7 +116,8 @@ RawObject* HeapPage::FindObject(FindObjectVisitor* visitor) const {
   uword end_addr = object_end();
   while (obj_addr < end_addr) {
     RawObject* raw_obj = RawObject::FromAddr(obj_addr);
-    if (raw_obj->FindObject(visitor)) {
+    if ((!needs_sweep_ || raw_obj->IsMarked()) &&
+        raw_obj->FindObject(visitor)) {
       return raw_obj;  // Found object, return it.
     }
     obj_addr += raw_obj->Size();
@@ -122,6 +156,13 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
       capacity_in_words_(0),
       used_in_words_(0),
       sweeping_(false),
+      sweep_cursor_(NULL),
+      sweep_cursor_previous_(NULL),
+      incremental_marker_(NULL),
+      incremental_marking_threshold_in_words_(
+          kMinIncrementalMarkingGrowthInWords),
+      pretenure_top_(0),
+      pretenure_end_(0),
       page_space_controller_(FLAG_heap_growth_space_ratio,
                              FLAG_heap_growth_rate,
                              FLAG_heap_growth_time_ratio) {
@@ -129,6 +170,7 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
 
 
 PageSpace::~PageSpace() {
+  delete incremental_marker_;
   FreePages(pages_);
   FreePages(large_pages_);
 }
@@ -208,11 +250,34 @@ void PageSpace::FreePages(HeapPage* pages) {
 uword PageSpace::TryAllocate(intptr_t size,
                              HeapPage::PageType type,
                              GrowthPolicy growth_policy) {
+  return TryAllocateInternal(size, type, growth_policy, false);
+}
+
+
+uword PageSpace::TryAllocateBump(intptr_t size, GrowthPolicy growth_policy) {
+  return TryAllocateInternal(size, HeapPage::kData, growth_policy, true);
+}
+
+
+static uword TryAllocateFromFreeList(FreeList* freelist,
+                                     intptr_t size,
+                                     bool bump) {
+  return bump ? freelist->TryAllocateBump(size) : freelist->TryAllocate(size);
+}
+
+
+uword PageSpace::TryAllocateInternal(intptr_t size,
+                                     HeapPage::PageType type,
+                                     GrowthPolicy growth_policy,
+                                     bool bump) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
   uword result = 0;
   if (size < kAllocatablePageSize) {
-    result = freelist_[type].TryAllocate(size);
+    result = TryAllocateFromFreeList(&freelist_[type], size, bump);
+    while ((result == 0) && SweepNextPage()) {
+      result = TryAllocateFromFreeList(&freelist_[type], size, bump);
+    }
     if ((result == 0) &&
         (page_space_controller_.CanGrowPageSpace(size) ||
          growth_policy == kForceGrowth) &&
@@ -255,6 +320,34 @@ uword PageSpace::TryAllocate(intptr_t size,
 }
 
 
+void PageSpace::ReleaseUnused(uword addr, intptr_t size) {
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  ASSERT(Contains(addr, HeapPage::kData));
+  freelist_[HeapPage::kData].Free(addr, size);
+  used_in_words_ -= (size >> kWordSizeLog2);
+}
+
+
+void PageSpace::RefillPretenureArea() {
+  if (pretenure_top_ < pretenure_end_) {
+    ReleaseUnused(pretenure_top_, pretenure_end_ - pretenure_top_);
+  }
+  pretenure_top_ = 0;
+  pretenure_end_ = 0;
+  uword area = TryAllocateInternal(kPretenureAreaSize,
+                                   HeapPage::kData,
+                                   kControlGrowth,
+                                   false);
+  if (area == 0) {
+    // Optimized code keeps allocating through the runtime.
+    return;
+  }
+  FreeListElement::AsElement(area, kPretenureAreaSize);
+  pretenure_top_ = area;
+  pretenure_end_ = area + kPretenureAreaSize;
+}
+
+
 bool PageSpace::Contains(uword addr) const {
   HeapPage* page = pages_;
   while (page != NULL) {
@@ -453,6 +546,9 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
   NoHandleScope no_handles(isolate);
 
+  // Mark bits of live objects on unswept pages are only cleared by sweeping.
+  CompleteSweep();
+
   if (FLAG_print_free_list_before_gc) {
     OS::Print("Data Freelist (before GC):\n");
     freelist_[HeapPage::kData].Print();
@@ -469,8 +565,17 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   const int64_t start = OS::GetCurrentTimeMicros();
 
   // Mark all reachable old-gen objects.
-  GCMarker marker(heap_);
-  marker.MarkObjects(isolate, this, invoke_api_callbacks);
+  intptr_t marked_words = 0;
+  if (incremental_marker_ != NULL) {
+    incremental_marker_->Finish(invoke_api_callbacks);
+    marked_words = incremental_marker_->marked_words();
+    delete incremental_marker_;
+    incremental_marker_ = NULL;
+  } else {
+    GCMarker marker(heap_);
+    marker.MarkObjects(isolate, this, invoke_api_callbacks);
+    marked_words = marker.marked_words();
+  }
 
   int64_t mid1 = OS::GetCurrentTimeMicros();
 
@@ -478,6 +583,9 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   // Reset the freelists and setup sweeping.
   freelist_[HeapPage::kData].Reset();
   freelist_[HeapPage::kExecutable].Reset();
+  // The unused part of the pretenuring area is reclaimed by the sweeper.
+  pretenure_top_ = 0;
+  pretenure_end_ = 0;
 
   int64_t mid2 = OS::GetCurrentTimeMicros();
 
@@ -486,7 +594,18 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
   HeapPage* prev_page = NULL;
   HeapPage* page = pages_;
+  intptr_t swept_pages = 0;
   while (page != NULL) {
+    if (FLAG_lazy_sweep && (swept_pages >= FLAG_eager_sweep_pages)) {
+      // Leave the remaining pages to be swept when the free lists run dry.
+      sweep_cursor_ = page;
+      sweep_cursor_previous_ = prev_page;
+      while (page != NULL) {
+        page->set_needs_sweep(true);
+        page = page->next();
+      }
+      break;
+    }
     HeapPage* next_page = page->next();
     intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
     if (page_in_use == 0) {
@@ -495,6 +614,7 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
       used_in_words += (page_in_use >> kWordSizeLog2);
       prev_page = page;
     }
+    swept_pages++;
     // Advance to the next page.
     page = next_page;
   }
@@ -516,9 +636,18 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
     page = next_page;
   }
 
+  if (sweep_cursor_ != NULL) {
+    // The unswept pages have not been accounted for yet, but the marker knows
+    // the size of all live objects.
+    used_in_words = marked_words;
+  }
+
   // Record data and print if requested.
   intptr_t used_before_in_words = used_in_words_;
   used_in_words_ = used_in_words;
+  incremental_marking_threshold_in_words_ = used_in_words +
+      Utils::Maximum(used_in_words / 100 * FLAG_incremental_marking_growth,
+                     kMinIncrementalMarkingGrowthInWords);
 
   int64_t end = OS::GetCurrentTimeMicros();
 
@@ -551,6 +680,59 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 }
 
 
+bool PageSpace::SweepNextPage() {
+  HeapPage* page = sweep_cursor_;
+  if (page == NULL) {
+    return false;
+  }
+  ASSERT(page->needs_sweep());
+  HeapPage* next_page = page->next();
+  page->set_needs_sweep(false);
+  GCSweeper sweeper(heap_);
+  intptr_t page_in_use = sweeper.SweepPage(page, &freelist_[page->type()]);
+  if (page_in_use == 0) {
+    // The live size was already accounted for by the last mark-sweep.
+    FreePage(page, sweep_cursor_previous_);
+  } else {
+    sweep_cursor_previous_ = page;
+  }
+  if ((next_page != NULL) && next_page->needs_sweep()) {
+    sweep_cursor_ = next_page;
+  } else {
+    sweep_cursor_ = NULL;
+    sweep_cursor_previous_ = NULL;
+  }
+  return true;
+}
+
+
+void PageSpace::CompleteSweep() {
+  while (SweepNextPage()) {
+  }
+}
+
+
+bool PageSpace::AdvanceIncrementalMarking() {
+  if (!IsIncrementalMarkingEnabled()) {
+    return false;
+  }
+  if (incremental_marker_ == NULL) {
+    if (used_in_words_ < incremental_marking_threshold_in_words_) {
+      return false;
+    }
+    Isolate* isolate = Isolate::Current();
+    NoHandleScope no_handles(isolate);
+    // Mark bits of unswept pages would be mistaken for marking progress.
+    CompleteSweep();
+    incremental_marker_ = new IncrementalMarker(isolate, heap_, this);
+    incremental_marker_->Start();
+    return false;
+  }
+  NoHandleScope no_handles(Isolate::Current());
+  return incremental_marker_->Step(FLAG_incremental_marking_step_kb * KB);
+}
+
+
 PageSpaceController::PageSpaceController(int heap_growth_ratio,
                                          int heap_growth_rate,
                                          int garbage_collection_time_ratio)
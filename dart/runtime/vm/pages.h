@@ -13,9 +13,11 @@ namespace dart {
 
 DECLARE_FLAG(bool, collect_code);
 DECLARE_FLAG(bool, log_code_drop);
+DECLARE_FLAG(bool, lazy_sweep);
 
 // Forward declarations.
 class Heap;
+class IncrementalMarker;
 class ObjectPointerVisitor;
 
 // An aligned page containing old generation objects. Alignment is used to be
@@ -46,6 +48,11 @@ class HeapPage {
     return executable_ ? kExecutable : kData;
   }
 
+  // A page that still has to be swept after the last mark-sweep contains
+  // unmarked dead objects, which are skipped when visiting the page.
+  bool needs_sweep() const { return needs_sweep_; }
+  void set_needs_sweep(bool value) { needs_sweep_ = value; }
+
   void VisitObjects(ObjectVisitor* visitor) const;
   void VisitObjectPointers(ObjectPointerVisitor* visitor) const;
 
@@ -74,6 +81,7 @@ class HeapPage {
   HeapPage* next_;
   uword object_end_;
   bool executable_;
+  bool needs_sweep_;
 
   friend class PageSpace;
 
@@ -186,6 +194,35 @@ class PageSpace {
                     HeapPage::PageType type = HeapPage::kData,
                     GrowthPolicy growth_policy = kControlGrowth);
 
+  // Allocates a data object out of a bump allocation area of the free list
+  // (see FreeList::TryAllocateBump). Used for promoted objects.
+  uword TryAllocateBump(intptr_t size,
+                        GrowthPolicy growth_policy = kControlGrowth);
+
+  // Returns the unused end [addr, addr + size) of a data allocation to the
+  // free list, e.g. the rest of a promotion buffer of a scavenger task.
+  void ReleaseUnused(uword addr, intptr_t size);
+
+  // Optimized code allocates objects of pretenured classes of up to
+  // kMaxPretenureObjectSize bytes by bumping pretenure_top_ in an area taken
+  // from the free list. The unused part of the area stays formatted as a
+  // free list element which stores its size in its third word, so
+  // allocations leave at least kPretenureAreaReserve bytes free.
+  static const intptr_t kPretenureAreaSize = 16 * KB;
+  static const intptr_t kMaxPretenureObjectSize = kPretenureAreaSize / 8;
+  static const intptr_t kPretenureAreaReserve = 2 * kObjectAlignment;
+
+  // Replaces the pretenuring area with a fresh one. Called from the runtime
+  // once optimized code has run out of space in the area.
+  void RefillPretenureArea();
+
+  uword PretenureTopAddress() {
+    return reinterpret_cast<uword>(&pretenure_top_);
+  }
+  uword PretenureEndAddress() {
+    return reinterpret_cast<uword>(&pretenure_end_);
+  }
+
   intptr_t UsedInWords() const { return used_in_words_; }
   intptr_t CapacityInWords() const { return capacity_in_words_; }
 
@@ -208,6 +245,17 @@ class PageSpace {
   // Collect the garbage in the page space using mark-sweep.
   void MarkSweep(bool invoke_api_callbacks);
 
+  // Sweep all pages left unswept by the last mark-sweep (see --lazy_sweep).
+  void CompleteSweep();
+
+  // Called after each scavenge to start incremental marking once the old
+  // generation has grown enough since the last mark-sweep, or to advance the
+  // marking in progress. Returns true if there is no marking work left and
+  // the mark-sweep should be completed.
+  bool AdvanceIncrementalMarking();
+
+  IncrementalMarker* incremental_marker() const { return incremental_marker_; }
+
   void StartEndAddress(uword* start, uword* end) const;
 
   void SetGrowthControlState(bool state) {
@@ -237,6 +285,10 @@ class PageSpace {
 
   static const intptr_t kAllocatablePageSize = 64 * KB;
 
+  uword TryAllocateInternal(intptr_t size,
+                            HeapPage::PageType type,
+                            GrowthPolicy growth_policy,
+                            bool bump);
   HeapPage* AllocatePage(HeapPage::PageType type);
   void FreePage(HeapPage* page, HeapPage* previous_page);
   HeapPage* AllocateLargePage(intptr_t size, HeapPage::PageType type);
@@ -245,6 +297,10 @@ class PageSpace {
 
   static intptr_t LargePageSizeFor(intptr_t size);
 
+  // Sweeps the next page left unswept by the last mark-sweep. Returns false
+  // if there are no unswept pages left.
+  bool SweepNextPage();
+
   bool CanIncreaseCapacityInWords(intptr_t increase_in_words) {
     ASSERT(capacity_in_words_ <= max_capacity_in_words_);
     return increase_in_words <= (max_capacity_in_words_ - capacity_in_words_);
@@ -266,8 +322,26 @@ class PageSpace {
   // Keep track whether a MarkSweep is currently running.
   bool sweeping_;
 
+  // The unswept pages form a contiguous run in pages_ starting at
+  // sweep_cursor_. Pages allocated since the last mark-sweep are appended
+  // after this run and never need sweeping.
+  HeapPage* sweep_cursor_;
+  HeapPage* sweep_cursor_previous_;
+
+  // Marking state while incremental marking is in progress, NULL otherwise.
+  IncrementalMarker* incremental_marker_;
+
+  // Incremental marking is started once used_in_words_ reaches this size.
+  intptr_t incremental_marking_threshold_in_words_;
+
+  // The pretenuring area, empty if both are 0. The whole area is counted
+  // as used until it is released.
+  uword pretenure_top_;
+  uword pretenure_end_;
+
   PageSpaceController page_space_controller_;
 
+  friend class HeapImage;
   friend class PageSpaceController;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpace);
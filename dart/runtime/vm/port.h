@@ -61,28 +61,48 @@ class PortMap: public AllStatic {
     bool live;
   } Entry;
 
-  // Allocate a new unique port.
-  static Dart_Port AllocatePort();
+  // The ports are spread over a fixed number of shards by their id, each
+  // with its own lock and hashmap, so that messages posted to different
+  // ports rarely contend for the same lock. The ids of a shard are all
+  // congruent to its index modulo kNumShards.
+  typedef struct {
+    // Lock protecting access to the shard.
+    Mutex* mutex;
+
+    // Hashmap of ports.
+    Entry* map;
+    intptr_t capacity;
+    intptr_t used;
+    intptr_t deleted;
+
+    Dart_Port next_port;
+  } Shard;
+
+  static const intptr_t kNumShards = 16;
+
+  static Shard* ShardFor(Dart_Port port) {
+    return &shards_[static_cast<uint64_t>(port) % kNumShards];
+  }
+
+  // Allocate a new unique port in the shard.
+  static Dart_Port AllocatePort(Shard* shard);
 
   static bool IsActivePort(Dart_Port id);
   static bool IsLivePort(Dart_Port id);
 
-  static intptr_t FindPort(Dart_Port port);
-  static void Rehash(intptr_t new_capacity);
-
-  static void MaintainInvariants();
+  static intptr_t FindPort(Shard* shard, Dart_Port port);
+  static intptr_t Hash(Dart_Port port, intptr_t capacity) {
+    return (static_cast<uint64_t>(port) / kNumShards) % capacity;
+  }
+  static void Rehash(Shard* shard, intptr_t new_capacity);
 
-  // Lock protecting access to the port map.
-  static Mutex* mutex_;
+  static void MaintainInvariants(Shard* shard);
 
-  // Hashmap of ports.
-  static Entry* map_;
+  static Shard shards_[kNumShards];
   static MessageHandler* deleted_entry_;
-  static intptr_t capacity_;
-  static intptr_t used_;
-  static intptr_t deleted_;
 
-  static Dart_Port next_port_;
+  // Shard in which the next port is created. Only incremented atomically.
+  static uintptr_t next_shard_;
 };
 
 }  // namespace dart
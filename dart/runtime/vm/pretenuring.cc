@@ -0,0 +1,216 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/pretenuring.h"
+
+#include "vm/class_table.h"
+#include "vm/code_generator.h"
+#include "vm/isolate.h"
+#include "vm/json_stream.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/stack_frame.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, pretenure, false,
+            "Allocate objects of allocation sites with a high scavenge "
+            "survival rate directly in old space from optimized code.");
+DEFINE_FLAG(int, pretenure_survival_ratio, 80,
+            "Pretenure an allocation site once at least this percentage of "
+            "its objects survive a scavenge.");
+DEFINE_FLAG(int, pretenure_min_allocations, 1000,
+            "Number of objects an allocation site must have allocated "
+            "between two scavenges to change its pretenuring decision.");
+DECLARE_FLAG(bool, trace_deoptimization);
+DECLARE_FLAG(bool, trace_deoptimization_verbose);
+
+
+PretenuringPolicy::PretenuringPolicy()
+    : table_length_(512) {
+  table_ = reinterpret_cast<Element*>(
+      calloc(table_length_, sizeof(Element)));  // NOLINT
+}
+
+
+PretenuringPolicy::~PretenuringPolicy() {
+  free(table_);
+}
+
+
+void PretenuringPolicy::Grow(intptr_t class_id) {
+  intptr_t new_table_length = table_length_;
+  while (new_table_length <= class_id) {
+    new_table_length *= 2;
+  }
+  Element* new_table = reinterpret_cast<Element*>(
+      realloc(table_, new_table_length * sizeof(Element)));  // NOLINT
+  memset(&new_table[table_length_], 0,
+         (new_table_length - table_length_) * sizeof(Element));
+  table_ = new_table;
+  table_length_ = new_table_length;
+}
+
+
+bool PretenuringPolicy::Update() {
+  bool changed = false;
+  for (intptr_t i = 0; i < table_length_; i++) {
+    Element* element = &table_[i];
+    if (element->allocated_ >= FLAG_pretenure_min_allocations) {
+      intptr_t survival_ratio =
+          (element->survived_ * 100) / element->allocated_;
+      bool pretenured = element->pretenured_;
+      if (survival_ratio >= FLAG_pretenure_survival_ratio) {
+        pretenured = true;
+      } else if (survival_ratio < (FLAG_pretenure_survival_ratio / 2)) {
+        // Only revert well below the threshold to avoid flip-flopping.
+        pretenured = false;
+      }
+      if (pretenured != element->pretenured_) {
+        element->pretenured_ = pretenured;
+        element->changed_ = true;
+        changed = true;
+      }
+    }
+    element->total_allocated_ += element->allocated_;
+    element->total_survived_ += element->survived_;
+    element->allocated_ = 0;
+    element->survived_ = 0;
+  }
+  return changed;
+}
+
+
+void PretenuringPolicy::RegisterDependentCode(const Code& code,
+                                              intptr_t class_id) {
+  ASSERT(code.is_optimized());
+  ObjectStore* object_store = Isolate::Current()->object_store();
+  GrowableObjectArray& dependent = GrowableObjectArray::Handle(
+      object_store->pretenured_code());
+  if (dependent.IsNull()) {
+    dependent = GrowableObjectArray::New(Heap::kOld);
+    object_store->set_pretenured_code(dependent);
+  }
+  // Try to find and reuse cleared WeakProperty to avoid allocating new one.
+  WeakProperty& weak_property = WeakProperty::Handle();
+  for (intptr_t i = 0; i < dependent.Length(); i++) {
+    weak_property ^= dependent.At(i);
+    if (weak_property.key() == Code::null()) {
+      weak_property.set_key(code);
+      weak_property.set_value(Smi::Handle(Smi::New(class_id)));
+      return;
+    }
+  }
+  weak_property = WeakProperty::New(Heap::kOld);
+  weak_property.set_key(code);
+  weak_property.set_value(Smi::Handle(Smi::New(class_id)));
+  dependent.Add(weak_property, Heap::kOld);
+}
+
+
+void PretenuringPolicy::DeoptimizeChangedCode() {
+  const GrowableObjectArray& dependent = GrowableObjectArray::Handle(
+      Isolate::Current()->object_store()->pretenured_code());
+  if (dependent.IsNull()) {
+    return;
+  }
+
+  // Find the registered code of the changed classes and clear its entries.
+  const GrowableObjectArray& changed_code =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  WeakProperty& weak_property = WeakProperty::Handle();
+  Code& code = Code::Handle();
+  Smi& class_id = Smi::Handle();
+  for (intptr_t i = 0; i < dependent.Length(); i++) {
+    weak_property ^= dependent.At(i);
+    code ^= weak_property.key();
+    if (code.IsNull()) {
+      // Code was garbage collected already, or the entry is unused.
+      continue;
+    }
+    class_id ^= weak_property.value();
+    ASSERT(class_id.Value() < table_length_);
+    if (table_[class_id.Value()].changed_) {
+      changed_code.Add(code);
+      weak_property.set_key(Code::Handle());
+      weak_property.set_value(Object::null_object());
+    }
+  }
+  for (intptr_t i = 0; i < table_length_; i++) {
+    table_[i].changed_ = false;
+  }
+  if (changed_code.Length() == 0) {
+    return;
+  }
+
+  // Deoptimize all changed code on the stack.
+  {
+    DartFrameIterator iterator;
+    StackFrame* frame = iterator.NextFrame();
+    while (frame != NULL) {
+      code = frame->LookupDartCode();
+      if (code.is_optimized()) {
+        for (intptr_t i = 0; i < changed_code.Length(); i++) {
+          if (changed_code.At(i) == code.raw()) {
+            if (FLAG_trace_deoptimization ||
+                FLAG_trace_deoptimization_verbose) {
+              const Function& function = Function::Handle(code.function());
+              OS::PrintErr("Deoptimizing %s because a pretenuring decision "
+                           "changed.\n", function.ToFullyQualifiedCString());
+            }
+            DeoptimizeAt(code, frame->pc());
+            break;
+          }
+        }
+      }
+      frame = iterator.NextFrame();
+    }
+  }
+
+  // Switch functions that use changed code to unoptimized code.
+  Function& function = Function::Handle();
+  for (intptr_t i = 0; i < changed_code.Length(); i++) {
+    code ^= changed_code.At(i);
+    function ^= code.function();
+    if (function.CurrentCode() == code.raw()) {
+      ASSERT(function.HasOptimizedCode());
+      if (FLAG_trace_deoptimization || FLAG_trace_deoptimization_verbose) {
+        OS::PrintErr("Switching %s to unoptimized code because a pretenuring "
+                     "decision changed.\n",
+                     function.ToFullyQualifiedCString());
+      }
+      function.SwitchToUnoptimizedCode();
+    }
+  }
+}
+
+
+void PretenuringPolicy::PrintToJSONStream(JSONStream* stream) {
+  ClassTable* class_table = Isolate::Current()->class_table();
+  Class& cls = Class::Handle();
+  String& str = String::Handle();
+  JSONObject jsobj(stream);
+  jsobj.AddProperty("type", "PretenuringPolicy");
+  jsobj.AddProperty("enabled", FLAG_pretenure);
+  JSONArray jsarr(&jsobj, "members");
+  for (intptr_t i = 0; i < table_length_; i++) {
+    Element* element = &table_[i];
+    if ((element->total_allocated_ == 0) ||
+        !class_table->IsValidIndex(i) ||
+        !class_table->HasValidClassAt(i)) {
+      continue;
+    }
+    cls = class_table->At(i);
+    str = cls.Name();
+    JSONObject jsentry(&jsarr);
+    jsentry.AddProperty("type", "AllocationSite");
+    jsentry.AddProperty("class", cls, true);
+    jsentry.AddProperty("name", str.ToCString());
+    jsentry.AddProperty("allocated", element->total_allocated_);
+    jsentry.AddProperty("survived", element->total_survived_);
+    jsentry.AddProperty("pretenured", element->pretenured_);
+  }
+}
+
+}  // namespace dart
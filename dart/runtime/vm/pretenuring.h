@@ -0,0 +1,90 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_PRETENURING_H_
+#define VM_PRETENURING_H_
+
+#include "platform/assert.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class Code;
+class JSONStream;
+
+DECLARE_FLAG(bool, pretenure);
+
+// PretenuringPolicy tracks how many of the objects allocated in new space
+// survive their first scavenge and decides which allocation sites should
+// allocate directly in old space. Objects do not record where they were
+// allocated, so an allocation site is approximated by the class of the
+// objects it allocates.
+class PretenuringPolicy {
+ public:
+  PretenuringPolicy();
+  ~PretenuringPolicy();
+
+  // Called by the scavenger for every object allocated in new space since
+  // the previous scavenge.
+  void RecordAllocation(intptr_t class_id, bool survived) {
+    if (class_id >= table_length_) {
+      Grow(class_id);
+    }
+    Element* element = &table_[class_id];
+    element->allocated_++;
+    if (survived) {
+      element->survived_++;
+    }
+  }
+
+  // Reevaluates the decisions using the objects recorded since the previous
+  // call. Called at the end of each scavenge. Returns true if a decision
+  // changed, in which case the optimized code compiled under the old
+  // decision must be deoptimized with DeoptimizeChangedCode.
+  bool Update();
+
+  bool ShouldPretenure(intptr_t class_id) const {
+    return FLAG_pretenure &&
+        (class_id < table_length_) &&
+        table_[class_id].pretenured_;
+  }
+
+  // Registers optimized code which allocates objects of the given class
+  // according to the current decision for it.
+  static void RegisterDependentCode(const Code& code, intptr_t class_id);
+
+  // Deoptimizes the registered code of all classes whose decision has changed
+  // since the previous call. Called on an interrupt scheduled by the
+  // scavenger, as the code cannot be deoptimized during a scavenge.
+  void DeoptimizeChangedCode();
+
+  void PrintToJSONStream(JSONStream* stream);
+
+ private:
+  class Element {
+   public:
+    // Objects recorded since the last update.
+    intptr_t allocated_;
+    intptr_t survived_;
+    // Objects recorded over the lifetime of the isolate.
+    intptr_t total_allocated_;
+    intptr_t total_survived_;
+    bool pretenured_;
+    // Whether pretenured_ has changed since the dependent code was last
+    // deoptimized.
+    bool changed_;
+  };
+
+  void Grow(intptr_t class_id);
+
+  intptr_t table_length_;
+  Element* table_;
+
+  DISALLOW_COPY_AND_ASSIGN(PretenuringPolicy);
+};
+
+}  // namespace dart
+
+#endif  // VM_PRETENURING_H_
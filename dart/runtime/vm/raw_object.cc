@@ -49,11 +49,15 @@ void RawObject::Validate(Isolate* isolate) const {
 intptr_t RawObject::SizeFromClass() const {
   Isolate* isolate = Isolate::Current();
   NoHandleScope no_handles(isolate);
+  return SizeFromClass(ptr()->tags_, isolate->class_table());
+}
+
 
+intptr_t RawObject::SizeFromClass(uword tags, ClassTable* class_table) const {
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  RawClass* raw_class = isolate->class_table()->At(GetClassId());
+  RawClass* raw_class = class_table->At(ClassIdTag::decode(tags));
   intptr_t instance_size =
       raw_class->ptr()->instance_size_in_words_ << kWordSizeLog2;
   intptr_t class_id = raw_class->ptr()->id_;
@@ -120,7 +124,7 @@ intptr_t RawObject::SizeFromClass() const {
       CLASS_LIST_TYPED_DATA(SIZE_FROM_CLASS) {
         const RawTypedData* raw_obj =
             reinterpret_cast<const RawTypedData*>(this);
-        intptr_t cid = raw_obj->GetClassId();
+        intptr_t cid = ClassIdTag::decode(tags);
         intptr_t array_len = Smi::Value(raw_obj->ptr()->length_);
         intptr_t lengthInBytes = array_len * TypedData::ElementSizeInBytes(cid);
         instance_size = TypedData::InstanceSize(lengthInBytes);
@@ -187,7 +191,6 @@ intptr_t RawObject::SizeFromClass() const {
     }
   }
   ASSERT(instance_size != 0);
-  uword tags = ptr()->tags_;
   ASSERT((instance_size == SizeTag::decode(tags)) ||
          (SizeTag::decode(tags) == 0));
   return instance_size;
@@ -196,7 +199,8 @@ intptr_t RawObject::SizeFromClass() const {
 
 intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
   intptr_t size = 0;
-  NoHandleScope no_handles(visitor->isolate());
+  // No NoHandleScope here: parallel marker tasks visit objects from helper
+  // threads which must not touch the stack resources of the isolate.
 
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
@@ -261,7 +265,12 @@ intptr_t RawObject::VisitPointers(ObjectPointerVisitor* visitor) {
   }
 
   ASSERT(size != 0);
-  ASSERT(size == Size());
+#if defined(DEBUG)
+  // Computing the size from the class requires the current isolate.
+  if (visitor->isolate() == Isolate::Current()) {
+    ASSERT(size == Size());
+  }
+#endif  // defined(DEBUG)
   return size;
 }
 
@@ -6,6 +6,7 @@
 #define VM_RAW_OBJECT_H_
 
 #include "platform/assert.h"
+#include "vm/atomic.h"
 #include "vm/globals.h"
 #include "vm/token.h"
 #include "vm/snapshot.h"
@@ -112,6 +113,7 @@ namespace dart {
 
 
 // Forward declarations.
+class ClassTable;
 class Isolate;
 #define DEFINE_FORWARD_DECLARATION(clazz)                                      \
   class Raw##clazz;
@@ -302,6 +304,20 @@ class RawObject {
     uword tags = ptr()->tags_;
     ptr()->tags_ = MarkBit::update(false, tags);
   }
+  // Atomically sets the mark bit. Returns false if the object was already
+  // marked, possibly by a concurrently running marker task.
+  bool TryAcquireMarkBit() {
+    uword* tags_addr = &ptr()->tags_;
+    uword old_tags;
+    do {
+      old_tags = *tags_addr;
+      if (MarkBit::decode(old_tags)) {
+        return false;
+      }
+    } while (AtomicOperations::CompareAndSwapWord(
+        tags_addr, old_tags, MarkBit::update(true, old_tags)) != old_tags);
+    return true;
+  }
 
   // Support for GC watched bit.
   bool IsWatched() const {
@@ -367,6 +383,19 @@ class RawObject {
     return result;
   }
 
+  // Returns the size of this object given its header, for callers which
+  // cannot rely on the header still being in place (e.g. parallel scavenger
+  // tasks racing to forward the object) or on Isolate::Current().
+  intptr_t SizeFromTags(uword tags, ClassTable* class_table) const {
+    intptr_t result = SizeTag::decode(tags);
+    if (result != 0) {
+      return result;
+    }
+    result = SizeFromClass(tags, class_table);
+    ASSERT(result > SizeTag::kMaxSizeTag);
+    return result;
+  }
+
   void Validate(Isolate* isolate) const;
   intptr_t VisitPointers(ObjectPointerVisitor* visitor);
   bool FindObject(FindObjectVisitor* visitor);
@@ -429,6 +458,7 @@ class RawObject {
   }
 
   intptr_t SizeFromClass() const;
+  intptr_t SizeFromClass(uword tags, ClassTable* class_table) const;
 
   intptr_t GetClassId() const {
     uword tags = ptr()->tags_;
@@ -441,6 +471,7 @@ class RawObject {
   friend class GCMarker;
   friend class ExternalTypedData;
   friend class Heap;
+  friend class HeapImage;
   friend class HeapProfiler;
   friend class HeapProfilerRootVisitor;
   friend class MarkingVisitor;
@@ -451,6 +482,7 @@ class RawObject {
   friend class RawInstance;
   friend class RawTypedData;
   friend class Scavenger;
+  friend class ScavengerVisitor;
   friend class SnapshotReader;
   friend class SnapshotWriter;
   friend class String;
@@ -1507,8 +1539,10 @@ class RawJSRegExp : public RawInstance {
   RawSmi* data_length_;
   RawSmi* num_bracket_expressions_;
   RawString* pattern_;  // Pattern to be used for matching.
+  RawCode* one_byte_code_;  // Native matchers, see RegExpCompiler.
+  RawCode* two_byte_code_;
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->pattern_);
+    return reinterpret_cast<RawObject**>(&ptr()->two_byte_code_);
   }
 
   intptr_t type_;  // Uninitialized, simple or complex.
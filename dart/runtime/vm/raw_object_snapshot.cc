@@ -2452,6 +2452,23 @@ void RawExternalTypedData::WriteTo(SnapshotWriter* writer,
   // Write out the serialization header value for this object.
   writer->WriteInlinedObjectHeader(object_id);
 
+  if (kind == Snapshot::kMessage) {
+    TransferableTypedDataPeer* receiver_peer =
+        writer->TransferPeerFor(this, ptr()->peer_);
+    if (receiver_peer != NULL) {
+      // The bytes are handed over to the receiver instead of being copied,
+      // see ExternalTypedData::ReadFrom.
+      writer->WriteIndexedObject(cid);
+      writer->WriteIntptrValue(tags);
+      writer->Write<RawObject*>(ptr()->length_);
+      writer->WriteIntptrValue(reinterpret_cast<intptr_t>(ptr()->data_));
+      writer->WriteIntptrValue(reinterpret_cast<intptr_t>(receiver_peer));
+      writer->WriteIntptrValue(
+          reinterpret_cast<intptr_t>(&TransferableTypedDataPeer::Finalize));
+      return;
+    }
+  }
+
   switch (cid) {
     case kExternalTypedDataInt8ArrayCid:
       EXT_TYPED_DATA_WRITE(kTypedDataInt8ArrayCid, int8_t);
@@ -0,0 +1,1070 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/regexp_compiler.h"
+
+#include "vm/growable_array.h"
+#include "vm/object.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, regexp_native_code, false,
+    "Compile simple regular expressions to native code instead of "
+    "interpreting them.");
+DEFINE_FLAG(bool, trace_regexp_compiler, false,
+    "Trace which regular expressions are compiled to native code.");
+
+
+// Quantified atoms are expanded, so keep their counts and the total size of
+// the generated code small.
+static const intptr_t kMaxRepeatCount = 16;
+static const intptr_t kMaxNodeCost = 4096;
+static const intptr_t kInfinity = -1;
+
+static const uint16_t kMaxUtf16CodeUnit = 0xFFFF;
+static const uint16_t kMaxOneByteChar = 0xFF;
+
+
+class RegExpNode : public ZoneAllocated {
+ public:
+  enum Kind {
+    kChar,
+    kClass,
+    kSequence,
+    kAlternation,
+    kGroup,
+    kRepeat,
+    kStart,
+    kEnd,
+  };
+
+  explicit RegExpNode(Kind kind)
+      : kind_(kind),
+        char_(0),
+        ranges_(NULL),
+        children_(NULL),
+        body_(NULL),
+        capture_index_(-1),
+        min_(0),
+        max_(0),
+        greedy_(true) { }
+
+  Kind kind() const { return kind_; }
+
+  // kChar.
+  uint16_t char_code() const { return char_; }
+  void set_char_code(uint16_t c) { char_ = c; }
+
+  // kClass: sorted, disjoint, inclusive ranges as (from, to) pairs.
+  ZoneGrowableArray<intptr_t>* ranges() const { return ranges_; }
+  void set_ranges(ZoneGrowableArray<intptr_t>* ranges) { ranges_ = ranges; }
+
+  // kSequence and kAlternation.
+  ZoneGrowableArray<RegExpNode*>* children() const { return children_; }
+  void set_children(ZoneGrowableArray<RegExpNode*>* children) {
+    children_ = children;
+  }
+
+  // kGroup and kRepeat.
+  RegExpNode* body() const { return body_; }
+  void set_body(RegExpNode* body) { body_ = body; }
+
+  // kGroup, -1 for non-capturing groups.
+  intptr_t capture_index() const { return capture_index_; }
+  void set_capture_index(intptr_t index) { capture_index_ = index; }
+
+  // kRepeat, max is kInfinity for unbounded repeats.
+  intptr_t min() const { return min_; }
+  intptr_t max() const { return max_; }
+  bool greedy() const { return greedy_; }
+  void set_repeat(intptr_t min, intptr_t max, bool greedy) {
+    min_ = min;
+    max_ = max;
+    greedy_ = greedy;
+  }
+
+ private:
+  const Kind kind_;
+  uint16_t char_;
+  ZoneGrowableArray<intptr_t>* ranges_;
+  ZoneGrowableArray<RegExpNode*>* children_;
+  RegExpNode* body_;
+  intptr_t capture_index_;
+  intptr_t min_;
+  intptr_t max_;
+  bool greedy_;
+
+  DISALLOW_COPY_AND_ASSIGN(RegExpNode);
+};
+
+
+// Parses the supported subset of the JavaScript regular expression syntax.
+// Returns NULL for anything outside of it, including syntax errors, which
+// are reported by jscre.
+class RegExpParser : public ValueObject {
+ public:
+  explicit RegExpParser(const String& pattern)
+      : pattern_(pattern),
+        length_(pattern.Length()),
+        position_(0),
+        num_groups_(0),
+        failed_(false) { }
+
+  RegExpNode* Parse() {
+    RegExpNode* node = ParseDisjunction();
+    if (failed_ || (position_ != length_)) {
+      return NULL;
+    }
+    return node;
+  }
+
+  intptr_t num_groups() const { return num_groups_; }
+
+ private:
+  bool AtEnd() const { return position_ >= length_; }
+  int32_t Peek() const { return pattern_.CharAt(position_); }
+  int32_t Next() { return pattern_.CharAt(position_++); }
+
+  RegExpNode* Fail() {
+    failed_ = true;
+    return NULL;
+  }
+
+  RegExpNode* ParseDisjunction() {
+    RegExpNode* alternative = ParseAlternative();
+    if (failed_ || AtEnd() || (Peek() != '|')) {
+      return alternative;
+    }
+    ZoneGrowableArray<RegExpNode*>* alternatives =
+        new ZoneGrowableArray<RegExpNode*>(2);
+    alternatives->Add(alternative);
+    while (!failed_ && !AtEnd() && (Peek() == '|')) {
+      Next();
+      alternatives->Add(ParseAlternative());
+    }
+    RegExpNode* node = new RegExpNode(RegExpNode::kAlternation);
+    node->set_children(alternatives);
+    return node;
+  }
+
+  RegExpNode* ParseAlternative() {
+    ZoneGrowableArray<RegExpNode*>* terms =
+        new ZoneGrowableArray<RegExpNode*>(4);
+    while (!failed_ && !AtEnd() && (Peek() != '|') && (Peek() != ')')) {
+      RegExpNode* term = ParseTerm();
+      if (term != NULL) {
+        terms->Add(term);
+      }
+    }
+    RegExpNode* node = new RegExpNode(RegExpNode::kSequence);
+    node->set_children(terms);
+    return node;
+  }
+
+  RegExpNode* ParseTerm() {
+    int32_t c = Peek();
+    if (c == '^') {
+      Next();
+      return new RegExpNode(RegExpNode::kStart);
+    }
+    if (c == '$') {
+      Next();
+      return new RegExpNode(RegExpNode::kEnd);
+    }
+    RegExpNode* atom = ParseAtom();
+    if (failed_ || AtEnd()) {
+      return atom;
+    }
+    intptr_t min;
+    intptr_t max;
+    switch (Peek()) {
+      case '*':
+        min = 0;
+        max = kInfinity;
+        break;
+      case '+':
+        min = 1;
+        max = kInfinity;
+        break;
+      case '?':
+        min = 0;
+        max = 1;
+        break;
+      case '{':
+        Next();
+        min = ParseCount();
+        max = min;
+        if (!AtEnd() && (Peek() == ',')) {
+          Next();
+          max = (!AtEnd() && (Peek() == '}')) ? kInfinity : ParseCount();
+        }
+        if (failed_ || AtEnd() || (Peek() != '}')) {
+          return Fail();
+        }
+        if ((max != kInfinity) && (max < min)) {
+          return Fail();
+        }
+        break;
+      default:
+        return atom;
+    }
+    Next();
+    bool greedy = true;
+    if (!AtEnd() && (Peek() == '?')) {
+      Next();
+      greedy = false;
+    }
+    RegExpNode* node = new RegExpNode(RegExpNode::kRepeat);
+    node->set_body(atom);
+    node->set_repeat(min, max, greedy);
+    return node;
+  }
+
+  intptr_t ParseCount() {
+    intptr_t count = 0;
+    intptr_t digits = 0;
+    while (!AtEnd() && (Peek() >= '0') && (Peek() <= '9')) {
+      count = count * 10 + (Next() - '0');
+      if (count > kMaxRepeatCount) {
+        Fail();
+        return 0;
+      }
+      digits++;
+    }
+    if (digits == 0) {
+      Fail();
+    }
+    return count;
+  }
+
+  RegExpNode* ParseAtom() {
+    int32_t c = Next();
+    switch (c) {
+      case '.': {
+        RegExpNode* node = new RegExpNode(RegExpNode::kClass);
+        ZoneGrowableArray<intptr_t>* ranges = NewRanges();
+        AddNewlineRanges(ranges);
+        node->set_ranges(Negate(ranges));
+        return node;
+      }
+      case '(': {
+        intptr_t capture_index = -1;
+        if (!AtEnd() && (Peek() == '?')) {
+          Next();
+          // Only non-capturing groups, no lookahead.
+          if (AtEnd() || (Next() != ':')) {
+            return Fail();
+          }
+        } else {
+          capture_index = ++num_groups_;
+        }
+        RegExpNode* body = ParseDisjunction();
+        if (failed_ || AtEnd() || (Next() != ')')) {
+          return Fail();
+        }
+        RegExpNode* node = new RegExpNode(RegExpNode::kGroup);
+        node->set_body(body);
+        node->set_capture_index(capture_index);
+        return node;
+      }
+      case '[':
+        return ParseClass();
+      case '\\':
+        return ParseAtomEscape();
+      case ')':
+      case ']':
+      case '{':
+      case '}':
+      case '*':
+      case '+':
+      case '?':
+        return Fail();
+      default:
+        return NewChar(c);
+    }
+  }
+
+  RegExpNode* ParseAtomEscape() {
+    if (AtEnd()) {
+      return Fail();
+    }
+    ZoneGrowableArray<intptr_t>* ranges = NewRanges();
+    if (ParseClassEscape(ranges)) {
+      RegExpNode* node = new RegExpNode(RegExpNode::kClass);
+      node->set_ranges(Normalize(ranges));
+      return node;
+    }
+    if (Peek() == 'b') {
+      // Word boundary.
+      return Fail();
+    }
+    int32_t c = ParseCharacterEscape();
+    if (failed_) {
+      return NULL;
+    }
+    return NewChar(c);
+  }
+
+  // Parses \d, \D, \s, \S, \w and \W, adding their ranges.
+  bool ParseClassEscape(ZoneGrowableArray<intptr_t>* ranges) {
+    ZoneGrowableArray<intptr_t>* escape_ranges = NewRanges();
+    bool negated = false;
+    switch (Peek()) {
+      case 'D':
+        negated = true;
+        // Fall through.
+      case 'd':
+        AddRange(escape_ranges, '0', '9');
+        break;
+      case 'S':
+        negated = true;
+        // Fall through.
+      case 's':
+        // Same as jscre, which only considers ASCII white space.
+        AddRange(escape_ranges, '\t', '\r');
+        AddRange(escape_ranges, ' ', ' ');
+        break;
+      case 'W':
+        negated = true;
+        // Fall through.
+      case 'w':
+        AddRange(escape_ranges, '0', '9');
+        AddRange(escape_ranges, 'A', 'Z');
+        AddRange(escape_ranges, '_', '_');
+        AddRange(escape_ranges, 'a', 'z');
+        break;
+      default:
+        return false;
+    }
+    Next();
+    if (negated) {
+      escape_ranges = Negate(escape_ranges);
+    }
+    for (intptr_t i = 0; i < escape_ranges->length(); i++) {
+      ranges->Add((*escape_ranges)[i]);
+    }
+    return true;
+  }
+
+  // Parses the escape after a backslash which denotes a single character.
+  int32_t ParseCharacterEscape() {
+    int32_t c = Next();
+    switch (c) {
+      case 'n': return '\n';
+      case 'r': return '\r';
+      case 't': return '\t';
+      case 'f': return '\f';
+      case 'v': return '\v';
+      case 'x': return ParseHex(2);
+      case 'u': return ParseHex(4);
+      case '0':
+        // Octal escapes are not supported, only a NUL character.
+        if (!AtEnd() && (Peek() >= '0') && (Peek() <= '9')) {
+          Fail();
+        }
+        return 0;
+      default:
+        // Back references, control escapes and escaped letters or digits
+        // with a jscre specific meaning.
+        if (((c >= '0') && (c <= '9')) ||
+            ((c >= 'a') && (c <= 'z')) ||
+            ((c >= 'A') && (c <= 'Z'))) {
+          Fail();
+        }
+        return c;
+    }
+  }
+
+  int32_t ParseHex(intptr_t digits) {
+    int32_t value = 0;
+    for (intptr_t i = 0; i < digits; i++) {
+      if (AtEnd()) {
+        Fail();
+        return 0;
+      }
+      int32_t c = Next();
+      if ((c >= '0') && (c <= '9')) {
+        value = value * 16 + (c - '0');
+      } else if ((c >= 'a') && (c <= 'f')) {
+        value = value * 16 + (c - 'a' + 10);
+      } else if ((c >= 'A') && (c <= 'F')) {
+        value = value * 16 + (c - 'A' + 10);
+      } else {
+        Fail();
+        return 0;
+      }
+    }
+    return value;
+  }
+
+  RegExpNode* ParseClass() {
+    bool negated = false;
+    if (!AtEnd() && (Peek() == '^')) {
+      Next();
+      negated = true;
+    }
+    // Empty classes, [] and [^], have special meanings in jscre.
+    if (AtEnd() || (Peek() == ']')) {
+      return Fail();
+    }
+    ZoneGrowableArray<intptr_t>* ranges = NewRanges();
+    while (!AtEnd() && (Peek() != ']')) {
+      int32_t from;
+      if (!ParseClassAtom(ranges, &from)) {
+        if (failed_) {
+          return NULL;
+        }
+        continue;
+      }
+      if ((position_ + 1 < length_) &&
+          (Peek() == '-') &&
+          (pattern_.CharAt(position_ + 1) != ']')) {
+        Next();
+        int32_t to;
+        if (!ParseClassAtom(ranges, &to) || (to < from)) {
+          return Fail();
+        }
+        AddRange(ranges, from, to);
+      } else {
+        AddRange(ranges, from, from);
+      }
+    }
+    if (AtEnd()) {
+      return Fail();
+    }
+    Next();
+    ranges = Normalize(ranges);
+    RegExpNode* node = new RegExpNode(RegExpNode::kClass);
+    node->set_ranges(negated ? Negate(ranges) : ranges);
+    return node;
+  }
+
+  // Parses a single character into c and returns true, or adds the ranges
+  // of a class escape and returns false.
+  bool ParseClassAtom(ZoneGrowableArray<intptr_t>* ranges, int32_t* c) {
+    if (AtEnd()) {
+      Fail();
+      return false;
+    }
+    *c = Next();
+    if (*c != '\\') {
+      return true;
+    }
+    if (AtEnd()) {
+      Fail();
+      return false;
+    }
+    if (ParseClassEscape(ranges)) {
+      return false;
+    }
+    if (Peek() == 'b') {
+      Next();
+      *c = '\b';
+      return true;
+    }
+    *c = ParseCharacterEscape();
+    return !failed_;
+  }
+
+  static RegExpNode* NewChar(int32_t c) {
+    RegExpNode* node = new RegExpNode(RegExpNode::kChar);
+    node->set_char_code(c);
+    return node;
+  }
+
+  static ZoneGrowableArray<intptr_t>* NewRanges() {
+    return new ZoneGrowableArray<intptr_t>(4);
+  }
+
+  static void AddRange(ZoneGrowableArray<intptr_t>* ranges,
+                       intptr_t from,
+                       intptr_t to) {
+    ranges->Add(from);
+    ranges->Add(to);
+  }
+
+  static void AddNewlineRanges(ZoneGrowableArray<intptr_t>* ranges) {
+    AddRange(ranges, '\n', '\n');
+    AddRange(ranges, '\r', '\r');
+    AddRange(ranges, 0x2028, 0x2029);
+  }
+
+  // Sorts the ranges and merges overlapping or adjacent ones.
+  static ZoneGrowableArray<intptr_t>* Normalize(
+      ZoneGrowableArray<intptr_t>* ranges) {
+    intptr_t count = ranges->length() / 2;
+    // Classes are short, so a simple insertion sort of the pairs is enough.
+    for (intptr_t i = 1; i < count; i++) {
+      intptr_t from = (*ranges)[2 * i];
+      intptr_t to = (*ranges)[2 * i + 1];
+      intptr_t j = i - 1;
+      while ((j >= 0) && ((*ranges)[2 * j] > from)) {
+        (*ranges)[2 * j + 2] = (*ranges)[2 * j];
+        (*ranges)[2 * j + 3] = (*ranges)[2 * j + 1];
+        j--;
+      }
+      (*ranges)[2 * j + 2] = from;
+      (*ranges)[2 * j + 3] = to;
+    }
+    ZoneGrowableArray<intptr_t>* result = NewRanges();
+    for (intptr_t i = 0; i < count; i++) {
+      intptr_t from = (*ranges)[2 * i];
+      intptr_t to = (*ranges)[2 * i + 1];
+      intptr_t last = result->length() - 1;
+      if ((last > 0) && (from <= (*result)[last] + 1)) {
+        if (to > (*result)[last]) {
+          (*result)[last] = to;
+        }
+      } else {
+        AddRange(result, from, to);
+      }
+    }
+    return result;
+  }
+
+  static ZoneGrowableArray<intptr_t>* Negate(
+      ZoneGrowableArray<intptr_t>* ranges) {
+    ranges = Normalize(ranges);
+    ZoneGrowableArray<intptr_t>* result = NewRanges();
+    intptr_t next = 0;
+    for (intptr_t i = 0; i < ranges->length(); i += 2) {
+      if ((*ranges)[i] > next) {
+        AddRange(result, next, (*ranges)[i] - 1);
+      }
+      next = (*ranges)[i + 1] + 1;
+    }
+    if (next <= kMaxUtf16CodeUnit) {
+      AddRange(result, next, kMaxUtf16CodeUnit);
+    }
+    return result;
+  }
+
+  const String& pattern_;
+  const intptr_t length_;
+  intptr_t position_;
+  intptr_t num_groups_;
+  bool failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(RegExpParser);
+};
+
+
+// Returns the minimum number of characters matched by the node.
+static intptr_t MinLength(RegExpNode* node) {
+  switch (node->kind()) {
+    case RegExpNode::kChar:
+    case RegExpNode::kClass:
+      return 1;
+    case RegExpNode::kStart:
+    case RegExpNode::kEnd:
+      return 0;
+    case RegExpNode::kGroup:
+      return MinLength(node->body());
+    case RegExpNode::kRepeat:
+      return node->min() * MinLength(node->body());
+    case RegExpNode::kSequence: {
+      intptr_t length = 0;
+      for (intptr_t i = 0; i < node->children()->length(); i++) {
+        length += MinLength((*node->children())[i]);
+      }
+      return length;
+    }
+    case RegExpNode::kAlternation: {
+      intptr_t length = MinLength((*node->children())[0]);
+      for (intptr_t i = 1; i < node->children()->length(); i++) {
+        intptr_t child_length = MinLength((*node->children())[i]);
+        if (child_length < length) {
+          length = child_length;
+        }
+      }
+      return length;
+    }
+  }
+  UNREACHABLE();
+  return 0;
+}
+
+
+// Returns an estimate of the size of the generated code.
+static intptr_t Cost(RegExpNode* node) {
+  switch (node->kind()) {
+    case RegExpNode::kChar:
+    case RegExpNode::kStart:
+    case RegExpNode::kEnd:
+      return 1;
+    case RegExpNode::kClass:
+      return 1 + node->ranges()->length() / 2;
+    case RegExpNode::kGroup:
+      return 1 + Cost(node->body());
+    case RegExpNode::kRepeat: {
+      intptr_t copies = node->min() +
+          ((node->max() == kInfinity) ? 1 : (node->max() - node->min()));
+      intptr_t body_cost = Cost(node->body());
+      if (body_cost > kMaxNodeCost) {
+        return body_cost;  // Avoid overflowing for nested repeats.
+      }
+      return 1 + copies * body_cost;
+    }
+    case RegExpNode::kSequence:
+    case RegExpNode::kAlternation: {
+      intptr_t cost = 1;
+      for (intptr_t i = 0; i < node->children()->length(); i++) {
+        cost += Cost((*node->children())[i]);
+        if (cost > kMaxNodeCost) {
+          break;
+        }
+      }
+      return cost;
+    }
+  }
+  UNREACHABLE();
+  return 0;
+}
+
+
+// Returns true if the node contains a capturing group which may not
+// participate in a match of the node. Such groups keep the value of an
+// earlier iteration of an enclosing repeat in the generated code, which
+// does not reset them like jscre does.
+static bool HasOptionalCapture(RegExpNode* node, bool optional) {
+  switch (node->kind()) {
+    case RegExpNode::kChar:
+    case RegExpNode::kClass:
+    case RegExpNode::kStart:
+    case RegExpNode::kEnd:
+      return false;
+    case RegExpNode::kGroup:
+      if (optional && (node->capture_index() >= 0)) {
+        return true;
+      }
+      return HasOptionalCapture(node->body(), optional);
+    case RegExpNode::kRepeat:
+      return HasOptionalCapture(node->body(),
+                                optional || (node->min() == 0));
+    case RegExpNode::kSequence:
+    case RegExpNode::kAlternation: {
+      bool child_optional = optional ||
+          ((node->kind() == RegExpNode::kAlternation) &&
+           (node->children()->length() > 1));
+      for (intptr_t i = 0; i < node->children()->length(); i++) {
+        if (HasOptionalCapture((*node->children())[i], child_optional)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  }
+  UNREACHABLE();
+  return false;
+}
+
+
+// Returns true if all repeats in the node can be compiled.
+static bool CanCompileRepeats(RegExpNode* node) {
+  switch (node->kind()) {
+    case RegExpNode::kChar:
+    case RegExpNode::kClass:
+    case RegExpNode::kStart:
+    case RegExpNode::kEnd:
+      return true;
+    case RegExpNode::kGroup:
+      return CanCompileRepeats(node->body());
+    case RegExpNode::kRepeat: {
+      RegExpNode* body = node->body();
+      // Repeats of empty matches would need a check for progress.
+      if (MinLength(body) == 0) {
+        return false;
+      }
+      if ((node->max() != 1) && HasOptionalCapture(body, false)) {
+        return false;
+      }
+      return CanCompileRepeats(body);
+    }
+    case RegExpNode::kSequence:
+    case RegExpNode::kAlternation:
+      for (intptr_t i = 0; i < node->children()->length(); i++) {
+        if (!CanCompileRepeats((*node->children())[i])) {
+          return false;
+        }
+      }
+      return true;
+  }
+  UNREACHABLE();
+  return false;
+}
+
+
+// Returns true if a match of the node can only start at the beginning of the
+// subject.
+static bool IsAnchored(RegExpNode* node, bool multi_line) {
+  if (multi_line) {
+    return false;
+  }
+  switch (node->kind()) {
+    case RegExpNode::kStart:
+      return true;
+    case RegExpNode::kGroup:
+      return IsAnchored(node->body(), multi_line);
+    case RegExpNode::kSequence:
+      return (node->children()->length() > 0) &&
+          IsAnchored((*node->children())[0], multi_line);
+    case RegExpNode::kAlternation:
+      for (intptr_t i = 0; i < node->children()->length(); i++) {
+        if (!IsAnchored((*node->children())[i], multi_line)) {
+          return false;
+        }
+      }
+      return true;
+    default:
+      return false;
+  }
+}
+
+
+// Emits the code matching a node. The code falls through on success and
+// jumps to the backtrack label on failure, which resumes at the most recent
+// choice point.
+class RegExpCodeGenerator : public ValueObject {
+ public:
+  RegExpCodeGenerator(RegExpMacroAssembler* masm, bool multi_line)
+      : masm_(masm),
+        multi_line_(multi_line),
+        max_char_((masm->char_size() == 1) ? kMaxOneByteChar
+                                           : kMaxUtf16CodeUnit) { }
+
+  Label* backtrack() { return &backtrack_; }
+
+  void EmitNode(RegExpNode* node) {
+    switch (node->kind()) {
+      case RegExpNode::kChar:
+        EmitChar(node->char_code());
+        break;
+      case RegExpNode::kClass:
+        EmitClass(node->ranges());
+        break;
+      case RegExpNode::kSequence:
+        for (intptr_t i = 0; i < node->children()->length(); i++) {
+          EmitNode((*node->children())[i]);
+        }
+        break;
+      case RegExpNode::kAlternation:
+        EmitAlternation(node->children());
+        break;
+      case RegExpNode::kGroup:
+        EmitGroup(node);
+        break;
+      case RegExpNode::kRepeat:
+        EmitRepeat(node);
+        break;
+      case RegExpNode::kStart:
+        EmitStart();
+        break;
+      case RegExpNode::kEnd:
+        EmitEnd();
+        break;
+    }
+  }
+
+ private:
+  void EmitChar(uint16_t c) {
+    if (c > max_char_) {
+      // Never matches a subject of this width.
+      masm_->Jump(&backtrack_);
+      return;
+    }
+    masm_->LoadCurrentChar(&backtrack_);
+    Label matched;
+    masm_->JumpIfCharEqual(c, &matched);
+    masm_->Jump(&backtrack_);
+    masm_->Bind(&matched);
+    masm_->AdvancePosition(1);
+  }
+
+  void EmitClass(ZoneGrowableArray<intptr_t>* ranges) {
+    masm_->LoadCurrentChar(&backtrack_);
+    Label matched;
+    for (intptr_t i = 0; i < ranges->length(); i += 2) {
+      intptr_t from = (*ranges)[i];
+      intptr_t to = (*ranges)[i + 1];
+      if (from > max_char_) {
+        break;
+      }
+      if (to > max_char_) {
+        to = max_char_;
+      }
+      if (from == to) {
+        masm_->JumpIfCharEqual(from, &matched);
+      } else {
+        masm_->JumpIfCharInRange(from, to, &matched);
+      }
+    }
+    masm_->Jump(&backtrack_);
+    masm_->Bind(&matched);
+    masm_->AdvancePosition(1);
+  }
+
+  // Jumps to label if the current character is a line terminator.
+  void EmitJumpIfNewline(Label* label) {
+    masm_->JumpIfCharEqual('\n', label);
+    masm_->JumpIfCharEqual('\r', label);
+    if (max_char_ > kMaxOneByteChar) {
+      masm_->JumpIfCharInRange(0x2028, 0x2029, label);
+    }
+  }
+
+  void EmitStart() {
+    Label matched;
+    masm_->JumpIfAtStart(&matched);
+    if (multi_line_) {
+      masm_->LoadPreviousChar();
+      EmitJumpIfNewline(&matched);
+    }
+    masm_->Jump(&backtrack_);
+    masm_->Bind(&matched);
+  }
+
+  void EmitEnd() {
+    Label matched;
+    masm_->JumpIfAtEnd(&matched);
+    if (multi_line_) {
+      masm_->LoadCurrentChar(&backtrack_);
+      EmitJumpIfNewline(&matched);
+    }
+    masm_->Jump(&backtrack_);
+    masm_->Bind(&matched);
+  }
+
+  // Tries the alternatives in order. Each but the last pushes a choice
+  // point which resumes with the next alternative.
+  void EmitAlternation(ZoneGrowableArray<RegExpNode*>* alternatives) {
+    Label done;
+    intptr_t last = alternatives->length() - 1;
+    for (intptr_t i = 0; i < last; i++) {
+      Label next;
+      masm_->PushPosition();
+      masm_->PushBacktrack(&next);
+      EmitNode((*alternatives)[i]);
+      masm_->Jump(&done);
+      masm_->Bind(&next);
+      masm_->PopPosition();
+    }
+    EmitNode((*alternatives)[last]);
+    masm_->Bind(&done);
+  }
+
+  // Saves the previous value of each capture on the backtrack stack, so it
+  // is restored when backtracking past the group.
+  void EmitGroup(RegExpNode* node) {
+    intptr_t index = node->capture_index();
+    if (index < 0) {
+      EmitNode(node->body());
+      return;
+    }
+    Label restore_start;
+    Label restore_end;
+    Label done;
+    masm_->PushCapture(2 * index);
+    masm_->PushBacktrack(&restore_start);
+    masm_->SetCapture(2 * index);
+    EmitNode(node->body());
+    masm_->PushCapture(2 * index + 1);
+    masm_->PushBacktrack(&restore_end);
+    masm_->SetCapture(2 * index + 1);
+    masm_->Jump(&done);
+    masm_->Bind(&restore_start);
+    masm_->PopCapture(2 * index);
+    masm_->Backtrack();
+    masm_->Bind(&restore_end);
+    masm_->PopCapture(2 * index + 1);
+    masm_->Backtrack();
+    masm_->Bind(&done);
+  }
+
+  void EmitRepeat(RegExpNode* node) {
+    RegExpNode* body = node->body();
+    for (intptr_t i = 0; i < node->min(); i++) {
+      EmitNode(body);
+    }
+    if (node->max() == kInfinity) {
+      if (node->greedy()) {
+        EmitGreedyLoop(body);
+      } else {
+        EmitLazyLoop(body);
+      }
+    } else if (node->max() > node->min()) {
+      if (node->greedy()) {
+        EmitGreedyOptional(body, node->max() - node->min());
+      } else {
+        EmitLazyOptional(body, node->max() - node->min());
+      }
+    }
+  }
+
+  // Matches the body as often as possible. Each iteration pushes a choice
+  // point which exits the loop at the position before the iteration.
+  void EmitGreedyLoop(RegExpNode* body) {
+    Label loop;
+    Label exit;
+    masm_->Bind(&loop);
+    masm_->PushPosition();
+    masm_->PushBacktrack(&exit);
+    EmitNode(body);
+    masm_->Jump(&loop);
+    masm_->Bind(&exit);
+    masm_->PopPosition();
+  }
+
+  // Continues after the loop first. Backtracking into the choice point
+  // matches one more iteration and tries to continue again.
+  void EmitLazyLoop(RegExpNode* body) {
+    Label more;
+    Label exit;
+    masm_->Jump(&exit);
+    masm_->Bind(&more);
+    masm_->PopPosition();
+    EmitNode(body);
+    masm_->Bind(&exit);
+    masm_->PushPosition();
+    masm_->PushBacktrack(&more);
+  }
+
+  // Matches up to count more iterations, each nested in the previous one,
+  // preferring more.
+  void EmitGreedyOptional(RegExpNode* body, intptr_t count) {
+    Label skip;
+    Label done;
+    masm_->PushPosition();
+    masm_->PushBacktrack(&skip);
+    EmitNode(body);
+    if (count > 1) {
+      EmitGreedyOptional(body, count - 1);
+    }
+    masm_->Jump(&done);
+    masm_->Bind(&skip);
+    masm_->PopPosition();
+    masm_->Bind(&done);
+  }
+
+  // Matches up to count more iterations, each nested in the previous one,
+  // preferring fewer.
+  void EmitLazyOptional(RegExpNode* body, intptr_t count) {
+    Label take;
+    Label done;
+    masm_->PushPosition();
+    masm_->PushBacktrack(&take);
+    masm_->Jump(&done);
+    masm_->Bind(&take);
+    masm_->PopPosition();
+    EmitNode(body);
+    if (count > 1) {
+      EmitLazyOptional(body, count - 1);
+    }
+    masm_->Bind(&done);
+  }
+
+  RegExpMacroAssembler* masm_;
+  const bool multi_line_;
+  const intptr_t max_char_;
+  Label backtrack_;
+
+  DISALLOW_COPY_AND_ASSIGN(RegExpCodeGenerator);
+};
+
+
+RawCode* RegExpCompiler::Compile(const String& pattern,
+                                 bool multi_line,
+                                 bool ignore_case,
+                                 intptr_t num_groups,
+                                 intptr_t char_size) {
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+  ASSERT((char_size == 1) || (char_size == 2));
+  if (ignore_case) {
+    return Code::null();
+  }
+  RegExpParser parser(pattern);
+  RegExpNode* root = parser.Parse();
+  if ((root == NULL) ||
+      (parser.num_groups() != num_groups) ||
+      (Cost(root) > kMaxNodeCost) ||
+      !CanCompileRepeats(root)) {
+    if (FLAG_trace_regexp_compiler) {
+      OS::Print("RegExp not compiled: %s\n", pattern.ToCString());
+    }
+    return Code::null();
+  }
+  if (FLAG_trace_regexp_compiler) {
+    OS::Print("RegExp compiled (%" Pd " byte chars): %s\n",
+              char_size, pattern.ToCString());
+  }
+
+  Assembler assembler;
+  RegExpMacroAssembler masm(&assembler, char_size, 2 * (num_groups + 1));
+  RegExpCodeGenerator generator(&masm, multi_line);
+  Label attempt;
+  Label next_attempt;
+  Label no_match;
+  masm.Prologue();
+  masm.Bind(&attempt);
+  masm.JumpIfAttemptPastEnd(&no_match);
+  masm.StartAttempt();
+  masm.PushBacktrack(&next_attempt);
+  generator.EmitNode(root);
+  masm.Succeed();
+  masm.Bind(generator.backtrack());
+  masm.Backtrack();
+  masm.Bind(&next_attempt);
+  if (IsAnchored(root, multi_line)) {
+    masm.Jump(&no_match);
+  } else {
+    masm.AdvanceAttempt();
+    masm.Jump(&attempt);
+  }
+  masm.Bind(&no_match);
+  masm.Return(kNoMatch);
+  masm.Bind(masm.stack_overflow());
+  masm.Return(kStackOverflow);
+  return Code::FinalizeCode("RegExp", &assembler);
+#else
+  return Code::null();
+#endif
+}
+
+
+// Backtrack stack sizes in words. Matches start with a stack allocated
+// buffer and retry with larger ones when they run out of space.
+static const intptr_t kInitialStackSize = 1 * KB;
+static const intptr_t kMaxStackSize = 1 * MB;
+
+
+RegExpCompiler::Result RegExpCompiler::Execute(const Code& code,
+                                               const void* subject,
+                                               intptr_t length,
+                                               intptr_t start_index,
+                                               intptr_t* captures) {
+  typedef intptr_t (*MatchFunction)(RegExpMatchState* state);
+  MatchFunction match = reinterpret_cast<MatchFunction>(code.EntryPoint());
+  RegExpMatchState state;
+  state.subject = reinterpret_cast<uword>(subject);
+  state.length = length;
+  state.captures = captures;
+  uword initial_stack[kInitialStackSize];
+  uword* stack = initial_stack;
+  intptr_t stack_size = kInitialStackSize;
+  while (true) {
+    state.start_index = start_index;
+    state.stack_base = stack;
+    state.stack_limit = stack + stack_size;
+    intptr_t result = match(&state);
+    if (stack != initial_stack) {
+      delete[] stack;
+    }
+    if ((result != kStackOverflow) || (stack_size >= kMaxStackSize)) {
+      return static_cast<Result>(result);
+    }
+    stack_size = Utils::Minimum(stack_size * 8, kMaxStackSize);
+    stack = new uword[stack_size];
+  }
+}
+
+}  // namespace dart
@@ -0,0 +1,129 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_REGEXP_COMPILER_H_
+#define VM_REGEXP_COMPILER_H_
+
+#include "vm/allocation.h"
+#include "vm/assembler.h"
+#include "vm/flags.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+class Code;
+class RawCode;
+class String;
+
+DECLARE_FLAG(bool, regexp_native_code);
+
+// Input and output of a compiled regular expression. The generated code is
+// called with a pointer to this structure as its only argument.
+struct RegExpMatchState {
+  uword subject;  // Address of the first character of the subject.
+  intptr_t length;  // Number of characters in the subject.
+  intptr_t start_index;  // Start of the current match attempt.
+  intptr_t* captures;  // Start and end of the match and of each group.
+  uword* stack_base;  // Backtrack stack.
+  uword* stack_limit;
+};
+
+
+// RegExpCompiler translates regular expressions into native code for the
+// common subset of the syntax: literals, character classes, quantifiers,
+// alternation and groups. Patterns using anything else, e.g. back
+// references, lookahead, word boundaries or case insensitive matching, are
+// rejected and left to the jscre interpreter.
+class RegExpCompiler : public AllStatic {
+ public:
+  enum Result {
+    kStackOverflow = -1,
+    kNoMatch = 0,
+    kMatch = 1,
+  };
+
+  // Returns the matcher for subjects with char_size bytes per character, or
+  // Code::null() if the pattern is not supported or does not have
+  // num_groups capturing groups.
+  static RawCode* Compile(const String& pattern,
+                          bool multi_line,
+                          bool ignore_case,
+                          intptr_t num_groups,
+                          intptr_t char_size);
+
+  // Searches the subject from start_index on. On a match, captures holds
+  // the start and end of the match followed by those of each group, or -1
+  // for groups which did not participate. The subject data must not move
+  // while matching. Returns kStackOverflow if the match needs more
+  // backtracking than supported.
+  static Result Execute(const Code& code,
+                        const void* subject,
+                        intptr_t length,
+                        intptr_t start_index,
+                        intptr_t* captures);
+};
+
+
+// Architecture specific code generation for RegExpCompiler. The current
+// position in the subject and the current character are kept in registers.
+// Backtracking is done through an explicit stack holding code addresses,
+// saved positions and saved captures. Any failed check jumps to a label
+// which pops a code address and continues there.
+class RegExpMacroAssembler : public ValueObject {
+ public:
+  RegExpMacroAssembler(Assembler* assembler,
+                       intptr_t char_size,
+                       intptr_t num_captures);
+
+  Assembler* assembler() const { return assembler_; }
+  intptr_t char_size() const { return char_size_; }
+  Label* stack_overflow() { return &stack_overflow_; }
+
+  void Bind(Label* label);
+  void Jump(Label* label);
+
+  // Entry and exit of the generated function.
+  void Prologue();
+  void Return(RegExpCompiler::Result result);
+
+  // Match attempts at successive start positions.
+  void JumpIfAttemptPastEnd(Label* label);
+  void StartAttempt();
+  void AdvanceAttempt();
+  void Succeed();
+
+  // Character checks. LoadCurrentChar jumps to on_end if the position is at
+  // the end of the subject, LoadPreviousChar expects it not to be at the
+  // start.
+  void LoadCurrentChar(Label* on_end);
+  void LoadPreviousChar();
+  void JumpIfCharEqual(uint16_t c, Label* label);
+  void JumpIfCharInRange(uint16_t from, uint16_t to, Label* label);
+  void AdvancePosition(intptr_t by);
+  void JumpIfAtStart(Label* label);
+  void JumpIfAtEnd(Label* label);
+
+  // Backtrack stack.
+  void PushBacktrack(Label* target);
+  void Backtrack();
+  void PushPosition();
+  void PopPosition();
+  void PushCapture(intptr_t index);
+  void PopCapture(intptr_t index);
+  void SetCapture(intptr_t index);
+
+ private:
+  void CheckStackLimit();
+
+  Assembler* assembler_;
+  const intptr_t char_size_;
+  const intptr_t num_captures_;
+  Label stack_overflow_;
+
+  DISALLOW_COPY_AND_ASSIGN(RegExpMacroAssembler);
+};
+
+}  // namespace dart
+
+#endif  // VM_REGEXP_COMPILER_H_
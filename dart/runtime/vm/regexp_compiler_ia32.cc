@@ -0,0 +1,231 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"  // Needed here to get TARGET_ARCH_IA32.
+#if defined(TARGET_ARCH_IA32)
+
+#include "vm/regexp_compiler.h"
+
+#include "vm/assembler.h"
+
+namespace dart {
+
+// Register usage of the generated code. The callee saved registers are
+// saved in the prologue and restored on return.
+static const Register kState = EDI;  // RegExpMatchState, the argument.
+static const Register kSubject = ESI;
+static const Register kLength = EDX;
+static const Register kPosition = ECX;
+static const Register kStackPointer = EBX;  // Next free backtrack stack slot.
+static const Register kCaptures = EBP;
+static const Register kChar = EAX;  // Current character and scratch.
+
+// Registers saved by the prologue, in push order.
+static const Register kSavedRegisters[] = { EBX, ESI, EDI, EBP };
+static const intptr_t kNumSavedRegisters = ARRAY_SIZE(kSavedRegisters);
+
+#define __ assembler_->
+
+
+static Address StateAddress(intptr_t offset) {
+  return Address(kState, offset);
+}
+
+
+static Address CaptureAddress(intptr_t index) {
+  return Address(kCaptures, index * kWordSize);
+}
+
+
+RegExpMacroAssembler::RegExpMacroAssembler(Assembler* assembler,
+                                           intptr_t char_size,
+                                           intptr_t num_captures)
+    : assembler_(assembler),
+      char_size_(char_size),
+      num_captures_(num_captures) {
+}
+
+
+void RegExpMacroAssembler::Bind(Label* label) {
+  __ Bind(label);
+}
+
+
+void RegExpMacroAssembler::Jump(Label* label) {
+  __ jmp(label);
+}
+
+
+void RegExpMacroAssembler::Prologue() {
+  for (intptr_t i = 0; i < kNumSavedRegisters; i++) {
+    __ pushl(kSavedRegisters[i]);
+  }
+  // The argument is above the saved registers and the return address.
+  __ movl(kState, Address(ESP, (kNumSavedRegisters + 1) * kWordSize));
+  __ movl(kSubject, StateAddress(OFFSET_OF(RegExpMatchState, subject)));
+  __ movl(kLength, StateAddress(OFFSET_OF(RegExpMatchState, length)));
+  __ movl(kCaptures, StateAddress(OFFSET_OF(RegExpMatchState, captures)));
+}
+
+
+void RegExpMacroAssembler::Return(RegExpCompiler::Result result) {
+  __ movl(EAX, Immediate(result));
+  for (intptr_t i = kNumSavedRegisters - 1; i >= 0; i--) {
+    __ popl(kSavedRegisters[i]);
+  }
+  __ ret();
+}
+
+
+void RegExpMacroAssembler::JumpIfAttemptPastEnd(Label* label) {
+  __ cmpl(kLength, StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ j(LESS, label);
+}
+
+
+void RegExpMacroAssembler::StartAttempt() {
+  __ movl(kPosition,
+          StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ movl(kStackPointer,
+          StateAddress(OFFSET_OF(RegExpMatchState, stack_base)));
+  // The match itself is stored on success, the groups start out unset.
+  for (intptr_t i = 2; i < num_captures_; i++) {
+    __ movl(CaptureAddress(i), Immediate(-1));
+  }
+}
+
+
+void RegExpMacroAssembler::AdvanceAttempt() {
+  __ incl(StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+}
+
+
+void RegExpMacroAssembler::Succeed() {
+  __ movl(EAX, StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ movl(CaptureAddress(0), EAX);
+  __ movl(CaptureAddress(1), kPosition);
+  Return(RegExpCompiler::kMatch);
+}
+
+
+void RegExpMacroAssembler::LoadCurrentChar(Label* on_end) {
+  __ cmpl(kPosition, kLength);
+  __ j(GREATER_EQUAL, on_end);
+  if (char_size_ == 1) {
+    __ movzxb(kChar, Address(kSubject, kPosition, TIMES_1, 0));
+  } else {
+    __ movzxw(kChar, Address(kSubject, kPosition, TIMES_2, 0));
+  }
+}
+
+
+void RegExpMacroAssembler::LoadPreviousChar() {
+  if (char_size_ == 1) {
+    __ movzxb(kChar, Address(kSubject, kPosition, TIMES_1, -1));
+  } else {
+    __ movzxw(kChar, Address(kSubject, kPosition, TIMES_2, -2));
+  }
+}
+
+
+void RegExpMacroAssembler::JumpIfCharEqual(uint16_t c, Label* label) {
+  __ cmpl(kChar, Immediate(c));
+  __ j(EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::JumpIfCharInRange(uint16_t from,
+                                             uint16_t to,
+                                             Label* label) {
+  Label not_in_range;
+  __ cmpl(kChar, Immediate(from));
+  __ j(LESS, &not_in_range, Assembler::kNearJump);
+  __ cmpl(kChar, Immediate(to));
+  __ j(LESS_EQUAL, label);
+  __ Bind(&not_in_range);
+}
+
+
+void RegExpMacroAssembler::AdvancePosition(intptr_t by) {
+  __ addl(kPosition, Immediate(by));
+}
+
+
+void RegExpMacroAssembler::JumpIfAtStart(Label* label) {
+  __ cmpl(kPosition, Immediate(0));
+  __ j(EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::JumpIfAtEnd(Label* label) {
+  __ cmpl(kPosition, kLength);
+  __ j(GREATER_EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::CheckStackLimit() {
+  // There are no spare registers for the limit, compare with memory.
+  __ cmpl(kStackPointer,
+          StateAddress(OFFSET_OF(RegExpMatchState, stack_limit)));
+  __ j(ABOVE_EQUAL, &stack_overflow_);
+}
+
+
+void RegExpMacroAssembler::PushBacktrack(Label* target) {
+  CheckStackLimit();
+  // There is no instruction loading the address of a label, so call over a
+  // jump to the target and push the return address, which is the address
+  // of the jump.
+  Label push;
+  __ call(&push);
+  __ jmp(target);
+  __ Bind(&push);
+  __ popl(EAX);
+  __ movl(Address(kStackPointer, 0), EAX);
+  __ addl(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::Backtrack() {
+  __ subl(kStackPointer, Immediate(kWordSize));
+  __ movl(EAX, Address(kStackPointer, 0));
+  __ jmp(EAX);
+}
+
+
+void RegExpMacroAssembler::PushPosition() {
+  CheckStackLimit();
+  __ movl(Address(kStackPointer, 0), kPosition);
+  __ addl(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::PopPosition() {
+  __ subl(kStackPointer, Immediate(kWordSize));
+  __ movl(kPosition, Address(kStackPointer, 0));
+}
+
+
+void RegExpMacroAssembler::PushCapture(intptr_t index) {
+  CheckStackLimit();
+  __ movl(EAX, CaptureAddress(index));
+  __ movl(Address(kStackPointer, 0), EAX);
+  __ addl(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::PopCapture(intptr_t index) {
+  __ subl(kStackPointer, Immediate(kWordSize));
+  __ movl(EAX, Address(kStackPointer, 0));
+  __ movl(CaptureAddress(index), EAX);
+}
+
+
+void RegExpMacroAssembler::SetCapture(intptr_t index) {
+  __ movl(CaptureAddress(index), kPosition);
+}
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_IA32
@@ -0,0 +1,161 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"
+#if defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
+
+#include "platform/assert.h"
+#include "vm/object.h"
+#include "vm/regexp_compiler.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static const intptr_t kMaxCaptures = 8;
+
+
+// Matches the one byte subject with the pattern, from start_index on, and
+// checks the result against the expected captures, which end with -2.
+// Two byte subjects are checked with the same pattern and expectation.
+static void CheckMatch(const char* pattern,
+                       intptr_t num_groups,
+                       const char* subject,
+                       intptr_t start_index,
+                       const intptr_t* expected,
+                       bool multi_line = false) {
+  const String& source = String::Handle(String::New(pattern));
+  intptr_t length = strlen(subject);
+  uint16_t* two_byte_subject = new uint16_t[length + 1];
+  for (intptr_t i = 0; i <= length; i++) {
+    two_byte_subject[i] = subject[i];
+  }
+  for (intptr_t char_size = 1; char_size <= 2; char_size++) {
+    const Code& code = Code::Handle(RegExpCompiler::Compile(
+        source, multi_line, false, num_groups, char_size));
+    EXPECT(!code.IsNull());
+    if (code.IsNull()) {
+      break;
+    }
+    intptr_t captures[kMaxCaptures];
+    const void* data = subject;
+    if (char_size == 2) {
+      data = two_byte_subject;
+    }
+    RegExpCompiler::Result result =
+        RegExpCompiler::Execute(code, data, length, start_index, captures);
+    if (expected == NULL) {
+      EXPECT_EQ(RegExpCompiler::kNoMatch, result);
+      continue;
+    }
+    EXPECT_EQ(RegExpCompiler::kMatch, result);
+    for (intptr_t i = 0; expected[i] != -2; i++) {
+      EXPECT_EQ(expected[i], captures[i]);
+    }
+  }
+  delete[] two_byte_subject;
+}
+
+
+static bool CanCompile(const char* pattern, intptr_t num_groups) {
+  const String& source = String::Handle(String::New(pattern));
+  const Code& code = Code::Handle(
+      RegExpCompiler::Compile(source, false, false, num_groups, 1));
+  return !code.IsNull();
+}
+
+
+TEST_CASE(RegExpCompiler_Literals) {
+  const intptr_t kAbc[] = { 2, 5, -2 };
+  CheckMatch("abc", 0, "xyabcabc", 0, kAbc);
+  const intptr_t kSecondAbc[] = { 5, 8, -2 };
+  CheckMatch("abc", 0, "xyabcabc", 3, kSecondAbc);
+  CheckMatch("abc", 0, "xyabdab", 0, NULL);
+  CheckMatch("abc", 0, "abc", 4, NULL);
+  const intptr_t kEmpty[] = { 3, 3, -2 };
+  CheckMatch("", 0, "abc", 3, kEmpty);
+}
+
+
+TEST_CASE(RegExpCompiler_Classes) {
+  const intptr_t kDigits[] = { 3, 6, -2 };
+  CheckMatch("\\d+", 0, "ab 123 cd", 0, kDigits);
+  CheckMatch("[0-9]+", 0, "ab 123 cd", 0, kDigits);
+  const intptr_t kNotSpace[] = { 0, 2, -2 };
+  CheckMatch("[^ ]+", 0, "ab 123 cd", 0, kNotSpace);
+  CheckMatch("\\S+", 0, "ab 123 cd", 0, kNotSpace);
+  const intptr_t kDot[] = { 0, 2, -2 };
+  CheckMatch(".*", 0, "ab\ncd", 0, kDot);
+  const intptr_t kWord[] = { 1, 4, -2 };
+  CheckMatch("\\w+", 0, "-a_1-", 0, kWord);
+}
+
+
+TEST_CASE(RegExpCompiler_Groups) {
+  const intptr_t kRequest[] = { 0, 15, 0, 3, 4, 6, 12, 15, -2 };
+  CheckMatch("(GET|POST) (/[a-z]*) HTTP/(\\d\\.\\d)", 3,
+             "GET /a HTTP/1.0", 0, kRequest);
+  const intptr_t kAlternative[] = { 0, 3, -1, -1, 0, 3, -2 };
+  CheckMatch("(a+b)|(a+c)", 2, "aac", 0, kAlternative);
+  const intptr_t kLast[] = { 0, 3, 2, 3, -2 };
+  CheckMatch("(?:(\\w))+", 1, "abc", 0, kLast);
+}
+
+
+TEST_CASE(RegExpCompiler_Quantifiers) {
+  const intptr_t kGreedy[] = { 0, 5, 0, 4, -2 };
+  CheckMatch("(a.*)b", 1, "axbxb", 0, kGreedy);
+  const intptr_t kLazy[] = { 0, 3, 0, 2, -2 };
+  CheckMatch("(a.*?)b", 1, "axbxb", 0, kLazy);
+  const intptr_t kCount[] = { 0, 3, -2 };
+  CheckMatch("a{2,3}", 0, "aaaa", 0, kCount);
+  const intptr_t kLazyCount[] = { 0, 2, -2 };
+  CheckMatch("a{2,3}?", 0, "aaaa", 0, kLazyCount);
+  CheckMatch("a{2,3}", 0, "abaca", 0, NULL);
+  const intptr_t kOptional[] = { 0, 2, -2 };
+  CheckMatch("ab?", 0, "abc", 0, kOptional);
+}
+
+
+TEST_CASE(RegExpCompiler_Anchors) {
+  const intptr_t kStart[] = { 0, 2, -2 };
+  CheckMatch("^ab", 0, "abab", 0, kStart);
+  CheckMatch("^ab", 0, "abab", 1, NULL);
+  const intptr_t kEnd[] = { 2, 4, -2 };
+  CheckMatch("ab$", 0, "abab", 0, kEnd);
+  const intptr_t kSecondLine[] = { 3, 5, -2 };
+  CheckMatch("^cd$", 0, "ab\ncd\nef", 0, kSecondLine, true);
+  CheckMatch("^cd$", 0, "ab\ncd\nef", 0, NULL, false);
+}
+
+
+TEST_CASE(RegExpCompiler_LongSubject) {
+  // Needs a larger backtrack stack than the initial one.
+  const intptr_t kLength = 100000;
+  char* subject = new char[kLength + 2];
+  memset(subject, 'a', kLength);
+  subject[kLength] = 'b';
+  subject[kLength + 1] = '\0';
+  const intptr_t kAll[] = { 0, kLength + 1, -2 };
+  CheckMatch("a*b", 0, subject, 0, kAll);
+  delete[] subject;
+}
+
+
+TEST_CASE(RegExpCompiler_Unsupported) {
+  EXPECT(CanCompile("a(b|c)*d", 1));
+  EXPECT(!CanCompile("(a)\\1", 1));  // Back reference.
+  EXPECT(!CanCompile("a(?=b)", 0));  // Lookahead.
+  EXPECT(!CanCompile("\\bword\\b", 0));  // Word boundary.
+  EXPECT(!CanCompile("(a*)*", 1));  // Repeat of an empty match.
+  EXPECT(!CanCompile("(a|(b))+", 2));  // Optional group in a loop.
+  EXPECT(!CanCompile("a(b", 1));  // Syntax error.
+  EXPECT(!CanCompile("(a)", 0));  // Group count mismatch.
+  const String& source = String::Handle(String::New("abc"));
+  EXPECT(Code::Handle(
+      RegExpCompiler::Compile(source, false, true, 0, 1)).IsNull());
+}
+
+}  // namespace dart
+
+#endif  // defined(TARGET_ARCH_IA32) || defined(TARGET_ARCH_X64)
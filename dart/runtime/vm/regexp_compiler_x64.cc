@@ -0,0 +1,220 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/globals.h"  // Needed here to get TARGET_ARCH_X64.
+#if defined(TARGET_ARCH_X64)
+
+#include "vm/regexp_compiler.h"
+
+#include "vm/assembler.h"
+
+namespace dart {
+
+// Register usage of the generated code. Only caller saved registers are
+// used, and TMP is left to the assembler.
+static const Register kState = RDI;  // RegExpMatchState, the argument.
+static const Register kSubject = RSI;
+static const Register kLength = RDX;
+static const Register kPosition = RCX;
+static const Register kStackPointer = R8;  // Next free backtrack stack slot.
+static const Register kStackLimit = R9;
+static const Register kCaptures = R10;
+static const Register kChar = RAX;  // Current character and scratch.
+
+#define __ assembler_->
+
+
+static Address StateAddress(intptr_t offset) {
+  return Address(kState, offset);
+}
+
+
+static Address CaptureAddress(intptr_t index) {
+  return Address(kCaptures, index * kWordSize);
+}
+
+
+RegExpMacroAssembler::RegExpMacroAssembler(Assembler* assembler,
+                                           intptr_t char_size,
+                                           intptr_t num_captures)
+    : assembler_(assembler),
+      char_size_(char_size),
+      num_captures_(num_captures) {
+}
+
+
+void RegExpMacroAssembler::Bind(Label* label) {
+  __ Bind(label);
+}
+
+
+void RegExpMacroAssembler::Jump(Label* label) {
+  __ jmp(label);
+}
+
+
+void RegExpMacroAssembler::Prologue() {
+  __ movq(kSubject, StateAddress(OFFSET_OF(RegExpMatchState, subject)));
+  __ movq(kLength, StateAddress(OFFSET_OF(RegExpMatchState, length)));
+  __ movq(kCaptures, StateAddress(OFFSET_OF(RegExpMatchState, captures)));
+  __ movq(kStackLimit,
+          StateAddress(OFFSET_OF(RegExpMatchState, stack_limit)));
+}
+
+
+void RegExpMacroAssembler::Return(RegExpCompiler::Result result) {
+  __ movq(RAX, Immediate(result));
+  __ ret();
+}
+
+
+void RegExpMacroAssembler::JumpIfAttemptPastEnd(Label* label) {
+  __ cmpq(kLength, StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ j(LESS, label);
+}
+
+
+void RegExpMacroAssembler::StartAttempt() {
+  __ movq(kPosition,
+          StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ movq(kStackPointer,
+          StateAddress(OFFSET_OF(RegExpMatchState, stack_base)));
+  // The match itself is stored on success, the groups start out unset.
+  for (intptr_t i = 2; i < num_captures_; i++) {
+    __ movq(CaptureAddress(i), Immediate(-1));
+  }
+}
+
+
+void RegExpMacroAssembler::AdvanceAttempt() {
+  __ incq(StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+}
+
+
+void RegExpMacroAssembler::Succeed() {
+  __ movq(RAX, StateAddress(OFFSET_OF(RegExpMatchState, start_index)));
+  __ movq(CaptureAddress(0), RAX);
+  __ movq(CaptureAddress(1), kPosition);
+  Return(RegExpCompiler::kMatch);
+}
+
+
+void RegExpMacroAssembler::LoadCurrentChar(Label* on_end) {
+  __ cmpq(kPosition, kLength);
+  __ j(GREATER_EQUAL, on_end);
+  if (char_size_ == 1) {
+    __ movzxb(kChar, Address(kSubject, kPosition, TIMES_1, 0));
+  } else {
+    __ movzxw(kChar, Address(kSubject, kPosition, TIMES_2, 0));
+  }
+}
+
+
+void RegExpMacroAssembler::LoadPreviousChar() {
+  if (char_size_ == 1) {
+    __ movzxb(kChar, Address(kSubject, kPosition, TIMES_1, -1));
+  } else {
+    __ movzxw(kChar, Address(kSubject, kPosition, TIMES_2, -2));
+  }
+}
+
+
+void RegExpMacroAssembler::JumpIfCharEqual(uint16_t c, Label* label) {
+  __ cmpq(kChar, Immediate(c));
+  __ j(EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::JumpIfCharInRange(uint16_t from,
+                                             uint16_t to,
+                                             Label* label) {
+  Label not_in_range;
+  __ cmpq(kChar, Immediate(from));
+  __ j(LESS, &not_in_range, Assembler::kNearJump);
+  __ cmpq(kChar, Immediate(to));
+  __ j(LESS_EQUAL, label);
+  __ Bind(&not_in_range);
+}
+
+
+void RegExpMacroAssembler::AdvancePosition(intptr_t by) {
+  __ addq(kPosition, Immediate(by));
+}
+
+
+void RegExpMacroAssembler::JumpIfAtStart(Label* label) {
+  __ cmpq(kPosition, Immediate(0));
+  __ j(EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::JumpIfAtEnd(Label* label) {
+  __ cmpq(kPosition, kLength);
+  __ j(GREATER_EQUAL, label);
+}
+
+
+void RegExpMacroAssembler::CheckStackLimit() {
+  __ cmpq(kStackPointer, kStackLimit);
+  __ j(ABOVE_EQUAL, &stack_overflow_);
+}
+
+
+void RegExpMacroAssembler::PushBacktrack(Label* target) {
+  CheckStackLimit();
+  // There is no instruction loading the address of a label, so call over a
+  // jump to the target and push the return address, which is the address
+  // of the jump.
+  Label push;
+  __ call(&push);
+  __ jmp(target);
+  __ Bind(&push);
+  __ popq(RAX);
+  __ movq(Address(kStackPointer, 0), RAX);
+  __ addq(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::Backtrack() {
+  __ subq(kStackPointer, Immediate(kWordSize));
+  __ movq(RAX, Address(kStackPointer, 0));
+  __ jmp(RAX);
+}
+
+
+void RegExpMacroAssembler::PushPosition() {
+  CheckStackLimit();
+  __ movq(Address(kStackPointer, 0), kPosition);
+  __ addq(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::PopPosition() {
+  __ subq(kStackPointer, Immediate(kWordSize));
+  __ movq(kPosition, Address(kStackPointer, 0));
+}
+
+
+void RegExpMacroAssembler::PushCapture(intptr_t index) {
+  CheckStackLimit();
+  __ movq(RAX, CaptureAddress(index));
+  __ movq(Address(kStackPointer, 0), RAX);
+  __ addq(kStackPointer, Immediate(kWordSize));
+}
+
+
+void RegExpMacroAssembler::PopCapture(intptr_t index) {
+  __ subq(kStackPointer, Immediate(kWordSize));
+  __ movq(RAX, Address(kStackPointer, 0));
+  __ movq(CaptureAddress(index), RAX);
+}
+
+
+void RegExpMacroAssembler::SetCapture(intptr_t index) {
+  __ movq(CaptureAddress(index), kPosition);
+}
+
+}  // namespace dart
+
+#endif  // defined TARGET_ARCH_X64
@@ -7,13 +7,19 @@
 #include <algorithm>
 #include <map>
 #include <utility>
+#include <vector>
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/freelist.h"
+#include "vm/gc_marker.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/stack_frame.h"
 #include "vm/store_buffer.h"
+#include "vm/thread.h"
+#include "vm/thread_pool.h"
 #include "vm/verifier.h"
 #include "vm/visitor.h"
 #include "vm/weak_table.h"
@@ -21,6 +27,10 @@
 
 namespace dart {
 
+DEFINE_FLAG(int, scavenger_tasks, 0,
+            "The number of tasks to spawn during scavenges "
+            "(0 means perform all scavenging on main thread).");
+
 // Scavenger uses RawObject::kMarkBit to distinguish forwaded and non-forwarded
 // objects. The kMarkBit does not intersect with the target address because of
 // object alignment.
@@ -66,20 +76,104 @@ class BoolScope : public ValueObject {
 };
 
 
+// Regions of to-space holding copied but not yet scanned objects, shared by
+// the tasks of a parallel scavenge. A task donates the unscanned part of an
+// allocation buffer when it retires the buffer, and takes a region once it has
+// run out of work of its own. The scavenge is complete when all tasks are
+// waiting for work and no regions are left.
+class ScavengerWorkList : public ValueObject {
+ public:
+  explicit ScavengerWorkList(intptr_t num_tasks)
+      : num_tasks_(num_tasks),
+        num_waiting_(0),
+        num_helpers_done_(0) {
+    ASSERT(num_tasks > 1);
+  }
+
+  ~ScavengerWorkList() {
+    ASSERT(regions_.empty());
+  }
+
+  void AddRegion(uword start, uword end) {
+    MonitorLocker ml(&monitor_);
+    regions_.push_back(std::make_pair(start, end));
+    ml.Notify();
+  }
+
+  // Returns false once all tasks have run out of work.
+  bool TakeRegion(uword* start, uword* end) {
+    MonitorLocker ml(&monitor_);
+    num_waiting_++;
+    while (regions_.empty() && (num_waiting_ < num_tasks_)) {
+      ml.Wait();
+    }
+    if (regions_.empty()) {
+      // Nobody is left to produce work: wake up the other waiting tasks.
+      ml.NotifyAll();
+      return false;
+    }
+    num_waiting_--;
+    *start = regions_.back().first;
+    *end = regions_.back().second;
+    regions_.pop_back();
+    return true;
+  }
+
+  void HelperDone() {
+    MonitorLocker ml(&monitor_);
+    num_helpers_done_++;
+    ml.NotifyAll();
+  }
+
+  // The main scavenging task is not a helper.
+  void WaitForHelpers() {
+    MonitorLocker ml(&monitor_);
+    while (num_helpers_done_ < (num_tasks_ - 1)) {
+      ml.Wait();
+    }
+  }
+
+  // Serializes the allocation of promoted objects in the old generation.
+  Mutex* promotion_mutex() { return &promotion_mutex_; }
+
+ private:
+  Monitor monitor_;
+  Mutex promotion_mutex_;
+  std::vector<std::pair<uword, uword> > regions_;
+  const intptr_t num_tasks_;
+  intptr_t num_waiting_;
+  intptr_t num_helpers_done_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerWorkList);
+};
+
+
 class ScavengerVisitor : public ObjectPointerVisitor {
  public:
-  explicit ScavengerVisitor(Isolate* isolate, Scavenger* scavenger)
+  // A non-NULL work_list selects parallel scavenging: objects are copied into
+  // private allocation buffers and forwarded atomically, and work that must
+  // happen on the isolate's thread (store buffer updates) or after all tasks
+  // are done (weak properties) is deferred.
+  ScavengerVisitor(Isolate* isolate,
+                   Scavenger* scavenger,
+                   ScavengerWorkList* work_list)
       : ObjectPointerVisitor(isolate),
         scavenger_(scavenger),
         heap_(scavenger->heap_),
         vm_heap_(Dart::vm_isolate()->heap()),
+        work_list_(work_list),
         visited_count_(0),
         handled_count_(0),
         delayed_weak_stack_(),
         growth_policy_(PageSpace::kControlGrowth),
         bytes_promoted_(0),
         visiting_old_object_(NULL),
-        in_scavenge_pointer_(false) { }
+        in_scavenge_pointer_(false),
+        lab_top_(0),
+        lab_end_(0),
+        lab_scanned_(0),
+        promotion_top_(0),
+        promotion_end_(0) { }
 
   void VisitPointers(RawObject** first, RawObject** last) {
     for (RawObject** current = first; current <= last; current++) {
@@ -119,7 +213,77 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   intptr_t handled_count() const { return handled_count_; }
   intptr_t bytes_promoted() const { return bytes_promoted_; }
 
+  // Parallel mode: scans the objects copied by this task and the regions
+  // donated by the other tasks until all tasks have run out of work.
+  void DrainWorkList() {
+    ASSERT(work_list_ != NULL);
+    while (true) {
+      while (ProcessLocalWork()) {}
+      uword start = 0;
+      uword end = 0;
+      if (!work_list_->TakeRegion(&start, &end)) {
+        return;
+      }
+      ScanRegion(start, end);
+    }
+  }
+
+  // Called on the isolate's thread once all tasks are done. Gives back the
+  // unused parts of the allocation buffers and takes over the work deferred
+  // by the given task, which may be this visitor itself.
+  void AbsorbDeferredWork(ScavengerVisitor* task) {
+    ASSERT(task->lab_scanned_ == task->lab_top_);
+    ASSERT(task->pending_.empty());
+    task->RetireLab();
+    {
+      MutexLocker ml(work_list_->promotion_mutex());
+      task->RetirePromotionLabLocked();
+    }
+    StoreBuffer* store_buffer = isolate()->store_buffer();
+    for (size_t i = 0; i < task->remembered_.size(); i++) {
+      store_buffer->AddObjectGC(task->remembered_[i]);
+    }
+    task->remembered_.clear();
+    delayed_weak_properties_.insert(delayed_weak_properties_.end(),
+                                    task->delayed_weak_properties_.begin(),
+                                    task->delayed_weak_properties_.end());
+    task->delayed_weak_properties_.clear();
+    if (task != this) {
+      visited_count_ += task->visited_count_;
+      handled_count_ += task->handled_count_;
+      bytes_promoted_ += task->bytes_promoted_;
+    }
+  }
+
+  // Switches to serial scavenging for the rest of the scavenge. The weak
+  // properties whose keys were not known to be reachable during the parallel
+  // phase are revisited.
+  void FinishParallel() {
+    ASSERT(work_list_ != NULL);
+    work_list_ = NULL;
+    if (scavenger_->had_promotion_failure_) {
+      growth_policy_ = PageSpace::kForceGrowth;
+    }
+    for (size_t i = 0; i < delayed_weak_properties_.size(); i++) {
+      scavenger_->ProcessWeakProperty(delayed_weak_properties_[i], this);
+    }
+    delayed_weak_properties_.clear();
+  }
+
  private:
+  // Allocation buffers of parallel tasks in to-space and in the old
+  // generation. Objects larger than a quarter of a buffer are allocated
+  // directly.
+  static const intptr_t kLabSize = 32 * KB;
+  static const intptr_t kPromotionLabSize = 32 * KB;
+
+  enum AllocationKind {
+    kToSpaceLab,
+    kToSpaceDirect,
+    kPromotionLab,
+    kPromotionDirect
+  };
+
   void UpdateStoreBuffer(RawObject** p, RawObject* obj) {
     uword ptr = reinterpret_cast<uword>(p);
     ASSERT(obj->IsHeapObject());
@@ -131,9 +295,212 @@ class ScavengerVisitor : public ObjectPointerVisitor {
       return;
     }
     visiting_old_object_->SetRememberedBit();
+    if (work_list_ != NULL) {
+      // The store buffer belongs to the isolate's thread.
+      remembered_.push_back(visiting_old_object_);
+      return;
+    }
     isolate()->store_buffer()->AddObjectGC(visiting_old_object_);
   }
 
+  bool ProcessLocalWork() {
+    if (lab_scanned_ < lab_top_) {
+      uword start = lab_scanned_;
+      uword end = lab_top_;
+      // Objects copied while scanning are picked up in the next round.
+      lab_scanned_ = end;
+      ScanRegion(start, end);
+      return true;
+    }
+    if (!pending_.empty()) {
+      RawObject* raw_obj = pending_.back();
+      pending_.pop_back();
+      if (raw_obj->IsOldObject()) {
+        VisitingOldObject(raw_obj);
+        raw_obj->VisitPointers(this);
+        VisitingOldObject(NULL);
+      } else {
+        ScanNewObject(raw_obj);
+      }
+      return true;
+    }
+    return false;
+  }
+
+  void ScanRegion(uword start, uword end) {
+    uword current = start;
+    while (current < end) {
+      current += ScanNewObject(RawObject::FromAddr(current));
+    }
+    ASSERT(current == end);
+  }
+
+  intptr_t ScanNewObject(RawObject* raw_obj) {
+    if (raw_obj->GetClassId() != kWeakPropertyCid) {
+      return raw_obj->VisitPointers(this);
+    }
+    RawWeakProperty* raw_weak = reinterpret_cast<RawWeakProperty*>(raw_obj);
+    RawObject* raw_key = raw_weak->ptr()->key_;
+    if (raw_key->IsHeapObject() && raw_key->IsNewObject()) {
+      uword header = *reinterpret_cast<uword*>(RawObject::ToAddr(raw_key));
+      if (!IsForwarding(header)) {
+        // Watched bits cannot be maintained by concurrent tasks. Keep the
+        // weak property until all tasks are done.
+        delayed_weak_properties_.push_back(raw_weak);
+        return WeakProperty::InstanceSize();
+      }
+    }
+    return raw_weak->VisitPointers(this);
+  }
+
+  // Parallel mode: copies the object and races the other tasks to install the
+  // forwarding address. Returns the address of the winning copy.
+  uword CopyAndForward(RawObject* raw_obj, uword header) {
+    ASSERT(!RawObject::WatchedBit::decode(header));
+    uword raw_addr = RawObject::ToAddr(raw_obj);
+    intptr_t size = raw_obj->SizeFromTags(header, isolate()->class_table());
+    AllocationKind kind;
+    uword new_addr = AllocateCopy(raw_addr, size, &kind);
+    memmove(reinterpret_cast<void*>(new_addr),
+            reinterpret_cast<void*>(raw_addr),
+            size);
+    // The header of the copy might have been read after another task forwarded
+    // the object. Only the header read above can be trusted.
+    *reinterpret_cast<uword*>(new_addr) = header;
+    ASSERT((new_addr & kForwardingMask) == 0);
+    uword previous = AtomicOperations::CompareAndSwapWord(
+        reinterpret_cast<uword*>(raw_addr), header, new_addr | kForwarded);
+    if (previous == header) {
+      if (kind != kToSpaceLab) {
+        // Not covered by the scan of the allocation buffer.
+        pending_.push_back(RawObject::FromAddr(new_addr));
+      }
+      if ((kind == kPromotionLab) || (kind == kPromotionDirect)) {
+        bytes_promoted_ += size;
+      }
+      return new_addr;
+    }
+    // Another task forwarded the object first. Give back the copy.
+    switch (kind) {
+      case kToSpaceLab:
+        ASSERT(lab_top_ == (new_addr + size));
+        lab_top_ = new_addr;
+        break;
+      case kPromotionLab:
+        ASSERT(promotion_top_ == (new_addr + size));
+        promotion_top_ = new_addr;
+        break;
+      default:
+        // Keep the heap parsable.
+        FreeListElement::AsElement(new_addr, size);
+        break;
+    }
+    return ForwardedAddr(previous);
+  }
+
+  uword AllocateCopy(uword raw_addr, intptr_t size, AllocationKind* kind) {
+    uword result = 0;
+    if (scavenger_->survivor_end_ <= raw_addr) {
+      result = TryAllocateInToSpace(size, kind);
+      if (result == 0) {
+        // Unlike the serial scavenge, the parallel one can run out of
+        // to-space because of the unused ends of the allocation buffers.
+        result = TryPromote(size, kind);
+      }
+    } else {
+      result = TryPromote(size, kind);
+      if (result == 0) {
+        result = TryAllocateInToSpace(size, kind);
+      }
+    }
+    if (result == 0) {
+      FATAL("Out of memory during parallel scavenge.\n");
+    }
+    return result;
+  }
+
+  uword TryAllocateInToSpace(intptr_t size, AllocationKind* kind) {
+    if (size <= (kLabSize / 4)) {
+      if ((lab_end_ - lab_top_) < static_cast<uword>(size)) {
+        RetireLab();
+        uword lab = scavenger_->TryAllocateShared(kLabSize);
+        if (lab != 0) {
+          lab_top_ = lab;
+          lab_end_ = lab + kLabSize;
+          lab_scanned_ = lab;
+        }
+      }
+      if ((lab_end_ - lab_top_) >= static_cast<uword>(size)) {
+        uword result = lab_top_;
+        lab_top_ += size;
+        *kind = kToSpaceLab;
+        return result;
+      }
+    }
+    *kind = kToSpaceDirect;
+    return scavenger_->TryAllocateShared(size);
+  }
+
+  uword TryPromote(intptr_t size, AllocationKind* kind) {
+    if (size <= (kPromotionLabSize / 4)) {
+      if ((promotion_end_ - promotion_top_) < static_cast<uword>(size)) {
+        MutexLocker ml(work_list_->promotion_mutex());
+        RetirePromotionLabLocked();
+        uword lab = TryAllocateOldLocked(kPromotionLabSize);
+        if (lab != 0) {
+          promotion_top_ = lab;
+          promotion_end_ = lab + kPromotionLabSize;
+        }
+      }
+      if ((promotion_end_ - promotion_top_) >= static_cast<uword>(size)) {
+        uword result = promotion_top_;
+        promotion_top_ += size;
+        *kind = kPromotionLab;
+        return result;
+      }
+      return 0;
+    }
+    MutexLocker ml(work_list_->promotion_mutex());
+    *kind = kPromotionDirect;
+    return TryAllocateOldLocked(size);
+  }
+
+  // Same growth policy as the serial scavenge, shared by all tasks.
+  uword TryAllocateOldLocked(intptr_t size) {
+    if (scavenger_->had_promotion_failure_) {
+      return heap_->TryAllocate(size, Heap::kOld, PageSpace::kForceGrowth);
+    }
+    uword result = heap_->TryAllocate(size, Heap::kOld, growth_policy_);
+    if (result == 0) {
+      scavenger_->had_promotion_failure_ = true;
+      result = heap_->TryAllocate(size, Heap::kOld, PageSpace::kForceGrowth);
+    }
+    return result;
+  }
+
+  // Shares the unscanned objects of the to-space buffer with the other tasks
+  // and keeps to-space parsable behind them.
+  void RetireLab() {
+    if (lab_scanned_ < lab_top_) {
+      work_list_->AddRegion(lab_scanned_, lab_top_);
+    }
+    if (lab_top_ < lab_end_) {
+      FreeListElement::AsElement(lab_top_, lab_end_ - lab_top_);
+    }
+    lab_top_ = 0;
+    lab_end_ = 0;
+    lab_scanned_ = 0;
+  }
+
+  void RetirePromotionLabLocked() {
+    if (promotion_top_ < promotion_end_) {
+      heap_->old_space()->ReleaseUnused(promotion_top_,
+                                        promotion_end_ - promotion_top_);
+    }
+    promotion_top_ = 0;
+    promotion_end_ = 0;
+  }
+
   void ScavengePointer(RawObject** p) {
     // ScavengePointer cannot be called recursively.
 #ifdef DEBUG
@@ -166,6 +533,8 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     if (IsForwarding(header)) {
       // Get the new location of the object.
       new_addr = ForwardedAddr(header);
+    } else if (work_list_ != NULL) {
+      new_addr = CopyAndForward(raw_obj, header);
     } else {
       if (raw_obj->IsWatched()) {
         raw_obj->ClearWatchedBit();
@@ -194,7 +563,7 @@ class ScavengerVisitor : public ObjectPointerVisitor {
         //
         // This object is a survivor of a previous scavenge. Attempt to promote
         // the object.
-        new_addr = heap_->TryAllocate(size, Heap::kOld, growth_policy_);
+        new_addr = heap_->old_space()->TryAllocateBump(size, growth_policy_);
         if (new_addr != 0) {
           // If promotion succeeded then we need to remember it so that it can
           // be traversed later.
@@ -206,7 +575,7 @@ class ScavengerVisitor : public ObjectPointerVisitor {
           // growth.
           scavenger_->had_promotion_failure_ = true;
           growth_policy_ = PageSpace::kForceGrowth;
-          new_addr = heap_->TryAllocate(size, Heap::kOld, growth_policy_);
+          new_addr = heap_->old_space()->TryAllocateBump(size, growth_policy_);
           if (new_addr != 0) {
             scavenger_->PushToPromotedStack(new_addr);
             bytes_promoted_ += size;
@@ -243,6 +612,7 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   Scavenger* scavenger_;
   Heap* heap_;
   Heap* vm_heap_;
+  ScavengerWorkList* work_list_;
   intptr_t visited_count_;
   intptr_t handled_count_;
   typedef std::multimap<RawObject*, RawWeakProperty*> DelaySet;
@@ -255,10 +625,42 @@ class ScavengerVisitor : public ObjectPointerVisitor {
   RawObject* visiting_old_object_;
   bool in_scavenge_pointer_;
 
+  // State of a parallel task. Objects in [lab_scanned_, lab_top_) have been
+  // copied into the to-space buffer but not scanned yet; pending_ holds the
+  // copied objects outside of that buffer.
+  uword lab_top_;
+  uword lab_end_;
+  uword lab_scanned_;
+  uword promotion_top_;
+  uword promotion_end_;
+  std::vector<RawObject*> pending_;
+  std::vector<RawObject*> remembered_;
+  std::vector<RawWeakProperty*> delayed_weak_properties_;
+
   DISALLOW_COPY_AND_ASSIGN(ScavengerVisitor);
 };
 
 
+class ScavengerTask : public ThreadPool::Task {
+ public:
+  ScavengerTask(ScavengerVisitor* visitor, ScavengerWorkList* work_list)
+      : visitor_(visitor),
+        work_list_(work_list) {
+  }
+
+  virtual void Run() {
+    visitor_->DrainWorkList();
+    work_list_->HelperDone();
+  }
+
+ private:
+  ScavengerVisitor* visitor_;
+  ScavengerWorkList* work_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerTask);
+};
+
+
 class ScavengerWeakVisitor : public HandleVisitor {
  public:
   explicit ScavengerWeakVisitor(Scavenger* scavenger) : scavenger_(scavenger) {
@@ -394,6 +796,7 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
   // Iterating through the store buffers.
   // Grab the deduplication sets out of the store buffer.
   StoreBufferBlock* pending = isolate->store_buffer()->Blocks();
+  IncrementalMarker* marker = heap_->incremental_marker();
   intptr_t visited_count_before = visitor->visited_count();
   intptr_t handled_count_before = visitor->handled_count();
   while (pending != NULL) {
@@ -405,6 +808,11 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
       raw_object->ClearRememberedBit();
       visitor->VisitingOldObject(raw_object);
       raw_object->VisitPointers(visitor);
+      if ((marker != NULL) && raw_object->IsMarked()) {
+        // The object was written to after it was marked. Its pointers are
+        // visited again by the incremental marker after the scavenge.
+        marker->Rescan(raw_object);
+      }
     }
     delete pending;
     pending = next;
@@ -447,6 +855,54 @@ void Scavenger::IterateRoots(Isolate* isolate,
 }
 
 
+uword Scavenger::TryAllocateShared(intptr_t size) {
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  uword result = top_;
+  while (true) {
+    if ((end_ - result) < static_cast<uword>(size)) {
+      return 0;
+    }
+    uword previous =
+        AtomicOperations::CompareAndSwapWord(&top_, result, result + size);
+    if (previous == result) {
+      return result;
+    }
+    result = previous;
+  }
+}
+
+
+void Scavenger::ScavengeParallel(Isolate* isolate,
+                                 ScavengerVisitor* visitor,
+                                 ScavengerWorkList* work_list,
+                                 bool invoke_api_callbacks) {
+  // Promotion from the helper threads must not sweep pages lazily.
+  heap_->old_space()->CompleteSweep();
+  const intptr_t num_helpers = FLAG_scavenger_tasks;
+  ScavengerVisitor** helpers = new ScavengerVisitor*[num_helpers];
+  for (intptr_t i = 0; i < num_helpers; i++) {
+    helpers[i] = new ScavengerVisitor(isolate, this, work_list);
+    Dart::thread_pool()->Run(new ScavengerTask(helpers[i], work_list));
+  }
+  // The roots have to be visited on the isolate's thread. The helpers take
+  // the objects copied from there as soon as they are donated.
+  IterateRoots(isolate, visitor, !invoke_api_callbacks);
+  int64_t start = OS::GetCurrentTimeMicros();
+  visitor->DrainWorkList();
+  work_list->WaitForHelpers();
+  visitor->AbsorbDeferredWork(visitor);
+  for (intptr_t i = 0; i < num_helpers; i++) {
+    visitor->AbsorbDeferredWork(helpers[i]);
+    delete helpers[i];
+  }
+  delete[] helpers;
+  // Everything copied so far has been scanned.
+  resolved_top_ = top_;
+  visitor->FinishParallel();
+  FinishScavenge(isolate, visitor, invoke_api_callbacks, start);
+}
+
+
 bool Scavenger::IsUnreachable(RawObject** p) {
   RawObject* raw_obj = *p;
   if (!raw_obj->IsHeapObject()) {
@@ -618,6 +1074,30 @@ void Scavenger::ProcessWeakTables() {
 }
 
 
+void Scavenger::RecordSurvival(Isolate* isolate, uword allocation_end) {
+  // The survivors of the previous scavenge are below survivor_end_ and have
+  // been accounted for already.
+  uword cur = survivor_end_;
+  while (cur < allocation_end) {
+    RawObject* raw_obj = RawObject::FromAddr(cur);
+    uword header = *reinterpret_cast<uword*>(cur);
+    bool survived = IsForwarding(header);
+    if (survived) {
+      raw_obj = RawObject::FromAddr(ForwardedAddr(header));
+    }
+    intptr_t class_id = raw_obj->GetClassId();
+    if (class_id != kFreeListElement) {
+      pretenuring_policy_.RecordAllocation(class_id, survived);
+    }
+    cur += raw_obj->Size();
+  }
+  if (pretenuring_policy_.Update()) {
+    // Optimized code cannot be deoptimized during the scavenge.
+    isolate->ScheduleInterrupts(Isolate::kPretenuringInterrupt);
+  }
+}
+
+
 void Scavenger::VisitObjectPointers(ObjectPointerVisitor* visitor) const {
   uword cur = FirstObjectStart();
   while (cur < top_) {
@@ -658,21 +1138,24 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
     OS::PrintErr(" done.\n");
   }
 
+  // Objects allocated since the last scavenge end here in from space.
+  const uword allocation_end = top_;
+
   // Setup the visitor and run a scavenge.
-  ScavengerVisitor visitor(isolate, this);
   Prologue(isolate, invoke_api_callbacks);
-  IterateRoots(isolate, &visitor, !invoke_api_callbacks);
-  int64_t start = OS::GetCurrentTimeMicros();
-  ProcessToSpace(&visitor);
-  int64_t middle = OS::GetCurrentTimeMicros();
-  IterateWeakReferences(isolate, &visitor);
-  ScavengerWeakVisitor weak_visitor(this);
-  IterateWeakRoots(isolate, &weak_visitor, invoke_api_callbacks);
-  visitor.Finalize();
-  ProcessWeakTables();
-  int64_t end = OS::GetCurrentTimeMicros();
-  heap_->RecordTime(kProcessToSpace, middle - start);
-  heap_->RecordTime(kIterateWeaks, end - middle);
+  if (FLAG_scavenger_tasks > 0) {
+    ScavengerWorkList work_list(FLAG_scavenger_tasks + 1);
+    ScavengerVisitor visitor(isolate, this, &work_list);
+    ScavengeParallel(isolate, &visitor, &work_list, invoke_api_callbacks);
+  } else {
+    ScavengerVisitor visitor(isolate, this, NULL);
+    IterateRoots(isolate, &visitor, !invoke_api_callbacks);
+    FinishScavenge(isolate, &visitor, invoke_api_callbacks,
+                   OS::GetCurrentTimeMicros());
+  }
+  if (FLAG_pretenure) {
+    RecordSurvival(isolate, allocation_end);
+  }
   Epilogue(isolate, invoke_api_callbacks);
 
   if (FLAG_verify_after_gc) {
@@ -687,6 +1170,23 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
 }
 
 
+void Scavenger::FinishScavenge(Isolate* isolate,
+                               ScavengerVisitor* visitor,
+                               bool invoke_api_callbacks,
+                               int64_t start) {
+  ProcessToSpace(visitor);
+  int64_t middle = OS::GetCurrentTimeMicros();
+  IterateWeakReferences(isolate, visitor);
+  ScavengerWeakVisitor weak_visitor(this);
+  IterateWeakRoots(isolate, &weak_visitor, invoke_api_callbacks);
+  visitor->Finalize();
+  ProcessWeakTables();
+  int64_t end = OS::GetCurrentTimeMicros();
+  heap_->RecordTime(kProcessToSpace, middle - start);
+  heap_->RecordTime(kIterateWeaks, end - middle);
+}
+
+
 void Scavenger::WriteProtect(bool read_only) {
   space_->Protect(
       read_only ? VirtualMemory::kReadOnly : VirtualMemory::kReadWrite);
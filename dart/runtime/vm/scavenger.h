@@ -9,6 +9,7 @@
 #include "platform/utils.h"
 #include "vm/flags.h"
 #include "vm/globals.h"
+#include "vm/pretenuring.h"
 #include "vm/raw_object.h"
 #include "vm/virtual_memory.h"
 #include "vm/visitor.h"
@@ -19,8 +20,10 @@ namespace dart {
 class Heap;
 class Isolate;
 class ScavengerVisitor;
+class ScavengerWorkList;
 
 DECLARE_FLAG(bool, gc_at_alloc);
+DECLARE_FLAG(int, scavenger_tasks);
 
 class Scavenger {
  public:
@@ -89,6 +92,8 @@ class Scavenger {
 
   void WriteProtect(bool read_only);
 
+  PretenuringPolicy* pretenuring_policy() { return &pretenuring_policy_; }
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -117,12 +122,25 @@ class Scavenger {
                         HandleVisitor* visitor,
                         bool visit_prologue_weak_persistent_handles);
   void ProcessToSpace(ScavengerVisitor* visitor);
+  // Copies the objects reachable from the roots using --scavenger_tasks
+  // helper tasks in addition to the isolate's thread.
+  void ScavengeParallel(Isolate* isolate,
+                        ScavengerVisitor* visitor,
+                        ScavengerWorkList* work_list,
+                        bool invoke_api_callbacks);
+  void FinishScavenge(Isolate* isolate,
+                      ScavengerVisitor* visitor,
+                      bool invoke_api_callbacks,
+                      int64_t start);
   uword ProcessWeakProperty(RawWeakProperty* raw_weak,
                             ScavengerVisitor* visitor);
   void Epilogue(Isolate* isolate, bool invoke_api_callbacks);
 
   bool IsUnreachable(RawObject** p);
 
+  // Allocation in to-space by concurrent scavenger tasks.
+  uword TryAllocateShared(intptr_t size);
+
   // During a scavenge we need to remember the promoted objects.
   // This is implemented as a stack of objects at the end of the to space. As
   // object sizes are always greater than sizeof(uword) and promoted objects do
@@ -144,6 +162,11 @@ class Scavenger {
 
   void ProcessWeakTables();
 
+  // Feeds the objects allocated since the previous scavenge, which end at
+  // allocation_end in from space, into the pretenuring policy. Schedules the
+  // deoptimization of dependent code if a decision changed.
+  void RecordSurvival(Isolate* isolate, uword allocation_end);
+
   VirtualMemory* space_;
   MemoryRegion* to_;
   MemoryRegion* from_;
@@ -170,6 +193,8 @@ class Scavenger {
   // Keep track whether the scavenge had a promotion failure.
   bool had_promotion_failure_;
 
+  PretenuringPolicy pretenuring_policy_;
+
   friend class ScavengerVisitor;
   friend class ScavengerWeakVisitor;
 
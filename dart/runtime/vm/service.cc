@@ -2,7 +2,9 @@
 // for details. All rights reserved. Use of this source code is governed by a
 // BSD-style license that can be found in the LICENSE file.
 
+#include "vm/background_compiler.h"
 #include "vm/debugger.h"
+#include "vm/heap.h"
 #include "vm/heap_histogram.h"
 #include "vm/isolate.h"
 #include "vm/message.h"
@@ -199,6 +201,16 @@ static void HandleObjectHistogram(Isolate* isolate, JSONStream* js) {
 }
 
 
+static void HandlePretenuring(Isolate* isolate, JSONStream* js) {
+  isolate->heap()->pretenuring_policy()->PrintToJSONStream(js);
+}
+
+
+static void HandleBackgroundCompiler(Isolate* isolate, JSONStream* js) {
+  isolate->background_compiler()->PrintToJSONStream(js);
+}
+
+
 static void HandleEcho(Isolate* isolate, JSONStream* js) {
   JSONObject jsobj(js);
   jsobj.AddProperty("type", "message");
@@ -258,6 +270,8 @@ static ServiceMessageHandlerEntry __message_handlers[] = {
   { "name", HandleName },
   { "stacktrace", HandleStackTrace },
   { "objecthistogram", HandleObjectHistogram},
+  { "pretenuring", HandlePretenuring },
+  { "backgroundcompiler", HandleBackgroundCompiler },
   { "library", HandleLibrary },
   { "classes", HandleClasses },
   { "objects", HandleObjects },
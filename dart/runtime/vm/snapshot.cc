@@ -4,11 +4,13 @@
 
 #include "vm/snapshot.h"
 
+#include "include/dart_api.h"
 #include "platform/assert.h"
 #include "vm/bigint_operations.h"
 #include "vm/bootstrap.h"
 #include "vm/class_finalizer.h"
 #include "vm/exceptions.h"
+#include "vm/flags.h"
 #include "vm/heap.h"
 #include "vm/longjump.h"
 #include "vm/object.h"
@@ -18,6 +20,9 @@
 
 namespace dart {
 
+DEFINE_FLAG(bool, flat_messages, true,
+    "Write messages of numbers, strings and lists without marking objects.");
+
 static const int kNumInitialReferencesInFullSnapshot = 160 * KB;
 static const int kNumInitialReferences = 64;
 
@@ -174,7 +179,16 @@ RawObject* SnapshotReader::ReadObject() {
   const Instance& null_object = Instance::Handle();
   *ErrorHandle() = UnhandledException::New(null_object, null_object);
   if (setjmp(*jump.Set()) == 0) {
-    Object& obj = Object::Handle(ReadObjectImpl());
+    Object& obj = Object::Handle();
+    int64_t header_value = Read<int64_t>();
+    if ((kind_ == Snapshot::kMessage) &&
+        (header_value == kFlatMessageHeader)) {
+      obj = ReadFlatObject();
+    } else if ((header_value & kSmiTagMask) == kSmiTag) {
+      obj = NewInteger(header_value);
+    } else {
+      obj = ReadObjectImpl(header_value);
+    }
     for (intptr_t i = 0; i < backward_references_.length(); i++) {
       if (!backward_references_[i]->is_deserialized()) {
         ReadObjectImpl();
@@ -239,6 +253,86 @@ RawObject* SnapshotReader::ReadObjectImpl(intptr_t header_value) {
 }
 
 
+RawObject* SnapshotReader::ReadFlatObject() {
+  Heap::Space space = HEAP_SPACE(kind_);
+  intptr_t tag = Read<int8_t>();
+  switch (tag) {
+    case kFlatNull:
+      return Object::null();
+    case kFlatTrue:
+      return Bool::True().raw();
+    case kFlatFalse:
+      return Bool::False().raw();
+    case kFlatInteger:
+      return Integer::New(Read<int64_t>(), space);
+    case kFlatDouble:
+      return Double::New(Read<double>(), space);
+    case kFlatOneByteString: {
+      intptr_t len = ReadIntptrValue();
+      const String& str = String::Handle(OneByteString::New(len, space));
+      if (len > 0) {
+        NoGCScope no_gc;
+        ReadBytes(OneByteString::CharAddr(str, 0), len);
+      }
+      return str.raw();
+    }
+    case kFlatTwoByteString: {
+      intptr_t len = ReadIntptrValue();
+      const String& str = String::Handle(TwoByteString::New(len, space));
+      NoGCScope no_gc;
+      for (intptr_t i = 0; i < len; i++) {
+        *TwoByteString::CharAddr(str, i) = Read<uint16_t>();
+      }
+      return str.raw();
+    }
+    case kFlatArray:
+    case kFlatGrowableArray: {
+      intptr_t len = ReadIntptrValue();
+      const Array& array = Array::Handle(Array::New(len, space));
+      Object& element = Object::Handle();
+      for (intptr_t i = 0; i < len; i++) {
+        element = ReadFlatObject();
+        array.SetAt(i, element);
+      }
+      if (tag == kFlatArray) {
+        return array.raw();
+      }
+      return GrowableObjectArray::New(array, space);
+    }
+    case kFlatUint8Array: {
+      intptr_t len = ReadIntptrValue();
+      const TypedData& data = TypedData::Handle(
+          TypedData::New(kTypedDataUint8ArrayCid, len, space));
+      if (len > 0) {
+        NoGCScope no_gc;
+        ReadBytes(reinterpret_cast<uint8_t*>(data.DataAddr(0)), len);
+      }
+      return data.raw();
+    }
+    case kFlatUtf8String: {
+      intptr_t len = ReadIntptrValue();
+      uint8_t* utf8 = isolate()->current_zone()->Alloc<uint8_t>(len);
+      ReadBytes(utf8, len);
+      return String::FromUTF8(utf8, len, space);
+    }
+    case kFlatCanonical: {
+      // Literals and symbols must stay identical to those of the receiver.
+      const Object& obj = Object::Handle(ReadFlatObject());
+      if (obj.IsString()) {
+        return Symbols::New(String::Cast(obj));
+      }
+      if (obj.IsMint() || obj.IsDouble()) {
+        return Instance::Cast(obj).CheckAndCanonicalize(NULL);
+      }
+      return obj.raw();
+    }
+    default:
+      UNREACHABLE();
+      return Object::null();
+  }
+}
+
+
 RawObject* SnapshotReader::ReadObjectRef() {
   int64_t header_value = Read<int64_t>();
   if ((header_value & kSmiTagMask) == kSmiTag) {
@@ -888,6 +982,8 @@ SnapshotWriter::SnapshotWriter(Snapshot::Kind kind,
                                ReAlloc alloc,
                                intptr_t initial_size)
     : BaseWriter(buffer, alloc, initial_size),
+      transferable_class_(NULL),
+      transfers_(),
       kind_(kind),
       object_store_(Isolate::Current()->object_store()),
       class_table_(Isolate::Current()->class_table()),
@@ -1412,6 +1508,23 @@ void SnapshotWriter::WriteInstance(intptr_t object_id,
   // Write out the class information for this object.
   WriteObjectImpl(cls);
 
+  // The bytes of a TransferableTypedData are moved to the receiver when
+  // they are written, see RawExternalTypedData::WriteTo.
+  if (cls == transferable_class_) {
+    RawObject* bytes = *reinterpret_cast<RawObject**>(
+        reinterpret_cast<uword>(raw->ptr()) + Instance::NextFieldOffset());
+    if (bytes->IsHeapObject() &&
+        (RawObject::ClassIdTag::decode(GetObjectTags(bytes)) ==
+         kExternalTypedDataUint8ArrayCid)) {
+      Transfer transfer = { reinterpret_cast<RawInstance*>(raw),
+                            NULL,
+                            reinterpret_cast<RawExternalTypedData*>(bytes),
+                            NULL,
+                            NULL };
+      transfers_.Add(transfer);
+    }
+  }
+
   // Write out all the fields for the object.
   // Instance::NextFieldOffset() returns the offset of the first field in
   // a Dart object.
@@ -1425,6 +1538,138 @@ void SnapshotWriter::WriteInstance(intptr_t object_id,
 }
 
 
+bool SnapshotWriter::WriteFlatObject(RawObject* raw,
+                                     FlatMessageObjects* objects) {
+  if (!raw->IsHeapObject()) {
+    Write<int8_t>(kFlatInteger);
+    Write<int64_t>(Smi::Value(reinterpret_cast<RawSmi*>(raw)));
+    return true;
+  }
+  if (raw == Object::null()) {
+    Write<int8_t>(kFlatNull);
+    return true;
+  }
+  if (raw == Bool::True().raw()) {
+    Write<int8_t>(kFlatTrue);
+    return true;
+  }
+  if (raw == Bool::False().raw()) {
+    Write<int8_t>(kFlatFalse);
+    return true;
+  }
+  const intptr_t cid = raw->GetClassId();
+  if (raw->IsCanonical()) {
+    // Other constants, like const lists, are written in the regular format.
+    if ((cid != kMintCid) && (cid != kDoubleCid) &&
+        (cid != kOneByteStringCid) && (cid != kTwoByteStringCid)) {
+      return false;
+    }
+    Write<int8_t>(kFlatCanonical);
+  }
+  switch (cid) {
+    case kMintCid:
+      Write<int8_t>(kFlatInteger);
+      Write<int64_t>(reinterpret_cast<RawMint*>(raw)->ptr()->value_);
+      return true;
+    case kDoubleCid:
+      Write<int8_t>(kFlatDouble);
+      Write<double>(reinterpret_cast<RawDouble*>(raw)->ptr()->value_);
+      return true;
+    case kOneByteStringCid: {
+      if (!objects->Add(raw)) {
+        return false;
+      }
+      RawOneByteString* str = reinterpret_cast<RawOneByteString*>(raw);
+      intptr_t len = Smi::Value(str->ptr()->length_);
+      Write<int8_t>(kFlatOneByteString);
+      WriteIntptrValue(len);
+      WriteBytes(str->ptr()->data_, len);
+      return true;
+    }
+    case kTwoByteStringCid: {
+      if (!objects->Add(raw)) {
+        return false;
+      }
+      RawTwoByteString* str = reinterpret_cast<RawTwoByteString*>(raw);
+      intptr_t len = Smi::Value(str->ptr()->length_);
+      Write<int8_t>(kFlatTwoByteString);
+      WriteIntptrValue(len);
+      for (intptr_t i = 0; i < len; i++) {
+        Write<uint16_t>(str->ptr()->data_[i]);
+      }
+      return true;
+    }
+    case kArrayCid: {
+      RawArray* array = reinterpret_cast<RawArray*>(raw);
+      if ((array->ptr()->type_arguments_ != TypeArguments::null()) ||
+          !objects->Add(raw)) {
+        return false;
+      }
+      intptr_t len = Smi::Value(array->ptr()->length_);
+      Write<int8_t>(kFlatArray);
+      WriteIntptrValue(len);
+      for (intptr_t i = 0; i < len; i++) {
+        if (!WriteFlatObject(array->ptr()->data()[i], objects)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case kGrowableObjectArrayCid: {
+      RawGrowableObjectArray* array =
+          reinterpret_cast<RawGrowableObjectArray*>(raw);
+      if ((array->ptr()->type_arguments_ != TypeArguments::null()) ||
+          !objects->Add(raw)) {
+        return false;
+      }
+      intptr_t len = Smi::Value(array->ptr()->length_);
+      RawObject** data = array->ptr()->data_->ptr()->data();
+      Write<int8_t>(kFlatGrowableArray);
+      WriteIntptrValue(len);
+      for (intptr_t i = 0; i < len; i++) {
+        if (!WriteFlatObject(data[i], objects)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case kTypedDataUint8ArrayCid: {
+      if (!objects->Add(raw)) {
+        return false;
+      }
+      RawTypedData* data = reinterpret_cast<RawTypedData*>(raw);
+      intptr_t len = Smi::Value(data->ptr()->length_);
+      Write<int8_t>(kFlatUint8Array);
+      WriteIntptrValue(len);
+      WriteBytes(data->ptr()->data_, len);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+
+TransferableTypedDataPeer* SnapshotWriter::TransferPeerFor(
+    RawExternalTypedData* raw, void* peer) {
+  for (intptr_t i = 0; i < transfers_.length(); i++) {
+    Transfer* transfer = &transfers_[i];
+    if (transfer->bytes == raw) {
+      ASSERT(transfer->receiver_peer == NULL);
+      transfer->sender_peer = reinterpret_cast<TransferableTypedDataPeer*>(peer);
+      if ((transfer->sender_peer == NULL) ||
+          (transfer->sender_peer->data() == NULL)) {
+        return NULL;
+      }
+      transfer->receiver_peer =
+          new TransferableTypedDataPeer(transfer->sender_peer->data());
+      return transfer->receiver_peer;
+    }
+  }
+  return NULL;
+}
+
+
 void SnapshotWriter::WriteInstanceRef(RawObject* raw, RawClass* cls) {
   // First check if object is a closure or has native fields.
   CheckIfSerializable(cls);
@@ -1500,11 +1745,48 @@ void SnapshotWriterVisitor::VisitPointers(RawObject** first, RawObject** last) {
 }
 
 
+void TransferableTypedDataPeer::Finalize(Dart_WeakPersistentHandle handle,
+                                         void* peer) {
+  delete reinterpret_cast<TransferableTypedDataPeer*>(peer);
+  Dart_DeleteWeakPersistentHandle(handle);
+}
+
+
+static RawClass* LookupTransferableTypedDataClass(Isolate* isolate) {
+  ObjectStore* object_store = isolate->object_store();
+  if (object_store->transferable_typed_data_class() == Class::null()) {
+    const Library& isolate_lib =
+        Library::Handle(isolate, Library::IsolateLibrary());
+    const Class& cls = Class::Handle(isolate,
+        isolate_lib.LookupClassAllowPrivate(
+            Symbols::_TransferableTypedDataImpl()));
+    object_store->set_transferable_typed_data_class(cls);
+  }
+  return object_store->transferable_typed_data_class();
+}
+
+
 void MessageWriter::WriteMessage(const Object& obj) {
   ASSERT(kind() == Snapshot::kMessage);
   Isolate* isolate = Isolate::Current();
   ASSERT(isolate != NULL);
 
+  // Most messages are small lists of numbers and strings, try writing them
+  // without marking the objects first.
+  if (FLAG_flat_messages) {
+    NoGCScope no_gc;
+    FlatMessageObjects objects;
+    WriteIntptrValue(kFlatMessageHeader);
+    if (WriteFlatObject(obj.raw(), &objects)) {
+      return;
+    }
+    Rewind(0);
+  }
+
+  // The class is looked up before writing, as the lookup may allocate.
+  RawClass* transferable_class =
+      can_transfer_ ? LookupTransferableTypedDataClass(isolate) : NULL;
+
   // Setup for long jump in case there is an exception while writing
   // the message.
   LongJump* base = isolate->long_jump_base();
@@ -1512,14 +1794,62 @@ void MessageWriter::WriteMessage(const Object& obj) {
   isolate->set_long_jump_base(&jump);
   if (setjmp(*jump.Set()) == 0) {
     NoGCScope no_gc;
+    transferable_class_ = transferable_class;
     WriteObject(obj.raw());
     UnmarkAll();
+    for (intptr_t i = 0; i < transfers_.length(); i++) {
+      transfers_[i].handle =
+          &Instance::ZoneHandle(isolate, transfers_[i].transferable);
+    }
     isolate->set_long_jump_base(base);
   } else {
     isolate->set_long_jump_base(base);
+    DeleteReceiverPeers();
     ThrowException(exception_type(), exception_msg());
   }
 }
 
 
+RawArray* MessageWriter::CompleteTransfers(bool posted) {
+  if (!posted) {
+    DeleteReceiverPeers();
+    return Array::null();
+  }
+  intptr_t num_moved = 0;
+  for (intptr_t i = 0; i < transfers_.length(); i++) {
+    if (transfers_[i].receiver_peer != NULL) {
+      num_moved++;
+    }
+  }
+  if (num_moved == 0) {
+    return Array::null();
+  }
+  const Array& moved = Array::Handle(Array::New(num_moved));
+  intptr_t index = 0;
+  for (intptr_t i = 0; i < transfers_.length(); i++) {
+    Transfer* transfer = &transfers_[i];
+    if (transfer->receiver_peer != NULL) {
+      // The receiver owns the bytes now.
+      transfer->sender_peer->Detach();
+      moved.SetAt(index++, *transfer->handle);
+    }
+  }
+  transfers_.Clear();
+  return moved.raw();
+}
+
+
+void MessageWriter::DeleteReceiverPeers() {
+  for (intptr_t i = 0; i < transfers_.length(); i++) {
+    TransferableTypedDataPeer* receiver_peer = transfers_[i].receiver_peer;
+    if (receiver_peer != NULL) {
+      // The bytes stay with the sender.
+      receiver_peer->Detach();
+      delete receiver_peer;
+    }
+  }
+  transfers_.Clear();
+}
+
+
 }  // namespace dart
@@ -26,6 +26,7 @@ class ClassTable;
 class ExternalTypedData;
 class GrowableObjectArray;
 class Heap;
+class Instance;
 class LanguageError;
 class Library;
 class Object;
@@ -39,6 +40,7 @@ class RawMixinAppType;
 class RawClass;
 class RawContext;
 class RawDouble;
+class RawExternalTypedData;
 class RawField;
 class RawClosureData;
 class RawRedirectionData;
@@ -47,6 +49,7 @@ class RawGrowableObjectArray;
 class RawFloat32x4;
 class RawInt32x4;
 class RawImmutableArray;
+class RawInstance;
 class RawLanguageError;
 class RawLibrary;
 class RawLibraryPrefix;
@@ -112,6 +115,62 @@ enum SerializeState {
 };
 
 
+// Flat messages hold acyclic graphs of numbers, strings, lists and byte
+// arrays without shared objects. They are written without marking objects
+// and read without backward references. A flat message starts with an
+// inlined object id which a regular message never uses, followed by the
+// values, each a tag and its payload. Canonical numbers and strings, such as
+// literals and symbols, are preceded by kFlatCanonical and canonicalized
+// again when read, like in regular messages.
+static const int64_t kFlatMessageHeader = kInlined;
+
+enum FlatMessageTag {
+  kFlatNull = 0,
+  kFlatTrue,
+  kFlatFalse,
+  kFlatInteger,  // int64 value.
+  kFlatDouble,  // double value.
+  kFlatOneByteString,  // Length and Latin-1 characters.
+  kFlatTwoByteString,  // Length and UTF-16 code units.
+  kFlatUtf8String,  // Length and UTF-8 bytes, written by ApiMessageWriter.
+  kFlatArray,  // Length and elements.
+  kFlatGrowableArray,  // Length and elements.
+  kFlatUint8Array,  // Length and bytes.
+  kFlatCanonical,  // Canonical number or string.
+};
+
+
+// The strings, lists and byte arrays of a flat message being written. A
+// message which repeats one of them, or has more than kMaxObjects of them,
+// is written in the regular format instead.
+class FlatMessageObjects : public ValueObject {
+ public:
+  static const intptr_t kMaxObjects = 64;
+
+  FlatMessageObjects() : length_(0) { }
+
+  // Returns false if the object was added before or there is no room left.
+  bool Add(const void* object) {
+    if (length_ == kMaxObjects) {
+      return false;
+    }
+    for (intptr_t i = 0; i < length_; i++) {
+      if (objects_[i] == object) {
+        return false;
+      }
+    }
+    objects_[length_++] = object;
+    return true;
+  }
+
+ private:
+  const void* objects_[kMaxObjects];
+  intptr_t length_;
+
+  DISALLOW_COPY_AND_ASSIGN(FlatMessageObjects);
+};
+
+
 #define HEAP_SPACE(kind) (kind == Snapshot::kMessage) ? Heap::kNew : Heap::kOld
 
 
@@ -301,6 +360,9 @@ class SnapshotReader : public BaseReader {
   RawObject* ReadObjectImpl(intptr_t header);
   RawObject* ReadObjectRef();
 
+  // Read a value of a flat message.
+  RawObject* ReadFlatObject();
+
   // Read a VM isolate object that was serialized as an Id.
   RawObject* ReadVMIsolateObject(intptr_t object_id);
 
@@ -416,6 +478,12 @@ class BaseWriter {
     stream_.WriteBytes(addr, len);
   }
 
+  // Drops everything written after the given number of bytes.
+  void Rewind(intptr_t bytes_written) {
+    ASSERT(bytes_written <= BytesWritten());
+    stream_.set_current(stream_.buffer() + bytes_written);
+  }
+
  protected:
   BaseWriter(uint8_t** buffer,
              ReAlloc alloc,
@@ -443,6 +511,26 @@ class BaseWriter {
 };
 
 
+// The peer of the external bytes of a TransferableTypedData. A peer owns the
+// bytes until it is detached, which happens to the peer of the sending
+// isolate once the bytes were handed over to the peer of the receiving one.
+class TransferableTypedDataPeer {
+ public:
+  explicit TransferableTypedDataPeer(uint8_t* data) : data_(data) { }
+  ~TransferableTypedDataPeer() { free(data_); }
+
+  uint8_t* data() const { return data_; }
+  void Detach() { data_ = NULL; }
+
+  static void Finalize(Dart_WeakPersistentHandle handle, void* peer);
+
+ private:
+  uint8_t* data_;
+
+  DISALLOW_COPY_AND_ASSIGN(TransferableTypedDataPeer);
+};
+
+
 class SnapshotWriter : public BaseWriter {
  protected:
   SnapshotWriter(Snapshot::Kind kind,
@@ -514,8 +602,33 @@ class SnapshotWriter : public BaseWriter {
                      intptr_t tags);
   void WriteInstanceRef(RawObject* raw, RawClass* cls);
 
+  // Writes a value of a flat message. Returns false if the object cannot be
+  // part of a flat message, in which case the output is incomplete.
+  bool WriteFlatObject(RawObject* raw, FlatMessageObjects* objects);
+
   ObjectStore* object_store() const { return object_store_; }
 
+  // A TransferableTypedData written to a message, with the external typed
+  // data holding its bytes and the peers which own the bytes in the sending
+  // and the receiving isolate.
+  struct Transfer {
+    RawInstance* transferable;
+    const Instance* handle;  // Set up once the objects are unmarked.
+    RawExternalTypedData* bytes;
+    TransferableTypedDataPeer* sender_peer;
+    TransferableTypedDataPeer* receiver_peer;
+  };
+
+  // Returns the peer owning the bytes in the receiving isolate if the
+  // external typed data is moved rather than copied, NULL otherwise.
+  TransferableTypedDataPeer* TransferPeerFor(RawExternalTypedData* raw,
+                                             void* peer);
+
+  // Class of the transferables whose bytes are moved, NULL if the bytes of
+  // all objects are copied.
+  RawClass* transferable_class_;
+  GrowableArray<Transfer> transfers_;
+
  private:
   Snapshot::Kind kind_;
   ObjectStore* object_store_;  // Object store for common classes.
@@ -527,6 +640,7 @@ class SnapshotWriter : public BaseWriter {
   friend class RawArray;
   friend class RawClass;
   friend class RawClosureData;
+  friend class RawExternalTypedData;
   friend class RawGrowableObjectArray;
   friend class RawImmutableArray;
   friend class RawJSRegExp;
@@ -581,8 +695,12 @@ class ScriptSnapshotWriter : public SnapshotWriter {
 class MessageWriter : public SnapshotWriter {
  public:
   static const intptr_t kInitialSize = 512;
-  MessageWriter(uint8_t** buffer, ReAlloc alloc)
-      : SnapshotWriter(Snapshot::kMessage, buffer, alloc, kInitialSize) {
+  // If can_transfer is true, the bytes of the TransferableTypedData objects
+  // in the message are moved to the receiver instead of being copied. Only
+  // a Dart isolate can take over the bytes, not a native port.
+  MessageWriter(uint8_t** buffer, ReAlloc alloc, bool can_transfer = false)
+      : SnapshotWriter(Snapshot::kMessage, buffer, alloc, kInitialSize),
+        can_transfer_(can_transfer) {
     ASSERT(buffer != NULL);
     ASSERT(alloc != NULL);
   }
@@ -590,7 +708,18 @@ class MessageWriter : public SnapshotWriter {
 
   void WriteMessage(const Object& obj);
 
+  // Completes the move of the bytes written by WriteMessage, once it is known
+  // whether the message was posted. If it was, the sender gives up the bytes
+  // and the TransferableTypedData objects which the sender has to empty are
+  // returned. Otherwise the receiver's peers are dropped and the sender keeps
+  // the bytes. Returns null if no bytes were moved.
+  RawArray* CompleteTransfers(bool posted);
+
  private:
+  void DeleteReceiverPeers();
+
+  bool can_transfer_;
+
   DISALLOW_COPY_AND_ASSIGN(MessageWriter);
 };
 
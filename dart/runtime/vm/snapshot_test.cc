@@ -705,6 +705,157 @@ TEST_CASE(SerializeByteArray) {
 }
 
 
+static int64_t ReadMessageHeader(const uint8_t* buffer, intptr_t length) {
+  ReadStream stream(buffer, length);
+  return ReadStream::Raw<sizeof(int64_t), int64_t>::Read(&stream);
+}
+
+
+TEST_CASE(SerializeFlatMessage) {
+  StackZone zone(Isolate::Current());
+
+  // Write a list of numbers, strings, a nested list and bytes.
+  const char* two_byte = "\xE2\x82\xAC";  // U+20AC
+  const Array& nested = Array::Handle(Array::New(2));
+  nested.SetAt(0, Smi::Handle(Smi::New(-7)));
+  const TypedData& bytes = TypedData::Handle(
+      TypedData::New(kTypedDataUint8ArrayCid, 3));
+  for (int i = 0; i < 3; i++) {
+    bytes.SetUint8(i, 10 + i);
+  }
+  const GrowableObjectArray& list =
+      GrowableObjectArray::Handle(GrowableObjectArray::New());
+  list.Add(Smi::Handle(Smi::New(42)));
+  list.Add(Integer::Handle(Integer::New(kMaxInt64)));
+  list.Add(Double::Handle(Double::New(3.5)));
+  list.Add(String::Handle(String::New("abc")));
+  list.Add(String::Handle(String::New(two_byte)));
+  list.Add(Bool::True());
+  list.Add(nested);
+  list.Add(bytes);
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &zone_allocator);
+  writer.WriteMessage(list);
+  intptr_t buffer_len = writer.BytesWritten();
+  EXPECT_EQ(kFlatMessageHeader, ReadMessageHeader(buffer, buffer_len));
+
+  // Read object back from the snapshot.
+  SnapshotReader reader(buffer, buffer_len,
+                        Snapshot::kMessage, Isolate::Current());
+  GrowableObjectArray& serialized_list = GrowableObjectArray::Handle();
+  serialized_list ^= reader.ReadObject();
+  EXPECT_EQ(8, serialized_list.Length());
+  Object& element = Object::Handle();
+  element = serialized_list.At(0);
+  EXPECT_EQ(42, Smi::Cast(element).Value());
+  element = serialized_list.At(1);
+  EXPECT_EQ(kMaxInt64, Mint::Cast(element).value());
+  element = serialized_list.At(2);
+  EXPECT_EQ(3.5, Double::Cast(element).value());
+  element = serialized_list.At(3);
+  EXPECT(String::Cast(element).IsOneByteString());
+  EXPECT(String::Cast(element).Equals("abc"));
+  element = serialized_list.At(4);
+  EXPECT(String::Cast(element).IsTwoByteString());
+  EXPECT(String::Cast(element).Equals(two_byte));
+  element = serialized_list.At(5);
+  EXPECT(element.raw() == Bool::True().raw());
+  element = serialized_list.At(6);
+  EXPECT(nested.Equals(Array::Cast(element)));
+  element = serialized_list.At(7);
+  EXPECT_EQ(3, TypedData::Cast(element).Length());
+  EXPECT_EQ(12, TypedData::Cast(element).GetUint8(2));
+
+  // Read object back from the snapshot into a C structure.
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, buffer_len, &zone_allocator);
+  Dart_CObject* root = api_reader.ReadMessage();
+  EXPECT_EQ(Dart_CObject_kArray, root->type);
+  EXPECT_EQ(8, root->value.as_array.length);
+  Dart_CObject** values = root->value.as_array.values;
+  EXPECT_EQ(42, values[0]->value.as_int32);
+  EXPECT_EQ(kMaxInt64, values[1]->value.as_int64);
+  EXPECT_EQ(3.5, values[2]->value.as_double);
+  EXPECT_STREQ("abc", values[3]->value.as_string);
+  EXPECT_STREQ(two_byte, values[4]->value.as_string);
+  EXPECT(values[5]->value.as_bool);
+  EXPECT_EQ(-7, values[6]->value.as_array.values[0]->value.as_int32);
+  EXPECT_EQ(Dart_CObject_kNull, values[6]->value.as_array.values[1]->type);
+  EXPECT_EQ(12, values[7]->value.as_typed_data.values[2]);
+  CheckEncodeDecodeMessage(root);
+}
+
+
+TEST_CASE(SerializeSharedObjectsNotFlat) {
+  StackZone zone(Isolate::Current());
+
+  // A message repeating an object is written in the regular format, which
+  // keeps the object shared.
+  const String& str = String::Handle(String::New("shared"));
+  const Array& array = Array::Handle(Array::New(3));
+  array.SetAt(0, str);
+  array.SetAt(1, str);
+  array.SetAt(2, array);
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &zone_allocator);
+  writer.WriteMessage(array);
+  intptr_t buffer_len = writer.BytesWritten();
+  EXPECT_NE(kFlatMessageHeader, ReadMessageHeader(buffer, buffer_len));
+
+  SnapshotReader reader(buffer, buffer_len,
+                        Snapshot::kMessage, Isolate::Current());
+  Array& serialized_array = Array::Handle();
+  serialized_array ^= reader.ReadObject();
+  EXPECT(serialized_array.At(0) == serialized_array.At(1));
+  EXPECT(serialized_array.At(2) == serialized_array.raw());
+}
+
+
+TEST_CASE(SerializeFlatCanonicalObjects) {
+  StackZone zone(Isolate::Current());
+
+  // Symbols and canonical numbers are canonical again when read, so that
+  // they stay identical to the literals of the receiver.
+  const String& symbol = String::Handle(Symbols::New("flatSymbol"));
+  Instance& mint = Instance::Handle(Integer::New(kMaxInt64));
+  EXPECT(mint.IsMint());
+  mint = mint.CheckAndCanonicalize(NULL);
+  const Double& dbl = Double::Handle(Double::NewCanonical(2.5));
+  const Array& array = Array::Handle(Array::New(4));
+  array.SetAt(0, symbol);
+  array.SetAt(1, mint);
+  array.SetAt(2, dbl);
+  array.SetAt(3, String::Handle(String::New("flatSymbol")));
+  uint8_t* buffer;
+  MessageWriter writer(&buffer, &zone_allocator);
+  writer.WriteMessage(array);
+  intptr_t buffer_len = writer.BytesWritten();
+  EXPECT_EQ(kFlatMessageHeader, ReadMessageHeader(buffer, buffer_len));
+
+  SnapshotReader reader(buffer, buffer_len,
+                        Snapshot::kMessage, Isolate::Current());
+  Array& serialized_array = Array::Handle();
+  serialized_array ^= reader.ReadObject();
+  EXPECT(serialized_array.At(0) == symbol.raw());
+  EXPECT(serialized_array.At(1) == mint.raw());
+  EXPECT(serialized_array.At(2) == dbl.raw());
+  // A string which is not canonical stays a copy.
+  EXPECT(serialized_array.At(3) != symbol.raw());
+  EXPECT(String::Handle(String::RawCast(serialized_array.At(3))).Equals(
+      symbol));
+
+  ApiNativeScope scope;
+  ApiMessageReader api_reader(buffer, buffer_len, &zone_allocator);
+  Dart_CObject* root = api_reader.ReadMessage();
+  EXPECT_EQ(4, root->value.as_array.length);
+  Dart_CObject** values = root->value.as_array.values;
+  EXPECT_STREQ("flatSymbol", values[0]->value.as_string);
+  EXPECT_EQ(kMaxInt64, values[1]->value.as_int64);
+  EXPECT_EQ(2.5, values[2]->value.as_double);
+  CheckEncodeDecodeMessage(root);
+}
+
+
 #define TEST_TYPED_ARRAY(darttype, ctype)                                     \
   {                                                                           \
     StackZone zone(Isolate::Current());                                       \
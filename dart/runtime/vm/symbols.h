@@ -228,6 +228,7 @@ class ObjectPointerVisitor;
   V(_lookupReceivePort, "_lookupReceivePort")                                  \
   V(_handleMessage, "_handleMessage")                                          \
   V(_SendPortImpl, "_SendPortImpl")                                            \
+  V(_TransferableTypedDataImpl, "_TransferableTypedDataImpl")                  \
   V(_create, "_create")                                                        \
   V(DotCreate, "._create")                                                     \
   V(DotWithType, "._withType")                                                 \
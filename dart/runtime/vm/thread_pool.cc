@@ -4,13 +4,438 @@
 
 #include "vm/thread_pool.h"
 
+#include "vm/atomic.h"
+#include "vm/flags.h"
+#include "vm/os.h"
+
 namespace dart {
 
 DEFINE_FLAG(int, worker_timeout_millis, 5000,
             "Free workers when they have been idle for this amount of time.");
+DEFINE_FLAG(int, scheduler_workers, 0,
+            "Maximum number of workers running scheduled tasks such as "
+            "message handlers, 0 for one per processor.");
+DEFINE_FLAG(int, scheduler_stall_millis, 100,
+            "Start an extra scheduler worker when no scheduled task started "
+            "for this amount of time while others are waiting.");
 
 Monitor* ThreadPool::exit_monitor_ = NULL;
 int* ThreadPool::exit_count_ = NULL;
+ThreadLocalKey ThreadPool::worker_queue_key_ = Thread::kUnsetThreadLocalKey;
+
+
+// The Scheduler runs the tasks passed to ThreadPool::Schedule. It has one
+// run queue per worker, and starts workers up to the maximum as tasks are
+// scheduled. Idle workers are freed after --worker_timeout_millis.
+//
+// A watchdog thread runs alongside the workers. If tasks are waiting but
+// none has started for --scheduler_stall_millis, all workers are stuck in
+// long running tasks and the watchdog starts an extra worker. Extra workers
+// have no run queue of their own and stop as soon as they find no task.
+//
+// The scheduler is reference counted by the pool and its threads, so that
+// threads still running a task when the pool is deleted can finish safely.
+class ThreadPool::Scheduler {
+ public:
+  explicit Scheduler(intptr_t max_workers);
+  ~Scheduler();
+
+  void Schedule(Task* task);
+
+  bool HasWaitingTasks() const;
+
+  // Stops the threads once they are done with their current task and drops
+  // the reference held by the pool.
+  void Shutdown();
+
+  // Takes and drops a reference, deleting the scheduler with the last one.
+  void Retain();
+  void Release();
+
+  uintptr_t num_workers() const { return num_workers_ + num_extra_workers_; }
+  uintptr_t extra_workers_started() const { return extra_workers_started_; }
+  uintptr_t scheduled() const { return scheduled_; }
+  uintptr_t stolen() const { return stolen_; }
+  uintptr_t waiting() const { return waiting_; }
+
+ private:
+  struct RunQueue {
+    RunQueue() : head(NULL), tail(NULL), active(false) { }
+
+    Mutex mutex;  // Protects head and tail.
+    Task* head;
+    Task* tail;
+    bool active;  // Owned by a running worker. Protected by monitor_.
+  };
+
+  struct StartInfo {
+    Scheduler* scheduler;
+    intptr_t index;  // Index of the run queue, -1 for extra workers.
+  };
+
+  static void Push(RunQueue* queue, Task* task);
+  static Task* Pop(RunQueue* queue);
+
+  // Returns the run queue of the current thread, or NULL if it is not a
+  // worker with a run queue.
+  RunQueue* CurrentQueue() const;
+
+  // Takes the next task from the run queue at index, or steals one from the
+  // other queues.
+  Task* Take(intptr_t index);
+
+  // Must be called with monitor_ held.
+  void StartWorker(bool extra);
+  void StartThread(Thread::ThreadStartFunction function, StartInfo* info);
+
+  static void WorkerMain(uword args);
+  static void WatchdogMain(uword args);
+  void WorkerLoop(intptr_t index);
+  void WatchdogLoop();
+
+  Monitor monitor_;  // Idle workers wait on this monitor.
+  Monitor watchdog_monitor_;
+  bool shutting_down_;
+  intptr_t refs_;  // Protected by monitor_.
+  bool watchdog_running_;  // Protected by monitor_.
+
+  const intptr_t max_workers_;
+  RunQueue* queues_;
+
+  // Only changed atomically.
+  uintptr_t num_workers_;
+  uintptr_t num_extra_workers_;
+  uintptr_t idle_workers_;
+  uintptr_t next_queue_;
+  uintptr_t waiting_;
+  uintptr_t started_;
+  uintptr_t scheduled_;
+  uintptr_t stolen_;
+  uintptr_t extra_workers_started_;
+
+  DISALLOW_COPY_AND_ASSIGN(Scheduler);
+};
+
+
+ThreadPool::Scheduler::Scheduler(intptr_t max_workers)
+    : shutting_down_(false),
+      refs_(1),
+      watchdog_running_(false),
+      max_workers_(max_workers),
+      queues_(new RunQueue[max_workers]),
+      num_workers_(0),
+      num_extra_workers_(0),
+      idle_workers_(0),
+      next_queue_(0),
+      waiting_(0),
+      started_(0),
+      scheduled_(0),
+      stolen_(0),
+      extra_workers_started_(0) {
+  ASSERT(max_workers > 0);
+}
+
+
+ThreadPool::Scheduler::~Scheduler() {
+  // Tasks which did not get to run before the shutdown are dropped.
+  for (intptr_t i = 0; i < max_workers_; i++) {
+    Task* task = Pop(&queues_[i]);
+    while (task != NULL) {
+      delete task;
+      task = Pop(&queues_[i]);
+    }
+  }
+  delete[] queues_;
+}
+
+
+void ThreadPool::Scheduler::Push(RunQueue* queue, Task* task) {
+  MutexLocker ml(&queue->mutex);
+  task->next_ = NULL;
+  if (queue->tail == NULL) {
+    queue->head = task;
+  } else {
+    queue->tail->next_ = task;
+  }
+  queue->tail = task;
+}
+
+
+ThreadPool::Task* ThreadPool::Scheduler::Pop(RunQueue* queue) {
+  if (queue->head == NULL) {
+    // Avoid taking the lock of an empty queue, e.g. while stealing.
+    return NULL;
+  }
+  MutexLocker ml(&queue->mutex);
+  Task* task = queue->head;
+  if (task != NULL) {
+    queue->head = task->next_;
+    if (queue->head == NULL) {
+      queue->tail = NULL;
+    }
+    task->next_ = NULL;
+  }
+  return task;
+}
+
+
+ThreadPool::Task* ThreadPool::Scheduler::Take(intptr_t index) {
+  Task* task = NULL;
+  if (index >= 0) {
+    task = Pop(&queues_[index]);
+  }
+  for (intptr_t i = 1; (task == NULL) && (i <= max_workers_); i++) {
+    intptr_t victim = (index + i) % max_workers_;
+    if (victim < 0) {
+      victim += max_workers_;
+    }
+    task = Pop(&queues_[victim]);
+    if (task != NULL && victim != index) {
+      AtomicOperations::FetchAndIncrement(&stolen_);
+    }
+  }
+  if (task != NULL) {
+    AtomicOperations::FetchAndDecrement(&waiting_);
+    AtomicOperations::FetchAndIncrement(&started_);
+  }
+  return task;
+}
+
+
+ThreadPool::Scheduler::RunQueue* ThreadPool::Scheduler::CurrentQueue() const {
+  RunQueue* queue =
+      reinterpret_cast<RunQueue*>(Thread::GetThreadLocal(worker_queue_key_));
+  if ((queue < queues_) || (queue >= queues_ + max_workers_)) {
+    return NULL;
+  }
+  return queue;
+}
+
+
+bool ThreadPool::Scheduler::HasWaitingTasks() const {
+  // A worker takes the tasks of its own queue before stealing, so a task
+  // which yields to tasks queued on other workers would just run again. It
+  // only needs to yield to the tasks of its own queue, which the owners of
+  // the other queues yield to as well.
+  RunQueue* queue = CurrentQueue();
+  if (queue != NULL) {
+    return queue->head != NULL;
+  }
+  return waiting_ > 0;
+}
+
+
+void ThreadPool::Scheduler::Schedule(Task* task) {
+  // Keep tasks scheduled by a worker on its own queue, they often touch
+  // the same data as the task which scheduled them.
+  RunQueue* queue = CurrentQueue();
+  if (queue == NULL) {
+    uintptr_t next = AtomicOperations::FetchAndIncrement(&next_queue_);
+    queue = &queues_[next % max_workers_];
+  }
+  // Count the task before it can be taken, so that waiting_ never drops
+  // below zero.
+  //
+  // The increment is a full memory barrier. An idle worker increments
+  // idle_workers_ before checking waiting_ and a retiring worker decrements
+  // num_workers_ before checking waiting_, so either the worker looks for
+  // the task again or the checks below see the worker.
+  AtomicOperations::FetchAndIncrement(&waiting_);
+  Push(queue, task);
+  AtomicOperations::FetchAndIncrement(&scheduled_);
+  if (idle_workers_ > 0) {
+    MonitorLocker ml(&monitor_);
+    ml.Notify();
+  } else if (num_workers_ < static_cast<uintptr_t>(max_workers_)) {
+    MonitorLocker ml(&monitor_);
+    if (!shutting_down_ &&
+        (num_workers_ < static_cast<uintptr_t>(max_workers_))) {
+      StartWorker(false);
+    }
+  }
+}
+
+
+void ThreadPool::Scheduler::StartWorker(bool extra) {
+  StartInfo* info = new StartInfo();
+  info->scheduler = this;
+  info->index = -1;
+  if (extra) {
+    AtomicOperations::FetchAndIncrement(&num_extra_workers_);
+    AtomicOperations::FetchAndIncrement(&extra_workers_started_);
+  } else {
+    for (intptr_t i = 0; i < max_workers_; i++) {
+      if (!queues_[i].active) {
+        info->index = i;
+        break;
+      }
+    }
+    ASSERT(info->index >= 0);
+    queues_[info->index].active = true;
+    AtomicOperations::FetchAndIncrement(&num_workers_);
+  }
+  StartThread(&WorkerMain, info);
+  if (!watchdog_running_) {
+    watchdog_running_ = true;
+    StartInfo* watchdog_info = new StartInfo();
+    watchdog_info->scheduler = this;
+    watchdog_info->index = -1;
+    StartThread(&WatchdogMain, watchdog_info);
+  }
+}
+
+
+void ThreadPool::Scheduler::StartThread(Thread::ThreadStartFunction function,
+                                        StartInfo* info) {
+  refs_++;
+  int result = Thread::Start(function, reinterpret_cast<uword>(info));
+  if (result != 0) {
+    FATAL1("Could not start scheduler thread: result = %d.", result);
+  }
+}
+
+
+void ThreadPool::Scheduler::WorkerMain(uword args) {
+  StartInfo* info = reinterpret_cast<StartInfo*>(args);
+  Scheduler* scheduler = info->scheduler;
+  intptr_t index = info->index;
+  delete info;
+  if (index >= 0) {
+    Thread::SetThreadLocal(worker_queue_key_,
+                           reinterpret_cast<uword>(&scheduler->queues_[index]));
+  }
+  scheduler->WorkerLoop(index);
+  Thread::SetThreadLocal(worker_queue_key_, 0);
+  scheduler->Release();
+}
+
+
+void ThreadPool::Scheduler::WorkerLoop(intptr_t index) {
+  int64_t idle_start = OS::GetCurrentTimeMillis();
+  while (!shutting_down_) {
+    Task* task = Take(index);
+    if (task != NULL) {
+      task->Run();
+      delete task;
+      idle_start = OS::GetCurrentTimeMillis();
+      continue;
+    }
+    MonitorLocker ml(&monitor_);
+    if (shutting_down_) {
+      break;
+    }
+    if (index < 0) {
+      // Extra workers stop as soon as they run out of tasks.
+      if (waiting_ == 0) {
+        AtomicOperations::FetchAndDecrement(&num_extra_workers_);
+        break;
+      }
+      continue;
+    }
+    AtomicOperations::FetchAndIncrement(&idle_workers_);
+    if (waiting_ > 0) {
+      // A task was scheduled after our last look at the queues.
+      AtomicOperations::FetchAndDecrement(&idle_workers_);
+      continue;
+    }
+    Monitor::WaitResult result = Monitor::kNotified;
+    if (FLAG_worker_timeout_millis <= 0) {
+      ml.Wait();
+    } else {
+      int64_t waited = OS::GetCurrentTimeMillis() - idle_start;
+      if (waited < FLAG_worker_timeout_millis) {
+        result = ml.Wait(FLAG_worker_timeout_millis - waited);
+      } else {
+        result = Monitor::kTimedOut;
+      }
+    }
+    AtomicOperations::FetchAndDecrement(&idle_workers_);
+    if (result == Monitor::kTimedOut && !shutting_down_) {
+      AtomicOperations::FetchAndDecrement(&num_workers_);
+      if (waiting_ == 0) {
+        queues_[index].active = false;
+        break;
+      }
+      AtomicOperations::FetchAndIncrement(&num_workers_);
+    }
+  }
+}
+
+
+void ThreadPool::Scheduler::WatchdogMain(uword args) {
+  StartInfo* info = reinterpret_cast<StartInfo*>(args);
+  Scheduler* scheduler = info->scheduler;
+  delete info;
+  scheduler->WatchdogLoop();
+  scheduler->Release();
+}
+
+
+void ThreadPool::Scheduler::WatchdogLoop() {
+  uintptr_t last_started = started_;
+  while (true) {
+    {
+      MonitorLocker ml(&watchdog_monitor_);
+      if (shutting_down_) {
+        return;
+      }
+      ml.Wait(FLAG_scheduler_stall_millis > 0 ? FLAG_scheduler_stall_millis
+                                              : 1);
+    }
+    MonitorLocker ml(&monitor_);
+    if (shutting_down_) {
+      return;
+    }
+    if (num_workers() == 0) {
+      // Started again with the next worker.
+      watchdog_running_ = false;
+      return;
+    }
+    uintptr_t started = started_;
+    if ((waiting_ > 0) &&
+        (idle_workers_ == 0) &&
+        (started == last_started) &&
+        (FLAG_scheduler_stall_millis > 0)) {
+      StartWorker(true);
+    }
+    last_started = started;
+  }
+}
+
+
+void ThreadPool::Scheduler::Shutdown() {
+  {
+    MonitorLocker ml(&monitor_);
+    shutting_down_ = true;
+    ml.NotifyAll();
+  }
+  {
+    MonitorLocker ml(&watchdog_monitor_);
+    ml.NotifyAll();
+  }
+  Release();
+}
+
+
+void ThreadPool::Scheduler::Retain() {
+  MonitorLocker ml(&monitor_);
+  ASSERT(refs_ > 0);
+  refs_++;
+}
+
+
+void ThreadPool::Scheduler::Release() {
+  bool last = false;
+  {
+    MonitorLocker ml(&monitor_);
+    refs_--;
+    last = (refs_ == 0);
+  }
+  if (last) {
+    delete this;
+  }
+}
+
 
 ThreadPool::ThreadPool()
   : shutting_down_(false),
@@ -19,7 +444,8 @@ ThreadPool::ThreadPool()
     count_started_(0),
     count_stopped_(0),
     count_running_(0),
-    count_idle_(0) {
+    count_idle_(0),
+    scheduler_(NULL) {
 }
 
 
@@ -28,6 +454,78 @@ ThreadPool::~ThreadPool() {
 }
 
 
+void ThreadPool::InitOnce() {
+  ASSERT(worker_queue_key_ == Thread::kUnsetThreadLocalKey);
+  worker_queue_key_ = Thread::CreateThreadLocal();
+  ASSERT(worker_queue_key_ != Thread::kUnsetThreadLocalKey);
+}
+
+
+void ThreadPool::Schedule(Task* task) {
+  Scheduler* scheduler = NULL;
+  {
+    // Take a reference under ThreadPool::mutex_, Shutdown may drop the
+    // reference of the pool at any time.
+    MutexLocker ml(&mutex_);
+    if (shutting_down_) {
+      delete task;
+      return;
+    }
+    if (scheduler_ == NULL) {
+      intptr_t max_workers = FLAG_scheduler_workers;
+      if (max_workers <= 0) {
+        max_workers = OS::NumberOfAvailableProcessors();
+      }
+      scheduler_ = new Scheduler(max_workers > 0 ? max_workers : 1);
+    }
+    scheduler = scheduler_;
+    scheduler->Retain();
+  }
+  // Release ThreadPool::mutex_ before scheduling, which may start threads.
+  scheduler->Schedule(task);
+  scheduler->Release();
+}
+
+
+// The scheduler is only deleted after Shutdown has cleared scheduler_ under
+// ThreadPool::mutex_, so it can be read while holding the mutex.
+
+bool ThreadPool::HasWaitingTasks() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) && scheduler_->HasWaitingTasks();
+}
+
+
+uint64_t ThreadPool::scheduler_workers() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) ? scheduler_->num_workers() : 0;
+}
+
+
+uint64_t ThreadPool::scheduler_extra_workers_started() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) ? scheduler_->extra_workers_started() : 0;
+}
+
+
+uint64_t ThreadPool::tasks_scheduled() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) ? scheduler_->scheduled() : 0;
+}
+
+
+uint64_t ThreadPool::tasks_stolen() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) ? scheduler_->stolen() : 0;
+}
+
+
+uint64_t ThreadPool::tasks_waiting() {
+  MutexLocker ml(&mutex_);
+  return (scheduler_ != NULL) ? scheduler_->waiting() : 0;
+}
+
+
 void ThreadPool::Run(Task* task) {
   Worker* worker = NULL;
   bool new_worker = false;
@@ -69,9 +567,12 @@ void ThreadPool::Run(Task* task) {
 
 void ThreadPool::Shutdown() {
   Worker* saved = NULL;
+  Scheduler* scheduler = NULL;
   {
     MutexLocker ml(&mutex_);
     shutting_down_ = true;
+    scheduler = scheduler_;
+    scheduler_ = NULL;
     saved = all_workers_;
     all_workers_ = NULL;
     idle_workers_ = NULL;
@@ -91,6 +592,10 @@ void ThreadPool::Shutdown() {
   }
   // Release ThreadPool::mutex_ before calling Worker functions.
 
+  if (scheduler != NULL) {
+    scheduler->Shutdown();
+  }
+
   Worker* current = saved;
   while (current != NULL) {
     // We may access all_next_ without holding ThreadPool::mutex_ here
@@ -203,7 +708,7 @@ bool ThreadPool::ReleaseIdleWorker(Worker* worker) {
 }
 
 
-ThreadPool::Task::Task() {
+ThreadPool::Task::Task() : next_(NULL) {
 }
 
 
@@ -23,6 +23,10 @@ class ThreadPool {
     virtual void Run() = 0;
 
    private:
+    friend class ThreadPool;
+
+    Task* next_;  // Link in a run queue of the scheduler.
+
     DISALLOW_COPY_AND_ASSIGN(Task);
   };
 
@@ -32,18 +36,43 @@ class ThreadPool {
   // themselves when they are active again.
   ~ThreadPool();
 
+  static void InitOnce();
+
   // Runs a task on the thread pool.
   void Run(Task* task);
 
+  // Runs a task on one of a bounded number of scheduler workers, queueing it
+  // if all of them are busy (see --scheduler_workers). Each worker has its
+  // own run queue: tasks scheduled from a worker are queued on that worker,
+  // other tasks are spread over the queues in turn, and workers which run
+  // out of tasks steal from the queues of the others. Scheduled tasks should
+  // return in a timely manner and schedule a new task to continue, e.g.
+  // when HasWaitingTasks() is true. Tasks blocking for longer than
+  // --scheduler_stall_millis cause extra workers to be started.
+  void Schedule(Task* task);
+
+  // Returns true if scheduled tasks are waiting for the worker running the
+  // caller, or for any worker if the caller is not a scheduler worker.
+  bool HasWaitingTasks();
+
   // Some simple stats.
   uint64_t workers_running() const { return count_running_; }
   uint64_t workers_idle() const { return count_idle_; }
   uint64_t workers_started() const { return count_started_; }
   uint64_t workers_stopped() const { return count_stopped_; }
 
+  // Stats of the scheduler workers.
+  uint64_t scheduler_workers();
+  uint64_t scheduler_extra_workers_started();
+  uint64_t tasks_scheduled();
+  uint64_t tasks_stolen();
+  uint64_t tasks_waiting();
+
  private:
   friend class ThreadPoolTestPeer;
 
+  class Scheduler;
+
   class Worker {
    public:
     explicit Worker(ThreadPool* pool);
@@ -104,6 +133,12 @@ class ThreadPool {
   uint64_t count_running_;
   uint64_t count_idle_;
 
+  // Created by the first call to Schedule. Protected by mutex_.
+  Scheduler* scheduler_;
+
+  // Holds the run queue of the scheduler worker running on a thread.
+  static ThreadLocalKey worker_queue_key_;
+
   static Monitor* exit_monitor_;  // Used only in testing.
   static int* exit_count_;        // Used only in testing.
 
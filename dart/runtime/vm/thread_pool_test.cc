@@ -9,6 +9,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, scheduler_stall_millis);
+DECLARE_FLAG(int, scheduler_workers);
 DECLARE_FLAG(int, worker_timeout_millis);
 
 
@@ -215,4 +217,105 @@ UNIT_TEST_CASE(ThreadPool_RecursiveSpawn) {
 }
 
 
+UNIT_TEST_CASE(ThreadPool_ScheduleMany) {
+  const int kTaskCount = 100;
+  const int kMaxWorkers = 2;
+  int saved_workers = FLAG_scheduler_workers;
+  FLAG_scheduler_workers = kMaxWorkers;
+  {
+    ThreadPool thread_pool;
+    Monitor sync[kTaskCount];
+    bool done[kTaskCount];
+
+    for (int i = 0; i < kTaskCount; i++) {
+      done[i] = false;
+      thread_pool.Schedule(new TestTask(&sync[i], &done[i]));
+    }
+    for (int i = 0; i < kTaskCount; i++) {
+      MonitorLocker ml(&sync[i]);
+      while (!done[i]) {
+        ml.Wait();
+      }
+      EXPECT(done[i]);
+    }
+    EXPECT_EQ(static_cast<uint64_t>(kTaskCount),
+              thread_pool.tasks_scheduled());
+    EXPECT(thread_pool.scheduler_workers() <=
+           static_cast<uint64_t>(kMaxWorkers));
+    // Scheduled tasks do not use the workers of Run.
+    EXPECT_EQ(0U, thread_pool.workers_started());
+  }
+  FLAG_scheduler_workers = saved_workers;
+}
+
+
+class WaitTask : public ThreadPool::Task {
+ public:
+  WaitTask(Monitor* sync, bool* release, bool* done)
+      : sync_(sync), release_(release), done_(done) {
+  }
+
+  void Run() {
+    MonitorLocker ml(sync_);
+    while (!*release_) {
+      ml.Wait();
+    }
+    *done_ = true;
+    ml.NotifyAll();
+  }
+
+ private:
+  Monitor* sync_;
+  bool* release_;
+  bool* done_;
+};
+
+
+class ReleaseTask : public ThreadPool::Task {
+ public:
+  ReleaseTask(Monitor* sync, bool* release)
+      : sync_(sync), release_(release) {
+  }
+
+  void Run() {
+    MonitorLocker ml(sync_);
+    *release_ = true;
+    ml.NotifyAll();
+  }
+
+ private:
+  Monitor* sync_;
+  bool* release_;
+};
+
+
+UNIT_TEST_CASE(ThreadPool_ScheduleStalled) {
+  int saved_workers = FLAG_scheduler_workers;
+  int saved_stall_millis = FLAG_scheduler_stall_millis;
+  FLAG_scheduler_workers = 1;
+  FLAG_scheduler_stall_millis = 10;
+  {
+    ThreadPool thread_pool;
+    Monitor sync;
+    bool release = false;
+    bool done = false;
+    // The only worker blocks until the second task runs, which needs an
+    // extra worker.
+    thread_pool.Schedule(new WaitTask(&sync, &release, &done));
+    thread_pool.Schedule(new ReleaseTask(&sync, &release));
+    {
+      MonitorLocker ml(&sync);
+      while (!done) {
+        ml.Wait();
+      }
+    }
+    EXPECT(release);
+    EXPECT(done);
+    EXPECT(thread_pool.scheduler_extra_workers_started() >= 1U);
+  }
+  FLAG_scheduler_workers = saved_workers;
+  FLAG_scheduler_stall_millis = saved_stall_millis;
+}
+
+
 }  // namespace dart
@@ -0,0 +1,670 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/type_feedback_cache.h"
+
+#include "vm/compiler.h"
+#include "vm/dart_entry.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/resolver.h"
+#include "vm/scanner.h"
+#include "vm/symbols.h"
+#include "vm/version.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, trace_type_feedback_cache, false,
+    "Trace saving and applying of the type feedback cache.");
+DECLARE_FLAG(bool, enable_asserts);
+DECLARE_FLAG(bool, enable_type_checks);
+DECLARE_FLAG(int, optimization_counter_threshold);
+
+// Written at the start and at the end of the cache, so that caches which
+// were truncated while being written are rejected.
+static const char kMarker[] = "dart-type-feedback";
+static const intptr_t kMarkerLength = sizeof(kMarker) - 1;
+
+
+static void WriteCString(WriteStream* stream, const char* str, intptr_t len) {
+  stream->WriteUnsigned(len);
+  stream->WriteBytes(reinterpret_cast<const uint8_t*>(str), len);
+}
+
+
+static const char* ReadCString(ReadStream* stream, intptr_t* len) {
+  *len = stream->ReadUnsigned();
+  char* str = Isolate::Current()->current_zone()->Alloc<char>(*len + 1);
+  stream->ReadBytes(reinterpret_cast<uint8_t*>(str), *len);
+  str[*len] = '\0';
+  return str;
+}
+
+
+static bool IsHexDigit(char c) {
+  return ((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f'));
+}
+
+
+// Private names carry the private key of their library, which depends on
+// the libraries loaded before. The key of the given library is replaced by
+// the bare separator. Returns NULL for names which carry the key of another
+// library.
+static const char* EncodeName(const String& name, const Library& library) {
+  const char* str = name.ToCString();
+  if (strchr(str, Scanner::kPrivateKeySeparator) == NULL) {
+    return str;
+  }
+  const char* key = String::Handle(library.private_key()).ToCString();
+  intptr_t key_len = strlen(key);
+  intptr_t len = strlen(str);
+  char* result = Isolate::Current()->current_zone()->Alloc<char>(len + 1);
+  intptr_t pos = 0;
+  for (intptr_t i = 0; i < len; ) {
+    if ((strncmp(str + i, key, key_len) == 0) &&
+        !IsHexDigit(str[i + key_len])) {
+      result[pos++] = Scanner::kPrivateKeySeparator;
+      i += key_len;
+    } else if (str[i] == Scanner::kPrivateKeySeparator) {
+      return NULL;
+    } else {
+      result[pos++] = str[i++];
+    }
+  }
+  result[pos] = '\0';
+  return result;
+}
+
+
+// Inverse of EncodeName, returns a symbol.
+static RawString* DecodeName(const char* str, const Library& library) {
+  const char* separator = strchr(str, Scanner::kPrivateKeySeparator);
+  if (separator == NULL) {
+    return Symbols::New(str);
+  }
+  const String& key = String::Handle(library.private_key());
+  String& result = String::Handle(String::New(""));
+  String& part = String::Handle();
+  while (separator != NULL) {
+    part = String::FromUTF8(reinterpret_cast<const uint8_t*>(str),
+                            separator - str);
+    result = String::Concat(result, part);
+    result = String::Concat(result, key);
+    str = separator + 1;
+    separator = strchr(str, Scanner::kPrivateKeySeparator);
+  }
+  part = String::New(str);
+  result = String::Concat(result, part);
+  return Symbols::New(result);
+}
+
+
+// A class is recorded by the url of its library and its name. Classes which
+// cannot be looked up by name are recorded by an empty url.
+static void WriteClassRef(WriteStream* stream, const Class& cls) {
+  const Library& library = Library::Handle(cls.library());
+  const char* name = NULL;
+  if (!library.IsNull()) {
+    name = EncodeName(String::Handle(cls.Name()), library);
+  }
+  if (name == NULL) {
+    WriteCString(stream, "", 0);
+    return;
+  }
+  const char* url = String::Handle(library.url()).ToCString();
+  WriteCString(stream, url, strlen(url));
+  WriteCString(stream, name, strlen(name));
+}
+
+
+// Reads a class reference, sets 'library' and returns the name of the
+// class, or returns null if the library is not loaded.
+static RawString* ReadClassRef(ReadStream* stream, Library* library) {
+  intptr_t len = 0;
+  const char* url = ReadCString(stream, &len);
+  if (len == 0) {
+    *library = Library::null();
+    return String::null();
+  }
+  *library = Library::LookupLibrary(String::Handle(String::New(url)));
+  const char* name = ReadCString(stream, &len);
+  if (library->IsNull()) {
+    return String::null();
+  }
+  return DecodeName(name, *library);
+}
+
+
+// Returns the finalized class, or null if it does not exist anymore.
+static RawClass* LookupClass(const Library& library, const String& name) {
+  if (library.IsNull() || name.IsNull()) {
+    return Class::null();
+  }
+  const Class& cls = Class::Handle(library.LookupClass(name));
+  if (cls.IsNull() ||
+      (cls.EnsureIsFinalized(Isolate::Current()) != Error::null())) {
+    return Class::null();
+  }
+  return cls.raw();
+}
+
+
+static RawClass* ReadClass(ReadStream* stream) {
+  Library& library = Library::Handle();
+  const String& name = String::Handle(ReadClassRef(stream, &library));
+  return LookupClass(library, name);
+}
+
+
+// A function is recorded by the reference to its owner class and its name,
+// which is empty if it cannot be looked up by name. Top level functions are
+// owned by the class named Symbols::TopLevel().
+static void WriteFunctionRef(WriteStream* stream, const Function& function) {
+  const Class& owner = Class::Handle(function.Owner());
+  const Library& library = Library::Handle(owner.library());
+  const char* name = NULL;
+  if (!library.IsNull() && !function.IsClosureFunction()) {
+    name = EncodeName(String::Handle(function.name()), library);
+  }
+  WriteClassRef(stream, owner);
+  if (name == NULL) {
+    WriteCString(stream, "", 0);
+    return;
+  }
+  WriteCString(stream, name, strlen(name));
+}
+
+
+static RawFunction* ReadFunction(ReadStream* stream) {
+  Library& library = Library::Handle();
+  const String& class_name = String::Handle(ReadClassRef(stream, &library));
+  intptr_t len = 0;
+  const char* name_str = ReadCString(stream, &len);
+  if (library.IsNull() || (len == 0)) {
+    return Function::null();
+  }
+  const String& name = String::Handle(DecodeName(name_str, library));
+  if (class_name.raw() == Symbols::TopLevel().raw()) {
+    return library.LookupLocalFunction(name);
+  }
+  const Class& cls = Class::Handle(LookupClass(library, class_name));
+  if (cls.IsNull()) {
+    return Function::null();
+  }
+  return cls.LookupFunction(name);
+}
+
+
+// Static calls do not collect feedback, their inline caches only hold the
+// static target.
+static bool HasTypeFeedback(const ICData& ic_data,
+                            const Library& caller_library) {
+  return !ic_data.IsNull() &&
+      (ic_data.num_args_tested() > 0) &&
+      !ic_data.is_closure_call() &&
+      (ic_data.NumberOfChecks() > 0) &&
+      !Function::Handle(ic_data.GetTargetAt(0)).is_static() &&
+      (EncodeName(String::Handle(ic_data.target_name()),
+                  caller_library) != NULL);
+}
+
+
+void TypeFeedbackCache::WriteICData(WriteStream* stream,
+                                    const ICData& ic_data,
+                                    const Library& caller_library) {
+  stream->WriteUnsigned(ic_data.deopt_id());
+  stream->WriteUnsigned(ic_data.num_args_tested());
+  // Selectors of private members carry the key of the calling library.
+  const char* target_name =
+      EncodeName(String::Handle(ic_data.target_name()), caller_library);
+  WriteCString(stream, target_name, strlen(target_name));
+  Isolate* isolate = Isolate::Current();
+  const intptr_t num_checks = ic_data.NumberOfChecks();
+  stream->WriteUnsigned(num_checks);
+  GrowableArray<intptr_t> class_ids;
+  Function& target = Function::Handle(isolate);
+  Class& cls = Class::Handle(isolate);
+  for (intptr_t i = 0; i < num_checks; i++) {
+    ic_data.GetCheckAt(i, &class_ids, &target);
+    for (intptr_t k = 0; k < class_ids.length(); k++) {
+      cls = isolate->class_table()->At(class_ids[k]);
+      WriteClassRef(stream, cls);
+    }
+    WriteFunctionRef(stream, target);
+    stream->WriteUnsigned(ic_data.GetCountAt(i));
+  }
+}
+
+
+void TypeFeedbackCache::WriteFunction(WriteStream* stream,
+                                      const Function& function) {
+  WriteFunctionRef(stream, function);
+  WriteStream::Raw<sizeof(int32_t), int32_t>::Write(
+      stream, function.SourceFingerprint());
+  WriteStream::Raw<sizeof(intptr_t), intptr_t>::Write(
+      stream, function.usage_counter());
+  stream->WriteUnsigned(function.HasOptimizedCode() ? 1 : 0);
+
+  // The feedback of optimized functions was collected before they were
+  // optimized and is still held by their unoptimized code.
+  const Code& code = Code::Handle(function.unoptimized_code());
+  const Array& ic_data_array = Array::Handle(code.ExtractTypeFeedbackArray());
+  const Library& library =
+      Library::Handle(Class::Handle(function.Owner()).library());
+  ICData& ic_data = ICData::Handle();
+  intptr_t count = 0;
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (HasTypeFeedback(ic_data, library)) {
+      count++;
+    }
+  }
+  stream->WriteUnsigned(count);
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (HasTypeFeedback(ic_data, library)) {
+      WriteICData(stream, ic_data, library);
+    }
+  }
+}
+
+
+static bool IsCacheable(const Function& function) {
+  if (function.IsClosureFunction() ||
+      (function.unoptimized_code() == Code::null())) {
+    return false;
+  }
+  return (function.usage_counter() > 0) || function.HasOptimizedCode();
+}
+
+
+void TypeFeedbackCache::Write(uint8_t** buffer,
+                              ReAlloc alloc,
+                              intptr_t* size) {
+  Isolate* isolate = Isolate::Current();
+  const GrowableObjectArray& libs = GrowableObjectArray::Handle(
+      isolate, isolate->object_store()->libraries());
+  Library& lib = Library::Handle(isolate);
+  Class& cls = Class::Handle(isolate);
+  Array& functions = Array::Handle(isolate);
+  Function& function = Function::Handle(isolate);
+  GrowableArray<const Function*> cached_functions;
+  for (intptr_t i = 0; i < libs.Length(); i++) {
+    lib ^= libs.At(i);
+    ClassDictionaryIterator it(lib, ClassDictionaryIterator::kIteratePrivate);
+    while (it.HasNext()) {
+      cls = it.GetNextClass();
+      if (!cls.is_finalized()) {
+        continue;
+      }
+      functions = cls.functions();
+      for (intptr_t j = 0; j < functions.Length(); j++) {
+        function ^= functions.At(j);
+        if (IsCacheable(function)) {
+          cached_functions.Add(&Function::ZoneHandle(isolate, function.raw()));
+        }
+      }
+    }
+  }
+
+  const intptr_t kInitialSize = 64 * KB;
+  WriteStream stream(buffer, alloc, kInitialSize);
+  stream.WriteBytes(reinterpret_cast<const uint8_t*>(kMarker), kMarkerLength);
+  const char* version = Version::String();
+  WriteCString(&stream, version, strlen(version));
+  // These flags change the code generated for a function and with it the
+  // deopt ids of its calls.
+  stream.WriteUnsigned(FLAG_enable_type_checks ? 1 : 0);
+  stream.WriteUnsigned(FLAG_enable_asserts ? 1 : 0);
+  stream.WriteUnsigned(cached_functions.length());
+  for (intptr_t i = 0; i < cached_functions.length(); i++) {
+    WriteFunction(&stream, *cached_functions[i]);
+  }
+  stream.WriteBytes(reinterpret_cast<const uint8_t*>(kMarker), kMarkerLength);
+  *size = stream.bytes_written();
+  if (FLAG_trace_type_feedback_cache) {
+    OS::Print("Saved type feedback of %" Pd " functions, %" Pd " bytes\n",
+              cached_functions.length(), *size);
+  }
+}
+
+
+// Checks that a cache is well formed before anything is read from it with
+// the unchecked ReadStream: every length and count must fit into the rest of
+// the buffer, and the cache must end right at the end of the buffer.
+class CacheChecker : public ValueObject {
+ public:
+  CacheChecker(const uint8_t* buffer, intptr_t size)
+      : current_(buffer), end_(buffer + size) { }
+
+  bool Check() {
+    intptr_t len = 0;
+    intptr_t type_checks = 0;
+    intptr_t asserts = 0;
+    intptr_t num_functions = 0;
+    if (!SkipCString(&len) ||
+        !ReadUnsigned(&type_checks) ||
+        !ReadUnsigned(&asserts) ||
+        !ReadUnsigned(&num_functions)) {
+      return false;
+    }
+    for (intptr_t i = 0; i < num_functions; i++) {
+      if (!SkipFunction()) {
+        return false;
+      }
+    }
+    return current_ == end_;
+  }
+
+ private:
+  // Values written with WriteStream::WriteUnsigned.
+  bool ReadUnsigned(intptr_t* value) {
+    uintptr_t result = 0;
+    intptr_t shift = 0;
+    while (current_ < end_) {
+      uint8_t b = *current_++;
+      if (b > kMaxUnsignedDataPerByte) {
+        uintptr_t last = b - kEndUnsignedByteMarker;
+        if ((shift >= kBitsPerWord) ||
+            ((shift > 0) && ((last >> (kBitsPerWord - shift)) != 0))) {
+          return false;
+        }
+        *value = static_cast<intptr_t>(result | (last << shift));
+        return *value >= 0;
+      }
+      if (shift >= kBitsPerWord) {
+        return false;
+      }
+      result |= static_cast<uintptr_t>(b) << shift;
+      shift += kDataBitsPerByte;
+    }
+    return false;
+  }
+
+  // Values written with WriteStream::Raw, which use at most
+  // 'max_bytes' bytes.
+  bool SkipRaw(intptr_t max_bytes) {
+    for (intptr_t i = 0; i < max_bytes; i++) {
+      if (current_ >= end_) {
+        return false;
+      }
+      if (*current_++ > kMaxUnsignedDataPerByte) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool SkipCString(intptr_t* len) {
+    if (!ReadUnsigned(len) || (*len > (end_ - current_))) {
+      return false;
+    }
+    current_ += *len;
+    return true;
+  }
+
+  bool SkipClassRef() {
+    intptr_t len = 0;
+    if (!SkipCString(&len)) {
+      return false;
+    }
+    return (len == 0) || SkipCString(&len);
+  }
+
+  bool SkipFunctionRef() {
+    intptr_t len = 0;
+    return SkipClassRef() && SkipCString(&len);
+  }
+
+  bool SkipICData() {
+    intptr_t deopt_id = 0;
+    intptr_t num_args_tested = 0;
+    intptr_t len = 0;
+    intptr_t num_checks = 0;
+    if (!ReadUnsigned(&deopt_id) ||
+        !ReadUnsigned(&num_args_tested) ||
+        !SkipCString(&len) ||
+        !ReadUnsigned(&num_checks)) {
+      return false;
+    }
+    // Every check takes at least one byte for each of its class references,
+    // two for its target and one for its count. This also bounds the size
+    // of the array ApplyICData allocates for the checks.
+    if ((num_args_tested == 0) ||
+        (num_args_tested > (end_ - current_)) ||
+        (num_checks > ((end_ - current_) / (num_args_tested + 3)))) {
+      return false;
+    }
+    for (intptr_t i = 0; i < num_checks; i++) {
+      for (intptr_t k = 0; k < num_args_tested; k++) {
+        if (!SkipClassRef()) {
+          return false;
+        }
+      }
+      intptr_t count = 0;
+      if (!SkipFunctionRef() || !ReadUnsigned(&count)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool SkipFunction() {
+    intptr_t was_optimized = 0;
+    intptr_t num_ic_data = 0;
+    if (!SkipFunctionRef() ||
+        !SkipRaw(kMaxRawBytes32) ||
+        !SkipRaw(kMaxRawBytesWord) ||
+        !ReadUnsigned(&was_optimized) ||
+        !ReadUnsigned(&num_ic_data)) {
+      return false;
+    }
+    for (intptr_t i = 0; i < num_ic_data; i++) {
+      if (!SkipICData()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static const intptr_t kMaxRawBytes32 = (32 / kDataBitsPerByte) + 1;
+  static const intptr_t kMaxRawBytesWord =
+      (kBitsPerWord / kDataBitsPerByte) + 1;
+
+  const uint8_t* current_;
+  const uint8_t* end_;
+
+  DISALLOW_COPY_AND_ASSIGN(CacheChecker);
+};
+
+
+// Reads the feedback of an inline cache and adds it to the matching inline
+// cache in 'ic_data_array', unless that is null.
+void TypeFeedbackCache::ApplyICData(ReadStream* stream,
+                                    const Library& caller_library,
+                                    const Array& ic_data_array) {
+  Isolate* isolate = Isolate::Current();
+  const intptr_t deopt_id = stream->ReadUnsigned();
+  const intptr_t num_args_tested = stream->ReadUnsigned();
+  intptr_t len = 0;
+  const char* target_name_str = ReadCString(stream, &len);
+  const intptr_t num_checks = stream->ReadUnsigned();
+
+  bool valid = !ic_data_array.IsNull();
+  String& target_name = String::Handle(isolate);
+  ICData& ic_data = ICData::Handle(isolate);
+  if (valid) {
+    target_name = DecodeName(target_name_str, caller_library);
+    if (deopt_id < ic_data_array.Length()) {
+      ic_data ^= ic_data_array.At(deopt_id);
+    }
+    valid = !ic_data.IsNull() &&
+        (ic_data.num_args_tested() == num_args_tested) &&
+        (ic_data.target_name() == target_name.raw());
+  }
+  Array& checks = Array::Handle(isolate);
+  if (valid) {
+    // Class ids, target and count of each check.
+    checks = Array::New(num_checks * (num_args_tested + 2));
+  }
+  Class& cls = Class::Handle(isolate);
+  Class& receiver_class = Class::Handle(isolate);
+  Function& target = Function::Handle(isolate);
+  intptr_t pos = 0;
+  for (intptr_t i = 0; i < num_checks; i++) {
+    for (intptr_t k = 0; k < num_args_tested; k++) {
+      cls = ReadClass(stream);
+      if (k == 0) {
+        receiver_class = cls.raw();
+      }
+      if (valid && cls.IsNull()) {
+        valid = false;
+      }
+      if (valid) {
+        checks.SetAt(pos++, Smi::Handle(isolate, Smi::New(cls.id())));
+      }
+    }
+    target = ReadFunction(stream);
+    const intptr_t count = stream->ReadUnsigned();
+    if (!valid) {
+      continue;
+    }
+    // The target must still be the one the receiver class dispatches to,
+    // otherwise the class hierarchy or the members changed.
+    const ArgumentsDescriptor args_desc(
+        Array::Handle(isolate, ic_data.arguments_descriptor()));
+    if (target.IsNull() ||
+        (Resolver::ResolveDynamicForReceiverClass(
+            receiver_class, target_name, args_desc) != target.raw())) {
+      valid = false;
+      continue;
+    }
+    // Calls through the inline cache jump to the code of the target, which
+    // is not compiled yet if the target changed or was never invoked.
+    if (!target.HasCode() &&
+        (Compiler::CompileFunction(target) != Error::null())) {
+      valid = false;
+      continue;
+    }
+    checks.SetAt(pos++, target);
+    checks.SetAt(pos++, Smi::Handle(isolate, Smi::New(count)));
+  }
+  if (ic_data_array.IsNull()) {
+    return;
+  }
+  if (!valid) {
+    stale_ic_data_++;
+    return;
+  }
+
+  // Inline caches which already collected feedback are left alone.
+  if (ic_data.NumberOfChecks() > 0) {
+    return;
+  }
+  GrowableArray<intptr_t> class_ids;
+  pos = 0;
+  for (intptr_t i = 0; i < num_checks; i++) {
+    class_ids.Clear();
+    for (intptr_t k = 0; k < num_args_tested; k++) {
+      class_ids.Add(Smi::Value(Smi::RawCast(checks.At(pos++))));
+    }
+    target ^= checks.At(pos++);
+    const intptr_t count = Smi::Value(Smi::RawCast(checks.At(pos++)));
+    if (num_args_tested == 1) {
+      ic_data.AddReceiverCheck(class_ids[0], target, count);
+    } else {
+      ic_data.AddCheck(class_ids, target);
+      ic_data.SetCountAt(ic_data.NumberOfChecks() - 1, count);
+    }
+  }
+  applied_ic_data_++;
+}
+
+
+void TypeFeedbackCache::ApplyFunction(ReadStream* stream) {
+  Isolate* isolate = Isolate::Current();
+  const Function& function = Function::Handle(isolate, ReadFunction(stream));
+  const int32_t fingerprint =
+      ReadStream::Raw<sizeof(int32_t), int32_t>::Read(stream);
+  const intptr_t usage_counter =
+      ReadStream::Raw<sizeof(intptr_t), intptr_t>::Read(stream);
+  const bool was_optimized = (stream->ReadUnsigned() != 0);
+  const intptr_t num_ic_data = stream->ReadUnsigned();
+
+  bool valid = !function.IsNull() &&
+      (function.SourceFingerprint() == fingerprint);
+  if (valid && !function.HasCode()) {
+    valid = (Compiler::CompileFunction(function) == Error::null());
+  }
+  const Library& library = Library::Handle(isolate,
+      valid ? Class::Handle(isolate, function.Owner()).library()
+            : Library::null());
+  Array& ic_data_array = Array::Handle(isolate);
+  if (valid && !function.HasOptimizedCode()) {
+    const Code& code = Code::Handle(isolate, function.unoptimized_code());
+    ic_data_array = code.ExtractTypeFeedbackArray();
+  }
+  for (intptr_t i = 0; i < num_ic_data; i++) {
+    ApplyICData(stream, library, ic_data_array);
+  }
+  if (!valid) {
+    stale_functions_++;
+    if (FLAG_trace_type_feedback_cache && !function.IsNull()) {
+      OS::Print("Stale type feedback: %s\n",
+                function.ToFullyQualifiedCString());
+    }
+    return;
+  }
+  // An optimized function is optimized again on its next invocation.
+  intptr_t counter = was_optimized ?
+      FLAG_optimization_counter_threshold : usage_counter;
+  if (counter > function.usage_counter()) {
+    function.set_usage_counter(counter);
+  }
+  applied_functions_++;
+}
+
+
+bool TypeFeedbackCache::Apply(const uint8_t* buffer, intptr_t size) {
+  if ((size < 2 * kMarkerLength) ||
+      (memcmp(buffer, kMarker, kMarkerLength) != 0) ||
+      (memcmp(buffer + size - kMarkerLength, kMarker, kMarkerLength) != 0)) {
+    return false;
+  }
+  CacheChecker checker(buffer + kMarkerLength, size - 2 * kMarkerLength);
+  if (!checker.Check()) {
+    if (FLAG_trace_type_feedback_cache) {
+      OS::Print("Rejected corrupt type feedback cache\n");
+    }
+    return false;
+  }
+  ReadStream stream(buffer + kMarkerLength, size - 2 * kMarkerLength);
+  intptr_t len = 0;
+  const char* version = ReadCString(&stream, &len);
+  if (strcmp(version, Version::String()) != 0) {
+    return false;
+  }
+  const bool type_checks = (stream.ReadUnsigned() != 0);
+  const bool asserts = (stream.ReadUnsigned() != 0);
+  if ((type_checks != FLAG_enable_type_checks) ||
+      (asserts != FLAG_enable_asserts)) {
+    return false;
+  }
+  const intptr_t num_functions = stream.ReadUnsigned();
+  for (intptr_t i = 0; i < num_functions; i++) {
+    ApplyFunction(&stream);
+  }
+  if (FLAG_trace_type_feedback_cache) {
+    OS::Print("Applied type feedback of %" Pd " functions and %" Pd " inline "
+              "caches, dropped %" Pd " stale functions and %" Pd " stale "
+              "inline caches\n",
+              applied_functions_, applied_ic_data_,
+              stale_functions_, stale_ic_data_);
+  }
+  return true;
+}
+
+}  // namespace dart
@@ -0,0 +1,78 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_TYPE_FEEDBACK_CACHE_H_
+#define VM_TYPE_FEEDBACK_CACHE_H_
+
+#include "vm/allocation.h"
+#include "vm/datastream.h"
+#include "vm/flags.h"
+
+namespace dart {
+
+class Array;
+class Function;
+class ICData;
+class Library;
+
+DECLARE_FLAG(bool, trace_type_feedback_cache);
+
+// TypeFeedbackCache saves the warm-up state of an isolate so that a restarted
+// process can skip it: the usage counters of the compiled functions and the
+// type feedback collected in the inline caches of their unoptimized code.
+// Loading the cache before running main compiles the recorded functions,
+// seeds their inline caches and restores their usage counters, so hot
+// functions are optimized on their first invocations with the same feedback
+// the previous run had gathered.
+//
+// Machine code is not cached, it embeds the addresses of stubs, runtime
+// entries and objects of the process which generated it. Classes and
+// functions are recorded by library url and name, since class ids differ
+// between runs. Entries are dropped on load if the source of a function
+// changed, or if a recorded receiver class no longer dispatches the call to
+// the recorded target in the current class hierarchy.
+class TypeFeedbackCache : public ValueObject {
+ public:
+  TypeFeedbackCache()
+      : applied_functions_(0),
+        stale_functions_(0),
+        applied_ic_data_(0),
+        stale_ic_data_(0) { }
+
+  // Writes the cache for the libraries loaded in the current isolate.
+  static void Write(uint8_t** buffer, ReAlloc alloc, intptr_t* size);
+
+  // Applies a cache written by Write to the current isolate. Returns false
+  // if the cache was written by a different VM version or with different
+  // code generation flags, or is truncated or corrupt, in which case nothing
+  // is applied.
+  bool Apply(const uint8_t* buffer, intptr_t size);
+
+  intptr_t applied_functions() const { return applied_functions_; }
+  intptr_t stale_functions() const { return stale_functions_; }
+  intptr_t applied_ic_data() const { return applied_ic_data_; }
+  intptr_t stale_ic_data() const { return stale_ic_data_; }
+
+ private:
+  static void WriteFunction(WriteStream* stream, const Function& function);
+  static void WriteICData(WriteStream* stream,
+                          const ICData& ic_data,
+                          const Library& caller_library);
+
+  void ApplyFunction(ReadStream* stream);
+  void ApplyICData(ReadStream* stream,
+                   const Library& caller_library,
+                   const Array& ic_data_array);
+
+  intptr_t applied_functions_;
+  intptr_t stale_functions_;  // Changed source or no longer resolvable.
+  intptr_t applied_ic_data_;
+  intptr_t stale_ic_data_;  // Targets changed with the class hierarchy.
+
+  DISALLOW_COPY_AND_ASSIGN(TypeFeedbackCache);
+};
+
+}  // namespace dart
+
+#endif  // VM_TYPE_FEEDBACK_CACHE_H_
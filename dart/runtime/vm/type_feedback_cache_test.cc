@@ -0,0 +1,241 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dart_api_impl.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/type_feedback_cache.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static const char* kScriptChars =
+    "class A { int foo() => 1; }\n"
+    "class B extends A { int foo() => 2; }\n"
+    "int callFoo(A a) => a.foo();\n"
+    "int run() {\n"
+    "  var sum = 0;\n"
+    "  var a = new A();\n"
+    "  var b = new B();\n"
+    "  for (var i = 0; i < 100; i++) {\n"
+    "    sum += callFoo(a) + callFoo(b);\n"
+    "  }\n"
+    "  return sum;\n"
+    "}\n";
+
+// B no longer overrides foo, calls of foo on a B dispatch to A.foo.
+static const char* kChangedScriptChars =
+    "class A { int foo() => 1; }\n"
+    "class B extends A { }\n"
+    "int callFoo(A a) => a.foo();\n";
+
+// B.foo returns something else, callFoo and run did not change.
+static const char* kChangedTargetScriptChars =
+    "class A { int foo() => 1; }\n"
+    "class B extends A { int foo() => 3; }\n"
+    "int callFoo(A a) => a.foo();\n"
+    "int run() {\n"
+    "  var sum = 0;\n"
+    "  var a = new A();\n"
+    "  var b = new B();\n"
+    "  for (var i = 0; i < 100; i++) {\n"
+    "    sum += callFoo(a) + callFoo(b);\n"
+    "  }\n"
+    "  return sum;\n"
+    "}\n";
+
+
+static RawFunction* LookupCallFoo(Dart_Handle lib) {
+  Library& library = Library::Handle();
+  library ^= Api::UnwrapHandle(lib);
+  return library.LookupLocalFunction(
+      String::Handle(Symbols::New("callFoo")));
+}
+
+
+// Returns the number of receiver classes recorded for the call of foo in
+// callFoo.
+static intptr_t NumberOfFooChecks(const Function& call_foo) {
+  const Code& code = Code::Handle(call_foo.unoptimized_code());
+  EXPECT(!code.IsNull());
+  const Array& ic_data_array = Array::Handle(code.ExtractTypeFeedbackArray());
+  ICData& ic_data = ICData::Handle();
+  for (intptr_t i = 0; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (!ic_data.IsNull() &&
+        String::Handle(ic_data.target_name()).Equals("foo")) {
+      return ic_data.NumberOfChecks();
+    }
+  }
+  return -1;
+}
+
+
+static uint8_t* SaveTypeFeedback(intptr_t* size) {
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("run"), 0, NULL));
+  const Function& call_foo = Function::Handle(LookupCallFoo(lib));
+  EXPECT_EQ(200, call_foo.usage_counter());
+  EXPECT_EQ(2, NumberOfFooChecks(call_foo));
+
+  uint8_t* buffer = NULL;
+  EXPECT_VALID(Dart_SaveTypeFeedback(&buffer, size));
+  uint8_t* copy = reinterpret_cast<uint8_t*>(malloc(*size));
+  memmove(copy, buffer, *size);
+  return copy;
+}
+
+
+UNIT_TEST_CASE(TypeFeedbackCache_SaveAndLoad) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    buffer = SaveTypeFeedback(&size);
+  }
+  {
+    // A new isolate starts out with the feedback of the first one.
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+    const Function& call_foo = Function::Handle(LookupCallFoo(lib));
+    EXPECT(!call_foo.HasCode());
+    EXPECT_VALID(Dart_LoadTypeFeedback(buffer, size));
+    EXPECT(call_foo.HasCode());
+    EXPECT_EQ(200, call_foo.usage_counter());
+    EXPECT_EQ(2, NumberOfFooChecks(call_foo));
+    EXPECT_VALID(Dart_Invoke(lib, NewString("run"), 0, NULL));
+  }
+  free(buffer);
+}
+
+
+UNIT_TEST_CASE(TypeFeedbackCache_DropStaleFeedback) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    buffer = SaveTypeFeedback(&size);
+  }
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    Dart_Handle lib = TestCase::LoadTestScript(kChangedScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(Isolate::Current()));
+    TypeFeedbackCache cache;
+    EXPECT(cache.Apply(buffer, size));
+    // callFoo did not change, but the recorded target B.foo is gone.
+    const Function& call_foo = Function::Handle(LookupCallFoo(lib));
+    EXPECT(call_foo.HasCode());
+    EXPECT_EQ(200, call_foo.usage_counter());
+    EXPECT_EQ(0, NumberOfFooChecks(call_foo));
+    EXPECT_LE(1, cache.stale_ic_data());
+    // run does not exist anymore.
+    EXPECT_LE(1, cache.stale_functions());
+  }
+  {
+    // Feedback of another VM version is rejected as a whole.
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    TestCase::LoadTestScript(kScriptChars, NULL);
+    buffer[sizeof("dart-type-feedback")] ^= 0xff;
+    EXPECT(Dart_IsError(Dart_LoadTypeFeedback(buffer, size)));
+  }
+  free(buffer);
+}
+
+
+UNIT_TEST_CASE(TypeFeedbackCache_CompileChangedTarget) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    buffer = SaveTypeFeedback(&size);
+  }
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    Dart_Handle lib = TestCase::LoadTestScript(kChangedTargetScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(Isolate::Current()));
+    Library& library = Library::Handle();
+    library ^= Api::UnwrapHandle(lib);
+    const Class& b = Class::Handle(
+        library.LookupLocalClass(String::Handle(Symbols::New("B"))));
+    EXPECT(!b.IsNull());
+    const Function& b_foo = Function::Handle(
+        b.LookupDynamicFunction(String::Handle(Symbols::New("foo"))));
+    EXPECT(!b_foo.IsNull());
+    EXPECT(!b_foo.HasCode());
+    TypeFeedbackCache cache;
+    EXPECT(cache.Apply(buffer, size));
+    // The feedback of B.foo itself is stale, but the checks of callFoo still
+    // dispatch to it, so it must have been compiled.
+    EXPECT_LE(1, cache.stale_functions());
+    const Function& call_foo = Function::Handle(LookupCallFoo(lib));
+    EXPECT_EQ(2, NumberOfFooChecks(call_foo));
+    EXPECT(b_foo.HasCode());
+    Dart_Handle result = Dart_Invoke(lib, NewString("run"), 0, NULL);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(400, value);
+  }
+  free(buffer);
+}
+
+
+UNIT_TEST_CASE(TypeFeedbackCache_RejectCorrupt) {
+  uint8_t* buffer = NULL;
+  intptr_t size = 0;
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    buffer = SaveTypeFeedback(&size);
+  }
+  {
+    TestIsolateScope __test_isolate__;
+    StackZone zone(__test_isolate__.isolate());
+    HandleScope scope(__test_isolate__.isolate());
+    TestCase::LoadTestScript(kScriptChars, NULL);
+    EXPECT_VALID(Api::CheckIsolateState(Isolate::Current()));
+    const intptr_t kMarkerLength = sizeof("dart-type-feedback") - 1;
+    uint8_t* corrupt = reinterpret_cast<uint8_t*>(malloc(size));
+
+    // A cache missing its last byte before the end marker.
+    memmove(corrupt, buffer, size - kMarkerLength - 1);
+    memmove(corrupt + size - kMarkerLength - 1,
+            buffer + size - kMarkerLength,
+            kMarkerLength);
+    {
+      TypeFeedbackCache cache;
+      EXPECT(!cache.Apply(corrupt, size - 1));
+      EXPECT_EQ(0, cache.applied_functions());
+    }
+
+    // Lengths and counts made huge by continuation bytes must not be read
+    // past the end of the buffer.
+    for (intptr_t i = kMarkerLength; i < size - kMarkerLength; i++) {
+      memmove(corrupt, buffer, size);
+      corrupt[i] = 0x7f;
+      TypeFeedbackCache cache;
+      cache.Apply(corrupt, size);
+    }
+    free(corrupt);
+  }
+  free(buffer);
+}
+
+}  // namespace dart
@@ -19,6 +19,7 @@ import 'dart:_foreign_helper' show DART_CLOSURE_TO_JS,
                                    JS_SET_CURRENT_ISOLATE,
                                    IsolateContext;
 import 'dart:_interceptors' show JSExtendableArray;
+import 'dart:typed_data' show ByteBuffer, TypedData, Uint8List;
 
 ReceivePort lazyPort;
 
@@ -927,6 +928,47 @@ _waitForPendingPorts(var message, void callback()) {
 }
 
 
+/**
+ * Implementation of [TransferableTypedData]. The bytes are moved to the
+ * receiving isolate when it shares the heap of the sender, and copied by
+ * postMessage when it runs in another worker.
+ */
+class TransferableTypedDataImpl implements TransferableTypedData {
+  TransferableTypedDataImpl._(this._bytes);
+
+  factory TransferableTypedDataImpl.fromList(List<TypedData> list) {
+    int length = 0;
+    for (TypedData data in list) {
+      length += data.lengthInBytes;
+    }
+    Uint8List bytes = new Uint8List(length);
+    int offset = 0;
+    for (TypedData data in list) {
+      int end = offset + data.lengthInBytes;
+      bytes.setRange(offset, end, new Uint8List.view(
+          data.buffer, data.offsetInBytes, data.lengthInBytes));
+      offset = end;
+    }
+    return new TransferableTypedDataImpl._(bytes);
+  }
+
+  ByteBuffer materialize() => _detach().buffer;
+
+  // Takes the bytes away from this object, when it is materialized or sent.
+  Uint8List _detach() {
+    if (_bytes == null) {
+      throw new StateError(
+          "TransferableTypedData was already materialized or sent");
+    }
+    Uint8List bytes = _bytes;
+    _bytes = null;
+    return bytes;
+  }
+
+  Uint8List _bytes;
+}
+
+
 /** Visitor that finds all unresolved [SendPort]s in a message. */
 class _PendingSendPortFinder extends _MessageTraverser {
   List<Future<SendPort>> ports;
@@ -956,6 +998,8 @@ class _PendingSendPortFinder extends _MessageTraverser {
       ports.add(port._futurePort);
     }
   }
+
+  visitTransferableTypedData(TransferableTypedDataImpl x) {}
 }
 
 /********************************************************
@@ -1162,6 +1206,7 @@ class _MessageTraverser {
     if (x is List) return visitList(x);
     if (x is Map) return visitMap(x);
     if (x is SendPort) return visitSendPort(x);
+    if (x is TransferableTypedDataImpl) return visitTransferableTypedData(x);
 
     // Overridable fallback.
     return visitObject(x);
@@ -1171,6 +1216,7 @@ class _MessageTraverser {
   visitList(List x);
   visitMap(Map x);
   visitSendPort(SendPort x);
+  visitTransferableTypedData(TransferableTypedDataImpl x);
 
   visitObject(Object x) {
     // TODO(floitsch): make this a real exception. (which one)?
@@ -1216,6 +1262,10 @@ class _Copier extends _MessageTraverser {
     return copy;
   }
 
+  // The receiver shares the heap, the bytes are moved without copying.
+  visitTransferableTypedData(TransferableTypedDataImpl x) {
+    return new TransferableTypedDataImpl._(x._detach());
+  }
 }
 
 /** Visitor that serializes a message as a JSON array. */
@@ -1247,6 +1297,11 @@ class _Serializer extends _MessageTraverser {
     return ['map', id, keys, values];
   }
 
+  // postMessage copies the bytes to the receiving worker.
+  visitTransferableTypedData(TransferableTypedDataImpl x) {
+    return ['transferable', x._detach()];
+  }
+
   _serializeList(List list) {
     int len = list.length;
     // Use a growable list because we do not add extra properties on
@@ -1284,6 +1339,7 @@ class _Deserializer {
       case 'list': return _deserializeList(x);
       case 'map': return _deserializeMap(x);
       case 'sendport': return deserializeSendPort(x);
+      case 'transferable': return new TransferableTypedDataImpl._(x[1]);
       default: return deserializeObject(x);
     }
   }
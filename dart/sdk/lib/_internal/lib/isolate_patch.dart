@@ -8,6 +8,7 @@ import 'dart:_isolate_helper' show IsolateNatives,
                                    lazyPort,
                                    ReceivePortImpl,
                                    RawReceivePortImpl,
+                                   TransferableTypedDataImpl,
                                    CloseToken,
                                    JsIsolateSink;
 
@@ -47,3 +48,9 @@ patch class RawReceivePort {
     return new RawReceivePortImpl(handler);
   }
 }
+
+patch class TransferableTypedData {
+  patch factory TransferableTypedData.fromList(List<TypedData> list) {
+    return new TransferableTypedDataImpl.fromList(list);
+  }
+}
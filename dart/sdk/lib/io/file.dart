@@ -20,6 +20,22 @@ class FileMode {
   final int _mode;
 }
 
+/**
+ * The expected access pattern of the bytes of a file mapped into memory with
+ * [RandomAccessFile.map]. The operating system uses the hint to decide how
+ * much of the file to read ahead, where supported.
+ */
+class FileMapHint {
+  /// No particular access pattern.
+  static const NORMAL = const FileMapHint._internal(0);
+  /// The bytes are accessed in order, more of the file can be read ahead.
+  static const SEQUENTIAL = const FileMapHint._internal(1);
+  /// The bytes are accessed in random order, reading ahead is wasted.
+  static const RANDOM = const FileMapHint._internal(2);
+  const FileMapHint._internal(int this._hint);
+  final int _hint;
+}
+
 /// The [FileMode] for opening a file only for reading.
 const READ = FileMode.READ;
 /// The [FileMode] for opening a file for reading and writing. The file will be
@@ -408,6 +424,35 @@ abstract class RandomAccessFile {
    */
   int readIntoSync(List<int> buffer, [int start, int end]);
 
+  /**
+   * Maps the bytes of the file from [start] to [end] into memory. If [start]
+   * is not present it defaults to 0, and if [end] is not present it defaults
+   * to the length of the file. Returns a [:Future<Uint8List>:] that completes
+   * with a list backed by the mapped memory.
+   *
+   * The bytes are not copied into the Dart heap, they are read from the file
+   * by the operating system when the list is accessed, which makes mapping
+   * suitable for large files. Writing to the list does not change the file.
+   * The memory stays mapped as long as the list is reachable, also after the
+   * file is closed. The file must not be truncated while a list mapping its
+   * end is in use, accessing the missing bytes crashes the process.
+   *
+   * [hint] tells the operating system how the list will be accessed.
+   */
+  Future<Uint8List> map([int start,
+                         int end,
+                         FileMapHint hint = FileMapHint.NORMAL]);
+
+  /**
+   * Synchronously maps the bytes of the file from [start] to [end] into
+   * memory. See [map].
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  Uint8List mapSync([int start,
+                     int end,
+                     FileMapHint hint = FileMapHint.NORMAL]);
+
   /**
    * Writes a single byte to the file. Returns a
    * [:Future<RandomAccessFile>:] that completes with this
@@ -443,6 +488,59 @@ abstract class RandomAccessFile {
    */
   void writeFromSync(List<int> buffer, [int start, int end]);
 
+  /**
+   * Reads up to [bytes] bytes from the file, starting at [position], without
+   * using or changing the position of the file. Returns a
+   * [:Future<List<int>>:] that completes with the bytes read, which are
+   * fewer than [bytes] if the end of the file is reached.
+   *
+   * A positional read is a single request to the IO service, where a read
+   * from a position otherwise needs a [setPosition] request first.
+   */
+  Future<List<int>> readAt(int position, int bytes);
+
+  /**
+   * Synchronously reads up to [bytes] bytes from the file, starting at
+   * [position], without using or changing the position of the file.
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  List<int> readAtSync(int position, int bytes);
+
+  /**
+   * Writes the bytes of [buffer] from index [start] to index [end] to the
+   * file at [position], without using or changing the position of the file.
+   * If [start] is omitted, it'll start from index 0. If [end] is omitted, it
+   * will write to the end of [buffer]. Returns a
+   * [:Future<RandomAccessFile>:] that completes with this [RandomAccessFile]
+   * when the write completes.
+   */
+  Future<RandomAccessFile> writeAt(int position,
+                                   List<int> buffer,
+                                   [int start, int end]);
+
+  /**
+   * Synchronously writes the bytes of [buffer] from index [start] to index
+   * [end] to the file at [position], without using or changing the position
+   * of the file.
+   *
+   * Throws a [FileSystemException] if the operation fails.
+   */
+  void writeAtSync(int position, List<int> buffer, [int start, int end]);
+
+  /**
+   * Reads many regions of the file in a single request to the IO service.
+   * Region i starts at [:positions[i]:] and is [:lengths[i]:] bytes long.
+   * The position of the file is neither used nor changed. Returns a
+   * [:Future<List<List<int>>>:] that completes with the bytes read for each
+   * region, which are fewer than its length if the region extends beyond
+   * the end of the file.
+   *
+   * Use [readBatch] instead of many [readAt] calls when doing many small
+   * reads, as only one async operation can be pending on a file at a time.
+   */
+  Future<List<List<int>>> readBatch(List<int> positions, List<int> lengths);
+
   /**
    * Writes a string to the file using the given [Encoding]. Returns a
    * [:Future<RandomAccessFile>:] that completes with this
@@ -671,6 +671,53 @@ class _RandomAccessFile implements RandomAccessFile {
     return result;
   }
 
+  Future<Uint8List> map([int start,
+                         int end,
+                         FileMapHint hint = FileMapHint.NORMAL]) {
+    if ((start != null && start is !int) ||
+        (end != null && end is !int) ||
+        hint is !FileMapHint) {
+      throw new ArgumentError();
+    }
+    if (start == null) start = 0;
+    Future<int> endFuture = (end == null) ? length() : new Future.value(end);
+    return endFuture.then((end) {
+      if (start < 0) throw new RangeError.value(start);
+      if (end < start) throw new RangeError.value(end);
+      if (end == start) return new Uint8List(0);
+      return _dispatch(_FILE_MAP, [_id, start, end - start, hint._hint])
+          .then((response) {
+            if (_isErrorResponse(response)) {
+              throw _exceptionFromResponse(response, "map failed", path);
+            }
+            return response[1];
+          });
+    });
+  }
+
+  external static _map(int id, int position, int length, int hint);
+
+  Uint8List mapSync([int start,
+                     int end,
+                     FileMapHint hint = FileMapHint.NORMAL]) {
+    _checkAvailable();
+    if ((start != null && start is !int) ||
+        (end != null && end is !int) ||
+        hint is !FileMapHint) {
+      throw new ArgumentError();
+    }
+    if (start == null) start = 0;
+    if (end == null) end = lengthSync();
+    if (start < 0) throw new RangeError.value(start);
+    if (end < start) throw new RangeError.value(end);
+    if (end == start) return new Uint8List(0);
+    var result = _map(_id, start, end - start, hint._hint);
+    if (result is OSError) {
+      throw new FileSystemException("map failed", path, result);
+    }
+    return result;
+  }
+
   Future<RandomAccessFile> writeByte(int value) {
     if (value is !int) {
       throw new ArgumentError(value);
@@ -748,6 +795,141 @@ class _RandomAccessFile implements RandomAccessFile {
     }
   }
 
+  Future<List<int>> readAt(int position, int bytes) {
+    if (position is !int || bytes is !int) {
+      throw new ArgumentError();
+    }
+    if (position < 0) throw new RangeError.value(position);
+    if (bytes < 0) throw new RangeError.value(bytes);
+    return _dispatch(_FILE_READ_AT, [_id, position, bytes]).then((response) {
+      if (_isErrorResponse(response)) {
+        throw _exceptionFromResponse(response, "readAt failed", path);
+      }
+      return response[1];
+    });
+  }
+
+  external static _readAt(int id, int position, int bytes);
+
+  List<int> readAtSync(int position, int bytes) {
+    _checkAvailable();
+    if (position is !int || bytes is !int) {
+      throw new ArgumentError();
+    }
+    if (position < 0) throw new RangeError.value(position);
+    if (bytes < 0) throw new RangeError.value(bytes);
+    var result = _readAt(_id, position, bytes);
+    if (result is OSError) {
+      throw new FileSystemException("readAt failed", path, result);
+    }
+    return result;
+  }
+
+  Future<RandomAccessFile> writeAt(int position,
+                                   List<int> buffer,
+                                   [int start, int end]) {
+    if (position is !int ||
+        buffer is !List ||
+        (start != null && start is !int) ||
+        (end != null && end is !int)) {
+      throw new ArgumentError("Invalid arguments to writeAt");
+    }
+    if (position < 0) throw new RangeError.value(position);
+    if (start == null) start = 0;
+    if (end == null) end = buffer.length;
+    _checkReadWriteListArguments(buffer.length, start, end);
+    _BufferAndStart result;
+    try {
+      result = _ensureFastAndSerializableByteData(buffer, start, end);
+    } catch (e) {
+      return new Future.error(e);
+    }
+    List request = new List(5);
+    request[0] = _id;
+    request[1] = position;
+    request[2] = result.buffer;
+    request[3] = result.start;
+    request[4] = end - (start - result.start);
+    return _dispatch(_FILE_WRITE_AT, request).then((response) {
+      if (_isErrorResponse(response)) {
+        throw _exceptionFromResponse(response, "writeAt failed", path);
+      }
+      return this;
+    });
+  }
+
+  external static _writeAt(int id,
+                           int position,
+                           List<int> buffer,
+                           int start,
+                           int end);
+
+  void writeAtSync(int position, List<int> buffer, [int start, int end]) {
+    _checkAvailable();
+    if (position is !int ||
+        buffer is !List ||
+        (start != null && start is !int) ||
+        (end != null && end is !int)) {
+      throw new ArgumentError("Invalid arguments to writeAtSync");
+    }
+    if (position < 0) throw new RangeError.value(position);
+    if (start == null) start = 0;
+    if (end == null) end = buffer.length;
+    if (end == start) return;
+    _checkReadWriteListArguments(buffer.length, start, end);
+    _BufferAndStart bufferAndStart =
+        _ensureFastAndSerializableByteData(buffer, start, end);
+    var result = _writeAt(_id,
+                          position,
+                          bufferAndStart.buffer,
+                          bufferAndStart.start,
+                          end - (start - bufferAndStart.start));
+    if (result is OSError) {
+      throw new FileSystemException("writeAt failed", path, result);
+    }
+  }
+
+  Future<List<List<int>>> readBatch(List<int> positions, List<int> lengths) {
+    if (positions is !List ||
+        lengths is !List ||
+        positions.length != lengths.length) {
+      throw new ArgumentError("Invalid arguments to readBatch");
+    }
+    // Copy the regions into plain lists, which are sent as arrays.
+    int count = positions.length;
+    List requestPositions = new List(count);
+    List requestLengths = new List(count);
+    for (int i = 0; i < count; i++) {
+      var position = positions[i];
+      var length = lengths[i];
+      if (position is !int || length is !int) {
+        throw new ArgumentError("Invalid arguments to readBatch");
+      }
+      if (position < 0) throw new RangeError.value(position);
+      if (length < 0) throw new RangeError.value(length);
+      requestPositions[i] = position;
+      requestLengths[i] = length;
+    }
+    return _dispatch(_FILE_READ_BATCH, [_id, requestPositions, requestLengths])
+        .then((response) {
+          if (_isErrorResponse(response)) {
+            throw _exceptionFromResponse(response, "readBatch failed", path);
+          }
+          // All regions are read into one buffer, one after the other.
+          Uint8List data = response[1];
+          List bytesRead = response[2];
+          var result = new List(count);
+          int offset = 0;
+          for (int i = 0; i < count; i++) {
+            result[i] = new Uint8List.view(data.buffer,
+                                           data.offsetInBytes + offset,
+                                           bytesRead[i]);
+            offset += requestLengths[i];
+          }
+          return result;
+        });
+  }
+
   Future<RandomAccessFile> writeString(String string,
                                        {Encoding encoding: UTF8}) {
     if (encoding is! Encoding) {
@@ -2313,6 +2313,10 @@ class _DetachedSocket extends Stream<List<int>> implements Socket {
 
   Future<Socket> get done => _socket.done;
 
+  Future<Socket> sendFile(RandomAccessFile file, [int start, int end]) {
+    return _socket.sendFile(file, start, end);
+  }
+
   int get port => _socket.port;
 
   InternetAddress get address => _socket.address;
@@ -43,6 +43,10 @@ const int _DIRECTORY_LIST_NEXT = 34;
 const int _DIRECTORY_LIST_STOP = 35;
 const int _DIRECTORY_RENAME = 36;
 const int _SSL_PROCESS_FILTER = 37;
+const int _FILE_MAP = 38;
+const int _FILE_READ_AT = 39;
+const int _FILE_WRITE_AT = 40;
+const int _FILE_READ_BATCH = 41;
 
 class _IOService {
   external static Future dispatch(int request, List data);
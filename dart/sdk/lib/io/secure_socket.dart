@@ -697,6 +697,25 @@ class _RawSecureSocket extends Stream<RawSocketEvent>
     return result;
   }
 
+  int readInto(List<int> buffer, [int start, int end]) {
+    if (buffer is! List ||
+        (start != null && start is! int) ||
+        (end != null && end is! int)) {
+      throw new ArgumentError("Invalid arguments to readInto on SecureSocket");
+    }
+    if (start == null) start = 0;
+    if (end == null) end = buffer.length;
+    if (start < 0) throw new RangeError.value(start);
+    if (end < start || end > buffer.length) throw new RangeError.value(end);
+    if (start == end) return 0;
+    // The plaintext is buffered by the filter, so there is nothing to gain
+    // over read.
+    var data = read(end - start);
+    if (data == null) return 0;
+    buffer.setRange(start, start + data.length, data);
+    return data.length;
+  }
+
   // Write the data to the socket, and schedule the filter to encrypt it.
   int write(List<int> data, [int offset, int bytes]) {
     if (bytes != null && (bytes is! int || bytes < 0)) {
@@ -724,6 +743,60 @@ class _RawSecureSocket extends Stream<RawSocketEvent>
     return written;
   }
 
+  int writeList(List<List<int>> buffers, [int offset]) {
+    if (buffers is! List) {
+      throw new ArgumentError(
+          "Invalid buffers parameter in SecureSocket.writeList");
+    }
+    if (offset != null && (offset is! int || offset < 0)) {
+      throw new ArgumentError(
+          "Invalid offset parameter in SecureSocket.writeList "
+          "(offset: $offset)");
+    }
+    if (offset == null) offset = 0;
+    // The plaintext is copied into the filter buffer, so write the lists one
+    // by one until the buffer is full.
+    int written = 0;
+    for (int i = 0; i < buffers.length; i++) {
+      var buffer = buffers[i];
+      int start = (i == 0) ? offset : 0;
+      int bytes = buffer.length - start;
+      if (bytes == 0) continue;
+      int count = write(buffer, start, bytes);
+      written += count;
+      if (count < bytes) break;
+    }
+    return written;
+  }
+
+  int sendFile(RandomAccessFile file, int position, int count) {
+    if (file is! RandomAccessFile ||
+        position is! int || position < 0 ||
+        count is! int || count < 0) {
+      throw new ArgumentError("Invalid arguments to sendFile on SecureSocket");
+    }
+    if (_closedWrite) {
+      _controller.addError(new SocketException("Writing to a closed socket"));
+      return 0;
+    }
+    if (_status != CONNECTED) return 0;
+    // The plaintext has to go through the filter, so read it from the file.
+    int bytes = min(count, _secureFilter.buffers[WRITE_PLAINTEXT].free);
+    if (bytes == 0) return 0;
+    int savedPosition = file.positionSync();
+    file.setPositionSync(position);
+    List<int> data;
+    try {
+      data = file.readSync(bytes);
+    } finally {
+      file.setPositionSync(savedPosition);
+    }
+    if (data.length < bytes) {
+      throw new SocketException("Sending beyond the end of the file");
+    }
+    return write(data);
+  }
+
   X509Certificate get peerCertificate => _secureFilter.peerCertificate;
 
   bool _onBadCertificateWrapper(X509Certificate certificate) {
@@ -371,6 +371,19 @@ abstract class RawSocket implements Stream<RawSocketEvent> {
    */
   List<int> read([int len]);
 
+  /**
+   * Reads into an existing List<int> from the socket. If [start] is present,
+   * the bytes will be filled into [buffer] from at index [start], otherwise
+   * index 0. If [end] is present, up to [end] - [start] bytes will be read
+   * into [buffer], otherwise up to [buffer.length].
+   *
+   * This function is non-blocking and, unlike [read], does not allocate a
+   * new list for the data. Reading into a [Uint8List] that is reused for
+   * every read avoids copying the data. Returns the number of bytes read,
+   * which is 0 if no data is available.
+   */
+  int readInto(List<int> buffer, [int start, int end]);
+
   /**
    * Writes up to [count] bytes of the buffer from [offset] buffer offset to
    * the socket. The number of successfully written bytes is returned. This
@@ -382,6 +395,33 @@ abstract class RawSocket implements Stream<RawSocketEvent> {
    */
   int write(List<int> buffer, [int offset, int count]);
 
+  /**
+   * Writes the bytes of the lists in [buffers] to the socket, in order, as
+   * if they were a single buffer. Writing starts at index [offset] of the
+   * first list, which defaults to 0. The number of successfully written bytes
+   * is returned, and the write can end in the middle of any of the lists.
+   * Like [write], this function is non-blocking and will only write data if
+   * buffer space is available in the socket.
+   *
+   * Where the platform supports it the lists are written with a single
+   * system call, so e.g. headers and body chunks do not have to be copied
+   * into one list or written one by one. [Uint8List]s are written without
+   * copying.
+   */
+  int writeList(List<List<int>> buffers, [int offset]);
+
+  /**
+   * Sends up to [count] bytes of [file], starting at [position], to the
+   * socket. The number of successfully sent bytes is returned. Like [write],
+   * this function is non-blocking and will only send data if buffer space is
+   * available in the socket.
+   *
+   * Where the platform supports it the bytes are sent directly from the file
+   * to the socket, without reading them into Dart. The position of [file] is
+   * not changed. Sending bytes beyond the end of the file is an error.
+   */
+  int sendFile(RandomAccessFile file, int position, int count);
+
   /**
    * Returns the port used by this socket.
    */
@@ -479,6 +519,19 @@ abstract class Socket implements Stream<List<int>>, IOSink {
    */
   bool setOption(SocketOption option, bool enabled);
 
+  /**
+   * Sends the bytes of [file] from [start] to [end] to the socket, after
+   * all data added before. The default value for [start] is 0 and for [end]
+   * the length of the file.
+   *
+   * Where the platform supports it the bytes are sent directly from the file
+   * to the socket, without reading them into Dart. Like [addStream], the
+   * socket is bound until the returned [Future] completes, and adding data
+   * to it in the meantime is an error. The position of [file] is not changed
+   * and the file must not be closed before the [Future] completes.
+   */
+  Future<Socket> sendFile(RandomAccessFile file, [int start, int end]);
+
   /**
    * Returns the port used by this socket.
    */
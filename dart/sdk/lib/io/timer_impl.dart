@@ -4,12 +4,119 @@
 
 part of dart.io;
 
-class _Timer extends LinkedListEntry<_Timer> implements Timer {
+// Timers are kept in a binary min-heap ordered by wakeup time, so adding and
+// cancelling a timer is O(log n). Timers with the same wakeup time are ordered
+// by the time they were added, so they are notified in FIFO order.
+class _TimerHeap {
+  List<_Timer> _list;
+  int _used = 0;
+
+  _TimerHeap([int initSize = 7]) : _list = new List<_Timer>(initSize);
+
+  bool get isEmpty => _used == 0;
+
+  _Timer get first => _list[0];
+
+  bool isFirst(_Timer timer) => timer._heapIndex == 0;
+
+  void add(_Timer timer) {
+    if (_used == _list.length) {
+      _resize();
+    }
+    timer._heapIndex = _used++;
+    _list[timer._heapIndex] = timer;
+    _bubbleUp(timer);
+  }
+
+  _Timer removeFirst() {
+    var f = first;
+    remove(f);
+    return f;
+  }
+
+  void remove(_Timer timer) {
+    _used--;
+    int index = timer._heapIndex;
+    timer._heapIndex = _Timer._NOT_QUEUED;
+    if (index == _used) {
+      _list[_used] = null;
+      return;
+    }
+    // Move the last timer into the hole and restore the heap order.
+    _Timer last = _list[_used];
+    _list[_used] = null;
+    last._heapIndex = index;
+    _list[index] = last;
+    if (last._compareTo(timer) < 0) {
+      _bubbleUp(last);
+    } else {
+      _bubbleDown(last);
+    }
+  }
+
+  void _resize() {
+    var newList = new List<_Timer>(_list.length * 2 + 1);
+    newList.setRange(0, _used, _list);
+    _list = newList;
+  }
+
+  void _bubbleUp(_Timer timer) {
+    while (!isFirst(timer)) {
+      _Timer parent = _parent(timer);
+      if (timer._compareTo(parent) < 0) {
+        _swap(timer, parent);
+      } else {
+        break;
+      }
+    }
+  }
+
+  void _bubbleDown(_Timer timer) {
+    while (true) {
+      int leftIndex = _leftChildIndex(timer._heapIndex);
+      int rightIndex = leftIndex + 1;
+      _Timer newest = timer;
+      if (leftIndex < _used && _list[leftIndex]._compareTo(newest) < 0) {
+        newest = _list[leftIndex];
+      }
+      if (rightIndex < _used && _list[rightIndex]._compareTo(newest) < 0) {
+        newest = _list[rightIndex];
+      }
+      if (identical(newest, timer)) {
+        // We are where we should be, break.
+        break;
+      }
+      _swap(newest, timer);
+    }
+  }
+
+  void _swap(_Timer first, _Timer second) {
+    int tmp = first._heapIndex;
+    first._heapIndex = second._heapIndex;
+    second._heapIndex = tmp;
+    _list[first._heapIndex] = first;
+    _list[second._heapIndex] = second;
+  }
+
+  _Timer _parent(_Timer timer) => _list[_parentIndex(timer._heapIndex)];
+
+  static int _parentIndex(int index) => (index - 1) ~/ 2;
+  static int _leftChildIndex(int index) => 2 * index + 1;
+}
+
+
+class _Timer implements Timer {
   // Disables the timer.
   static const int _NO_TIMER = -1;
 
+  // Index of a timer which is not in the heap.
+  static const int _NOT_QUEUED = -1;
+
   // Timers are ordered by wakeup time.
-  static LinkedList<_Timer> _timers = new LinkedList<_Timer>();
+  static _TimerHeap _timers = new _TimerHeap();
+
+  // Sequence number of the last timer added to the heap.
+  static int _idCount = 0;
 
   static RawReceivePort _receivePort;
   static bool _handling_callbacks = false;
@@ -17,6 +124,8 @@ class _Timer extends LinkedListEntry<_Timer> implements Timer {
   Function _callback;
   int _milliSeconds;
   int _wakeupTime = 0;
+  int _heapIndex = _NOT_QUEUED;
+  int _id = 0;
 
   static Timer _createTimer(void callback(Timer timer),
                             int milliSeconds,
@@ -53,16 +162,16 @@ class _Timer extends LinkedListEntry<_Timer> implements Timer {
 
   bool get isActive => _callback != null;
 
-  // Cancels a set timer. The timer is removed from the timer list and if
+  // Cancels a set timer. The timer is removed from the timer heap and if
   // the given timer is the earliest timer the native timer is reset.
   void cancel() {
     _clear();
     // Return if already canceled.
-    if (list == null) return;
+    if (_heapIndex == _NOT_QUEUED) return;
     assert(!_timers.isEmpty);
-    _Timer first = _timers.first;
-    unlink();
-    if (identical(first, this)) {
+    bool wasFirst = _timers.isFirst(this);
+    _timers.remove(this);
+    if (wasFirst) {
       _notifyEventHandler();
     }
   }
@@ -72,18 +181,16 @@ class _Timer extends LinkedListEntry<_Timer> implements Timer {
     _wakeupTime += _milliSeconds;
   }
 
-  // Adds a timer to the timer list and resets the native timer if it is the
-  // earliest timer in the list. Timers with the same wakeup time are enqueued
-  // in order and notified in FIFO order.
+  int _compareTo(_Timer other) {
+    int c = _wakeupTime - other._wakeupTime;
+    if (c != 0) return c;
+    return _id - other._id;
+  }
+
+  // Adds a timer to the timer heap. Timers with the same wakeup time are
+  // enqueued in order and notified in FIFO order.
   void _addTimerToList() {
-    _Timer entry = _timers.isEmpty ? null : _timers.first;
-    while (entry != null) {
-      if (_wakeupTime < entry._wakeupTime) {
-        entry.insertBefore(this);
-        return;
-      }
-      entry = entry.next;
-    }
+    _id = _idCount++;
     _timers.add(this);
   }
 
@@ -128,7 +235,7 @@ class _Timer extends LinkedListEntry<_Timer> implements Timer {
       while (!_timers.isEmpty) {
         _Timer entry = _timers.first;
         if (entry._wakeupTime <= currentTime) {
-          entry.unlink();
+          _timers.removeFirst();
           pending_timers.add(entry);
         } else {
           break;
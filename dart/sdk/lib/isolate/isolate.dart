@@ -15,6 +15,7 @@
 library dart.isolate;
 
 import "dart:async";
+import "dart:typed_data";
 
 /**
  * Thrown when an isolate cannot be created.
@@ -213,6 +214,35 @@ abstract class RawReceivePort {
   SendPort get sendPort;
 }
 
+/**
+ * Bytes which can be sent to another isolate without being copied.
+ *
+ * The bytes of the given typed data are copied once when the
+ * [TransferableTypedData] is created. Sending it through a [SendPort] then
+ * moves the bytes to the receiving isolate in constant time, whatever their
+ * length, and leaves the sent object empty. The receiver gets a
+ * [TransferableTypedData] holding the bytes, which it turns into a
+ * [ByteBuffer] by calling [materialize].
+ *
+ * Native ports of the standalone VM, and isolates running in another web
+ * worker when compiled to JavaScript, receive a copy of the bytes instead.
+ */
+abstract class TransferableTypedData {
+  /**
+   * Creates a [TransferableTypedData] holding the bytes of all the typed
+   * data in [list], one after the other.
+   */
+  external factory TransferableTypedData.fromList(List<TypedData> list);
+
+  /**
+   * Returns a [ByteBuffer] holding the bytes, without copying them.
+   *
+   * Throws a [StateError] if the bytes were already materialized or sent to
+   * another isolate.
+   */
+  ByteBuffer materialize();
+}
+
 /**
  * Wraps unhandled exceptions thrown during isolate execution. It is
  * used to show both the error message and the stack trace for unhandled
@@ -0,0 +1,45 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test that string literals and symbols sent to another isolate are
+// identical to the literals and symbols of the receiver.
+
+library message_canonical_test;
+import 'dart:isolate';
+import '../../pkg/unittest/lib/unittest.dart';
+
+// Replies whether the first element of each received list is identical to
+// the literal or the symbol of this isolate.
+void remote(SendPort port) {
+  RawReceivePort receivePort = new RawReceivePort();
+  int count = 0;
+  receivePort.handler = (List message) {
+    port.send([identical(message[0], "canonical literal"),
+               identical(message[0], #canonicalSymbol)]);
+    if (++count == 2) receivePort.close();
+  };
+  port.send(receivePort.sendPort);
+}
+
+main() {
+  test("literal and symbol", () {
+    RawReceivePort reply = new RawReceivePort();
+    var replies = [];
+    reply.handler = expectAsync1((message) {
+      if (message is SendPort) {
+        // A list of strings is sent in the flat format, a symbol in the
+        // regular one.
+        message.send(["canonical literal"]);
+        message.send([#canonicalSymbol]);
+        return;
+      }
+      replies.add(message);
+      if (replies.length == 2) {
+        expect(replies, equals([[true, false], [false, true]]));
+        reply.close();
+      }
+    }, count: 3);
+    Isolate.spawn(remote, reply.sendPort);
+  });
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test sending TransferableTypedData between isolates.
+
+library transferable_typed_data_test;
+import 'dart:isolate';
+import 'dart:typed_data';
+import '../../pkg/unittest/lib/unittest.dart';
+
+// Replies with the sum of the received bytes and a transferable holding
+// them in reverse order.
+void remote(SendPort port) {
+  RawReceivePort receivePort = new RawReceivePort();
+  receivePort.handler = (TransferableTypedData message) {
+    Uint8List bytes = new Uint8List.view(message.materialize());
+    int sum = bytes.fold(0, (a, b) => a + b);
+    Uint8List reversed = new Uint8List.fromList(bytes.reversed.toList());
+    port.send([sum, new TransferableTypedData.fromList([reversed])]);
+    receivePort.close();
+  };
+  port.send(receivePort.sendPort);
+}
+
+main() {
+  test("materialize", () {
+    var transferable = new TransferableTypedData.fromList(
+        [new Uint8List.fromList([1, 2]), new Int16List.fromList([-1])]);
+    Uint8List bytes = new Uint8List.view(transferable.materialize());
+    expect(bytes, equals([1, 2, 255, 255]));
+    expect(() => transferable.materialize(), throwsStateError);
+  });
+  test("send and reply", () {
+    RawReceivePort port = new RawReceivePort();
+    Isolate.spawn(remote, port.sendPort);
+    port.handler = expectAsync1((SendPort remotePort) {
+      var transferable = new TransferableTypedData.fromList(
+          [new Uint8List.fromList([1, 2, 3]), new Uint8List.fromList([4])]);
+      remotePort.send(transferable);
+      // The bytes were moved to the other isolate.
+      expect(() => transferable.materialize(), throwsStateError);
+      port.handler = expectAsync1((List reply) {
+        expect(reply[0], 10);
+        Uint8List bytes = new Uint8List.view(reply[1].materialize());
+        expect(bytes, equals([4, 3, 2, 1]));
+        port.close();
+      });
+    });
+  });
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_SIZE = 100000;
+
+int expectedByte(int index) => (index * 7) & 0xff;
+
+void expectRange(List<int> data, int start, int end) {
+  Expect.isTrue(data is Uint8List);
+  Expect.equals(end - start, data.length);
+  for (int i = 0; i < data.length; i++) {
+    Expect.equals(expectedByte(start + i), data[i]);
+  }
+}
+
+File createFile(Directory dir) {
+  var data = new Uint8List(FILE_SIZE);
+  for (int i = 0; i < FILE_SIZE; i++) data[i] = expectedByte(i);
+  var file = new File("${dir.path}/file");
+  file.writeAsBytesSync(data);
+  return file;
+}
+
+void testMapSync(File file) {
+  var raf = file.openSync();
+  expectRange(raf.mapSync(), 0, FILE_SIZE);
+  // Regions which do not start at a page boundary.
+  expectRange(raf.mapSync(1), 1, FILE_SIZE);
+  expectRange(raf.mapSync(4097, 10000, FileMapHint.RANDOM), 4097, 10000);
+  expectRange(raf.mapSync(0, 10, FileMapHint.SEQUENTIAL), 0, 10);
+  Expect.equals(0, raf.mapSync(10, 10).length);
+  // Mapping does not change the position of the file.
+  Expect.equals(0, raf.positionSync());
+
+  // Writing to the mapped list does not change the file.
+  var data = raf.mapSync(100, 200);
+  data[0] = expectedByte(100) + 1;
+  Expect.equals(expectedByte(100), raf.mapSync(100, 101)[0]);
+  raf.setPositionSync(100);
+  Expect.equals(expectedByte(100), raf.readByteSync());
+
+  // The list stays valid after the file is closed.
+  data = raf.mapSync(1000, 2000);
+  raf.closeSync();
+  expectRange(data, 1000, 2000);
+}
+
+void testMapSyncInvalidArguments(File file) {
+  var raf = file.openSync();
+  Expect.throws(() => raf.mapSync(-1), (e) => e is RangeError);
+  Expect.throws(() => raf.mapSync(10, 5), (e) => e is RangeError);
+  Expect.throws(() => raf.mapSync(0, FILE_SIZE + 1),
+                (e) => e is FileSystemException);
+  Expect.throws(() => raf.mapSync(FILE_SIZE - 10, FILE_SIZE + 10),
+                (e) => e is FileSystemException);
+  Expect.throws(() => raf.mapSync(0, 10, 1), (e) => e is ArgumentError);
+  raf.closeSync();
+  Expect.throws(() => raf.mapSync(), (e) => e is FileSystemException);
+}
+
+Future testMap(File file) {
+  return file.open().then((raf) {
+    return raf.map()
+        .then((data) {
+          expectRange(data, 0, FILE_SIZE);
+          return raf.map(12345, 54321, FileMapHint.SEQUENTIAL);
+        })
+        .then((data) {
+          expectRange(data, 12345, 54321);
+          return raf.map(0, FILE_SIZE + 1);
+        })
+        .then((_) => Expect.fail("Mapping beyond the end of the file"),
+              onError: (e) => Expect.isTrue(e is FileSystemException))
+        .then((_) => raf.close());
+  });
+}
+
+main() {
+  asyncStart();
+  var dir = Directory.systemTemp.createTempSync('file_map_test');
+  var file = createFile(dir);
+  testMapSync(file);
+  testMapSyncInvalidArguments(file);
+  testMap(file).then((_) {
+    // Windows does not delete files which are still mapped, and the lists
+    // are only unmapped when they are garbage collected.
+    if (!Platform.isWindows) dir.deleteSync(recursive: true);
+    asyncEnd();
+  });
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test positional reads and writes and batched reads on RandomAccessFile.
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_SIZE = 10000;
+
+int expectedByte(int index) => (index * 7) & 0xff;
+
+void expectRange(List<int> data, int start, int end) {
+  Expect.equals(end - start, data.length);
+  for (int i = 0; i < data.length; i++) {
+    Expect.equals(expectedByte(start + i), data[i]);
+  }
+}
+
+File createFile(Directory dir) {
+  var data = new Uint8List(FILE_SIZE);
+  for (int i = 0; i < FILE_SIZE; i++) data[i] = expectedByte(i);
+  var file = new File("${dir.path}/file");
+  file.writeAsBytesSync(data);
+  return file;
+}
+
+void testReadAtSync(File file) {
+  var raf = file.openSync();
+  raf.setPositionSync(17);
+  expectRange(raf.readAtSync(0, 100), 0, 100);
+  expectRange(raf.readAtSync(5000, 1), 5000, 5001);
+  // Reads beyond the end of the file are short.
+  expectRange(raf.readAtSync(FILE_SIZE - 10, 100), FILE_SIZE - 10, FILE_SIZE);
+  Expect.equals(0, raf.readAtSync(FILE_SIZE + 10, 100).length);
+  Expect.equals(17, raf.positionSync());
+  Expect.throws(() => raf.readAtSync(-1, 1), (e) => e is RangeError);
+  Expect.throws(() => raf.readAtSync(0, -1), (e) => e is RangeError);
+  raf.closeSync();
+}
+
+void testWriteAtSync(File file) {
+  var raf = file.openSync(mode: FileMode.APPEND);
+  raf.setPositionSync(17);
+  raf.writeAtSync(100, [1, 2, 3, 4, 5], 1, 4);
+  raf.writeAtSync(200, new Uint8List.fromList([6, 7]));
+  Expect.equals(17, raf.positionSync());
+  Expect.listEquals([2, 3, 4], raf.readAtSync(100, 3));
+  Expect.listEquals([6, 7], raf.readAtSync(200, 2));
+  // Restore the original bytes.
+  var original = new Uint8List(3);
+  for (int i = 0; i < 3; i++) original[i] = expectedByte(100 + i);
+  raf.writeAtSync(100, original);
+  raf.writeAtSync(200, [expectedByte(200), expectedByte(201)]);
+  Expect.throws(() => raf.writeAtSync(-1, [1]), (e) => e is RangeError);
+  Expect.throws(() => raf.writeAtSync(0, [1], 0, 2), (e) => e is RangeError);
+  raf.closeSync();
+  expectRange(file.readAsBytesSync(), 0, FILE_SIZE);
+}
+
+Future testReadAtWriteAt(File file) {
+  return file.open(mode: FileMode.APPEND).then((raf) {
+    return raf.setPosition(17)
+        .then((_) => raf.writeAt(300, [8, 9, 10], 1))
+        .then((_) => raf.readAt(299, 4))
+        .then((data) {
+          Expect.listEquals([expectedByte(299), 9, 10, expectedByte(302)],
+                            data);
+          return raf.writeAt(300, [expectedByte(300), expectedByte(301)]);
+        })
+        .then((_) => raf.readAt(FILE_SIZE - 1, 10))
+        .then((data) {
+          expectRange(data, FILE_SIZE - 1, FILE_SIZE);
+          return raf.position();
+        })
+        .then((position) {
+          Expect.equals(17, position);
+          return raf.close();
+        });
+  });
+}
+
+Future testReadBatch(File file) {
+  var positions = [];
+  var lengths = [];
+  for (int i = 0; i < 1000; i++) {
+    positions.add((i * 7919) % FILE_SIZE);
+    lengths.add(i % 17);
+  }
+  // A region beyond the end of the file and an empty region.
+  positions.add(FILE_SIZE - 5);
+  lengths.add(10);
+  positions.add(0);
+  lengths.add(0);
+  return file.open().then((raf) {
+    return raf.readBatch(positions, lengths)
+        .then((result) {
+          Expect.equals(positions.length, result.length);
+          for (int i = 0; i < positions.length; i++) {
+            int start = positions[i];
+            int end = start + lengths[i];
+            if (end > FILE_SIZE) end = FILE_SIZE;
+            expectRange(result[i], start, end);
+          }
+          return raf.readBatch([], []);
+        })
+        .then((result) {
+          Expect.equals(0, result.length);
+          Expect.throws(() => raf.readBatch([0], []),
+                        (e) => e is ArgumentError);
+          Expect.throws(() => raf.readBatch([0], [-1]),
+                        (e) => e is RangeError);
+          return raf.close();
+        });
+  });
+}
+
+main() {
+  asyncStart();
+  var dir = Directory.systemTemp.createTempSync('file_read_at_test');
+  var file = createFile(dir);
+  testReadAtSync(file);
+  testWriteAtSync(file);
+  testReadAtWriteAt(file)
+      .then((_) => testReadBatch(file))
+      .then((_) {
+        dir.deleteSync(recursive: true);
+        asyncEnd();
+      });
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test many concurrent requests of all categories to the IO service.
+//
+// VMOptions=
+// VMOptions=--io-service-workers=1
+// VMOptions=--io-service-workers=3
+
+import "dart:async";
+import "dart:io";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_COUNT = 20;
+const int ROUNDS = 10;
+
+Future testFiles(Directory dir) {
+  var futures = [];
+  for (int i = 0; i < FILE_COUNT; i++) {
+    var file = new File("${dir.path}/file$i");
+    futures.add(file.writeAsString("$i")
+        .then((_) => file.length())
+        .then((length) {
+          Expect.equals("$i".length, length);
+          return file.readAsString();
+        })
+        .then((contents) => Expect.equals("$i", contents)));
+  }
+  return Future.wait(futures);
+}
+
+Future testStats(Directory dir) {
+  var futures = [];
+  for (int i = 0; i < FILE_COUNT * ROUNDS; i++) {
+    var file = new File("${dir.path}/file${i % FILE_COUNT}");
+    futures.add(file.exists().then(Expect.isTrue));
+    futures.add(FileStat.stat(file.path).then((stat) {
+      Expect.equals(FileSystemEntityType.FILE, stat.type);
+    }));
+  }
+  return Future.wait(futures);
+}
+
+Future testDirectories(Directory dir) {
+  var futures = [];
+  for (int i = 0; i < ROUNDS; i++) {
+    futures.add(new Directory("${dir.path}/dir$i").create()
+        .then((created) => created.exists())
+        .then(Expect.isTrue));
+    futures.add(dir.list().length.then((count) {
+      Expect.isTrue(count >= FILE_COUNT);
+    }));
+  }
+  return Future.wait(futures);
+}
+
+Future testLookups() {
+  var futures = [];
+  for (int i = 0; i < ROUNDS; i++) {
+    futures.add(InternetAddress.lookup("localhost").then((addresses) {
+      Expect.isTrue(addresses.isNotEmpty);
+    }));
+  }
+  return Future.wait(futures);
+}
+
+main() {
+  asyncStart();
+  var dir = Directory.systemTemp.createTempSync('io_service_workers_test');
+  testFiles(dir)
+      .then((_) => Future.wait([testStats(dir),
+                                testDirectories(dir),
+                                testLookups()]))
+      .then((_) {
+        dir.deleteSync(recursive: true);
+        asyncEnd();
+      });
+}
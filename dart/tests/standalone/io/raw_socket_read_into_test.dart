@@ -0,0 +1,100 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// VMOptions=
+// VMOptions=--short_socket_read
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int DATA_SIZE = 100000;
+
+int expectedByte(int index) => (index * 7) & 0xff;
+
+// Sends DATA_SIZE bytes from a server to a client which reads them into the
+// same buffer over and over.
+testReadInto(List<int> buffer, int start, int end) {
+  asyncStart();
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      var data = new Uint8List(DATA_SIZE);
+      for (int i = 0; i < DATA_SIZE; i++) data[i] = expectedByte(i);
+      int written = 0;
+      client.listen((event) {
+        switch (event) {
+          case RawSocketEvent.WRITE:
+            written += client.write(data, written, DATA_SIZE - written);
+            if (written < DATA_SIZE) {
+              client.writeEventsEnabled = true;
+            } else {
+              client.shutdown(SocketDirection.SEND);
+            }
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            client.close();
+            server.close();
+            break;
+        }
+      });
+    });
+
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      int received = 0;
+      socket.writeEventsEnabled = false;
+      socket.listen((event) {
+        switch (event) {
+          case RawSocketEvent.READ:
+            int bytes;
+            do {
+              bytes = socket.readInto(buffer, start, end);
+              Expect.isTrue(bytes >= 0 && bytes <= end - start);
+              for (int i = 0; i < bytes; i++) {
+                Expect.equals(expectedByte(received + i), buffer[start + i]);
+              }
+              received += bytes;
+            } while (bytes > 0);
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            Expect.equals(DATA_SIZE, received);
+            socket.close();
+            asyncEnd();
+            break;
+        }
+      });
+    });
+  });
+}
+
+testInvalidArguments() {
+  asyncStart();
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) => client.close());
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      var buffer = new Uint8List(10);
+      Expect.throws(() => socket.readInto(null));
+      Expect.throws(() => socket.readInto(buffer, -1));
+      Expect.throws(() => socket.readInto(buffer, 5, 4));
+      Expect.throws(() => socket.readInto(buffer, 0, 11));
+      Expect.equals(0, socket.readInto(buffer, 5, 5));
+      socket.close();
+      server.close();
+      asyncEnd();
+    });
+  });
+}
+
+main() {
+  testReadInto(new Uint8List(4096), 0, 4096);
+  testReadInto(new Uint8List(4096), 100, 1000);
+  testReadInto(new List<int>(1000), 10, 1000);
+  testInvalidArguments();
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// VMOptions=
+// VMOptions=--short_socket_read
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+int expectedByte(int index) => (index * 7) & 0xff;
+
+// Returns lists of the given lengths which together hold the expected bytes,
+// alternating between Uint8List, views, and plain lists.
+List<List<int>> makeBuffers(List<int> lengths) {
+  var buffers = [];
+  int index = 0;
+  for (int i = 0; i < lengths.length; i++) {
+    var buffer;
+    switch (i % 3) {
+      case 0:
+        buffer = new Uint8List(lengths[i]);
+        break;
+      case 1:
+        buffer = new Uint8List.view(new Uint8List(lengths[i] + 8).buffer,
+                                    4,
+                                    lengths[i]);
+        break;
+      case 2:
+        buffer = new List<int>(lengths[i]);
+        break;
+    }
+    for (int j = 0; j < lengths[i]; j++) buffer[j] = expectedByte(index++);
+    buffers.add(buffer);
+  }
+  return buffers;
+}
+
+// Sends the buffers from a server to a client with writeList, continuing
+// after partial writes from the buffer and offset the write ended at.
+testWriteList(List<int> lengths) {
+  asyncStart();
+  int total = lengths.fold(0, (sum, length) => sum + length);
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      var buffers = makeBuffers(lengths);
+      int offset = 0;
+      client.listen((event) {
+        switch (event) {
+          case RawSocketEvent.WRITE:
+            int written = client.writeList(buffers, offset);
+            offset += written;
+            while (buffers.isNotEmpty && offset >= buffers[0].length) {
+              offset -= buffers[0].length;
+              buffers.removeAt(0);
+            }
+            if (buffers.isNotEmpty) {
+              client.writeEventsEnabled = true;
+            } else {
+              client.shutdown(SocketDirection.SEND);
+            }
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            client.close();
+            server.close();
+            break;
+        }
+      });
+    });
+
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      int received = 0;
+      socket.writeEventsEnabled = false;
+      socket.listen((event) {
+        switch (event) {
+          case RawSocketEvent.READ:
+            var data = socket.read();
+            for (int i = 0; i < data.length; i++) {
+              Expect.equals(expectedByte(received + i), data[i]);
+            }
+            received += data.length;
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            Expect.equals(total, received);
+            socket.close();
+            asyncEnd();
+            break;
+        }
+      });
+    });
+  });
+}
+
+testInvalidArguments() {
+  asyncStart();
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) => client.close());
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      var buffer = new Uint8List(10);
+      Expect.throws(() => socket.writeList(null));
+      Expect.throws(() => socket.writeList([buffer], -1));
+      Expect.throws(() => socket.writeList([buffer], 11));
+      Expect.throws(() => socket.writeList([], 1));
+      Expect.throws(() => socket.writeList([buffer, null]));
+      Expect.equals(0, socket.writeList([]));
+      socket.close();
+      server.close();
+      asyncEnd();
+    });
+  });
+}
+
+main() {
+  testWriteList([100]);
+  testWriteList([200, 4000, 0, 4000, 4000]);
+  testWriteList(new List.filled(100, 1000));
+  testWriteList([1000000, 10, 1000000]);
+  testInvalidArguments();
+}
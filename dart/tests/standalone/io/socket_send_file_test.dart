@@ -0,0 +1,156 @@
+// Copyright (c) 2013, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// VMOptions=
+// VMOptions=--short_socket_read
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_SIZE = 300000;
+
+int expectedByte(int index) => (index * 7) & 0xff;
+
+RandomAccessFile createFile(Directory dir) {
+  var data = new Uint8List(FILE_SIZE);
+  for (int i = 0; i < FILE_SIZE; i++) data[i] = expectedByte(i);
+  var file = new File("${dir.path}/file");
+  file.writeAsBytesSync(data);
+  return file.openSync();
+}
+
+// Connects a client which collects all the data to a server and calls send
+// with the server side socket. Calls check with the received data.
+Future connect(void send(socket), void check(List<int> received)) {
+  var completer = new Completer();
+  ServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((socket) {
+      server.close();
+      send(socket);
+    });
+    Socket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      var received = [];
+      socket.listen(received.addAll, onDone: () {
+        check(received);
+        socket.destroy();
+        completer.complete();
+      });
+    });
+  });
+  return completer.future;
+}
+
+// Sends a range of the file between other data.
+Future testSendFile(RandomAccessFile file, int start, int end) {
+  file.setPositionSync(17);
+  return connect((socket) {
+    socket.add([1, 2, 3]);
+    socket.sendFile(file, start, end).then((result) {
+      Expect.identical(socket, result);
+      Expect.equals(17, file.positionSync());
+      socket.add([4, 5, 6]);
+      socket.close();
+    });
+    // The socket is bound until the file has been sent.
+    Expect.throws(() => socket.add([7]), (e) => e is StateError);
+  }, (received) {
+    if (end == null) end = FILE_SIZE;
+    if (start == null) start = 0;
+    Expect.equals(3 + (end - start) + 3, received.length);
+    Expect.listEquals([1, 2, 3], received.sublist(0, 3));
+    for (int i = 0; i < end - start; i++) {
+      Expect.equals(expectedByte(start + i), received[3 + i]);
+    }
+    Expect.listEquals([4, 5, 6], received.sublist(received.length - 3));
+  });
+}
+
+// Sends the file with RawSocket.sendFile, continuing on write events.
+Future testRawSendFile(RandomAccessFile file) {
+  var completer = new Completer();
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) {
+      int position = 0;
+      client.listen((event) {
+        switch (event) {
+          case RawSocketEvent.WRITE:
+            position += client.sendFile(file, position, FILE_SIZE - position);
+            if (position < FILE_SIZE) {
+              client.writeEventsEnabled = true;
+            } else {
+              client.shutdown(SocketDirection.SEND);
+            }
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            client.close();
+            server.close();
+            break;
+        }
+      });
+    });
+
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      int received = 0;
+      socket.writeEventsEnabled = false;
+      socket.listen((event) {
+        switch (event) {
+          case RawSocketEvent.READ:
+            var data = socket.read();
+            for (int i = 0; i < data.length; i++) {
+              Expect.equals(expectedByte(received + i), data[i]);
+            }
+            received += data.length;
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            Expect.equals(FILE_SIZE, received);
+            socket.close();
+            completer.complete();
+            break;
+        }
+      });
+    });
+  });
+  return completer.future;
+}
+
+Future testInvalidArguments(RandomAccessFile file) {
+  var completer = new Completer();
+  RawServerSocket.bind(InternetAddress.LOOPBACK_IP_V4, 0).then((server) {
+    server.listen((client) => client.close());
+    RawSocket.connect(InternetAddress.LOOPBACK_IP_V4, server.port)
+        .then((socket) {
+      Expect.throws(() => socket.sendFile(null, 0, 1));
+      Expect.throws(() => socket.sendFile(file, -1, 1));
+      Expect.throws(() => socket.sendFile(file, 0, -1));
+      Expect.equals(0, socket.sendFile(file, 0, 0));
+      socket.close();
+      server.close();
+      completer.complete();
+    });
+  });
+  return completer.future;
+}
+
+main() {
+  asyncStart();
+  var dir = Directory.systemTemp.createTempSync('socket_send_file_test');
+  var file = createFile(dir);
+  Future.wait([testSendFile(file, null, null),
+               testSendFile(file, 1000, 1000),
+               testSendFile(file, 12345, 200000),
+               testRawSendFile(file),
+               testInvalidArguments(file)]).then((_) {
+    file.closeSync();
+    dir.deleteSync(recursive: true);
+    asyncEnd();
+  });
+}